@@ -1,6 +1,4 @@
 #include <algorithm>
-#include <iterator>
-#include <sstream>
 #include "CommandConsole.hpp"
 #include "../Graphics/Renderer.hpp"
 #include "../Graphics/VertexDataContainers.hpp"
@@ -8,6 +6,7 @@
 #pragma region Command Console Const Variable Definitions
 STATIC CommandConsole* CommandConsole::s_console = nullptr;
 STATIC std::map< std::string, CommandConsole::ConsoleCommand > CommandConsole::s_commandRegistry;
+STATIC LogMessageQueue CommandConsole::s_postedLines;
 
 STATIC const Color CommandConsole::BACKGROUND_PANE_COLOR = Color( 0.133333f, 0.156862f, 0.164705f, 0.4f );
 STATIC const Color CommandConsole::BORDER_COLOR = Color( 0.f, 0.f, 1.f, 1.f );
@@ -17,28 +16,6 @@ STATIC const float CommandConsole::TEXT_LINE_HEIGHT = 30.f;
 STATIC const float CommandConsole::Prompt::CURSOR_BLINK_RATE_SECONDS = 0.75f;
 #pragma endregion
 
-//-----------------------------------------------------------------------------------------------
-struct CommandConsole::CommandArguments
-{
-	std::string argumentsAsSingleString;
-	std::vector< std::string > argumentsAsStringArray;
-
-	CommandArguments() { }
-
-	CommandArguments( const std::string& singleStringOfArguments )
-		: argumentsAsSingleString( singleStringOfArguments )
-	{
-		//Assume that arguments are white-space delimited, so we can use a stringstream to parse
-		std::istringstream argumentStream( singleStringOfArguments );
-
-		//This wonderful piece of code courtesy of Zunino on Stack Overflow:
-		//http://stackoverflow.com/questions/236129/how-to-split-a-string-in-c
-		std::copy( std::istream_iterator< std::string >( argumentStream ), 
-					std::istream_iterator< std::string >(),
-					std::back_inserter< std::vector< std::string > >( argumentsAsStringArray ) );
-	}
-};
-
 //-----------------------------------------------------------------------------------------------
 struct CommandConsole::PaneColorData
 {
@@ -55,12 +32,83 @@ struct CommandConsole::PaneColorData
 	{ }
 };
 
+#pragma region Log Ring Buffer
+//-----------------------------------------------------------------------------------------------
+void CommandConsole::Log::Clear()
+{
+	storedLines.clear();
+	oldestLineIndex = 0;
+	numberOfStoredLines = 0;
+	storedTextBytes = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+//The dropped line's text is released here rather than when its slot is next written, since
+//assigning a short string over a long one would keep the long one's allocation.
+void CommandConsole::Log::DropOldestLine()
+{
+	TextLine& oldestLine = storedLines[ oldestLineIndex ];
+	storedTextBytes -= oldestLine.text.length();
+	std::string().swap( oldestLine.text );
+
+	oldestLineIndex = ( oldestLineIndex + 1 ) % MAXIMUM_STORED_LINES;
+	--numberOfStoredLines;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Until the ring first fills, the next free slot is always the end of the vector.
+void CommandConsole::Log::StoreLine( const TextLine& line )
+{
+	//A single line longer than the whole budget is cut down to fit it
+	size_t lineBytes = ( line.text.length() < MAXIMUM_STORED_TEXT_BYTES ) ? line.text.length() : MAXIMUM_STORED_TEXT_BYTES;
+	while( numberOfStoredLines > 0 && ( numberOfStoredLines == MAXIMUM_STORED_LINES || storedTextBytes + lineBytes > MAXIMUM_STORED_TEXT_BYTES ) )
+		DropOldestLine();
+
+	unsigned int newestLineIndex = ( oldestLineIndex + numberOfStoredLines ) % MAXIMUM_STORED_LINES;
+	if( newestLineIndex == storedLines.size() )
+		storedLines.push_back( line );
+	else
+		storedLines[ newestLineIndex ] = line;
+	storedLines[ newestLineIndex ].text.resize( lineBytes );
+
+	++numberOfStoredLines;
+	storedTextBytes += lineBytes;
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+void CommandConsole::DrainPostedLines()
+{
+	static const Color DROPPED_LINES_COLOR = Color( 1.f, 0.5f, 0.f, 1.f );
+
+	while( s_postedLines.TryPop( m_postedLine ) )
+		WriteTextToLog( m_postedLine.text, m_postedLine.textColor, m_postedLine.backgroundColor, m_postedLine.shadowColor );
+
+	unsigned int numberOfDroppedLines = s_postedLines.TakeNumberOfDroppedMessages();
+	if( numberOfDroppedLines > 0 )
+	{
+		std::ostringstream warning;
+		warning << "WARNING: " << numberOfDroppedLines << " posted log lines were dropped because the queue was full.";
+		WriteTextToLog( warning.str(), DROPPED_LINES_COLOR );
+	}
+}
+
 //-----------------------------------------------------------------------------------------------
 void CommandConsole::ExecuteCommandInPrompt()
+{
+	//Run a copy, since the command may well clear or change the prompt
+	std::string commandLine = m_prompt.currentInput;
+	ExecuteCommandLine( commandLine );
+
+	ClearPrompt();
+}
+
+//-----------------------------------------------------------------------------------------------
+void CommandConsole::ExecuteCommandLine( const std::string& commandLine )
 {
 	std::string command;
 	CommandArguments arguments;
-	SplitCommandIntoCommandAndArguments( m_prompt.currentInput, command, arguments );
+	SplitCommandIntoCommandAndArguments( commandLine, command, arguments );
 
 	std::map< std::string, ConsoleCommand >::const_iterator commandPairing = s_commandRegistry.find( command );
 	if( commandPairing == s_commandRegistry.end() )
@@ -71,8 +119,75 @@ void CommandConsole::ExecuteCommandInPrompt()
 	{
 		commandPairing->second( arguments );
 	}
+}
 
-	ClearPrompt();
+//-----------------------------------------------------------------------------------------------
+bool CommandConsole::ExecuteScript( const std::string& filePath )
+{
+	static const Color SCRIPT_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+
+	if( m_runningScripts.size() >= MAXIMUM_SCRIPT_NESTING_DEPTH )
+	{
+		WriteTextToLog( "ERROR: Scripts are nested too deeply to run " + filePath, SCRIPT_ERROR_COLOR );
+		return false;
+	}
+
+	CommandScript script;
+	std::string errorMessage;
+	if( !script.LoadFromFile( filePath, errorMessage ) )
+	{
+		WriteTextToLog( "ERROR: " + errorMessage, SCRIPT_ERROR_COLOR );
+		return false;
+	}
+
+	m_runningScripts.push_back( script );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void CommandConsole::StopScripts()
+{
+	static const Color SCRIPT_TEXT_COLOR = Color( 0.6f, 0.6f, 0.6f, 1.f );
+
+	if( m_runningScripts.empty() )
+		return;
+
+	m_runningScripts.clear();
+	WriteTextToLog( "Stopped all running scripts.", SCRIPT_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Commands are echoed so a log file shows what a replayed scenario actually did, and when.
+void CommandConsole::RunScripts( float deltaSeconds )
+{
+	static const Color SCRIPT_TEXT_COLOR = Color( 0.6f, 0.6f, 0.6f, 1.f );
+
+	if( m_runningScripts.empty() )
+		return;
+
+	m_runningScripts.back().CountDownWait( deltaSeconds );
+
+	std::string commandLine;
+	while( !m_runningScripts.empty() )
+	{
+		//Re-fetched every pass: a command can start another script and move the vector
+		CommandScript& script = m_runningScripts.back();
+		if( script.IsWaiting() )
+			return;
+
+		if( script.IsFinished() )
+		{
+			WriteTextToLog( "Finished script " + script.GetFilePath(), SCRIPT_TEXT_COLOR );
+			m_runningScripts.pop_back();
+			continue;
+		}
+
+		if( !script.TakeNextCommandLine( commandLine ) )
+			continue;
+
+		WriteTextToLog( "> " + commandLine, SCRIPT_TEXT_COLOR );
+		ExecuteCommandLine( commandLine );
+	}
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -146,12 +261,12 @@ void CommandConsole::RenderBackgroundPanes() const
 	static const int BEGINNING_OF_BUFFER = 0;
 	static const int SIZE_OF_QUAD_ARRAY_STRUCTURE = sizeof( PaneColorData );
 	static const int NUMBER_OF_VERTEX_COORDINATES = 2;
-	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, BEGINNING_OF_BUFFER );
+	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, ( const void* )BEGINNING_OF_BUFFER );
 
 	static const int NUMBER_OF_COLOR_COORDINATES = 4;
 	renderer->SetPointerToColorArray( NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, ( float* )offsetof( PaneColorData, paneColor ) );
 	
-	renderer->RenderPartOfArray( Renderer::TRIANGLE_STRIP, 9, Renderer::UNSIGNED_SHORT_TYPE, BEGINNING_OF_BUFFER );
+	renderer->RenderPartOfArray( Renderer::TRIANGLE_STRIP, 9, Renderer::UNSIGNED_SHORT_TYPE, ( const void* )BEGINNING_OF_BUFFER );
 
 	renderer->BindBufferObject( Renderer::INDEX_BUFFER, 0 );
 	renderer->BindBufferObject( Renderer::ARRAY_BUFFER, 0 );
@@ -167,13 +282,13 @@ void CommandConsole::RenderBorders() const
 	static const int BEGINNING_OF_BUFFER = 0;
 	static const int SIZE_OF_QUAD_ARRAY_STRUCTURE = sizeof( PaneColorData );
 	static const int NUMBER_OF_VERTEX_COORDINATES = 2;
-	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, BEGINNING_OF_BUFFER );
+	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, ( const void* )BEGINNING_OF_BUFFER );
 
 	static const int NUMBER_OF_COLOR_COORDINATES = 4;
 	renderer->SetPointerToColorArray( NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_QUAD_ARRAY_STRUCTURE, ( float* )offsetof( PaneColorData, borderColor ) );
 
 	renderer->SetLineWidth( BORDER_THICKNESS );
-	renderer->RenderPartOfArray( Renderer::LINE_LOOP, 9, Renderer::UNSIGNED_SHORT_TYPE, BEGINNING_OF_BUFFER );
+	renderer->RenderPartOfArray( Renderer::LINE_LOOP, 9, Renderer::UNSIGNED_SHORT_TYPE, ( const void* )BEGINNING_OF_BUFFER );
 
 	renderer->BindBufferObject( Renderer::INDEX_BUFFER, 0 );
 	renderer->BindBufferObject( Renderer::ARRAY_BUFFER, 0 );
@@ -188,19 +303,22 @@ void CommandConsole::RenderConsoleText() const
 	float textStartX = m_log.lowerLeftCorner.x + 10.f; //Get off the screen edge
 	float currentTextLowerLeftY = m_log.lowerLeftCorner.y + 10.f; //Get above the border
 
-	std::vector< TextLine >::const_reverse_iterator line;
-	for( line = m_log.previousOutput.rbegin(); line != m_log.previousOutput.rend(); ++line )
+	//Walk up from the newest line and stop at the top of the pane, so the cost is one screenful of
+	//text no matter how much history the log holds
+	for( unsigned int i = 0; i < m_log.GetNumberOfStoredLines() && currentTextLowerLeftY < m_log.upperRightCorner.y; ++i )
 	{
-		renderer->Render2DText( line->text, m_font, TEXT_LINE_HEIGHT, FloatVector2( textStartX, currentTextLowerLeftY ), 
-								line->textColor, line->backgroundColor, line->shadowColor );
+		const TextLine& line = m_log.GetLineFromNewest( i );
+		m_textBatch.AddText( line.text, m_font, TEXT_LINE_HEIGHT, FloatVector2( textStartX, currentTextLowerLeftY ), 
+							 line.textColor, line.backgroundColor, line.shadowColor );
 		currentTextLowerLeftY += TEXT_LINE_HEIGHT + LINE_VERTICAL_SPACING;
 	}
 
-
-
-
 	FloatVector2 consoleInputStartLocation( m_prompt.lowerLeftCorner.x + 5.f, m_prompt.lowerLeftCorner.y + 5.f );
-	renderer->Render2DText( "> " + m_prompt.currentInput, m_font, TEXT_LINE_HEIGHT, consoleInputStartLocation, Color( 1.f, 1.f, 0.f, 1.f ) );
+	m_textBatch.AddText( "> " + m_prompt.currentInput, m_font, TEXT_LINE_HEIGHT, consoleInputStartLocation, Color( 1.f, 1.f, 0.f, 1.f ) );
+
+	//Every line shares one font sheet, so this goes out as one background draw and one glyph draw
+	m_textBatch.RecordInto( m_textCommands );
+	m_textCommands.Submit( renderer );
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -220,7 +338,7 @@ void CommandConsole::RenderTextCursor() const
 	static const int BEGINNING_OF_BUFFER = 0;
 	static const int SIZE_OF_LINE_ARRAY_STRUCTURE = sizeof( VertexColorData2D );
 	static const int NUMBER_OF_VERTEX_COORDINATES = 2;
-	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_LINE_ARRAY_STRUCTURE, BEGINNING_OF_BUFFER );
+	renderer->SetPointerToVertexArray( NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_LINE_ARRAY_STRUCTURE, ( const void* )BEGINNING_OF_BUFFER );
 
 	static const int NUMBER_OF_COLOR_COORDINATES = 4;
 	renderer->SetPointerToColorArray( NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, SIZE_OF_LINE_ARRAY_STRUCTURE, ( float* )offsetof( VertexColorData2D, red ) );
@@ -263,7 +381,7 @@ void CommandConsole::Render() const
 	renderer->EnableArrayType( Renderer::COLOR_ARRAYS );
 
 	const ShaderProgram* activeShader = renderer->GetActiveShaderProgram();
-	unsigned int shaderTextureToggleID = renderer->GetUniformVariableLocation( activeShader, "u_texturesEnabled" );
+	int shaderTextureToggleID = activeShader->GetUniformVariableIDFromName( STRING_ID( "u_texturesEnabled" ) );
 	renderer->SetUniformVariable( shaderTextureToggleID, 0 );
 
 	RenderBackgroundPanes();
@@ -290,8 +408,14 @@ void CommandConsole::Render() const
 }
 
 //-----------------------------------------------------------------------------------------------
+//Runs every frame, whether or not the console is showing, so posted lines and the log file keep up.
 void CommandConsole::Update( float deltaSeconds )
 {
+	RunScripts( deltaSeconds );
+
+	DrainPostedLines();
+	m_logFile.SubmitPendingLines();
+
 	m_prompt.secondsSinceCursorBlinkChange += deltaSeconds;
 	if( m_prompt.secondsSinceCursorBlinkChange > Prompt::CURSOR_BLINK_RATE_SECONDS )
 	{
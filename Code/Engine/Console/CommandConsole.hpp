@@ -3,12 +3,20 @@
 #pragma once
 
 //-----------------------------------------------------------------------------------------------
+#include <algorithm>
 #include <functional>
+#include <iterator>
+#include <sstream>
 #include <string>
 #include <vector>
 #include "../Font/BitmapFont.hpp"
+#include "../Graphics/RenderCommandBuffer.hpp"
+#include "../Graphics/TextBatch.hpp"
 #include "../Math/FloatVector2.hpp"
 #include "../Color.hpp"
+#include "CommandScript.hpp"
+#include "LogFileSink.hpp"
+#include "LogMessageQueue.hpp"
 
 //-----------------------------------------------------------------------------------------------
 STATIC class CommandConsole
@@ -41,19 +49,36 @@ private:
 	};
 	
 	//-----------------------------------------------------------------------------------------------
+	//A ring of the most recent lines. Once either cap is reached the oldest lines are dropped, so a
+	//benchmark that spams the log for an hour holds no more memory than one that ran for a minute.
 	struct Log
 	{
+		static const unsigned int MAXIMUM_STORED_LINES = 2048;
+		static const size_t MAXIMUM_STORED_TEXT_BYTES = 256 * 1024;
+
 		Log( const FloatVector2& logLowerLeftCorner, const FloatVector2& logUpperRightCorner )
 			: lowerLeftCorner( logLowerLeftCorner )
 			, upperRightCorner( logUpperRightCorner )
+			, oldestLineIndex( 0 )
+			, numberOfStoredLines( 0 )
+			, storedTextBytes( 0 )
 		{ }
 
-		void Clear() { previousOutput.clear(); }
-		void StoreLine( TextLine line ) { previousOutput.push_back( line ); }
+		void Clear();
+		void DropOldestLine();
+		const TextLine& GetLineFromNewest( unsigned int linesBeforeNewest ) const 
+		{ 
+			return storedLines[ ( oldestLineIndex + numberOfStoredLines - 1 - linesBeforeNewest ) % MAXIMUM_STORED_LINES ]; 
+		}
+		unsigned int GetNumberOfStoredLines() const { return numberOfStoredLines; }
+		void StoreLine( const TextLine& line );
 
 		//Data Members
 		FloatVector2 lowerLeftCorner, upperRightCorner;
-		std::vector< TextLine > previousOutput;
+		std::vector< TextLine > storedLines; //Grows to MAXIMUM_STORED_LINES, then wraps around
+		unsigned int oldestLineIndex;
+		unsigned int numberOfStoredLines;
+		size_t storedTextBytes;
 	};
 
 	//-----------------------------------------------------------------------------------------------
@@ -91,17 +116,35 @@ public:
 	void ClearLog( ) { m_log.Clear(); }
 	void ClearPrompt();
 	void ExecuteCommandInPrompt();
+	void ExecuteCommandLine( const std::string& commandLine );
 	void MovePromptCursorLeft();
 	void MovePromptCursorRight();
 	void MovePromptCursorToStart()	{ m_prompt.cursorLocation = 0; }
 	void MovePromptCursorToEnd()	{ m_prompt.cursorLocation = m_prompt.currentInput.length(); }
 	bool PromptIsEmpty() const { return m_prompt.currentInput.empty(); }
+	const BitmapFont& GetFont() const { return m_font; }
 	void RemoveLetterLeftOfCursorPosition();
 	void RemoveLetterRightOfCursorPosition();
 
 	void WriteTextToLog( const std::string& text, const Color& textColor, const Color& backgroundColor = Color( 0.f, 0.f, 0.f, 0.f ), 
 							const Color& textShadowColor = Color( 0.f, 0.f, 0.f, 0.f ) );
 
+	//Safe from any thread, even before the console exists; the line shows up at the next Update.
+	//Never blocks, so if the queue fills up the line is dropped and the loss is reported instead.
+	static void PostTextToLog( const std::string& text, const Color& textColor, const Color& backgroundColor = Color( 0.f, 0.f, 0.f, 0.f ), 
+							   const Color& textShadowColor = Color( 0.f, 0.f, 0.f, 0.f ) );
+
+	//Mirrors every line logged from now on into a file, written by a background thread.
+	bool StartLogFile( const std::string& filePath ) { return m_logFile.Open( filePath ); }
+	void StopLogFile() { m_logFile.Close(); }
+	bool IsWritingLogFile() const { return m_logFile.IsOpen(); }
+
+	//Scripts run from the next Update on, a frame at a time. A script started from inside another
+	//one runs to its end before the rest of its caller.
+	bool ExecuteScript( const std::string& filePath );
+	bool IsRunningScript() const { return !m_runningScripts.empty(); }
+	void StopScripts();
+
 	void Render() const;
 	void Update( float deltaSeconds );
 
@@ -110,25 +153,34 @@ private:
 	static const Color BORDER_COLOR;
 	static const float BORDER_THICKNESS;
 	static const float TEXT_LINE_HEIGHT;
+	static const unsigned int MAXIMUM_SCRIPT_NESTING_DEPTH = 8;
 
 	static CommandConsole* s_console;
 	static std::map< std::string, ConsoleCommand > s_commandRegistry;
+	static LogMessageQueue s_postedLines;
 
 	CommandConsole( const FloatVector2& logLowerLeftCorner, const FloatVector2& logUpperRightCorner, 
 					const FloatVector2 promptLowerLeftCorner, const FloatVector2& promptUpperRightCorner );
 	void Initialize();
 
+	void DrainPostedLines();
 	void GenerateConsolePaneVBO();
 	void GenerateTextCursorVBO();
 	void RenderBackgroundPanes() const;
 	void RenderBorders() const;
 	void RenderConsoleText() const;
 	void RenderTextCursor() const;
+	void RunScripts( float deltaSeconds );
 	void SplitCommandIntoCommandAndArguments( const std::string& commandLine, std::string& out_command, CommandArguments& out_arguments ) const;
 
 	BitmapFont m_font;
 	Log m_log;
+	LogFileSink m_logFile;
+	LogMessageQueue::Message m_postedLine; //Reused while draining so posted text doesn't reallocate
 	Prompt m_prompt;
+	std::vector< CommandScript > m_runningScripts; //Innermost last
+	mutable TextBatch m_textBatch;
+	mutable RenderCommandBuffer m_textCommands;
 
 	unsigned int m_borderIndexBufferID;
 	unsigned int m_paneIndexBufferID;
@@ -142,6 +194,28 @@ private:
 
 
 
+//-----------------------------------------------------------------------------------------------
+struct CommandConsole::CommandArguments
+{
+	std::string argumentsAsSingleString;
+	std::vector< std::string > argumentsAsStringArray;
+
+	CommandArguments() { }
+
+	CommandArguments( const std::string& singleStringOfArguments )
+		: argumentsAsSingleString( singleStringOfArguments )
+	{
+		//Assume that arguments are white-space delimited, so we can use a stringstream to parse
+		std::istringstream argumentStream( singleStringOfArguments );
+
+		//This wonderful piece of code courtesy of Zunino on Stack Overflow:
+		//http://stackoverflow.com/questions/236129/how-to-split-a-string-in-c
+		std::copy( std::istream_iterator< std::string >( argumentStream ), 
+					std::istream_iterator< std::string >(),
+					std::back_inserter< std::vector< std::string > >( argumentsAsStringArray ) );
+	}
+};
+
 //-----------------------------------------------------------------------------------------------
 STATIC inline void CommandConsole::CreateConsole( const FloatVector2& logLowerLeftCorner, const FloatVector2& logUpperRightCorner, 
 													const FloatVector2 promptLowerLeftCorner, const FloatVector2& promptUpperRightCorner )
@@ -244,6 +318,14 @@ inline void CommandConsole::WriteTextToLog( const std::string& text, const Color
 											const Color& backgroundColor, const Color& textShadowColor )
 {
 	m_log.StoreLine( TextLine( text, textColor, backgroundColor, textShadowColor ) );
+	m_logFile.WriteLine( text );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC inline void CommandConsole::PostTextToLog( const std::string& text, const Color& textColor,
+												  const Color& backgroundColor, const Color& textShadowColor )
+{
+	s_postedLines.TryPush( text, textColor, backgroundColor, textShadowColor );
 }
 
 #endif //INCLUDED_COMMAND_CONSOLE_HPP
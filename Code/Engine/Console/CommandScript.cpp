@@ -0,0 +1,131 @@
+#include <cstdio>
+#include <cstdlib>
+#include <sstream>
+#include "../EngineDefines.hpp"
+#include "CommandScript.hpp"
+
+//-----------------------------------------------------------------------------------------------
+static bool ReadTextFile( const std::string& filePath, std::string& out_text )
+{
+	FILE* textFile = nullptr;
+#if defined( _WIN32 )
+	if( fopen_s( &textFile, filePath.c_str(), "rb" ) != 0 )
+		textFile = nullptr;
+#else
+	textFile = fopen( filePath.c_str(), "rb" );
+#endif
+	if( textFile == nullptr )
+		return false;
+
+	fseek( textFile, 0, SEEK_END );
+	long fileSize = ftell( textFile );
+	rewind( textFile );
+
+	out_text.resize( fileSize > 0 ? static_cast< size_t >( fileSize ) : 0 );
+	size_t bytesRead = out_text.empty() ? 0 : fread( &out_text[ 0 ], 1, out_text.size(), textFile );
+	fclose( textFile );
+	return bytesRead == out_text.size();
+}
+
+//-----------------------------------------------------------------------------------------------
+//"30f" is thirty frames, "2.5s" two and a half seconds; a bare number counts frames.
+STATIC bool CommandScript::ParseWait( const std::string& waitArgument, ScriptLine& out_waitLine )
+{
+	const char* argumentStart = waitArgument.c_str();
+	char* argumentEnd = nullptr;
+	double amount = strtod( argumentStart, &argumentEnd );
+	if( argumentEnd == argumentStart || amount < 0.0 )
+		return false;
+
+	std::string unit( argumentEnd );
+	out_waitLine.waitFrames = 0;
+	out_waitLine.waitSeconds = 0.f;
+	if( unit == "s" )
+		out_waitLine.waitSeconds = static_cast< float >( amount );
+	else if( unit == "f" || unit.empty() )
+		out_waitLine.waitFrames = static_cast< unsigned int >( amount );
+	else
+		return false;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool CommandScript::LoadFromFile( const std::string& filePath, std::string& out_errorMessage )
+{
+	m_filePath = filePath;
+	m_lines.clear();
+	m_nextLineIndex = 0;
+	m_framesToWait = 0;
+	m_secondsToWait = 0.f;
+
+	std::string scriptText;
+	if( !ReadTextFile( filePath, scriptText ) )
+	{
+		out_errorMessage = "Could not read " + filePath;
+		return false;
+	}
+
+	std::istringstream scriptStream( scriptText );
+	std::string line;
+	unsigned int lineNumber = 0;
+	while( std::getline( scriptStream, line ) )
+	{
+		++lineNumber;
+
+		size_t firstCharacter = line.find_first_not_of( " \t\r" );
+		if( firstCharacter == std::string::npos || line[ firstCharacter ] == '#' )
+			continue;
+		size_t lastCharacter = line.find_last_not_of( " \t\r" );
+
+		ScriptLine scriptLine;
+		scriptLine.commandLine.assign( line, firstCharacter, lastCharacter - firstCharacter + 1 );
+		scriptLine.waitFrames = 0;
+		scriptLine.waitSeconds = 0.f;
+
+		std::istringstream lineStream( scriptLine.commandLine );
+		std::string firstWord, waitArgument, extraArgument;
+		lineStream >> firstWord;
+		if( firstWord == "wait" )
+		{
+			if( !( lineStream >> waitArgument ) || ( lineStream >> extraArgument ) || !ParseWait( waitArgument, scriptLine ) )
+			{
+				std::ostringstream errorMessage;
+				errorMessage << filePath << "(" << lineNumber << "): expected \"wait <n>f\" or \"wait <n>s\"";
+				out_errorMessage = errorMessage.str();
+				m_lines.clear();
+				return false;
+			}
+			scriptLine.commandLine.clear();
+		}
+
+		m_lines.push_back( scriptLine );
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void CommandScript::CountDownWait( float deltaSeconds )
+{
+	if( m_framesToWait > 0 )
+		--m_framesToWait;
+
+	if( m_secondsToWait > 0.f )
+		m_secondsToWait -= deltaSeconds;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool CommandScript::TakeNextCommandLine( std::string& out_commandLine )
+{
+	const ScriptLine& scriptLine = m_lines[ m_nextLineIndex ];
+	++m_nextLineIndex;
+
+	if( scriptLine.commandLine.empty() )
+	{
+		m_framesToWait = scriptLine.waitFrames;
+		m_secondsToWait = scriptLine.waitSeconds;
+		return false;
+	}
+
+	out_commandLine = scriptLine.commandLine;
+	return true;
+}
@@ -0,0 +1,52 @@
+#ifndef INCLUDED_COMMAND_SCRIPT_HPP
+#define INCLUDED_COMMAND_SCRIPT_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <string>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+//A file of console commands, one per line, run by the console a frame at a time. Besides commands
+//a script can hold "wait <n>f" to pause for n frames or "wait <n>s" for n seconds of game time.
+//Blank lines and lines starting with '#' are skipped. Waits count game time rather than wall time,
+//so with a locked frame rate a script replays over exactly the same frames every run.
+//-----------------------------------------------------------------------------------------------
+class CommandScript
+{
+	struct ScriptLine
+	{
+		std::string commandLine; //Empty for a wait
+		unsigned int waitFrames;
+		float waitSeconds;
+	};
+
+	std::string m_filePath;
+	std::vector< ScriptLine > m_lines;
+	unsigned int m_nextLineIndex;
+	unsigned int m_framesToWait;
+	float m_secondsToWait;
+
+	static bool ParseWait( const std::string& waitArgument, ScriptLine& out_waitLine );
+
+public:
+	CommandScript()
+		: m_nextLineIndex( 0 )
+		, m_framesToWait( 0 )
+		, m_secondsToWait( 0.f )
+	{ }
+
+	//The whole file is checked up front, so a typo fails before anything has run rather than halfway through.
+	bool LoadFromFile( const std::string& filePath, std::string& out_errorMessage );
+
+	const std::string& GetFilePath() const { return m_filePath; }
+	bool IsFinished() const { return m_nextLineIndex >= m_lines.size(); }
+	bool IsWaiting() const { return m_framesToWait > 0 || m_secondsToWait > 0.f; }
+
+	//Call once a frame before taking lines.
+	void CountDownWait( float deltaSeconds );
+	//Returns false without a command when the next line is a wait, which starts counting down instead.
+	bool TakeNextCommandLine( std::string& out_commandLine );
+};
+
+#endif //INCLUDED_COMMAND_SCRIPT_HPP
@@ -0,0 +1,95 @@
+#include "LogFileSink.hpp"
+
+//-----------------------------------------------------------------------------------------------
+bool LogFileSink::Open( const std::string& filePath )
+{
+	Close();
+
+#if defined( _WIN32 )
+	if( fopen_s( &m_file, filePath.c_str(), "w" ) != 0 )
+		m_file = nullptr;
+#else
+	m_file = fopen( filePath.c_str(), "w" );
+#endif
+	if( m_file == nullptr )
+		return false;
+
+	m_isStopping = false;
+	m_writerThread = std::thread( &LogFileSink::RunWriterThread, this );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void LogFileSink::Close()
+{
+	if( m_file == nullptr )
+		return;
+
+	SubmitPendingLines();
+	{
+		std::lock_guard< std::mutex > handoffLock( m_handoffLock );
+		m_isStopping = true;
+	}
+	m_handoffSignal.notify_one();
+	m_writerThread.join();
+
+	fclose( m_file );
+	m_file = nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------
+void LogFileSink::WriteLine( const std::string& line )
+{
+	if( m_file == nullptr )
+		return;
+
+	m_unsubmittedText.append( line );
+	m_unsubmittedText.push_back( '\n' );
+}
+
+//-----------------------------------------------------------------------------------------------
+//If the writer hasn't caught up with last frame's text yet, this frame's is appended behind it.
+void LogFileSink::SubmitPendingLines()
+{
+	if( m_file == nullptr || m_unsubmittedText.empty() )
+		return;
+
+	{
+		std::lock_guard< std::mutex > handoffLock( m_handoffLock );
+		if( m_submittedText.empty() )
+			m_submittedText.swap( m_unsubmittedText );
+		else
+			m_submittedText.append( m_unsubmittedText );
+	}
+	m_unsubmittedText.clear();
+	m_handoffSignal.notify_one();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Writes happen outside the lock, so the owning thread can keep submitting while the disk is busy.
+void LogFileSink::RunWriterThread()
+{
+	std::string textToWrite;
+	for( ;; )
+	{
+		bool isStopping = false;
+		{
+			std::unique_lock< std::mutex > handoffLock( m_handoffLock );
+			while( m_submittedText.empty() && !m_isStopping )
+				m_handoffSignal.wait( handoffLock );
+
+			textToWrite.swap( m_submittedText );
+			isStopping = m_isStopping;
+		}
+
+		if( !textToWrite.empty() )
+		{
+			fwrite( textToWrite.data(), 1, textToWrite.size(), m_file );
+			fflush( m_file );
+			textToWrite.clear();
+		}
+
+		if( isStopping )
+			return;
+	}
+}
@@ -0,0 +1,52 @@
+#ifndef INCLUDED_LOG_FILE_SINK_HPP
+#define INCLUDED_LOG_FILE_SINK_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <condition_variable>
+#include <cstdio>
+#include <mutex>
+#include <string>
+#include <thread>
+
+//-----------------------------------------------------------------------------------------------
+//Mirrors log lines to a file from a background thread, so the frame never waits on the disk.
+//Lines gather on the owning thread and are handed over once a frame by SubmitPendingLines, which
+//only swaps two strings under the lock. All calls must come from the thread that opened the sink.
+//-----------------------------------------------------------------------------------------------
+class LogFileSink
+{
+	std::string m_unsubmittedText; //Owning thread only
+
+	std::mutex m_handoffLock;
+	std::condition_variable m_handoffSignal;
+	std::string m_submittedText;
+	bool m_isStopping;
+
+	FILE* m_file;
+	std::thread m_writerThread;
+
+	void RunWriterThread();
+
+	//We have no need of a pithy assignment or copy operator!
+	LogFileSink( const LogFileSink& );
+	void operator=( const LogFileSink& );
+
+public:
+	LogFileSink()
+		: m_isStopping( false )
+		, m_file( nullptr )
+	{ }
+	~LogFileSink() { Close(); }
+
+	//Starts a fresh file, closing any file already open. Returns false if it can't be created.
+	bool Open( const std::string& filePath );
+	//Writes out everything still pending before returning.
+	void Close();
+	bool IsOpen() const { return m_file != nullptr; }
+
+	void WriteLine( const std::string& line );
+	void SubmitPendingLines();
+};
+
+#endif //INCLUDED_LOG_FILE_SINK_HPP
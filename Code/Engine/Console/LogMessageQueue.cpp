@@ -0,0 +1,76 @@
+#include "LogMessageQueue.hpp"
+
+//-----------------------------------------------------------------------------------------------
+static size_t RoundUpToPowerOfTwo( unsigned int value )
+{
+	size_t powerOfTwo = 1;
+	while( powerOfTwo < value )
+		powerOfTwo <<= 1;
+	return powerOfTwo;
+}
+
+//-----------------------------------------------------------------------------------------------
+LogMessageQueue::LogMessageQueue( unsigned int capacityMessages )
+	: m_slots( RoundUpToPowerOfTwo( capacityMessages ) )
+	, m_indexMask( m_slots.size() - 1 )
+	, m_numberOfDroppedMessages( 0 )
+	, m_nextPushIndex( 0 )
+	, m_nextPopIndex( 0 )
+{
+	for( size_t i = 0; i < m_slots.size(); ++i )
+		m_slots[ i ].sequence.store( i, std::memory_order_relaxed );
+}
+
+//-----------------------------------------------------------------------------------------------
+bool LogMessageQueue::TryPush( const std::string& text, const Color& textColor, const Color& backgroundColor, const Color& shadowColor )
+{
+	size_t pushIndex = m_nextPushIndex.load( std::memory_order_relaxed );
+	Slot* slot = nullptr;
+	for( ;; )
+	{
+		slot = &m_slots[ pushIndex & m_indexMask ];
+		size_t sequence = slot->sequence.load( std::memory_order_acquire );
+
+		if( sequence == pushIndex )
+		{
+			//The slot is free for this index; claim it unless another producer got there first
+			if( m_nextPushIndex.compare_exchange_weak( pushIndex, pushIndex + 1, std::memory_order_relaxed ) )
+				break;
+		}
+		else if( sequence < pushIndex )
+		{
+			//Still holding the message from one lap ago, which hasn't been popped yet
+			m_numberOfDroppedMessages.fetch_add( 1, std::memory_order_relaxed );
+			return false;
+		}
+		else
+		{
+			pushIndex = m_nextPushIndex.load( std::memory_order_relaxed );
+		}
+	}
+
+	slot->message.text.assign( text );
+	slot->message.textColor = textColor;
+	slot->message.backgroundColor = backgroundColor;
+	slot->message.shadowColor = shadowColor;
+	slot->sequence.store( pushIndex + 1, std::memory_order_release );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool LogMessageQueue::TryPop( Message& out_message )
+{
+	Slot& slot = m_slots[ m_nextPopIndex & m_indexMask ];
+	if( slot.sequence.load( std::memory_order_acquire ) != m_nextPopIndex + 1 )
+		return false;
+
+	out_message.text.swap( slot.message.text );
+	out_message.textColor = slot.message.textColor;
+	out_message.backgroundColor = slot.message.backgroundColor;
+	out_message.shadowColor = slot.message.shadowColor;
+
+	//Hand the slot to the push one lap ahead
+	slot.sequence.store( m_nextPopIndex + m_slots.size(), std::memory_order_release );
+	++m_nextPopIndex;
+	return true;
+}
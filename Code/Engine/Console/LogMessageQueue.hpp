@@ -0,0 +1,65 @@
+#ifndef INCLUDED_LOG_MESSAGE_QUEUE_HPP
+#define INCLUDED_LOG_MESSAGE_QUEUE_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <atomic>
+#include <string>
+#include <vector>
+#include "../Color.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A fixed ring of log messages that any number of threads push into and a single thread drains.
+//Pushing never locks or waits: a producer claims a slot with one compare-and-swap, and if the ring
+//is full the message is counted as dropped instead. Slot strings keep their capacity from one lap
+//to the next, so once the ring has warmed up short messages don't allocate either.
+//-----------------------------------------------------------------------------------------------
+class LogMessageQueue
+{
+public:
+	static const unsigned int DEFAULT_CAPACITY_MESSAGES = 1024;
+
+	struct Message
+	{
+		std::string text;
+		Color textColor;
+		Color backgroundColor;
+		Color shadowColor;
+	};
+
+	//The capacity is rounded up to a power of two.
+	explicit LogMessageQueue( unsigned int capacityMessages = DEFAULT_CAPACITY_MESSAGES );
+
+	//Safe from any thread.
+	bool TryPush( const std::string& text, const Color& textColor, const Color& backgroundColor, const Color& shadowColor );
+	unsigned int TakeNumberOfDroppedMessages() { return m_numberOfDroppedMessages.exchange( 0, std::memory_order_relaxed ); }
+
+	//Only ever call this from the one draining thread. The popped text is swapped out rather than
+	//copied, so pass the same message in each time to recycle its allocation.
+	bool TryPop( Message& out_message );
+
+private:
+	//Each slot's sequence says whose turn it is: equal to a push index when free for that push,
+	//one past it once the message is written and ready to pop.
+	struct Slot
+	{
+		std::atomic< size_t > sequence;
+		Message message;
+	};
+
+	std::vector< Slot > m_slots;
+	size_t m_indexMask;
+	std::atomic< unsigned int > m_numberOfDroppedMessages;
+
+	//Producers hammer the push index while the consumer owns the pop index; keep them on separate cache lines
+	char m_padBeforePushIndex[ 64 ];
+	std::atomic< size_t > m_nextPushIndex;
+	char m_padBeforePopIndex[ 64 ];
+	size_t m_nextPopIndex;
+
+	//We have no need of a pithy assignment or copy operator!
+	LogMessageQueue( const LogMessageQueue& );
+	void operator=( const LogMessageQueue& );
+};
+
+#endif //INCLUDED_LOG_MESSAGE_QUEUE_HPP
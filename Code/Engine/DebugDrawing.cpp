@@ -1,38 +1,300 @@
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <memory>
+#include <mutex>
+#include "Graphics/RenderCommandBuffer.hpp"
 #include "Math/EngineMath.hpp"
 #include "DebugDrawing.hpp"
+#include "Profiler.hpp"
 
 //-----------------------------------------------------------------------------------------------
 Debug::ShapeManager Debug::g_shapeManager;
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::Initialize()
+static const unsigned int NUMBER_OF_LINE_VERTICES_IN_POINT = 6;
+static const unsigned int NUMBER_OF_LINE_VERTICES_IN_LINE = 2;
+static const unsigned int NUMBER_OF_LINE_VERTICES_IN_AXES = 6;
+static const unsigned int NUMBER_OF_LINE_VERTICES_IN_ARROW = 2;
+static const unsigned int NUMBER_OF_STRIP_POINTS_IN_ARROWHEAD = 8;
+static const unsigned int NUMBER_OF_LINE_VERTICES_IN_AABB = 24;
+static const unsigned int NUMBER_OF_STRIP_POINTS_IN_AABB = 14;
+static const unsigned int SPHERE_RECURSIONS = 2;
+
+//-----------------------------------------------------------------------------------------------
+void GenerateUnitIcosahedralSphereAboutOrigin( std::vector< FloatVector3 >& out_triangleArray, unsigned int numberOfRecursions );
+
+//-----------------------------------------------------------------------------------------------
+//Each visibility keeps its transient and timed shapes in separate arrays.
+static const unsigned int NUMBER_OF_SHAPE_ARRAYS = 6;
+
+//-----------------------------------------------------------------------------------------------
+static unsigned int GetShapeArrayIndex( unsigned char visibility, float lifetimeSeconds )
 {
-	Renderer* renderer = Renderer::GetRenderer();
+	assert( visibility <= Debug::DRAW_ALWAYS );
+	return 2 * visibility + ( lifetimeSeconds > 0.f ? 1 : 0 );
+}
+
+//-----------------------------------------------------------------------------------------------
+struct PendingRun
+{
+	unsigned int orderKey;
+	unsigned int firstRecordIndex;
+};
+
+//-----------------------------------------------------------------------------------------------
+template< typename RecordType >
+struct PendingRecords
+{
+	std::vector< RecordType > records;
+	std::vector< PendingRun > runs;
+};
+
+//-----------------------------------------------------------------------------------------------
+//Only ever written by its own thread; the main thread reads and clears it while merging.
+//Records are kept apart by the array they'll be merged into, so every run goes over in one insert.
+struct ThreadShapeBuffer
+{
+	std::atomic< bool > threadHasExited;
+	unsigned int currentOrderKey;
+	PendingRecords< Debug::ShapeRecord > pendingShapes[ NUMBER_OF_SHAPE_ARRAYS ];
+	PendingRecords< Debug::ShapeListRecord > pendingLists[ NUMBER_OF_SHAPE_ARRAYS ];
+
+	//Never shrunk, so the arrays inside keep their capacity from frame to frame
+	std::vector< Debug::ShapeListData > pendingListData;
+	unsigned int numberOfPendingListData;
+
+	ThreadShapeBuffer()
+		: threadHasExited( false )
+		, currentOrderKey( 0 )
+		, numberOfPendingListData( 0 )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+template< typename RecordType >
+struct MergedRun
+{
+	unsigned int orderKey;
+	const RecordType* firstRecord;
+	const RecordType* endRecord;
+
+	bool operator<( const MergedRun& other ) const { return orderKey < other.orderKey; }
+};
+
+static std::mutex g_threadShapeBufferRegistryLock;
+static std::vector< std::shared_ptr< ThreadShapeBuffer > > g_threadShapeBuffers;
+
+//Only touched by the main thread while merging, but kept around so merging doesn't allocate
+static std::vector< std::shared_ptr< ThreadShapeBuffer > > g_buffersToMerge;
+static std::vector< PendingRecords< Debug::ShapeRecord >* > g_pendingShapesToMerge;
+static std::vector< PendingRecords< Debug::ShapeListRecord >* > g_pendingListsToMerge;
+static std::vector< MergedRun< Debug::ShapeRecord > > g_shapeRunsToMerge;
+static std::vector< MergedRun< Debug::ShapeListRecord > > g_listRunsToMerge;
+static std::vector< unsigned int > g_listDataIndicesInPool;
+
+//-----------------------------------------------------------------------------------------------
+//Owned by the thread; flags its buffer for removal once the thread is gone and its shapes are merged.
+struct ThreadShapeBufferHandle
+{
+	std::shared_ptr< ThreadShapeBuffer > buffer;
+
+	~ThreadShapeBufferHandle()
+	{
+		if( buffer )
+			buffer->threadHasExited = true;
+	}
+};
+static thread_local ThreadShapeBufferHandle t_threadShapeBuffer;
+
+//-----------------------------------------------------------------------------------------------
+static ThreadShapeBuffer& GetThreadShapeBuffer()
+{
+	if( !t_threadShapeBuffer.buffer )
+	{
+		std::lock_guard< std::mutex > registryLock( g_threadShapeBufferRegistryLock );
+		t_threadShapeBuffer.buffer = std::make_shared< ThreadShapeBuffer >();
+		g_threadShapeBuffers.push_back( t_threadShapeBuffer.buffer );
+	}
+	return *t_threadShapeBuffer.buffer;
+}
+
+//-----------------------------------------------------------------------------------------------
+template< typename RecordType >
+static void AddPendingRecord( PendingRecords< RecordType >& pending, unsigned int orderKey, const RecordType& record )
+{
+	if( pending.runs.empty() || pending.runs.back().orderKey != orderKey )
+	{
+		PendingRun run;
+		run.orderKey = orderKey;
+		run.firstRecordIndex = pending.records.size();
+		pending.runs.push_back( run );
+	}
+	pending.records.push_back( record );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Appends every thread's records for one array in drawing order, with one insert per run.
+template< typename RecordType >
+static void MergePendingRecordsIntoArray( const std::vector< PendingRecords< RecordType >* >& pendingFromEachThread,
+	std::vector< MergedRun< RecordType > >& runsToMerge, std::vector< RecordType >& out_records )
+{
+	runsToMerge.clear();
+	unsigned int numberOfRecords = 0;
+	unsigned int numberOfThreadsWithRecords = 0;
+	PendingRecords< RecordType >* lastPendingWithRecords = nullptr;
+	for( unsigned int threadIndex = 0; threadIndex < pendingFromEachThread.size(); ++threadIndex )
+	{
+		PendingRecords< RecordType >& pending = *pendingFromEachThread[ threadIndex ];
+		if( pending.records.empty() )
+			continue;
+
+		numberOfRecords += pending.records.size();
+		++numberOfThreadsWithRecords;
+		lastPendingWithRecords = &pending;
 
+		for( unsigned int runIndex = 0; runIndex < pending.runs.size(); ++runIndex )
+		{
+			unsigned int endRecordIndex = pending.records.size();
+			if( runIndex + 1 < pending.runs.size() )
+				endRecordIndex = pending.runs[ runIndex + 1 ].firstRecordIndex;
+
+			MergedRun< RecordType > run;
+			run.orderKey = pending.runs[ runIndex ].orderKey;
+			run.firstRecord = pending.records.data() + pending.runs[ runIndex ].firstRecordIndex;
+			run.endRecord = pending.records.data() + endRecordIndex;
+			runsToMerge.push_back( run );
+		}
+	}
+	if( numberOfRecords == 0 )
+		return;
+
+	//One thread's records already in drawing order are taken whole, and the thread gets the empty array back
+	if( numberOfThreadsWithRecords == 1 && out_records.empty() && std::is_sorted( runsToMerge.begin(), runsToMerge.end() ) )
+	{
+		out_records.swap( lastPendingWithRecords->records );
+		return;
+	}
+
+	//Runs were gathered thread by thread, so a stable sort keeps threads in registration order within a key
+	std::stable_sort( runsToMerge.begin(), runsToMerge.end() );
+
+	//Timed arrays grow a little every frame, so don't let reserving defeat the vector's own growth
+	size_t numberOfRecordsNeeded = out_records.size() + numberOfRecords;
+	if( out_records.capacity() < numberOfRecordsNeeded )
+		out_records.reserve( std::max( numberOfRecordsNeeded, 2 * out_records.capacity() ) );
+
+	for( unsigned int runIndex = 0; runIndex < runsToMerge.size(); ++runIndex )
+	{
+		const MergedRun< RecordType >& run = runsToMerge[ runIndex ];
+		out_records.insert( out_records.end(), run.firstRecord, run.endRecord );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+//Returns the index of this thread's list data holding the first numberOfPositions positions.
+//Lists drawn from positions that haven't changed since the last list share that list's copy.
+static unsigned int GetPendingListDataForPositions( ThreadShapeBuffer& buffer, const FloatVector3* positions, unsigned int numberOfPositions )
+{
+	if( buffer.numberOfPendingListData > 0 )
+	{
+		unsigned int lastListDataIndex = buffer.numberOfPendingListData - 1;
+		const Debug::ShapeListData& lastListData = buffer.pendingListData[ lastListDataIndex ];
+		if( lastListData.sourcePositions == positions && lastListData.positions.size() >= numberOfPositions &&
+			memcmp( lastListData.positions.data(), positions, numberOfPositions * sizeof( FloatVector3 ) ) == 0 )
+		{
+			return lastListDataIndex;
+		}
+	}
+
+	if( buffer.numberOfPendingListData == buffer.pendingListData.size() )
+		buffer.pendingListData.push_back( Debug::ShapeListData() );
+
+	Debug::ShapeListData& listData = buffer.pendingListData[ buffer.numberOfPendingListData ];
+	listData.sourcePositions = positions;
+	listData.positions.assign( positions, positions + numberOfPositions );
+	listData.indexPairs.clear();
+	listData.numberOfReferences = 0;
+	return buffer.numberOfPendingListData++;
+}
+
+//-----------------------------------------------------------------------------------------------
+static inline unsigned int GetNumberOfTriangleVerticesInStrip( unsigned int numberOfStripPoints )
+{
+	return 3 * ( numberOfStripPoints - 2 );
+}
+
+//-----------------------------------------------------------------------------------------------
+static inline void WriteShapeVertex( Debug::ShapeVertex*& out_vertex, float x, float y, float z, Debug::PackedColor color )
+{
+	out_vertex->x = x;
+	out_vertex->y = y;
+	out_vertex->z = z;
+	out_vertex->color = color;
+	++out_vertex;
+}
+
+//-----------------------------------------------------------------------------------------------
+static inline void WriteShapeVertex( Debug::ShapeVertex*& out_vertex, const FloatVector3& position, Debug::PackedColor color )
+{
+	WriteShapeVertex( out_vertex, position.x, position.y, position.z, color );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Strips are written out as triangle lists so every shape can share a single draw call.
+static void WriteTriangleStripAsTriangles( Debug::ShapeVertex*& out_vertex, const FloatVector3* stripPoints, unsigned int numberOfStripPoints, Debug::PackedColor color )
+{
+	for( unsigned int i = 2; i < numberOfStripPoints; ++i )
+	{
+		//Every other triangle in a strip has its first two points swapped to keep the winding consistent
+		unsigned int firstIndex  = ( ( i & 1 ) == 0 ) ? i - 2 : i - 1;
+		unsigned int secondIndex = ( ( i & 1 ) == 0 ) ? i - 1 : i - 2;
+
+		WriteShapeVertex( out_vertex, stripPoints[ firstIndex ], color );
+		WriteShapeVertex( out_vertex, stripPoints[ secondIndex ], color );
+		WriteShapeVertex( out_vertex, stripPoints[ i ], color );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::Initialize()
+{
 	m_shapeRenderingMaterial.SetShaderProgram( ShaderProgram::CreateOrGetShaderProgram( "Data/Shaders/BasicNoTexture.vertex.330.glsl", "Data/Shaders/BasicNoTexture.fragment.330.glsl" ) );
 	m_shapeRenderingMaterial.SetModelMatrixUniform( "u_modelMatrix" );
 	m_shapeRenderingMaterial.SetViewMatrixUniform( "u_viewMatrix" );
 	m_shapeRenderingMaterial.SetProjectionMatrixUniform( "u_projectionMatrix" );
 
 	m_vertexAttributeID = m_shapeRenderingMaterial.GetShaderProgram()->GetAttributeIDFromName( "i_vertexWorldPosition" );
-	renderer->BindVertexArraysToAttributeLocation( m_vertexAttributeID );
-
 	m_colorAttributeID = m_shapeRenderingMaterial.GetShaderProgram()->GetAttributeIDFromName( "i_vertexColor" );
-	renderer->BindVertexArraysToAttributeLocation( m_colorAttributeID );
+
+	//Every sphere is a scaled and translated copy of this one
+	GenerateUnitIcosahedralSphereAboutOrigin( m_unitSphereTriangles, SPHERE_RECURSIONS );
+
+	//Registering the main thread first puts its shapes ahead of worker shapes with the same order key
+	GetThreadShapeBuffer();
 }
 
 //-----------------------------------------------------------------------------------------------
 void Debug::ShapeManager::Render()
 {
+	PROFILE_ZONE( "Debug::RenderDrawings" );
+
+	MergeThreadShapeBuffers();
+
 	Renderer* renderer = Renderer::GetRenderer();
+	RenderStateCache stateCache( renderer );
 
-	m_shapeRenderingMaterial.Apply( renderer );
+	m_shapeRenderingMaterial.Apply( renderer, stateCache );
 
-	RenderShapesDrawnSkinnyWhenOccluded( renderer );
-	RenderShapesDrawnOnlyWhenVisible( renderer );
-	RenderShapesDrawnAlways( renderer );
+	RenderShapesDrawnSkinnyWhenOccluded( renderer, stateCache );
+	RenderShapesDrawnOnlyWhenVisible( renderer, stateCache );
+	RenderShapesDrawnAlways( renderer, stateCache );
 
-	m_shapeRenderingMaterial.Remove( renderer );
+	//Leaves depth testing on and no arrays enabled, as the rest of the frame expects
+	m_shapeRenderingMaterial.Remove( stateCache );
+	stateCache.DisableAllArrays();
+	stateCache.EnableFeature( Renderer::DEPTH_TESTING );
+	RenderCommandBuffer::AddStateCacheStatistics( stateCache );
 
 	CleanupDeadShapes();
 }
@@ -40,128 +302,595 @@ void Debug::ShapeManager::Render()
 //-----------------------------------------------------------------------------------------------
 void Debug::ShapeManager::Update( float deltaSeconds )
 {
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_linesDrawnWhenVisible );
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_linesSkinnyOccluded );
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_linesAlwaysDrawn );
+	PROFILE_ZONE( "Debug::UpdateDrawings" );
 
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_triStripsDrawnWhenVisible );
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_triStripsSkinnyOccluded );
-	UpdateLifetimesInShapeDataArray( deltaSeconds, m_triStripsAlwaysDrawn );
+	//Transient shapes die at the end of the frame they were drawn in, so only timed shapes age
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
+	{
+		UpdateLifetimesInShapeRecordArray( deltaSeconds, m_shapesByVisibility[ i ].timedShapes );
+		UpdateLifetimesInShapeRecordArray( deltaSeconds, m_shapesByVisibility[ i ].timedLists );
+	}
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::CleanupDeadShapes()
+void Debug::ShapeManager::Clear()
 {
-	RemoveDeadShapesFromDataArray( m_linesDrawnWhenVisible );
-	RemoveDeadShapesFromDataArray( m_linesSkinnyOccluded );
-	RemoveDeadShapesFromDataArray( m_linesAlwaysDrawn );
+	MergeThreadShapeBuffers();
 
-	RemoveDeadShapesFromDataArray( m_triStripsDrawnWhenVisible );
-	RemoveDeadShapesFromDataArray( m_triStripsSkinnyOccluded );
-	RemoveDeadShapesFromDataArray( m_triStripsAlwaysDrawn );
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
+	{
+		m_shapesByVisibility[ i ].transientShapes.clear();
+		m_shapesByVisibility[ i ].timedShapes.clear();
+		ReleaseShapeLists( m_shapesByVisibility[ i ].transientLists );
+		ReleaseShapeLists( m_shapesByVisibility[ i ].timedLists );
+	}
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::RenderShapesDrawnSkinnyWhenOccluded( const Renderer* renderer ) const
+unsigned int Debug::ShapeManager::GetNumberOfBytesStored()
 {
-	renderer->DisableFeature( Renderer::DEPTH_TESTING );
-	renderer->SetLineWidth( 2.f );
+	MergeThreadShapeBuffers();
 
-	static const int SIZE_OF_ARRAY_STRUCTURE = sizeof( ShapeVertexData );
-	static const int NUMBER_OF_VERTEX_COORDINATES = 3;
-	static const int NUMBER_OF_COLOR_COORDINATES = 4;
-	static const int VERTEX_ARRAY_START = 0;
+	unsigned int numberOfBytes = 0;
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
+	{
+		const ShapeRecordArrays& shapeArrays = m_shapesByVisibility[ i ];
+		numberOfBytes += ( shapeArrays.transientShapes.size() + shapeArrays.timedShapes.size() ) * sizeof( ShapeRecord );
+		numberOfBytes += ( shapeArrays.transientLists.size() + shapeArrays.timedLists.size() ) * sizeof( ShapeListRecord );
+	}
+
+	//Released list data is empty, so it counts for nothing
+	for( unsigned int i = 0; i < m_shapeListData.size(); ++i )
+	{
+		const ShapeListData& listData = m_shapeListData[ i ];
+		numberOfBytes += listData.positions.size() * sizeof( FloatVector3 ) + listData.indexPairs.size() * sizeof( unsigned int );
+	}
+	return numberOfBytes;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::AddShape( const ShapeRecord& shape )
+{
+	ThreadShapeBuffer& buffer = GetThreadShapeBuffer();
+	unsigned int shapeArrayIndex = GetShapeArrayIndex( shape.visibility, shape.lifetimeRemainingSeconds );
+	AddPendingRecord( buffer.pendingShapes[ shapeArrayIndex ], buffer.currentOrderKey, shape );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::AddPointList( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
+{
+	ThreadShapeBuffer& buffer = GetThreadShapeBuffer();
+
+	ShapeListRecord list;
+	list.listDataIndex = GetPendingListDataForPositions( buffer, locations, numberOfPoints );
+	list.firstIndexPair = 0;
+	list.numberOfShapes = numberOfPoints;
+	list.size = size;
+	list.lifetimeRemainingSeconds = lifetimeSeconds;
+	list.color = PackedColor( color );
+	list.type = static_cast< unsigned char >( SHAPE_POINT );
+	list.visibility = static_cast< unsigned char >( visibility );
+	AddPendingRecord( buffer.pendingLists[ GetShapeArrayIndex( list.visibility, lifetimeSeconds ) ], buffer.currentOrderKey, list );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::AddLineList( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
+{
+	ThreadShapeBuffer& buffer = GetThreadShapeBuffer();
+
+	//Only the positions the lines use are copied
+	unsigned int numberOfPositions = 0;
+	for( unsigned int i = 0; i < 2 * numberOfLines; ++i )
+		numberOfPositions = std::max( numberOfPositions, indexPairs[ i ] + 1 );
+
+	ShapeListRecord list;
+	list.listDataIndex = GetPendingListDataForPositions( buffer, positions, numberOfPositions );
+	ShapeListData& listData = buffer.pendingListData[ list.listDataIndex ];
+	list.firstIndexPair = listData.indexPairs.size() / 2;
+	listData.indexPairs.insert( listData.indexPairs.end(), indexPairs, indexPairs + 2 * numberOfLines );
+
+	list.numberOfShapes = numberOfLines;
+	list.size = 0.f;
+	list.lifetimeRemainingSeconds = lifetimeSeconds;
+	list.color = PackedColor( color );
+	list.type = static_cast< unsigned char >( SHAPE_LINE );
+	list.visibility = static_cast< unsigned char >( visibility );
+	AddPendingRecord( buffer.pendingLists[ GetShapeArrayIndex( list.visibility, lifetimeSeconds ) ], buffer.currentOrderKey, list );
+}
+
+//-----------------------------------------------------------------------------------------------
+std::vector< Debug::ShapeRecord >& Debug::ShapeManager::GetArrayForShapes( unsigned int shapeArrayIndex )
+{
+	ShapeRecordArrays& shapeArrays = m_shapesByVisibility[ shapeArrayIndex / 2 ];
 
-	if( m_linesSkinnyOccluded.size() > 0 )
+	if( shapeArrayIndex % 2 == 0 )
+		return shapeArrays.transientShapes;
+	return shapeArrays.timedShapes;
+}
+
+//-----------------------------------------------------------------------------------------------
+std::vector< Debug::ShapeListRecord >& Debug::ShapeManager::GetArrayForShapeLists( unsigned int shapeArrayIndex )
+{
+	ShapeRecordArrays& shapeArrays = m_shapesByVisibility[ shapeArrayIndex / 2 ];
+
+	if( shapeArrayIndex % 2 == 0 )
+		return shapeArrays.transientLists;
+	return shapeArrays.timedLists;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::MergeThreadShapeBuffers()
+{
+	{
+		std::lock_guard< std::mutex > registryLock( g_threadShapeBufferRegistryLock );
+		g_buffersToMerge = g_threadShapeBuffers;
+
+		//Buffers of exited threads still get merged below, they just won't be seen again
+		for( unsigned int i = 0; i < g_threadShapeBuffers.size(); )
+		{
+			if( g_threadShapeBuffers[ i ]->threadHasExited )
+				g_threadShapeBuffers.erase( g_threadShapeBuffers.begin() + i );
+			else
+				++i;
+		}
+	}
+
+	for( unsigned int bufferIndex = 0; bufferIndex < g_buffersToMerge.size(); ++bufferIndex )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesSkinnyOccluded[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesSkinnyOccluded[0].red );
-		renderer->RenderVertexArray( Renderer::LINES, VERTEX_ARRAY_START, m_linesSkinnyOccluded.size() );
+		ThreadShapeBuffer& buffer = *g_buffersToMerge[ bufferIndex ];
+		g_listDataIndicesInPool.resize( buffer.numberOfPendingListData );
+
+		//List data is swapped into the shared pool rather than copied, and the thread gets the
+		//released slot's arrays back to fill next frame
+		for( unsigned int i = 0; i < buffer.numberOfPendingListData; ++i )
+		{
+			if( m_freeShapeListDataIndices.empty() )
+			{
+				m_freeShapeListDataIndices.push_back( m_shapeListData.size() );
+				m_shapeListData.push_back( ShapeListData() );
+			}
+			unsigned int listDataIndex = m_freeShapeListDataIndices.back();
+			m_freeShapeListDataIndices.pop_back();
+
+			std::swap( m_shapeListData[ listDataIndex ], buffer.pendingListData[ i ] );
+			g_listDataIndicesInPool[ i ] = listDataIndex;
+		}
+		for( unsigned int shapeArrayIndex = 0; shapeArrayIndex < NUMBER_OF_SHAPE_ARRAYS; ++shapeArrayIndex )
+		{
+			std::vector< ShapeListRecord >& pendingLists = buffer.pendingLists[ shapeArrayIndex ].records;
+			for( unsigned int i = 0; i < pendingLists.size(); ++i )
+			{
+				ShapeListRecord& list = pendingLists[ i ];
+				list.listDataIndex = g_listDataIndicesInPool[ list.listDataIndex ];
+				++m_shapeListData[ list.listDataIndex ].numberOfReferences;
+			}
+		}
 	}
 
-	if( m_triStripsSkinnyOccluded.size() > 0 )
+	for( unsigned int shapeArrayIndex = 0; shapeArrayIndex < NUMBER_OF_SHAPE_ARRAYS; ++shapeArrayIndex )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsSkinnyOccluded[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsSkinnyOccluded[0].red );
-		renderer->RenderVertexArray( Renderer::TRIANGLE_STRIP, VERTEX_ARRAY_START, m_triStripsSkinnyOccluded.size() );
+		g_pendingShapesToMerge.clear();
+		g_pendingListsToMerge.clear();
+		for( unsigned int bufferIndex = 0; bufferIndex < g_buffersToMerge.size(); ++bufferIndex )
+		{
+			g_pendingShapesToMerge.push_back( &g_buffersToMerge[ bufferIndex ]->pendingShapes[ shapeArrayIndex ] );
+			g_pendingListsToMerge.push_back( &g_buffersToMerge[ bufferIndex ]->pendingLists[ shapeArrayIndex ] );
+		}
+		MergePendingRecordsIntoArray( g_pendingShapesToMerge, g_shapeRunsToMerge, GetArrayForShapes( shapeArrayIndex ) );
+		MergePendingRecordsIntoArray( g_pendingListsToMerge, g_listRunsToMerge, GetArrayForShapeLists( shapeArrayIndex ) );
 	}
 
-	renderer->EnableFeature( Renderer::DEPTH_TESTING );
+	for( unsigned int bufferIndex = 0; bufferIndex < g_buffersToMerge.size(); ++bufferIndex )
+	{
+		ThreadShapeBuffer& buffer = *g_buffersToMerge[ bufferIndex ];
+		for( unsigned int shapeArrayIndex = 0; shapeArrayIndex < NUMBER_OF_SHAPE_ARRAYS; ++shapeArrayIndex )
+		{
+			buffer.pendingShapes[ shapeArrayIndex ].records.clear();
+			buffer.pendingShapes[ shapeArrayIndex ].runs.clear();
+			buffer.pendingLists[ shapeArrayIndex ].records.clear();
+			buffer.pendingLists[ shapeArrayIndex ].runs.clear();
+		}
+		buffer.numberOfPendingListData = 0;
+	}
+	g_buffersToMerge.clear();
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::RenderShapesDrawnOnlyWhenVisible( const Renderer* renderer ) const
+unsigned int Debug::ShapeManager::SetDrawingOrderForThisThread( unsigned int orderKey )
 {
-	renderer->SetLineWidth( 5.f );
+	ThreadShapeBuffer& buffer = GetThreadShapeBuffer();
 
-	static const int SIZE_OF_ARRAY_STRUCTURE = sizeof( ShapeVertexData );
-	static const int NUMBER_OF_VERTEX_COORDINATES = 3;
-	static const int NUMBER_OF_COLOR_COORDINATES = 4;
-	static const int VERTEX_ARRAY_START = 0;
+	unsigned int previousOrderKey = buffer.currentOrderKey;
+	buffer.currentOrderKey = orderKey;
+	return previousOrderKey;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::StashShapes( ShapeRecordArrays* out_stashedShapesByVisibility )
+{
+	MergeThreadShapeBuffers();
 
-	if( m_linesDrawnWhenVisible.size() > 0 )
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesDrawnWhenVisible[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesDrawnWhenVisible[0].red );
-		renderer->RenderVertexArray( Renderer::LINES, VERTEX_ARRAY_START, m_linesDrawnWhenVisible.size() );
+		m_shapesByVisibility[ i ].transientShapes.swap( out_stashedShapesByVisibility[ i ].transientShapes );
+		m_shapesByVisibility[ i ].timedShapes.swap( out_stashedShapesByVisibility[ i ].timedShapes );
+		m_shapesByVisibility[ i ].transientLists.swap( out_stashedShapesByVisibility[ i ].transientLists );
+		m_shapesByVisibility[ i ].timedLists.swap( out_stashedShapesByVisibility[ i ].timedLists );
 	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RestoreStashedShapes( ShapeRecordArrays* stashedShapesByVisibility )
+{
+	Clear();
 
-	if( m_triStripsDrawnWhenVisible.size() > 0 )
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsDrawnWhenVisible[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsDrawnWhenVisible[0].red );
-		renderer->RenderVertexArray( Renderer::TRIANGLE_STRIP, VERTEX_ARRAY_START, m_triStripsDrawnWhenVisible.size() );
+		m_shapesByVisibility[ i ].transientShapes.swap( stashedShapesByVisibility[ i ].transientShapes );
+		m_shapesByVisibility[ i ].timedShapes.swap( stashedShapesByVisibility[ i ].timedShapes );
+		m_shapesByVisibility[ i ].transientLists.swap( stashedShapesByVisibility[ i ].transientLists );
+		m_shapesByVisibility[ i ].timedLists.swap( stashedShapesByVisibility[ i ].timedLists );
 	}
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::RenderShapesDrawnAlways( const Renderer* renderer ) const
+void Debug::ShapeManager::CleanupDeadShapes()
 {
-	renderer->DisableFeature( Renderer::DEPTH_TESTING );
-	renderer->SetLineWidth( 5.f );
+	for( unsigned int i = 0; i < NUMBER_OF_VISIBILITY_TYPES; ++i )
+	{
+		ShapeRecordArrays& shapeArrays = m_shapesByVisibility[ i ];
 
-	static const int SIZE_OF_ARRAY_STRUCTURE = sizeof( ShapeVertexData );
-	static const int NUMBER_OF_VERTEX_COORDINATES = 3;
-	static const int NUMBER_OF_COLOR_COORDINATES = 4;
-	static const int VERTEX_ARRAY_START = 0;
+		//clear() keeps the capacity, so steady per-frame drawing stops allocating after the first frame
+		shapeArrays.transientShapes.clear();
+		RemoveDeadShapesFromRecordArray( shapeArrays.timedShapes );
+		ReleaseShapeLists( shapeArrays.transientLists );
+		RemoveDeadShapesFromRecordArray( shapeArrays.timedLists );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::ReleaseShapeLists( std::vector< ShapeListRecord >& listRecords )
+{
+	for( unsigned int i = 0; i < listRecords.size(); ++i )
+	{
+		ReleaseShapeListData( listRecords[ i ].listDataIndex );
+	}
+	listRecords.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::ReleaseShapeListData( unsigned int listDataIndex )
+{
+	ShapeListData& listData = m_shapeListData[ listDataIndex ];
+	assert( listData.numberOfReferences > 0 );
 
-	if( m_linesAlwaysDrawn.size() > 0 )
+	--listData.numberOfReferences;
+	if( listData.numberOfReferences == 0 )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesAlwaysDrawn[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_linesAlwaysDrawn[0].red );
-		renderer->RenderVertexArray( Renderer::LINES, VERTEX_ARRAY_START, m_linesAlwaysDrawn.size() );
+		listData.sourcePositions = nullptr;
+		listData.positions.clear();
+		listData.indexPairs.clear();
+		m_freeShapeListDataIndices.push_back( listDataIndex );
 	}
+}
 
-	if( m_triStripsAlwaysDrawn.size() > 0 )
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::CountVerticesForShapes( const std::vector< ShapeRecord >& shapeRecords, unsigned int& out_numberOfLineVertices, unsigned int& out_numberOfTriangleVertices ) const
+{
+	for( unsigned int i = 0; i < shapeRecords.size(); ++i )
 	{
-		renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsAlwaysDrawn[0].x );
-		renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &m_triStripsAlwaysDrawn[0].red );
-		renderer->RenderVertexArray( Renderer::TRIANGLE_STRIP, VERTEX_ARRAY_START, m_triStripsAlwaysDrawn.size() );
+		switch( shapeRecords[ i ].type )
+		{
+		case SHAPE_POINT:
+			out_numberOfLineVertices += NUMBER_OF_LINE_VERTICES_IN_POINT;
+			break;
+		case SHAPE_LINE:
+			out_numberOfLineVertices += NUMBER_OF_LINE_VERTICES_IN_LINE;
+			break;
+		case SHAPE_AXES:
+			out_numberOfLineVertices += NUMBER_OF_LINE_VERTICES_IN_AXES;
+			break;
+		case SHAPE_ARROW:
+			out_numberOfLineVertices += NUMBER_OF_LINE_VERTICES_IN_ARROW;
+			out_numberOfTriangleVertices += GetNumberOfTriangleVerticesInStrip( NUMBER_OF_STRIP_POINTS_IN_ARROWHEAD );
+			break;
+		case SHAPE_AABB:
+			out_numberOfLineVertices += NUMBER_OF_LINE_VERTICES_IN_AABB;
+			out_numberOfTriangleVertices += GetNumberOfTriangleVerticesInStrip( NUMBER_OF_STRIP_POINTS_IN_AABB );
+			break;
+		case SHAPE_SPHERE:
+			out_numberOfTriangleVertices += m_unitSphereTriangles.size();
+			break;
+		default:
+			assert( false );
+		}
 	}
+}
 
-	renderer->EnableFeature( Renderer::DEPTH_TESTING );
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::CountVerticesForShapes( const std::vector< ShapeListRecord >& listRecords, unsigned int& out_numberOfLineVertices ) const
+{
+	for( unsigned int i = 0; i < listRecords.size(); ++i )
+	{
+		const ShapeListRecord& list = listRecords[ i ];
+		if( list.type == SHAPE_POINT )
+			out_numberOfLineVertices += list.numberOfShapes * NUMBER_OF_LINE_VERTICES_IN_POINT;
+		else
+			out_numberOfLineVertices += list.numberOfShapes * NUMBER_OF_LINE_VERTICES_IN_LINE;
+	}
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::RemoveDeadShapesFromDataArray( std::vector< ShapeVertexData >& vertexDataArray )
+void Debug::ShapeManager::ExpandShapesIntoVertices( const std::vector< ShapeRecord >& shapeRecords, ShapeVertex*& out_lineVertex, ShapeVertex*& out_triangleVertex ) const
 {
-	for( unsigned int i = 0; i < vertexDataArray.size(); ++i )
+	static const PackedColor RED( Color( 1.f, 0.f, 0.f, 1.f ) );
+	static const PackedColor GREEN( Color( 0.f, 1.f, 0.f, 1.f ) );
+	static const PackedColor BLUE( Color( 0.f, 0.f, 1.f, 1.f ) );
+
+	for( unsigned int i = 0; i < shapeRecords.size(); ++i )
 	{
-		if( vertexDataArray[ i ].lifetimeRemainingSeconds <= 0.f )
+		const ShapeRecord& shape = shapeRecords[ i ];
+		const FloatVector3& start = shape.start;
+		const FloatVector3& end = shape.end;
+
+		switch( shape.type )
 		{
-			vertexDataArray.erase( vertexDataArray.begin() + i );
-			--i;
-			continue;
+		case SHAPE_POINT:
+			WriteShapeVertex( out_lineVertex, start.x - shape.size, start.y, start.z, shape.startColor );
+			WriteShapeVertex( out_lineVertex, start.x + shape.size, start.y, start.z, shape.startColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y - shape.size, start.z, shape.startColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y + shape.size, start.z, shape.startColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z - shape.size, shape.startColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z + shape.size, shape.startColor );
+			break;
+
+		case SHAPE_LINE:
+			WriteShapeVertex( out_lineVertex, start, shape.startColor );
+			WriteShapeVertex( out_lineVertex, end, shape.endColor );
+			break;
+
+		case SHAPE_AXES:
+			WriteShapeVertex( out_lineVertex, start, RED );
+			WriteShapeVertex( out_lineVertex, start.x + shape.size, start.y, start.z, RED );
+			WriteShapeVertex( out_lineVertex, start, GREEN );
+			WriteShapeVertex( out_lineVertex, start.x, start.y + shape.size, start.z, GREEN );
+			WriteShapeVertex( out_lineVertex, start, BLUE );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z + shape.size, BLUE );
+			break;
+
+		case SHAPE_ARROW:
+		{
+			FloatVector3 lineDirection = end - start;
+			lineDirection.Normalize();
+			FloatVector3 arrowheadStart = end - shape.size * 1.5f * lineDirection;
+
+			WriteShapeVertex( out_lineVertex, start, shape.startColor );
+			WriteShapeVertex( out_lineVertex, arrowheadStart, shape.endColor );
+
+			FloatVector3 orthogonalVector1( 0.f, 1.f, 0.f ), orthogonalVector2( 0.f, 0.f, 1.f );
+			GramSchmidt3D( lineDirection, orthogonalVector1, orthogonalVector2 );
+
+			const FloatVector3 arrowheadStrip[ NUMBER_OF_STRIP_POINTS_IN_ARROWHEAD ] =
+			{
+				arrowheadStart + orthogonalVector1 - orthogonalVector2,
+				arrowheadStart - orthogonalVector1 + orthogonalVector2,
+				arrowheadStart - orthogonalVector1 - orthogonalVector2,
+				end,
+				arrowheadStart + orthogonalVector1 - orthogonalVector2,
+				arrowheadStart + orthogonalVector1 + orthogonalVector2,
+				arrowheadStart - orthogonalVector1 + orthogonalVector2,
+				end
+			};
+			WriteTriangleStripAsTriangles( out_triangleVertex, arrowheadStrip, NUMBER_OF_STRIP_POINTS_IN_ARROWHEAD, shape.endColor );
+			break;
+		}
+
+		case SHAPE_AABB:
+		{
+			const PackedColor& edgeColor = shape.startColor;
+
+			//Near side quad
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z, edgeColor );
+
+			//Far side quad
+			WriteShapeVertex( out_lineVertex, end.x,   end.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   end.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   end.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   end.y, end.z,   edgeColor );
+
+			//Connecting lines
+			WriteShapeVertex( out_lineVertex, start.x, start.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y,   start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   end.y,   start.z, edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, start.x, end.y,   end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   start.y, end.z,   edgeColor );
+			WriteShapeVertex( out_lineVertex, end.x,   end.y,   end.z,   edgeColor );
+
+			const FloatVector3 faceStrip[ NUMBER_OF_STRIP_POINTS_IN_AABB ] =
+			{
+				FloatVector3( start.x, start.y, start.z ),
+				FloatVector3( end.x,   start.y, start.z ),
+				FloatVector3( start.x, end.y,   start.z ),
+				FloatVector3( end.x,   end.y,   start.z ),
+				FloatVector3( end.x,   end.y,   end.z   ),
+				FloatVector3( end.x,   start.y, start.z ),
+				FloatVector3( end.x,   start.y, end.z   ),
+				FloatVector3( start.x, start.y, start.z ),
+				FloatVector3( start.x, start.y, end.z   ),
+				FloatVector3( start.x, end.y,   start.z ),
+				FloatVector3( start.x, end.y,   end.z   ),
+				FloatVector3( end.x,   end.y,   end.z   ),
+				FloatVector3( start.x, start.y, end.z   ),
+				FloatVector3( end.x,   start.y, end.z   )
+			};
+			WriteTriangleStripAsTriangles( out_triangleVertex, faceStrip, NUMBER_OF_STRIP_POINTS_IN_AABB, shape.endColor );
+			break;
+		}
+
+		case SHAPE_SPHERE:
+			for( unsigned int pointIndex = 0; pointIndex < m_unitSphereTriangles.size(); ++pointIndex )
+			{
+				const FloatVector3& unitPoint = m_unitSphereTriangles[ pointIndex ];
+				WriteShapeVertex( out_triangleVertex, unitPoint.x * shape.size + start.x, unitPoint.y * shape.size + start.y, unitPoint.z * shape.size + start.z, shape.startColor );
+			}
+			break;
+
+		default:
+			assert( false );
 		}
 	}
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::ShapeManager::UpdateLifetimesInShapeDataArray( float deltaSeconds, std::vector< ShapeVertexData >& vertexDataArray )
+void Debug::ShapeManager::ExpandShapesIntoVertices( const std::vector< ShapeListRecord >& listRecords, ShapeVertex*& out_lineVertex ) const
 {
-	for( unsigned int i = 0; i < vertexDataArray.size(); ++i )
+	for( unsigned int listIndex = 0; listIndex < listRecords.size(); ++listIndex )
 	{
-		vertexDataArray[ i ].lifetimeRemainingSeconds -= deltaSeconds;
+		const ShapeListRecord& list = listRecords[ listIndex ];
+		const FloatVector3* positions = m_shapeListData[ list.listDataIndex ].positions.data();
+
+		if( list.type == SHAPE_POINT )
+		{
+			for( unsigned int i = 0; i < list.numberOfShapes; ++i )
+			{
+				const FloatVector3& location = positions[ i ];
+				WriteShapeVertex( out_lineVertex, location.x - list.size, location.y, location.z, list.color );
+				WriteShapeVertex( out_lineVertex, location.x + list.size, location.y, location.z, list.color );
+				WriteShapeVertex( out_lineVertex, location.x, location.y - list.size, location.z, list.color );
+				WriteShapeVertex( out_lineVertex, location.x, location.y + list.size, location.z, list.color );
+				WriteShapeVertex( out_lineVertex, location.x, location.y, location.z - list.size, list.color );
+				WriteShapeVertex( out_lineVertex, location.x, location.y, location.z + list.size, list.color );
+			}
+		}
+		else
+		{
+			const unsigned int* indexPairs = m_shapeListData[ list.listDataIndex ].indexPairs.data() + 2 * list.firstIndexPair;
+			for( unsigned int i = 0; i < list.numberOfShapes; ++i )
+			{
+				WriteShapeVertex( out_lineVertex, positions[ indexPairs[ 2 * i ] ], list.color );
+				WriteShapeVertex( out_lineVertex, positions[ indexPairs[ 2 * i + 1 ] ], list.color );
+			}
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RenderShapeVertexArray( const Renderer* renderer, RenderStateCache& stateCache, Renderer::Shape shape, const std::vector< ShapeVertex >& vertexArray ) const
+{
+	static const int SIZE_OF_ARRAY_STRUCTURE = sizeof( ShapeVertex );
+	static const int NUMBER_OF_VERTEX_COORDINATES = 3;
+	static const int NUMBER_OF_COLOR_COORDINATES = 4;
+	static const int VERTEX_ARRAY_START = 0;
+
+	if( vertexArray.empty() )
+		return;
+
+	stateCache.EnableAttributeArray( m_vertexAttributeID );
+	stateCache.EnableAttributeArray( m_colorAttributeID );
+	renderer->SetPointerToGenericArray( m_vertexAttributeID, NUMBER_OF_VERTEX_COORDINATES, Renderer::FLOAT_TYPE, false, SIZE_OF_ARRAY_STRUCTURE, &vertexArray[0].x );
+	renderer->SetPointerToGenericArray( m_colorAttributeID, NUMBER_OF_COLOR_COORDINATES, Renderer::UNSIGNED_BYTE, true, SIZE_OF_ARRAY_STRUCTURE, &vertexArray[0].color );
+	renderer->RenderVertexArray( shape, VERTEX_ARRAY_START, vertexArray.size() );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Depth testing and line width are only touched when there is something to draw.
+void Debug::ShapeManager::RenderShapesWithVisibility( const Renderer* renderer, RenderStateCache& stateCache, DrawingVisibility visibility, bool depthTesting, float lineWidth )
+{
+	const ShapeRecordArrays& shapeArrays = m_shapesByVisibility[ visibility ];
+
+	//Size the scratch arrays once, then expand every record straight into them
+	unsigned int numberOfLineVertices = 0;
+	unsigned int numberOfTriangleVertices = 0;
+	CountVerticesForShapes( shapeArrays.timedShapes, numberOfLineVertices, numberOfTriangleVertices );
+	CountVerticesForShapes( shapeArrays.transientShapes, numberOfLineVertices, numberOfTriangleVertices );
+	CountVerticesForShapes( shapeArrays.timedLists, numberOfLineVertices );
+	CountVerticesForShapes( shapeArrays.transientLists, numberOfLineVertices );
+	if( numberOfLineVertices == 0 && numberOfTriangleVertices == 0 )
+		return;
+
+	m_lineVertices.resize( numberOfLineVertices );
+	m_triangleVertices.resize( numberOfTriangleVertices );
+
+	ShapeVertex* nextLineVertex = m_lineVertices.data();
+	ShapeVertex* nextTriangleVertex = m_triangleVertices.data();
+	ExpandShapesIntoVertices( shapeArrays.timedShapes, nextLineVertex, nextTriangleVertex );
+	ExpandShapesIntoVertices( shapeArrays.transientShapes, nextLineVertex, nextTriangleVertex );
+	ExpandShapesIntoVertices( shapeArrays.timedLists, nextLineVertex );
+	ExpandShapesIntoVertices( shapeArrays.transientLists, nextLineVertex );
+	assert( nextLineVertex == m_lineVertices.data() + numberOfLineVertices );
+	assert( nextTriangleVertex == m_triangleVertices.data() + numberOfTriangleVertices );
+
+	if( depthTesting )
+		stateCache.EnableFeature( Renderer::DEPTH_TESTING );
+	else
+		stateCache.DisableFeature( Renderer::DEPTH_TESTING );
+	stateCache.SetLineWidth( lineWidth );
+
+	RenderShapeVertexArray( renderer, stateCache, Renderer::LINES, m_lineVertices );
+	RenderShapeVertexArray( renderer, stateCache, Renderer::TRIANGLES, m_triangleVertices );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RenderShapesDrawnSkinnyWhenOccluded( const Renderer* renderer, RenderStateCache& stateCache )
+{
+	RenderShapesWithVisibility( renderer, stateCache, DRAW_SKINNY_IF_OCCLUDED, false, 2.f );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RenderShapesDrawnOnlyWhenVisible( const Renderer* renderer, RenderStateCache& stateCache )
+{
+	RenderShapesWithVisibility( renderer, stateCache, DRAW_ONLY_IF_VISIBLE, true, 5.f );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RenderShapesDrawnAlways( const Renderer* renderer, RenderStateCache& stateCache )
+{
+	RenderShapesWithVisibility( renderer, stateCache, DRAW_ALWAYS, false, 5.f );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RemoveDeadShapesFromRecordArray( std::vector< ShapeRecord >& shapeRecords )
+{
+	//A single stable compaction pass, so surviving shapes keep their drawing order
+	std::vector< ShapeRecord >::iterator firstDeadShape = std::remove_if( shapeRecords.begin(), shapeRecords.end(), 
+		[]( const ShapeRecord& shape ) { return shape.lifetimeRemainingSeconds <= 0.f; } );
+	shapeRecords.erase( firstDeadShape, shapeRecords.end() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::ShapeManager::RemoveDeadShapesFromRecordArray( std::vector< ShapeListRecord >& listRecords )
+{
+	unsigned int numberOfLiveLists = 0;
+	for( unsigned int i = 0; i < listRecords.size(); ++i )
+	{
+		if( listRecords[ i ].lifetimeRemainingSeconds <= 0.f )
+			ReleaseShapeListData( listRecords[ i ].listDataIndex );
+		else
+			listRecords[ numberOfLiveLists++ ] = listRecords[ i ];
+	}
+	listRecords.resize( numberOfLiveLists );
+}
+
+//-----------------------------------------------------------------------------------------------
+template< typename RecordType >
+void Debug::ShapeManager::UpdateLifetimesInShapeRecordArray( float deltaSeconds, std::vector< RecordType >& shapeRecords )
+{
+	for( unsigned int i = 0; i < shapeRecords.size(); ++i )
+	{
+		shapeRecords[ i ].lifetimeRemainingSeconds -= deltaSeconds;
 	}
 }
 
@@ -323,32 +1052,31 @@ void GenerateUnitIcosahedralSphereAboutOrigin( std::vector< FloatVector3 >& out_
 }
 
 //-----------------------------------------------------------------------------------------------
-void Debug::DrawSphereForTime( const FloatVector3& center, float radius, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
+void Debug::DrawPointListForTime( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
+{
+	if( numberOfPoints == 0 )
+		return;
+
+	if( visibility == DRAW_SKINNY_IF_OCCLUDED )
+	{
+		//Add a second list that will be drawn larger when visible; it shares this one's positions
+		DrawPointListForTime( locations, numberOfPoints, size, color, DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
+	}
+
+	g_shapeManager.AddPointList( locations, numberOfPoints, size, color, visibility, lifetimeSeconds );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Debug::DrawLineListForTime( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
 {
-	std::vector< ShapeVertexData >* arrayToAddPoint = nullptr;
+	if( numberOfLines == 0 )
+		return;
 
-	switch( visibility )
+	if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 	{
-	case DRAW_ALWAYS:
-		arrayToAddPoint = &g_shapeManager.m_triStripsAlwaysDrawn;
-		break;
-	case DRAW_ONLY_IF_VISIBLE:
-		arrayToAddPoint = &g_shapeManager.m_triStripsDrawnWhenVisible;
-		break;
-	case DRAW_SKINNY_IF_OCCLUDED:
-		arrayToAddPoint = &g_shapeManager.m_triStripsSkinnyOccluded;
-		//Add a second set of vertices that will be drawn larger when visible
-		DrawSphereForTime( center, radius, Color( color.r, color.g, color.b, 0.5 * color.a ), DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
-		break;
-	default:
-		assert( false );
+		//Add a second list that will be drawn larger when visible; it shares this one's positions
+		DrawLineListForTime( positions, indexPairs, numberOfLines, color, DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
 	}
 
- 	std::vector< FloatVector3 > icosahedralSpherePoints;
- 	GenerateUnitIcosahedralSphereAboutOrigin( icosahedralSpherePoints, 2 );
- 
- 	for( unsigned int i = 0; i < icosahedralSpherePoints.size(); ++i )
- 	{
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, icosahedralSpherePoints[ i ] * radius + center, color ) );
- 	}
+	g_shapeManager.AddLineList( positions, indexPairs, numberOfLines, color, visibility, lifetimeSeconds );
 }
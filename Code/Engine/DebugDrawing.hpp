@@ -5,8 +5,8 @@
 //-----------------------------------------------------------------------------------------------
 #include <vector>
 #include "Graphics/Material.hpp"
-#include "Graphics/Mesh.hpp"
 #include "Graphics/Renderer.hpp"
+#include "Graphics/RenderStateCache.hpp"
 #include "Math/FloatVector3.hpp"
 #include "Color.hpp"
 
@@ -20,37 +20,105 @@ namespace Debug
 		DRAW_ALWAYS = 2
 	};
 
-	struct ShapeVertexData
+	enum ShapeType
 	{
-		float x, y, z;
-		float red, green, blue, alpha;
-		float lifetimeRemainingSeconds;
+		SHAPE_POINT,
+		SHAPE_LINE,
+		SHAPE_AXES,
+		SHAPE_ARROW,
+		SHAPE_AABB,
+		SHAPE_SPHERE
+	};
+
+	struct PackedColor
+	{
+		unsigned char red, green, blue, alpha;
 
-		ShapeVertexData() { }
-
-		ShapeVertexData( float lifetimeSeconds, float X, float Y, float Z, const Color& color ) 
-			: lifetimeRemainingSeconds( lifetimeSeconds )
-			, x( X )
-			, y( Y )
-			, z( Z )
-			, red  ( color.r )
-			, green( color.g )
-			, blue ( color.b )
-			, alpha( color.a )
+		PackedColor() { }
+
+		PackedColor( const Color& color )
+			: red  ( PackChannel( color.r ) )
+			, green( PackChannel( color.g ) )
+			, blue ( PackChannel( color.b ) )
+			, alpha( PackChannel( color.a ) )
 		{ }
 
-		ShapeVertexData( float lifetimeSeconds, const FloatVector3& position, const Color& color ) 
-			: lifetimeRemainingSeconds( lifetimeSeconds )
-			, x( position.x )
-			, y( position.y )
-			, z( position.z )
-			, red  ( color.r )
-			, green( color.g )
-			, blue ( color.b )
-			, alpha( color.a )
+		static unsigned char PackChannel( float channel )
+		{
+			if( channel <= 0.f )
+				return 0;
+			if( channel >= 1.f )
+				return 255;
+			return static_cast< unsigned char >( channel * 255.f + 0.5f );
+		}
+	};
+
+	//One record per shape; vertices are only generated from these when the shapes are submitted.
+	struct ShapeRecord
+	{
+		FloatVector3 start;	//Location, line start, box minimum or sphere center
+		FloatVector3 end;	//Line end or box maximum
+		float size;			//Point size, axis length, arrowhead size or sphere radius
+		float lifetimeRemainingSeconds;
+		PackedColor startColor;	//Also the edge color of boxes
+		PackedColor endColor;	//Also the face color of boxes
+		unsigned char type;			//A ShapeType
+		unsigned char visibility;	//A DrawingVisibility
+
+		ShapeRecord() { }
+
+		ShapeRecord( ShapeType shapeType, DrawingVisibility shapeVisibility, float lifetimeSeconds, const FloatVector3& startLocation, const FloatVector3& endLocation, float shapeSize, const Color& firstColor, const Color& secondColor )
+			: start( startLocation )
+			, end( endLocation )
+			, size( shapeSize )
+			, lifetimeRemainingSeconds( lifetimeSeconds )
+			, startColor( firstColor )
+			, endColor( secondColor )
+			, type( static_cast< unsigned char >( shapeType ) )
+			, visibility( static_cast< unsigned char >( shapeVisibility ) )
+		{ }
+	};
+
+	//One record per DrawPointList/DrawLineList call. Its positions live in a ShapeListData that every list
+	//drawn from the same unchanged positions shares, and each line is just a pair of indices into them,
+	//so a cloth wireframe costs about 10 bytes a line rather than a ShapeRecord each.
+	struct ShapeListRecord
+	{
+		unsigned int listDataIndex;
+		unsigned int firstIndexPair;	//Lines only
+		unsigned int numberOfShapes;
+		float size;						//Point size
+		float lifetimeRemainingSeconds;
+		PackedColor color;
+		unsigned char type;			//SHAPE_POINT or SHAPE_LINE
+		unsigned char visibility;	//A DrawingVisibility
+	};
+
+	struct ShapeListData
+	{
+		const FloatVector3* sourcePositions;	//Only compared against, to spot lists drawn from the same positions
+		std::vector< FloatVector3 > positions;
+		std::vector< unsigned int > indexPairs;
+		unsigned int numberOfReferences;
+
+		ShapeListData()
+			: sourcePositions( nullptr )
+			, numberOfReferences( 0 )
 		{ }
 	};
 
+	struct ShapeVertex
+	{
+		float x, y, z;
+		PackedColor color;
+
+		//Left empty so resizing the scratch arrays doesn't zero vertices that are about to be written
+		ShapeVertex() { }
+	};
+
+	//Shapes can be drawn from any thread. Each thread collects its shapes in its own buffer without locking,
+	//and RenderDrawings() merges every buffer on the main thread, so worker threads must be done drawing
+	//for the frame by then (true of any work that's joined before rendering).
 	class ShapeManager
 	{
 	public:
@@ -60,42 +128,128 @@ namespace Debug
 		void Initialize();
 		void Render();
 		void Update( float deltaSeconds );
+		void Clear();
+
+		//Bytes held by the records and list data of the shapes drawn so far, for measuring
+		unsigned int GetNumberOfBytesStored();
 
 		//"Call anywhere" functions
 		friend void DrawPointForTime( const FloatVector3& location, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
 		friend void DrawLineForTime( const FloatVector3& startLocation, const Color& startColor, const FloatVector3& endLocation, const Color& endColor, DrawingVisibility visibility, float lifetimeSeconds );
 		friend void DrawAxesForTime( const FloatVector3& location, float axisLength, DrawingVisibility visibility, float lifetimeSeconds );
 		friend void DrawArrowForTime( const FloatVector3& startLocation, const Color& startColor, const FloatVector3& endLocation, const Color& endColor, DrawingVisibility visibility, float timelineSeconds );
-		friend void DrawAABBForTime( const FloatVector3& minLocation, const FloatVector3& maxLocation, const Color& edgeColor, const Color& faceColor, DrawingVisibility visibility, float lifetimeSeconds );	
+		friend void DrawAABBForTime( const FloatVector3& minLocation, const FloatVector3& maxLocation, const Color& edgeColor, const Color& faceColor, DrawingVisibility visibility, float lifetimeSeconds );
 		friend void DrawSphereForTime( const FloatVector3& center, float radius, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+		friend void DrawPointListForTime( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+		friend void DrawLineListForTime( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
 
 	private:
-		void CleanupDeadShapes();
-		void RemoveDeadShapesFromDataArray( std::vector< ShapeVertexData >& vertexDataArray );
+		friend class ScopedDrawingOrder;
+		friend class ScopedShapeStash;
 
-		void RenderShapesDrawnSkinnyWhenOccluded( const Renderer* renderer ) const;
-		void RenderShapesDrawnOnlyWhenVisible( const Renderer* renderer ) const;
-		void RenderShapesDrawnAlways( const Renderer* renderer ) const;
+		static const unsigned int NUMBER_OF_VISIBILITY_TYPES = 3;
 
-		void UpdateLifetimesInShapeDataArray( float deltaSeconds, std::vector< ShapeVertexData >& vertexDataArray );
+		//Shapes with no lifetime only live for the frame they're drawn in, so they're kept apart
+		//from timed shapes and simply cleared after rendering. Lists are drawn after single shapes.
+		struct ShapeRecordArrays
+		{
+			std::vector< ShapeRecord > transientShapes;
+			std::vector< ShapeRecord > timedShapes;
+			std::vector< ShapeListRecord > transientLists;
+			std::vector< ShapeListRecord > timedLists;
+		};
+
+		void AddShape( const ShapeRecord& shape );
+		void AddPointList( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+		void AddLineList( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+		std::vector< ShapeRecord >& GetArrayForShapes( unsigned int shapeArrayIndex );
+		std::vector< ShapeListRecord >& GetArrayForShapeLists( unsigned int shapeArrayIndex );
+		void MergeThreadShapeBuffers();
+		unsigned int SetDrawingOrderForThisThread( unsigned int orderKey );
+		void StashShapes( ShapeRecordArrays* out_stashedShapesByVisibility );
+		void RestoreStashedShapes( ShapeRecordArrays* stashedShapesByVisibility );
+
+		void CleanupDeadShapes();
+		void RemoveDeadShapesFromRecordArray( std::vector< ShapeRecord >& shapeRecords );
+		void RemoveDeadShapesFromRecordArray( std::vector< ShapeListRecord >& listRecords );
+		void ReleaseShapeLists( std::vector< ShapeListRecord >& listRecords );
+		void ReleaseShapeListData( unsigned int listDataIndex );
+
+		void CountVerticesForShapes( const std::vector< ShapeRecord >& shapeRecords, unsigned int& out_numberOfLineVertices, unsigned int& out_numberOfTriangleVertices ) const;
+		void CountVerticesForShapes( const std::vector< ShapeListRecord >& listRecords, unsigned int& out_numberOfLineVertices ) const;
+		void ExpandShapesIntoVertices( const std::vector< ShapeRecord >& shapeRecords, ShapeVertex*& out_lineVertex, ShapeVertex*& out_triangleVertex ) const;
+		void ExpandShapesIntoVertices( const std::vector< ShapeListRecord >& listRecords, ShapeVertex*& out_lineVertex ) const;
+		void RenderShapeVertexArray( const Renderer* renderer, RenderStateCache& stateCache, Renderer::Shape shape, const std::vector< ShapeVertex >& vertexArray ) const;
+		void RenderShapesWithVisibility( const Renderer* renderer, RenderStateCache& stateCache, DrawingVisibility visibility, bool depthTesting, float lineWidth );
+		void RenderShapesDrawnSkinnyWhenOccluded( const Renderer* renderer, RenderStateCache& stateCache );
+		void RenderShapesDrawnOnlyWhenVisible( const Renderer* renderer, RenderStateCache& stateCache );
+		void RenderShapesDrawnAlways( const Renderer* renderer, RenderStateCache& stateCache );
+
+		template< typename RecordType >
+		void UpdateLifetimesInShapeRecordArray( float deltaSeconds, std::vector< RecordType >& shapeRecords );
 
 		Material m_shapeRenderingMaterial;
 		int m_vertexAttributeID;
 		int m_colorAttributeID;
 
-		std::vector< ShapeVertexData > m_linesAlwaysDrawn;
-		std::vector< ShapeVertexData > m_linesSkinnyOccluded;
-		std::vector< ShapeVertexData > m_linesDrawnWhenVisible;
-		std::vector< ShapeVertexData > m_triStripsAlwaysDrawn;
-		std::vector< ShapeVertexData > m_triStripsSkinnyOccluded;
-		std::vector< ShapeVertexData > m_triStripsDrawnWhenVisible;
+		ShapeRecordArrays m_shapesByVisibility[ NUMBER_OF_VISIBILITY_TYPES ];
+		std::vector< FloatVector3 > m_unitSphereTriangles;
+
+		//List data referenced by list records; released slots keep their capacity for reuse
+		std::vector< ShapeListData > m_shapeListData;
+		std::vector< unsigned int > m_freeShapeListDataIndices;
+
+		//Scratch space for expanded vertices, kept between frames so submission doesn't allocate
+		std::vector< ShapeVertex > m_lineVertices;
+		std::vector< ShapeVertex > m_triangleVertices;
 	};
 
 	extern ShapeManager g_shapeManager;
 
+	//-----------------------------------------------------------------------------------------------
+	//Merged shapes are ordered by key first and thread second, and each thread keeps its own drawing order.
+	//Parallel work that gives each work item its own key is therefore drawn the same way every frame,
+	//whichever threads the items ran on. Shapes drawn outside of any scope use key 0.
+	class ScopedDrawingOrder
+	{
+	public:
+		explicit ScopedDrawingOrder( unsigned int orderKey )
+			: m_previousOrderKey( g_shapeManager.SetDrawingOrderForThisThread( orderKey ) )
+		{ }
+
+		~ScopedDrawingOrder() { g_shapeManager.SetDrawingOrderForThisThread( m_previousOrderKey ); }
+
+	private:
+		unsigned int m_previousOrderKey;
+
+		//We have no need of a pithy assignment or copy operator!
+		ScopedDrawingOrder( const ScopedDrawingOrder& );
+		void operator=( const ScopedDrawingOrder& );
+	};
+
+	//-----------------------------------------------------------------------------------------------
+	//Sets every shape drawn so far aside, timed ones included, and puts them back when the scope ends,
+	//dropping whatever was drawn in between. Main thread only. Lets code that clears the drawings
+	//repeatedly (benchmarks) run without wiping out the user's shapes.
+	class ScopedShapeStash
+	{
+	public:
+		ScopedShapeStash() { g_shapeManager.StashShapes( m_stashedShapesByVisibility ); }
+		~ScopedShapeStash() { g_shapeManager.RestoreStashedShapes( m_stashedShapesByVisibility ); }
+
+	private:
+		ShapeManager::ShapeRecordArrays m_stashedShapesByVisibility[ ShapeManager::NUMBER_OF_VISIBILITY_TYPES ];
+
+		//We have no need of a pithy assignment or copy operator!
+		ScopedShapeStash( const ScopedShapeStash& );
+		void operator=( const ScopedShapeStash& );
+	};
+
 	inline void InitializeDrawingSystem() { g_shapeManager.Initialize(); }
 	inline void RenderDrawings() { g_shapeManager.Render(); }
 	inline void UpdateDrawings( float deltaSeconds ) { g_shapeManager.Update( deltaSeconds ); }
+	inline void ClearDrawings() { g_shapeManager.Clear(); }
+	inline unsigned int GetNumberOfBytesInDrawings() { return g_shapeManager.GetNumberOfBytesStored(); }
 
 
 
@@ -103,65 +257,31 @@ namespace Debug
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawPointForTime( const FloatVector3& location, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
 	{
-		std::vector< ShapeVertexData >* arrayToAddPoint = nullptr;
-
-		switch( visibility )
+		if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 		{
-		case DRAW_ALWAYS:
-			arrayToAddPoint = &g_shapeManager.m_linesAlwaysDrawn;
-			break;
-		case DRAW_ONLY_IF_VISIBLE:
-			arrayToAddPoint = &g_shapeManager.m_linesDrawnWhenVisible;
-			break;
-		case DRAW_SKINNY_IF_OCCLUDED:
-			arrayToAddPoint = &g_shapeManager.m_linesSkinnyOccluded;
-			//Add a second set of vertices that will be drawn larger when visible
+			//Add a second shape that will be drawn larger when visible
 			DrawPointForTime( location, size, color, DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
-			break;
-		default:
-			assert( false );
 		}
-		
- 		static const unsigned int NUMBER_OF_VERTICES_IN_POINT = 6;
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location - FloatVector3( size, 0.f, 0.f ), color ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location + FloatVector3( size, 0.f, 0.f ), color ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location - FloatVector3( 0.f, size, 0.f ), color ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location + FloatVector3( 0.f, size, 0.f ), color ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location - FloatVector3( 0.f, 0.f, size ), color ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location + FloatVector3( 0.f, 0.f, size ), color ) );
+
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_POINT, visibility, lifetimeSeconds, location, location, size, color, color ) );
 	}
 
 	//-----------------------------------------------------------------------------------------------
-	inline void DrawPoint( const FloatVector3& location, float size, const Color& color, DrawingVisibility visibility ) 
-	{ 
-		DrawPointForTime( location, size, color, visibility, 0.f ); 
+	inline void DrawPoint( const FloatVector3& location, float size, const Color& color, DrawingVisibility visibility )
+	{
+		DrawPointForTime( location, size, color, visibility, 0.f );
 	}
 
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawLineForTime( const FloatVector3& startLocation, const Color& startColor, const FloatVector3& endLocation, const Color& endColor, DrawingVisibility visibility, float lifetimeSeconds )
 	{
-		std::vector< ShapeVertexData >* arrayToAddPoint = nullptr;
-
-		switch( visibility )
+		if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 		{
-		case DRAW_ALWAYS:
-			arrayToAddPoint = &g_shapeManager.m_linesAlwaysDrawn;
-			break;
-		case DRAW_ONLY_IF_VISIBLE:
-			arrayToAddPoint = &g_shapeManager.m_linesDrawnWhenVisible;
-			break;
-		case DRAW_SKINNY_IF_OCCLUDED:
-			arrayToAddPoint = &g_shapeManager.m_linesSkinnyOccluded;
-			//Add a second set of vertices that will be drawn larger when visible
+			//Add a second shape that will be drawn larger when visible
 			DrawLineForTime( startLocation, startColor, endLocation, endColor, DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
-			break;
-		default:
-			assert( false );
 		}
-		
- 		static const unsigned int NUMBER_OF_VERTICES_IN_LINE = 2;
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, startLocation, startColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, endLocation,   endColor   ) );
+
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_LINE, visibility, lifetimeSeconds, startLocation, endLocation, 0.f, startColor, endColor ) );
 	}
 
 	//-----------------------------------------------------------------------------------------------
@@ -173,32 +293,15 @@ namespace Debug
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawAxesForTime( const FloatVector3& location, float axisLength, DrawingVisibility visibility, float lifetimeSeconds )
 	{
-		std::vector< ShapeVertexData >* arrayToAddPoint = nullptr;
-
-		switch( visibility )
+		if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 		{
-		case DRAW_ALWAYS:
-			arrayToAddPoint = &g_shapeManager.m_linesAlwaysDrawn;
-			break;
-		case DRAW_ONLY_IF_VISIBLE:
-			arrayToAddPoint = &g_shapeManager.m_linesDrawnWhenVisible;
-			break;
-		case DRAW_SKINNY_IF_OCCLUDED:
-			arrayToAddPoint = &g_shapeManager.m_linesSkinnyOccluded;
-			//Add a second set of vertices that will be drawn larger when visible
+			//Add a second shape that will be drawn larger when visible
 			DrawAxesForTime( location, axisLength, DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
-			break;
-		default:
-			assert( false );
 		}
 
- 		static const unsigned int NUMBER_OF_VERTICES_IN_AXES = 6;
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location,											Color( 1.f, 0.f, 0.f, 1.f ) ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location.x + axisLength, location.y, location.z,	Color( 1.f, 0.f, 0.f, 1.f ) ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location,											Color( 0.f, 1.f, 0.f, 1.f ) ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location.x, location.y + axisLength, location.z,	Color( 0.f, 1.f, 0.f, 1.f ) ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location,											Color( 0.f, 0.f, 1.f, 1.f ) ) );
-		arrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, location.x, location.y, location.z + axisLength,	Color( 0.f, 0.f, 1.f, 1.f ) ) );
+		//Axes are always drawn red, green and blue, so the record's colors go unused
+		static const Color UNUSED_COLOR( 1.f, 1.f, 1.f, 1.f );
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_AXES, visibility, lifetimeSeconds, location, location, axisLength, UNUSED_COLOR, UNUSED_COLOR ) );
 	}
 
 	//-----------------------------------------------------------------------------------------------
@@ -219,44 +322,14 @@ namespace Debug
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawArrowForTime( const FloatVector3& startLocation, const Color& startColor, const FloatVector3& endLocation, const Color& endColor, DrawingVisibility visibility, float timelineSeconds )
 	{
-		static const float ARROWHEAD_SIZE = 1.f;
-		FloatVector3 lineDirection = endLocation - startLocation;
-		lineDirection.Normalize();
-		FloatVector3 arrowheadStart = endLocation - ARROWHEAD_SIZE * 1.5f * lineDirection;
-
-
-		std::vector< ShapeVertexData >* arrayToAddPoint = nullptr;
-		switch( visibility )
+		if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 		{
-		case DRAW_ALWAYS:
-			arrayToAddPoint = &g_shapeManager.m_triStripsAlwaysDrawn;
-			DrawLineForTime( startLocation, startColor, arrowheadStart, endColor, DRAW_ALWAYS, timelineSeconds );
-			break;
-		case DRAW_SKINNY_IF_OCCLUDED:
-			arrayToAddPoint = &g_shapeManager.m_triStripsSkinnyOccluded;
-			DrawLineForTime( startLocation, startColor, arrowheadStart, endColor, DRAW_SKINNY_IF_OCCLUDED, timelineSeconds );
+			//Add a second shape that will be drawn larger when visible
 			DrawArrowForTime( startLocation, startColor, endLocation, endColor, DRAW_ONLY_IF_VISIBLE, timelineSeconds );
-			break;
-		case DRAW_ONLY_IF_VISIBLE:
-			arrayToAddPoint = &g_shapeManager.m_triStripsDrawnWhenVisible;
-			DrawLineForTime( startLocation, startColor, arrowheadStart, endColor, DRAW_ONLY_IF_VISIBLE, timelineSeconds );
-			break;
-		default:
-			assert( false );
 		}
 
-		FloatVector3 orthogonalVector1( 0.f, 1.f, 0.f ), orthogonalVector2( 0.f, 0.f, 1.f );
-		GramSchmidt3D( lineDirection, orthogonalVector1, orthogonalVector2 );
-
- 		static const unsigned int NUMBER_OF_VERTICES_IN_ARROWHEAD = 8;
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart + orthogonalVector1 - orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart - orthogonalVector1 + orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart - orthogonalVector1 - orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, endLocation, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart + orthogonalVector1 - orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart + orthogonalVector1 + orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, arrowheadStart - orthogonalVector1 + orthogonalVector2, endColor ) );
-		arrayToAddPoint->push_back( ShapeVertexData( timelineSeconds, endLocation, endColor ) );
+		static const float ARROWHEAD_SIZE = 1.f;
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_ARROW, visibility, timelineSeconds, startLocation, endLocation, ARROWHEAD_SIZE, startColor, endColor ) );
 	}
 
 	//-----------------------------------------------------------------------------------------------
@@ -268,84 +341,45 @@ namespace Debug
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawAABBForTime( const FloatVector3& minLocation, const FloatVector3& maxLocation, const Color& edgeColor, const Color& faceColor, DrawingVisibility visibility, float lifetimeSeconds )
 	{
-		std::vector< ShapeVertexData >* lineArrayToAddPoint = nullptr;
-		std::vector< ShapeVertexData >* triArrayToAddPoint = nullptr;
-		
-		switch( visibility )
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_AABB, visibility, lifetimeSeconds, minLocation, maxLocation, 0.f, edgeColor, faceColor ) );
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	inline void DrawAABB( const FloatVector3& minLocation, const FloatVector3& maxLocation, const Color& edgeColor, const Color& faceColor, DrawingVisibility visibility )
+	{
+		DrawAABBForTime( minLocation, maxLocation, edgeColor, faceColor, visibility, 0.f );
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	inline void DrawSphereForTime( const FloatVector3& center, float radius, const Color& color, DrawingVisibility visibility, float lifetimeSeconds )
+	{
+		if( visibility == DRAW_SKINNY_IF_OCCLUDED )
 		{
-		case DRAW_ALWAYS:
-			lineArrayToAddPoint = &g_shapeManager.m_linesAlwaysDrawn;
-			triArrayToAddPoint = &g_shapeManager.m_triStripsAlwaysDrawn;
-			break;
-		case DRAW_SKINNY_IF_OCCLUDED:
-			lineArrayToAddPoint = &g_shapeManager.m_linesSkinnyOccluded;
-			triArrayToAddPoint = &g_shapeManager.m_triStripsSkinnyOccluded;
-			break;
-		case DRAW_ONLY_IF_VISIBLE:
-			lineArrayToAddPoint = &g_shapeManager.m_linesDrawnWhenVisible;
-			triArrayToAddPoint = &g_shapeManager.m_triStripsDrawnWhenVisible;
-			break;
-		default:
-			assert( false );
+			//Add a second shape that will be drawn larger when visible
+			DrawSphereForTime( center, radius, Color( color.r, color.g, color.b, 0.5f * color.a ), DRAW_ONLY_IF_VISIBLE, lifetimeSeconds );
 		}
 
-		static const unsigned int NUMBER_OF_VERTICES_FOR_EDGES = 24;
-
-		//Near side quad
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation, edgeColor ) );
-
-		//Far side quad
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation, edgeColor ) );
-
-		//Connecting lines
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, maxLocation.y, minLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, maxLocation.z, edgeColor ) );
-		lineArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation, edgeColor ) );
-		
-		static const unsigned int NUMBER_OF_VERTICES_FOR_FACES = 14;
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, minLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, minLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, maxLocation.y, minLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, minLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, maxLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, minLocation.y, maxLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, minLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, maxLocation.y, maxLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, minLocation.x, minLocation.y, maxLocation.z, faceColor ) );
-		triArrayToAddPoint->push_back( ShapeVertexData( lifetimeSeconds, maxLocation.x, minLocation.y, maxLocation.z, faceColor ) );
+		g_shapeManager.AddShape( ShapeRecord( SHAPE_SPHERE, visibility, lifetimeSeconds, center, center, radius, color, color ) );
 	}
 
 	//-----------------------------------------------------------------------------------------------
-	inline void DrawAABB( const FloatVector3& minLocation, const FloatVector3& maxLocation, const Color& edgeColor, const Color& faceColor, DrawingVisibility visibility )
+	//Bulk versions for drawing many shapes of one color at once, such as a whole cloth wireframe.
+	//Each line is a pair of indices into the position stream. The positions are copied when drawn,
+	//once for consecutive lists on a thread that draw from the same unchanged positions.
+	void DrawPointListForTime( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+	void DrawLineListForTime( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+
+	//-----------------------------------------------------------------------------------------------
+	inline void DrawPointList( const FloatVector3* locations, unsigned int numberOfPoints, float size, const Color& color, DrawingVisibility visibility )
 	{
-		DrawAABBForTime( minLocation, maxLocation, edgeColor, faceColor, visibility, 0.f );
+		DrawPointListForTime( locations, numberOfPoints, size, color, visibility, 0.f );
 	}
 
 	//-----------------------------------------------------------------------------------------------
-	void DrawSphereForTime( const FloatVector3& center, float radius, const Color& color, DrawingVisibility visibility, float lifetimeSeconds );
+	inline void DrawLineList( const FloatVector3* positions, const unsigned int* indexPairs, unsigned int numberOfLines, const Color& color, DrawingVisibility visibility )
+	{
+		DrawLineListForTime( positions, indexPairs, numberOfLines, color, visibility, 0.f );
+	}
 
 	//-----------------------------------------------------------------------------------------------
 	inline void DrawSphere( const FloatVector3& center, float radius, const Color& color, DrawingVisibility visibility )
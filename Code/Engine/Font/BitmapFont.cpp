@@ -1,7 +1,51 @@
 #include "../XML/pugixml.hpp"
+#include "../MemoryMappedFile.hpp"
 #include "BitmapFont.hpp"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
 #include <sstream>
 
+//Every x86 target we build for has SSE; anything else measures text with the plain loops.
+#if defined( __SSE__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define BITMAP_FONT_USE_SSE
+#include <xmmintrin.h>
+#endif
+
+#pragma region Compiled Font Format
+//-----------------------------------------------------------------------------------------------
+//A compiled font is this header followed by a flat array of glyph records, written and read in the
+//machine's own byte order. The source size and hash tie it to the exact XML it was built from.
+static const unsigned int COMPILED_FONT_MAGIC = 0x544E4642; //"BFNT" when read from a little-endian file
+static const unsigned int COMPILED_FONT_VERSION = 1;
+static const unsigned int COMPILED_FONT_NAME_LENGTH = 64;
+
+struct CompiledFontHeader
+{
+	unsigned int magic;
+	unsigned int version;
+	unsigned int sourceSizeBytes;
+	StringID	 sourceHash;
+	unsigned int numberOfTextureSheets;
+	unsigned int numberOfGlyphs;
+	char		 fontName[ COMPILED_FONT_NAME_LENGTH ];
+};
+
+struct BitmapFont::CompiledGlyph
+{
+	unsigned int ucsIndex;
+	unsigned int textureSheetID;
+	float		 textureUVMins[ 2 ];
+	float		 textureUVMaxs[ 2 ];
+	float		 advanceBeforeDrawA;
+	float		 fontWidthB;
+	float		 advanceAfterDrawC;
+};
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+STATIC const Glyph BitmapFont::s_missingGlyph;
+
 unsigned int ConvertStringToUnsignedInt( const std::string& numberString )
 {
 	unsigned int output;
@@ -40,15 +84,13 @@ FloatVector2 ConvertStringToFloatVector2( const std::string& numberString )
 }
 
 //-----------------------------------------------------------------------------------------------
-void BitmapFont::LoadFontMetadataFromXML( const std::string& fontMetadataXMLfileLocation )
+bool BitmapFont::LoadFontMetadataFromXML( const char* xmlText, size_t xmlSizeBytes, std::vector< CompiledGlyph >& out_glyphs )
 {
 	pugi::xml_document fontXMLmetadata;
 
-	pugi::xml_parse_result xmlParseResult = fontXMLmetadata.load_file( fontMetadataXMLfileLocation.c_str() );
+	pugi::xml_parse_result xmlParseResult = fontXMLmetadata.load_buffer( xmlText, xmlSizeBytes );
 	if( xmlParseResult != true )
-	{
-		exit( -14 );
-	}
+		return false;
 
 	pugi::xml_node rootNode = fontXMLmetadata.child( "FontDefinition" );
 
@@ -56,7 +98,7 @@ void BitmapFont::LoadFontMetadataFromXML( const std::string& fontMetadataXMLfile
 	m_fontName = fontInfoNode.attribute( "name" ).value();
 	m_numberOfTextureSheets = ConvertStringToUnsignedInt( fontInfoNode.attribute( "numTextureSheets" ).value() );
 
-	for (pugi::xml_node glyphData = rootNode.child( "Glyph" ); glyphData != false; glyphData = glyphData.next_sibling( "Glyph" ) )
+	for (pugi::xml_node glyphData = rootNode.child( "Glyph" ); glyphData; glyphData = glyphData.next_sibling( "Glyph" ) )
 	{
 		Glyph newGlyph( ConvertStringToUnsignedInt( glyphData.attribute( "sheet" ).value() ),
 						ConvertStringToFloatVector2( glyphData.attribute( "texCoordMins" ).value() ),
@@ -66,15 +108,121 @@ void BitmapFont::LoadFontMetadataFromXML( const std::string& fontMetadataXMLfile
 						ConvertStringToFloat( glyphData.attribute( "ttfC" ).value() ) );
 
 		unsigned int ucsIndex = ConvertStringToUnsignedInt( glyphData.attribute( "ucsIndex" ).value() );
-		m_glyphData[ ucsIndex ] = newGlyph;
+		AddGlyph( ucsIndex, newGlyph );
+
+		CompiledGlyph compiledGlyph;
+		compiledGlyph.ucsIndex = ucsIndex;
+		compiledGlyph.textureSheetID = newGlyph.m_textureSheetID;
+		compiledGlyph.textureUVMins[ 0 ] = newGlyph.m_textureUVMins.x;
+		compiledGlyph.textureUVMins[ 1 ] = newGlyph.m_textureUVMins.y;
+		compiledGlyph.textureUVMaxs[ 0 ] = newGlyph.m_textureUVMaxs.x;
+		compiledGlyph.textureUVMaxs[ 1 ] = newGlyph.m_textureUVMaxs.y;
+		compiledGlyph.advanceBeforeDrawA = newGlyph.m_advanceBeforeDrawA;
+		compiledGlyph.fontWidthB = newGlyph.m_fontWidthB;
+		compiledGlyph.advanceAfterDrawC = newGlyph.m_advanceAfterDrawC;
+		out_glyphs.push_back( compiledGlyph );
 	}
+	BuildDenseAdvanceTable();
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Anything unexpected about the file, from a stale hash to a truncated glyph array, just sends us
+//back to the XML.
+bool BitmapFont::LoadFontMetadataFromCompiledFile( const std::string& compiledFileLocation, size_t sourceSizeBytes, StringID sourceHash )
+{
+	MemoryMappedFile compiledFile;
+	if( !compiledFile.Open( compiledFileLocation ) || compiledFile.GetSizeBytes() < sizeof( CompiledFontHeader ) )
+		return false;
+
+	const CompiledFontHeader* header = reinterpret_cast< const CompiledFontHeader* >( compiledFile.GetData() );
+	if( header->magic != COMPILED_FONT_MAGIC || header->version != COMPILED_FONT_VERSION
+		|| header->sourceSizeBytes != sourceSizeBytes || header->sourceHash != sourceHash
+		|| header->fontName[ COMPILED_FONT_NAME_LENGTH - 1 ] != '\0' )
+		return false;
+
+	size_t expectedSizeBytes = sizeof( CompiledFontHeader ) + header->numberOfGlyphs * sizeof( CompiledGlyph );
+	if( compiledFile.GetSizeBytes() != expectedSizeBytes )
+		return false;
+
+	m_fontName = header->fontName;
+	m_numberOfTextureSheets = header->numberOfTextureSheets;
+
+	const CompiledGlyph* compiledGlyphs = reinterpret_cast< const CompiledGlyph* >( compiledFile.GetData() + sizeof( CompiledFontHeader ) );
+	for( unsigned int i = 0; i < header->numberOfGlyphs; ++i )
+	{
+		const CompiledGlyph& compiledGlyph = compiledGlyphs[ i ];
+		AddGlyph( compiledGlyph.ucsIndex, Glyph( compiledGlyph.textureSheetID,
+												 FloatVector2( compiledGlyph.textureUVMins[ 0 ], compiledGlyph.textureUVMins[ 1 ] ),
+												 FloatVector2( compiledGlyph.textureUVMaxs[ 0 ], compiledGlyph.textureUVMaxs[ 1 ] ),
+												 compiledGlyph.advanceBeforeDrawA, compiledGlyph.fontWidthB, compiledGlyph.advanceAfterDrawC ) );
+	}
+	BuildDenseAdvanceTable();
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+bool BitmapFont::WriteCompiledFontFile( const std::string& compiledFileLocation, size_t sourceSizeBytes, StringID sourceHash,
+										const std::vector< CompiledGlyph >& glyphs ) const
+{
+	CompiledFontHeader header;
+	memset( &header, 0, sizeof( header ) );
+	header.magic = COMPILED_FONT_MAGIC;
+	header.version = COMPILED_FONT_VERSION;
+	header.sourceSizeBytes = static_cast< unsigned int >( sourceSizeBytes );
+	header.sourceHash = sourceHash;
+	header.numberOfTextureSheets = m_numberOfTextureSheets;
+	header.numberOfGlyphs = glyphs.size();
+	memcpy( header.fontName, m_fontName.c_str(), std::min< size_t >( m_fontName.length(), COMPILED_FONT_NAME_LENGTH - 1 ) );
+
+	FILE* compiledFile = nullptr;
+#if defined( _WIN32 )
+	if( fopen_s( &compiledFile, compiledFileLocation.c_str(), "wb" ) != 0 )
+		compiledFile = nullptr;
+#else
+	compiledFile = fopen( compiledFileLocation.c_str(), "wb" );
+#endif
+	if( compiledFile == nullptr )
+		return false;
+
+	bool writeSucceeded = fwrite( &header, sizeof( header ), 1, compiledFile ) == 1;
+	if( writeSucceeded && !glyphs.empty() )
+		writeSucceeded = fwrite( &glyphs[ 0 ], sizeof( CompiledGlyph ), glyphs.size(), compiledFile ) == glyphs.size();
+	writeSucceeded = ( fclose( compiledFile ) == 0 ) && writeSucceeded;
+
+	//A half-written file would only be rejected on the next load, but there's no reason to leave it around
+	if( !writeSucceeded )
+		remove( compiledFileLocation.c_str() );
+	return writeSucceeded;
+}
+
+//-----------------------------------------------------------------------------------------------
+void BitmapFont::LoadFontMetadata( const std::string& fontMetadataXMLfileLocation )
+{
+	MemoryMappedFile sourceFile;
+	if( !sourceFile.Open( fontMetadataXMLfileLocation ) )
+		exit( -14 );
+
+	const char* xmlText = reinterpret_cast< const char* >( sourceFile.GetData() );
+	StringID sourceHash = HashString( xmlText, sourceFile.GetSizeBytes() );
+
+	std::string compiledFileLocation = GetCompiledFontLocation( fontMetadataXMLfileLocation );
+	if( LoadFontMetadataFromCompiledFile( compiledFileLocation, sourceFile.GetSizeBytes(), sourceHash ) )
+		return;
+
+	std::vector< CompiledGlyph > compiledGlyphs;
+	if( !LoadFontMetadataFromXML( xmlText, sourceFile.GetSizeBytes(), compiledGlyphs ) )
+		exit( -14 );
+
+	//If this fails (say, from a read-only install) we simply parse the XML again next time
+	WriteCompiledFontFile( compiledFileLocation, sourceFile.GetSizeBytes(), sourceHash, compiledGlyphs );
 }
 
 //-----------------------------------------------------------------------------------------------
 BitmapFont::BitmapFont( const std::string& fontDefinitionXMLlocation, 
 	const std::string* fontAtlasLocations, unsigned int numberOfAtlases )
 {
-	LoadFontMetadataFromXML( fontDefinitionXMLlocation );
+	LoadFontMetadata( fontDefinitionXMLlocation );
 
 	for( unsigned int textureID = 0; textureID < numberOfAtlases; ++textureID )
 	{
@@ -84,13 +232,132 @@ BitmapFont::BitmapFont( const std::string& fontDefinitionXMLlocation,
 }
 
 //-----------------------------------------------------------------------------------------------
-float BitmapFont::GetWidthOfCharacter( char character, float fontHeight ) const
+STATIC std::string BitmapFont::GetCompiledFontLocation( const std::string& fontDefinitionXMLlocation )
 {
-	const Glyph& characterGlyph = ( *m_glyphData.find( character ) ).second;
+	static const std::string XML_EXTENSION = ".xml";
+	static const std::string COMPILED_EXTENSION = ".bin";
 
-	float preAdvanceWidth = characterGlyph.m_advanceBeforeDrawA * fontHeight;
-	float characterWidth = characterGlyph.m_fontWidthB * fontHeight;
-	float postAdvanceWidth = characterGlyph.m_advanceAfterDrawC * fontHeight;
+	size_t extensionStart = fontDefinitionXMLlocation.length() - std::min( fontDefinitionXMLlocation.length(), XML_EXTENSION.length() );
+	if( fontDefinitionXMLlocation.compare( extensionStart, std::string::npos, XML_EXTENSION ) == 0 )
+		return fontDefinitionXMLlocation.substr( 0, extensionStart ) + COMPILED_EXTENSION;
+	return fontDefinitionXMLlocation + COMPILED_EXTENSION;
+}
 
-	return preAdvanceWidth + characterWidth + postAdvanceWidth;
+//-----------------------------------------------------------------------------------------------
+STATIC bool BitmapFont::CompileFontDefinition( const std::string& fontDefinitionXMLlocation )
+{
+	MemoryMappedFile sourceFile;
+	if( !sourceFile.Open( fontDefinitionXMLlocation ) )
+		return false;
+
+	const char* xmlText = reinterpret_cast< const char* >( sourceFile.GetData() );
+	StringID sourceHash = HashString( xmlText, sourceFile.GetSizeBytes() );
+
+	BitmapFont font;
+	std::vector< CompiledGlyph > compiledGlyphs;
+	if( !font.LoadFontMetadataFromXML( xmlText, sourceFile.GetSizeBytes(), compiledGlyphs ) )
+		return false;
+
+	return font.WriteCompiledFontFile( GetCompiledFontLocation( fontDefinitionXMLlocation ), sourceFile.GetSizeBytes(), sourceHash, compiledGlyphs );
+}
+
+//-----------------------------------------------------------------------------------------------
+void BitmapFont::AddGlyph( unsigned int ucsIndex, const Glyph& glyph )
+{
+	if( ucsIndex < NUMBER_OF_DENSE_GLYPHS )
+		m_denseGlyphs[ ucsIndex ] = glyph;
+	else
+		m_sparseGlyphs[ ucsIndex ] = glyph;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Characters the font doesn't define keep a default glyph, so they draw and measure as nothing.
+void BitmapFont::BuildDenseAdvanceTable()
+{
+	for( unsigned int i = 0; i < NUMBER_OF_DENSE_GLYPHS; ++i )
+	{
+		const Glyph& glyph = m_denseGlyphs[ i ];
+		m_denseAdvances[ i ] = glyph.m_advanceBeforeDrawA + glyph.m_fontWidthB + glyph.m_advanceAfterDrawC;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+const Glyph& BitmapFont::GetGlyphForCodePoint( unsigned int codePoint ) const
+{
+	if( codePoint < NUMBER_OF_DENSE_GLYPHS )
+		return m_denseGlyphs[ codePoint ];
+
+	std::map< unsigned int, Glyph >::const_iterator sparseGlyph = m_sparseGlyphs.find( codePoint );
+	if( sparseGlyph == m_sparseGlyphs.end() )
+		return s_missingGlyph;
+	return sparseGlyph->second;
+}
+
+#pragma region Text Measurement
+#ifdef BITMAP_FONT_USE_SSE
+//-----------------------------------------------------------------------------------------------
+//SSE has no gather, so the four table reads are scalar; everything after them stays in the register.
+static inline __m128 LoadFourAdvances( const float* advanceTable, const unsigned char* characters )
+{
+	return _mm_set_ps( advanceTable[ characters[ 3 ] ], advanceTable[ characters[ 2 ] ],
+					   advanceTable[ characters[ 1 ] ], advanceTable[ characters[ 0 ] ] );
+}
+#endif
+
+//-----------------------------------------------------------------------------------------------
+float BitmapFont::CalculateTextWidth( const char* text, unsigned int numberOfCharacters, float fontHeight ) const
+{
+	const unsigned char* characters = reinterpret_cast< const unsigned char* >( text );
+	float textWidth = 0.f;
+	unsigned int i = 0;
+
+#ifdef BITMAP_FONT_USE_SSE
+	__m128 partialWidths = _mm_setzero_ps();
+	for( ; i + 4 <= numberOfCharacters; i += 4 )
+		partialWidths = _mm_add_ps( partialWidths, LoadFourAdvances( m_denseAdvances, characters + i ) );
+
+	partialWidths = _mm_add_ps( partialWidths, _mm_movehl_ps( partialWidths, partialWidths ) );
+	partialWidths = _mm_add_ss( partialWidths, _mm_shuffle_ps( partialWidths, partialWidths, _MM_SHUFFLE( 1, 1, 1, 1 ) ) );
+	textWidth = _mm_cvtss_f32( partialWidths );
+#endif
+
+	for( ; i < numberOfCharacters; ++i )
+		textWidth += m_denseAdvances[ characters[ i ] ];
+	return textWidth * fontHeight;
+}
+
+//-----------------------------------------------------------------------------------------------
+void BitmapFont::CalculateAdvancePrefixSums( const char* text, unsigned int numberOfCharacters, float fontHeight, float* out_penPositions ) const
+{
+	const unsigned char* characters = reinterpret_cast< const unsigned char* >( text );
+	float penPosition = 0.f;
+	unsigned int i = 0;
+
+	out_penPositions[ 0 ] = 0.f;
+
+#ifdef BITMAP_FONT_USE_SSE
+	const __m128 zero = _mm_setzero_ps();
+	const __m128 scale = _mm_set1_ps( fontHeight );
+	__m128 carry = zero;
+	for( ; i + 4 <= numberOfCharacters; i += 4 )
+	{
+		__m128 sums = _mm_mul_ps( LoadFourAdvances( m_denseAdvances, characters + i ), scale );
+
+		//Inclusive scan within the register: add the lanes shifted up by one, then by two
+		sums = _mm_add_ps( sums, _mm_move_ss( _mm_shuffle_ps( sums, sums, _MM_SHUFFLE( 2, 1, 0, 0 ) ), zero ) );
+		sums = _mm_add_ps( sums, _mm_movelh_ps( zero, sums ) );
+		sums = _mm_add_ps( sums, carry );
+
+		_mm_storeu_ps( out_penPositions + i + 1, sums );
+		carry = _mm_shuffle_ps( sums, sums, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+	}
+	penPosition = _mm_cvtss_f32( carry );
+#endif
+
+	for( ; i < numberOfCharacters; ++i )
+	{
+		penPosition += m_denseAdvances[ characters[ i ] ] * fontHeight;
+		out_penPositions[ i + 1 ] = penPosition;
+	}
 }
+#pragma endregion
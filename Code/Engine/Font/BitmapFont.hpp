@@ -6,6 +6,8 @@
 #include <map>
 #include <vector>
 #include "../Graphics/Texture.hpp"
+#include "../EngineDefines.hpp"
+#include "../StringID.hpp"
 #include "Glyph.hpp"
 
 //-----------------------------------------------------------------------------------------------
@@ -18,16 +20,31 @@ public:
 		ENGLISH = 1
 	};
 
+	//Every char indexes the dense table directly; only code points past Latin-1 fall back to the map.
+	static const unsigned int NUMBER_OF_DENSE_GLYPHS = 256;
+
 private:
+	static const Glyph s_missingGlyph;
+
 	std::string  m_fontName;
 	Locale		 m_locale;
 	unsigned int m_numberOfTextureSheets;
 	float		 m_pixelHeight;
 
 	std::vector< Texture* >	m_glyphAtlases;
-	std::map< unsigned int, Glyph >	m_glyphData;
+	Glyph					m_denseGlyphs[ NUMBER_OF_DENSE_GLYPHS ];
+	float					m_denseAdvances[ NUMBER_OF_DENSE_GLYPHS ]; //A + B + C of each glyph, per unit of font height
+	std::map< unsigned int, Glyph >	m_sparseGlyphs;
+
+	struct CompiledGlyph; //One record of the binary font format, laid out in BitmapFont.cpp
 
-	void LoadFontMetadataFromXML( const std::string& fontMetadataXMLfileLocation );
+	void AddGlyph( unsigned int ucsIndex, const Glyph& glyph );
+	void BuildDenseAdvanceTable();
+	void LoadFontMetadata( const std::string& fontMetadataXMLfileLocation );
+	bool LoadFontMetadataFromCompiledFile( const std::string& compiledFileLocation, size_t sourceSizeBytes, StringID sourceHash );
+	bool LoadFontMetadataFromXML( const char* xmlText, size_t xmlSizeBytes, std::vector< CompiledGlyph >& out_glyphs );
+	bool WriteCompiledFontFile( const std::string& compiledFileLocation, size_t sourceSizeBytes, StringID sourceHash,
+								const std::vector< CompiledGlyph >& glyphs ) const;
 
 public:
 	BitmapFont()
@@ -35,14 +52,29 @@ public:
 		, m_locale( NONE )
 		, m_numberOfTextureSheets( 0 )
 		, m_pixelHeight( 0.f )
-	{ }
+	{
+		BuildDenseAdvanceTable();
+	}
 
-	BitmapFont( const std::string& fontDefinitionXMLlocation, 
+	BitmapFont( const std::string& fontDefinitionXMLlocation,
 				const std::string* fontAtlasLocations, unsigned int numberOfAtlases );
 
-	const Glyph& GetGlyphForCharacter( char character ) const { return ( *m_glyphData.find( character ) ).second ; }
+	//Fonts load from a compiled binary beside their XML definition whenever its recorded source hash
+	//still matches the XML, and write one after parsing otherwise. CompileFontDefinition builds it
+	//ahead of time, so even the first run after a font changes skips the XML parse.
+	static std::string GetCompiledFontLocation( const std::string& fontDefinitionXMLlocation );
+	static bool CompileFontDefinition( const std::string& fontDefinitionXMLlocation );
+
+	const Glyph& GetGlyphForCharacter( char character ) const { return m_denseGlyphs[ static_cast< unsigned char >( character ) ]; }
+	const Glyph& GetGlyphForCodePoint( unsigned int codePoint ) const;
 	const Texture* GetTextureSheet( unsigned int sheetNumber ) const { return m_glyphAtlases[ sheetNumber ]; }
-	float GetWidthOfCharacter( char character, float fontHeight ) const;
+	float GetWidthOfCharacter( char character, float fontHeight ) const { return m_denseAdvances[ static_cast< unsigned char >( character ) ] * fontHeight; }
+
+	//Measure whole runs of characters at once rather than summing GetWidthOfCharacter in a loop.
+	//The prefix sums hold numberOfCharacters + 1 pen positions: out_penPositions[ i ] is the width
+	//of the first i characters, so the last entry is the width of the whole run.
+	float CalculateTextWidth( const char* text, unsigned int numberOfCharacters, float fontHeight ) const;
+	void CalculateAdvancePrefixSums( const char* text, unsigned int numberOfCharacters, float fontHeight, float* out_penPositions ) const;
 };
 
 #endif //INCLUDED_BITMAP_FONT_HPP
@@ -0,0 +1,170 @@
+#include <chrono>
+#include <cmath>
+#include <thread>
+#include "FramePacer.hpp"
+#include "Time.hpp"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <mmsystem.h>
+#pragma comment( lib, "winmm" ) // Link in winmm.lib for timeBeginPeriod
+#endif
+
+//-----------------------------------------------------------------------------------------------
+static const unsigned int TIMER_RESOLUTION_MILLISECONDS = 1;
+static const double SLEEP_ESTIMATE_SMOOTHING_WEIGHT = 0.1;
+static const double INITIAL_SLEEP_ESTIMATE_SECONDS = 0.002;
+
+static double g_targetFrameSeconds = 1.0 / 60.0;
+static bool g_isCapped = true;
+static double g_nextFrameTargetSeconds = 0.0;
+static double g_lastFrameStartSeconds = 0.0;
+
+//How long a 1 ms sleep really takes, as a running mean and variance
+static double g_averageSleepSeconds = INITIAL_SLEEP_ESTIMATE_SECONDS;
+static double g_sleepVarianceSeconds = 0.0;
+
+static FramePacer::Statistics g_statistics;
+
+//-----------------------------------------------------------------------------------------------
+static void SleepOnce()
+{
+	double sleepStartSeconds = GetCurrentTimeSeconds();
+	std::this_thread::sleep_for( std::chrono::milliseconds( TIMER_RESOLUTION_MILLISECONDS ) );
+	double sleptSeconds = GetCurrentTimeSeconds() - sleepStartSeconds;
+
+	double deviation = sleptSeconds - g_averageSleepSeconds;
+	g_averageSleepSeconds += SLEEP_ESTIMATE_SMOOTHING_WEIGHT * deviation;
+	g_sleepVarianceSeconds += SLEEP_ESTIMATE_SMOOTHING_WEIGHT * ( deviation * deviation - g_sleepVarianceSeconds );
+	g_statistics.sleptSeconds += sleptSeconds;
+}
+
+//-----------------------------------------------------------------------------------------------
+//The frame's start is the moment the wait hands back control, so frame time includes the wait.
+static void RecordFrameStart( double frameStartSeconds )
+{
+	if( g_lastFrameStartSeconds != 0.0 )
+	{
+		double frameSeconds = frameStartSeconds - g_lastFrameStartSeconds;
+		if( g_statistics.numberOfFrames == 0 || frameSeconds < g_statistics.minimumFrameSeconds )
+			g_statistics.minimumFrameSeconds = frameSeconds;
+		if( frameSeconds > g_statistics.maximumFrameSeconds )
+			g_statistics.maximumFrameSeconds = frameSeconds;
+		g_statistics.totalFrameSeconds += frameSeconds;
+		++g_statistics.numberOfFrames;
+	}
+	g_lastFrameStartSeconds = frameStartSeconds;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FramePacer::Initialize( double targetFrameSeconds )
+{
+#if defined( _WIN32 )
+	timeBeginPeriod( TIMER_RESOLUTION_MILLISECONDS );
+#endif
+	g_targetFrameSeconds = targetFrameSeconds;
+	g_nextFrameTargetSeconds = 0.0;
+	g_lastFrameStartSeconds = 0.0;
+	ResetStatistics();
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FramePacer::Shutdown()
+{
+#if defined( _WIN32 )
+	timeEndPeriod( TIMER_RESOLUTION_MILLISECONDS );
+#endif
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC double FramePacer::GetTargetFrameSeconds()
+{
+	return g_targetFrameSeconds;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FramePacer::SetTargetFrameSeconds( double targetFrameSeconds )
+{
+	g_targetFrameSeconds = targetFrameSeconds;
+	g_nextFrameTargetSeconds = 0.0;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool FramePacer::IsCapped()
+{
+	return g_isCapped;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FramePacer::SetCapped( bool isCapped )
+{
+	g_isCapped = isCapped;
+	g_nextFrameTargetSeconds = 0.0;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Targets advance by whole frame times rather than from when the wait ended, so small overshoots
+//don't add up into a slow drift. A frame that overran its target resyncs instead of rushing to catch up.
+STATIC void FramePacer::WaitForNextFrame()
+{
+	double timeNow = GetCurrentTimeSeconds();
+	if( !g_isCapped )
+	{
+		RecordFrameStart( timeNow );
+		return;
+	}
+
+	if( timeNow >= g_nextFrameTargetSeconds )
+	{
+		if( g_nextFrameTargetSeconds != 0.0 )
+			++g_statistics.numberOfMissedFrames;
+		g_nextFrameTargetSeconds = timeNow + g_targetFrameSeconds;
+		RecordFrameStart( timeNow );
+		return;
+	}
+
+	//Sleep only while a sleep that runs long by two standard deviations would still wake in time
+	double sleepThresholdSeconds = g_averageSleepSeconds + 2.0 * sqrt( g_sleepVarianceSeconds );
+	while( g_nextFrameTargetSeconds - timeNow > sleepThresholdSeconds )
+	{
+		SleepOnce();
+		timeNow = GetCurrentTimeSeconds();
+	}
+
+	double spinStartSeconds = timeNow;
+	while( timeNow < g_nextFrameTargetSeconds )
+	{
+		std::this_thread::yield();
+		timeNow = GetCurrentTimeSeconds();
+	}
+	g_statistics.spunSeconds += timeNow - spinStartSeconds;
+
+	double latenessSeconds = timeNow - g_nextFrameTargetSeconds;
+	if( latenessSeconds > g_statistics.maximumLatenessSeconds )
+		g_statistics.maximumLatenessSeconds = latenessSeconds;
+	g_statistics.totalLatenessSeconds += latenessSeconds;
+
+	g_nextFrameTargetSeconds += g_targetFrameSeconds;
+	RecordFrameStart( timeNow );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC const FramePacer::Statistics& FramePacer::GetStatistics()
+{
+	return g_statistics;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void FramePacer::ResetStatistics()
+{
+	g_statistics.numberOfFrames = 0;
+	g_statistics.numberOfMissedFrames = 0;
+	g_statistics.minimumFrameSeconds = 0.0;
+	g_statistics.maximumFrameSeconds = 0.0;
+	g_statistics.totalFrameSeconds = 0.0;
+	g_statistics.maximumLatenessSeconds = 0.0;
+	g_statistics.totalLatenessSeconds = 0.0;
+	g_statistics.sleptSeconds = 0.0;
+	g_statistics.spunSeconds = 0.0;
+}
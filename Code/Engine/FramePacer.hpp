@@ -0,0 +1,55 @@
+#ifndef INCLUDED_FRAME_PACER_HPP
+#define INCLUDED_FRAME_PACER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include "EngineDefines.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Holds the main loop to a target frame rate without burning a core. The wait sleeps while the
+//frame target is further away than a sleep has recently been seen to overshoot by, then spins
+//(yielding) for the remainder. Uncapped, frames run back to back; the game still steps by the
+//fixed frame time, so a scripted scenario replays the same frames, only faster.
+//-----------------------------------------------------------------------------------------------
+STATIC class FramePacer
+{
+public:
+	//-----------------------------------------------------------------------------------------------
+	//Lateness is how far past its target a waited frame actually woke: the pacer's own jitter.
+	//Frames that overran their target never wait, so they are counted as missed instead.
+	struct Statistics
+	{
+		unsigned int numberOfFrames;
+		unsigned int numberOfMissedFrames;
+		double minimumFrameSeconds;
+		double maximumFrameSeconds;
+		double totalFrameSeconds;
+		double maximumLatenessSeconds;
+		double totalLatenessSeconds;
+		double sleptSeconds;
+		double spunSeconds;
+
+		double GetAverageFrameSeconds() const { return ( numberOfFrames == 0 ) ? 0.0 : totalFrameSeconds / numberOfFrames; }
+		double GetAverageLatenessSeconds() const
+		{
+			unsigned int numberOfWaitedFrames = numberOfFrames - numberOfMissedFrames;
+			return ( numberOfWaitedFrames == 0 ) ? 0.0 : totalLatenessSeconds / numberOfWaitedFrames;
+		}
+	};
+
+	//Raises the OS timer resolution so short sleeps are possible; Shutdown puts it back.
+	static void Initialize( double targetFrameSeconds );
+	static void Shutdown();
+
+	static double GetTargetFrameSeconds();
+	static void SetTargetFrameSeconds( double targetFrameSeconds );
+	static bool IsCapped();
+	static void SetCapped( bool isCapped );
+
+	static void WaitForNextFrame();
+
+	static const Statistics& GetStatistics();
+	static void ResetStatistics();
+};
+
+#endif //INCLUDED_FRAME_PACER_HPP
@@ -1,7 +1,35 @@
+#include <cstdlib>
+#include <functional>
+#include <iomanip>
 #include "../Engine/Graphics/Renderer.hpp"
+#include "../Engine/Graphics/RenderCommandBuffer.hpp"
+#include "../Engine/Graphics/TextBatch.hpp"
 #include "../Engine/DebugDrawing.hpp"
+#include "../Engine/FramePacer.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Profiler.hpp"
+#include "../Engine/Time.hpp"
+#include "../Engine/TraceRecorder.hpp"
+#include "../Game/EngineSettings.hpp"
 #include "Game.hpp"
 
+#ifdef GRAPHICS_USE_RECORDING
+	#include "../Engine/Graphics/RecordingRenderer.hpp"
+#endif
+
+//-----------------------------------------------------------------------------------------------
+STATIC const double Game::FRAME_STATISTICS_INTERVAL_SECONDS = 0.5;
+
+//-----------------------------------------------------------------------------------------------
+//Appends the simulation thread's average step cost and rate over a span of wall time, if it stepped at all.
+static void WriteSimulationThreadStatistics( std::ostringstream& out_statistics, unsigned int numberOfSteps, double stepSeconds, double elapsedSeconds )
+{
+	if( numberOfSteps == 0 || elapsedSeconds <= 0.0 )
+		return;
+
+	out_statistics << "  sim thread " << ( stepSeconds / numberOfSteps * 1000.0 ) << " ms x " << ( numberOfSteps / elapsedSeconds ) << "/s";
+}
+
 //-----------------------------------------------------------------------------------------------
 void Game::UpdateConsoleInput( float, Keyboard& keyInput, const Mouse& )
 {
@@ -57,8 +85,222 @@ Game::Game( bool& quitVariable, unsigned int screenWidth, unsigned int screenHei
 	, m_horizontalFOVDegrees( horizontalFOVDegrees )
 	, m_console( nullptr )
 	, m_consoleVisible( false )
+	, m_frameStatisticsVisible( false )
+	, m_statisticsIntervalStartSeconds( 0.0 )
+	, m_framesInStatisticsInterval( 0 )
+	, m_simulationSecondsInInterval( 0.0 )
+	, m_renderSecondsInInterval( 0.0 )
+	, m_simulationThreadStepsAtIntervalStart( 0 )
+	, m_simulationThreadSecondsAtIntervalStart( 0.0 )
+	, m_frameStatisticsLine( "Gathering frame statistics..." )
+	, m_isCapturing( false )
+	, m_captureOwnsTrace( false )
+	, m_captureStartSeconds( 0.0 )
+	, m_framesInCapture( 0 )
+	, m_captureSimulationSeconds( 0.0 )
+	, m_captureRenderSeconds( 0.0 )
+	, m_simulationThreadStepsAtCaptureStart( 0 )
+	, m_simulationThreadSecondsAtCaptureStart( 0.0 )
+	, m_numberOfFailedChecks( 0 )
 { }
 
+//-----------------------------------------------------------------------------------------------
+//Frame time runs from one Update to the next, so it includes render and the wait for the next frame.
+void Game::UpdateFrameStatistics( double updateStartSeconds, double simulationSeconds )
+{
+	if( m_statisticsIntervalStartSeconds == 0.0 )
+	{
+		m_statisticsIntervalStartSeconds = updateStartSeconds;
+		GetSimulationThreadTotals( m_simulationThreadStepsAtIntervalStart, m_simulationThreadSecondsAtIntervalStart );
+	}
+
+	m_simulationSecondsInInterval += simulationSeconds;
+	++m_framesInStatisticsInterval;
+	if( m_isCapturing )
+	{
+		m_captureSimulationSeconds += simulationSeconds;
+		++m_framesInCapture;
+	}
+
+	double intervalSeconds = updateStartSeconds - m_statisticsIntervalStartSeconds;
+	if( intervalSeconds < FRAME_STATISTICS_INTERVAL_SECONDS )
+		return;
+
+	unsigned int simulationThreadSteps;
+	double simulationThreadSeconds;
+	GetSimulationThreadTotals( simulationThreadSteps, simulationThreadSeconds );
+
+	double inverseNumberOfFrames = 1.0 / m_framesInStatisticsInterval;
+	std::ostringstream statisticsLine;
+	statisticsLine << std::fixed << std::setprecision( 2 );
+	statisticsLine << "frame " << ( intervalSeconds * inverseNumberOfFrames * 1000.0 ) << " ms  update " 
+				   << ( m_simulationSecondsInInterval * inverseNumberOfFrames * 1000.0 ) << " ms  render " 
+				   << ( m_renderSecondsInInterval * inverseNumberOfFrames * 1000.0 ) << " ms";
+	WriteSimulationThreadStatistics( statisticsLine, simulationThreadSteps - m_simulationThreadStepsAtIntervalStart, 
+									 simulationThreadSeconds - m_simulationThreadSecondsAtIntervalStart, intervalSeconds );
+	statisticsLine << "  threads " << JobSystem::GetNumberOfThreads();
+	m_frameStatisticsLine = statisticsLine.str();
+
+	m_simulationThreadStepsAtIntervalStart = simulationThreadSteps;
+	m_simulationThreadSecondsAtIntervalStart = simulationThreadSeconds;
+	m_statisticsIntervalStartSeconds = updateStartSeconds;
+	m_framesInStatisticsInterval = 0;
+	m_simulationSecondsInInterval = 0.0;
+	m_renderSecondsInInterval = 0.0;
+}
+
+//-----------------------------------------------------------------------------------------------
+//stats: toggles the frame/update/render overlay and logs the current averages
+void Game::ToggleFrameStatistics( const CommandConsole::CommandArguments& )
+{
+	static const Color STATISTICS_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+
+	m_frameStatisticsVisible = !m_frameStatisticsVisible;
+	m_console->WriteTextToLog( m_frameStatisticsLine, STATISTICS_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//capture start [name] | stop [traceFile]: brackets a stretch of frames, usually from a script, and
+//reports its average frame/update/render and simulation thread times and profile zones so runs can be compared
+void Game::ControlCapture( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color CAPTURE_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color CAPTURE_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	const std::vector< std::string >& argumentList = arguments.argumentsAsStringArray;
+
+	if( !argumentList.empty() && argumentList[ 0 ] == "start" )
+	{
+		//A trace that was running before the capture (such as from -trace) keeps running; the capture just marks its span
+		if( !m_isCapturing )
+			m_captureOwnsTrace = !TraceRecorder::IsRecording();
+		else if( !m_captureOwnsTrace )
+			TraceRecorder::RecordEnd( "Capture" );
+
+		m_isCapturing = true;
+		m_captureName = ( argumentList.size() > 1 ) ? argumentList[ 1 ] : "unnamed";
+		m_captureStartSeconds = GetCurrentTimeSeconds();
+		m_framesInCapture = 0;
+		m_captureSimulationSeconds = 0.0;
+		m_captureRenderSeconds = 0.0;
+		GetSimulationThreadTotals( m_simulationThreadStepsAtCaptureStart, m_simulationThreadSecondsAtCaptureStart );
+
+		Profiler::ResetStatistics();
+		if( m_captureOwnsTrace )
+			TraceRecorder::Start();
+		else
+			TraceRecorder::RecordBegin( "Capture" );
+		m_console->WriteTextToLog( "Capture " + m_captureName + " started.", CAPTURE_TEXT_COLOR );
+	}
+	else if( !argumentList.empty() && argumentList[ 0 ] == "stop" && m_isCapturing )
+	{
+		m_isCapturing = false;
+		if( m_captureOwnsTrace )
+			TraceRecorder::Stop();
+		else
+			TraceRecorder::RecordEnd( "Capture" );
+
+		unsigned int simulationThreadSteps;
+		double simulationThreadSeconds;
+		GetSimulationThreadTotals( simulationThreadSteps, simulationThreadSeconds );
+
+		double captureSeconds = GetCurrentTimeSeconds() - m_captureStartSeconds;
+		double inverseNumberOfFrames = ( m_framesInCapture == 0 ) ? 0.0 : 1.0 / m_framesInCapture;
+		std::ostringstream summary;
+		summary << std::fixed << std::setprecision( 2 );
+		summary << "Capture " << m_captureName << ": " << m_framesInCapture << " frames, frame " 
+				<< ( captureSeconds * inverseNumberOfFrames * 1000.0 ) << " ms  update " 
+				<< ( m_captureSimulationSeconds * inverseNumberOfFrames * 1000.0 ) << " ms  render " 
+				<< ( m_captureRenderSeconds * inverseNumberOfFrames * 1000.0 ) << " ms";
+		WriteSimulationThreadStatistics( summary, simulationThreadSteps - m_simulationThreadStepsAtCaptureStart, 
+										 simulationThreadSeconds - m_simulationThreadSecondsAtCaptureStart, captureSeconds );
+		summary << "  threads " << JobSystem::GetNumberOfThreads();
+		m_console->WriteTextToLog( summary.str(), CAPTURE_TEXT_COLOR );
+
+		std::vector< std::string > reportLines;
+		Profiler::WriteReport( reportLines );
+		for( unsigned int i = 0; i < reportLines.size(); ++i )
+			m_console->WriteTextToLog( reportLines[ i ], CAPTURE_TEXT_COLOR );
+
+		if( argumentList.size() > 1 )
+		{
+			if( TraceRecorder::WriteChromeTraceFile( argumentList[ 1 ] ) )
+				m_console->WriteTextToLog( "Trace written to " + argumentList[ 1 ], CAPTURE_TEXT_COLOR );
+			else
+				m_console->WriteTextToLog( "ERROR: Could not write trace to " + argumentList[ 1 ], CAPTURE_ERROR_COLOR );
+		}
+	}
+	else
+	{
+		m_console->WriteTextToLog( "Usage: capture start [name] | stop [traceFile]", CAPTURE_ERROR_COLOR );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+//renderstats [expect <statistic> <maximum>]: what last frame cost the renderer. With the recording
+//backend, expect fails the run (a nonzero exit code) if that frame's counter went over the maximum,
+//so a headless scripted run can guard against render regressions.
+void Game::ControlRenderStatistics( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color REPORT_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color REPORT_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	const std::vector< std::string >& argumentList = arguments.argumentsAsStringArray;
+
+	if( !argumentList.empty() )
+	{
+		if( argumentList[ 0 ] != "expect" || argumentList.size() != 3 )
+		{
+			m_console->WriteTextToLog( "Usage: renderstats [expect <statistic> <maximum>]", REPORT_ERROR_COLOR );
+			return;
+		}
+
+#ifdef GRAPHICS_USE_RECORDING
+		const RecordingStatistics& recordingStatistics = static_cast< RecordingRenderer* >( Renderer::GetRenderer() )->GetLastFrameStatistics();
+		unsigned int value = 0;
+		if( !recordingStatistics.FindValueByName( argumentList[ 1 ], value ) )
+		{
+			m_console->WriteTextToLog( "ERROR: No render statistic named " + argumentList[ 1 ], REPORT_ERROR_COLOR );
+			++m_numberOfFailedChecks;
+			return;
+		}
+
+		unsigned int maximum = static_cast< unsigned int >( strtoul( argumentList[ 2 ].c_str(), nullptr, 10 ) );
+		std::ostringstream result;
+		result << ( ( value <= maximum ) ? "PASS " : "FAIL " ) << argumentList[ 1 ] << " " << value << " (maximum " << maximum << ")";
+		if( value > maximum )
+			++m_numberOfFailedChecks;
+		m_console->WriteTextToLog( result.str(), ( value <= maximum ) ? REPORT_TEXT_COLOR : REPORT_ERROR_COLOR );
+#else
+		m_console->WriteTextToLog( "ERROR: renderstats expect needs the recording renderer (GRAPHICS_USE_RECORDING)", REPORT_ERROR_COLOR );
+		++m_numberOfFailedChecks;
+#endif
+		return;
+	}
+
+	const RenderCommandBuffer::FrameStatistics& statistics = RenderCommandBuffer::GetLastFrameStatistics();
+	std::ostringstream report;
+	report << "Last frame: " << statistics.drawsSubmitted << " buffered draws, " << statistics.stateChangesIssued 
+		   << " state changes issued, " << statistics.stateChangesAvoided << " avoided.";
+	m_console->WriteTextToLog( report.str(), REPORT_TEXT_COLOR );
+
+	const TextBatch::CacheStatistics& textStatistics = TextBatch::GetLastFrameStatistics();
+	std::ostringstream textReport;
+	textReport << "Text layouts: " << textStatistics.layoutsBuilt << " built, " << textStatistics.layoutsReused << " reused, "
+			   << textStatistics.layoutsEvicted << " evicted, " << textStatistics.layoutsCached << " cached; spans: "
+			   << textStatistics.spansKept << " kept, " << textStatistics.spansMoved << " moved, " << textStatistics.spansWritten << " written.";
+	m_console->WriteTextToLog( textReport.str(), REPORT_TEXT_COLOR );
+
+#ifdef GRAPHICS_USE_RECORDING
+	const RecordingStatistics& recordingStatistics = static_cast< RecordingRenderer* >( Renderer::GetRenderer() )->GetLastFrameStatistics();
+	std::ostringstream backendReport;
+	backendReport << "Recorded: " << recordingStatistics.commands << " commands, " << recordingStatistics.drawCalls << " draw calls, " 
+				  << recordingStatistics.verticesSubmitted << " vertices, " << recordingStatistics.bytesSubmitted << " bytes submitted, " 
+				  << recordingStatistics.stateChanges << " state changes (" << recordingStatistics.redundantStateChanges << " redundant), " 
+				  << recordingStatistics.uniformUpdates << " uniform updates, " << recordingStatistics.shaderBinds << " shader binds, " 
+				  << recordingStatistics.textureBinds << " texture binds, " << recordingStatistics.bufferUploadBytes << " buffer bytes uploaded.";
+	m_console->WriteTextToLog( backendReport.str(), REPORT_TEXT_COLOR );
+#endif
+}
+
 //-----------------------------------------------------------------------------------------------
 void ClearConsoleLog( const CommandConsole::CommandArguments& )
 {
@@ -67,6 +309,218 @@ void ClearConsoleLog( const CommandConsole::CommandArguments& )
 	console->ClearLog( );
 }
 
+//-----------------------------------------------------------------------------------------------
+//profile [reset|on|off]
+void PrintProfileReport( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color REPORT_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		const std::string& option = arguments.argumentsAsStringArray[ 0 ];
+		if( option == "reset" )
+			Profiler::ResetStatistics();
+		else if( option == "on" )
+			Profiler::SetEnabled( true );
+		else if( option == "off" )
+			Profiler::SetEnabled( false );
+		else
+			console->WriteTextToLog( "Usage: profile [reset|on|off]", Color( 1.f, 0.f, 0.f, 1.f ) );
+		return;
+	}
+
+	std::vector< std::string > reportLines;
+	Profiler::WriteReport( reportLines );
+	for( unsigned int i = 0; i < reportLines.size(); ++i )
+		console->WriteTextToLog( reportLines[ i ], REPORT_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//trace start [capacityEvents] | stop | dump <file>
+void ControlTraceRecording( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color TRACE_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color TRACE_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+	const std::vector< std::string >& argumentList = arguments.argumentsAsStringArray;
+
+	if( argumentList.empty() )
+	{
+		console->WriteTextToLog( "Usage: trace start [capacityEvents] | stop | dump <file>", TRACE_ERROR_COLOR );
+		return;
+	}
+
+	if( argumentList[ 0 ] == "start" )
+	{
+		int capacityEvents = ( argumentList.size() > 1 ) ? atoi( argumentList[ 1 ].c_str() ) : 0;
+		if( capacityEvents > 0 )
+			TraceRecorder::Start( static_cast< unsigned int >( capacityEvents ) );
+		else
+			TraceRecorder::Start();
+		console->WriteTextToLog( "Trace recording started.", TRACE_TEXT_COLOR );
+	}
+	else if( argumentList[ 0 ] == "stop" )
+	{
+		TraceRecorder::Stop();
+		std::ostringstream message;
+		message << "Trace recording stopped with " << TraceRecorder::GetNumberOfRecordedEvents() << " events.";
+		console->WriteTextToLog( message.str(), TRACE_TEXT_COLOR );
+	}
+	else if( argumentList[ 0 ] == "dump" && argumentList.size() > 1 )
+	{
+		if( TraceRecorder::WriteChromeTraceFile( argumentList[ 1 ] ) )
+			console->WriteTextToLog( "Trace written to " + argumentList[ 1 ], TRACE_TEXT_COLOR );
+		else
+			console->WriteTextToLog( "ERROR: Could not write trace to " + argumentList[ 1 ], TRACE_ERROR_COLOR );
+	}
+	else
+	{
+		console->WriteTextToLog( "Usage: trace start [capacityEvents] | stop | dump <file>", TRACE_ERROR_COLOR );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+//compilefont <fontDefinition.xml>: writes the binary a font would otherwise build on its first load
+void CompileFontDefinition( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color FONT_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color FONT_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( arguments.argumentsAsStringArray.empty() )
+	{
+		console->WriteTextToLog( "Usage: compilefont <fontDefinition.xml>", FONT_ERROR_COLOR );
+		return;
+	}
+
+	const std::string& fontDefinitionLocation = arguments.argumentsAsStringArray[ 0 ];
+	if( BitmapFont::CompileFontDefinition( fontDefinitionLocation ) )
+		console->WriteTextToLog( "Font compiled to " + BitmapFont::GetCompiledFontLocation( fontDefinitionLocation ), FONT_TEXT_COLOR );
+	else
+		console->WriteTextToLog( "ERROR: Could not compile " + fontDefinitionLocation, FONT_ERROR_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//logfile <file> | stop
+void ControlLogFile( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color LOG_FILE_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color LOG_FILE_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+	const std::vector< std::string >& argumentList = arguments.argumentsAsStringArray;
+
+	if( argumentList.empty() )
+	{
+		console->WriteTextToLog( "Usage: logfile <file> | stop", LOG_FILE_ERROR_COLOR );
+		return;
+	}
+
+	if( argumentList[ 0 ] == "stop" )
+	{
+		console->StopLogFile();
+		console->WriteTextToLog( "Log file closed.", LOG_FILE_TEXT_COLOR );
+	}
+	else if( console->StartLogFile( argumentList[ 0 ] ) )
+		console->WriteTextToLog( "Mirroring the log to " + argumentList[ 0 ], LOG_FILE_TEXT_COLOR );
+	else
+		console->WriteTextToLog( "ERROR: Could not open " + argumentList[ 0 ], LOG_FILE_ERROR_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//threads [n]: how many threads, counting the main one, share parallel work like cloth integration
+void SetNumberOfJobThreads( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color THREADS_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color THREADS_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		int numberOfThreads = atoi( arguments.argumentsAsStringArray[ 0 ].c_str() );
+		if( numberOfThreads <= 0 )
+		{
+			console->WriteTextToLog( "Usage: threads [numberOfThreads]", THREADS_ERROR_COLOR );
+			return;
+		}
+		JobSystem::SetNumberOfThreads( static_cast< unsigned int >( numberOfThreads ) );
+	}
+
+	std::ostringstream message;
+	message << "Running with " << JobSystem::GetNumberOfThreads() << " thread(s); this machine has " 
+			<< JobSystem::GetNumberOfHardwareThreads() << " hardware threads.";
+	console->WriteTextToLog( message.str(), THREADS_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//pacer [framesPerSecond | uncapped | reset]: frame pacing settings and how steadily frames are hitting them
+void ControlFramePacer( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color PACER_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color PACER_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		const std::string& option = arguments.argumentsAsStringArray[ 0 ];
+		double framesPerSecond = atof( option.c_str() );
+		if( option == "uncapped" )
+			FramePacer::SetCapped( false );
+		else if( option == "reset" )
+			FramePacer::ResetStatistics();
+		else if( framesPerSecond > 0.0 )
+		{
+			FramePacer::SetTargetFrameSeconds( 1.0 / framesPerSecond );
+			FramePacer::SetCapped( true );
+		}
+		else
+		{
+			console->WriteTextToLog( "Usage: pacer [framesPerSecond | uncapped | reset]", PACER_ERROR_COLOR );
+			return;
+		}
+		FramePacer::ResetStatistics();
+	}
+
+	const FramePacer::Statistics& statistics = FramePacer::GetStatistics();
+	std::ostringstream settings;
+	settings << std::fixed << std::setprecision( 2 );
+	if( FramePacer::IsCapped() )
+		settings << "Pacing to " << ( 1.0 / FramePacer::GetTargetFrameSeconds() ) << " fps";
+	else
+		settings << "Uncapped";
+	settings << "; " << statistics.numberOfFrames << " frames, " << statistics.numberOfMissedFrames << " missed their target.";
+	console->WriteTextToLog( settings.str(), PACER_TEXT_COLOR );
+
+	std::ostringstream timing;
+	timing << std::fixed << std::setprecision( 3 );
+	timing << "Frame " << ( statistics.GetAverageFrameSeconds() * 1000.0 ) << " ms avg (" << ( statistics.minimumFrameSeconds * 1000.0 ) 
+		   << " - " << ( statistics.maximumFrameSeconds * 1000.0 ) << "), woke late by " << ( statistics.GetAverageLatenessSeconds() * 1000.0 ) 
+		   << " ms avg, " << ( statistics.maximumLatenessSeconds * 1000.0 ) << " ms max; waited " << ( statistics.sleptSeconds * 1000.0 ) 
+		   << " ms asleep, " << ( statistics.spunSeconds * 1000.0 ) << " ms spinning.";
+	console->WriteTextToLog( timing.str(), PACER_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//exec <script> | stop
+void ExecuteCommandScript( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color SCRIPT_TEXT_COLOR = Color( 0.6f, 0.6f, 0.6f, 1.f );
+	static const Color SCRIPT_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( arguments.argumentsAsStringArray.empty() )
+	{
+		console->WriteTextToLog( "Usage: exec <script> | stop", SCRIPT_ERROR_COLOR );
+		return;
+	}
+
+	const std::string& scriptLocation = arguments.argumentsAsStringArray[ 0 ];
+	if( scriptLocation == "stop" )
+		console->StopScripts();
+	else if( console->ExecuteScript( scriptLocation ) )
+		console->WriteTextToLog( "Running script " + scriptLocation, SCRIPT_TEXT_COLOR );
+}
+
 //-----------------------------------------------------------------------------------------------
 void Game::Initialize() 
 {
@@ -82,6 +536,16 @@ void Game::Initialize()
 	m_console = CommandConsole::GetConsole();
 
 	CommandConsole::RegisterConsoleCommand( "clear", ClearConsoleLog );
+	CommandConsole::RegisterConsoleCommand( "profile", PrintProfileReport );
+	CommandConsole::RegisterConsoleCommand( "trace", ControlTraceRecording );
+	CommandConsole::RegisterConsoleCommand( "renderstats", std::bind( &Game::ControlRenderStatistics, this, std::placeholders::_1 ) );
+	CommandConsole::RegisterConsoleCommand( "compilefont", CompileFontDefinition );
+	CommandConsole::RegisterConsoleCommand( "logfile", ControlLogFile );
+	CommandConsole::RegisterConsoleCommand( "threads", SetNumberOfJobThreads );
+	CommandConsole::RegisterConsoleCommand( "exec", ExecuteCommandScript );
+	CommandConsole::RegisterConsoleCommand( "pacer", ControlFramePacer );
+	CommandConsole::RegisterConsoleCommand( "stats", std::bind( &Game::ToggleFrameStatistics, this, std::placeholders::_1 ) );
+	CommandConsole::RegisterConsoleCommand( "capture", std::bind( &Game::ControlCapture, this, std::placeholders::_1 ) );
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -90,6 +554,9 @@ void Game::Render() const
 	static const double NEAR_CLIPPING_PLANE_DISTANCE = 0.1;
 	static const double FAR_CLIPPING_PLANE_DISTANCE = 1000.0;
 
+	PROFILE_ZONE( "Game::Render" );
+
+	double renderStartSeconds = GetCurrentTimeSeconds();
 	Renderer* renderer = Renderer::GetRenderer();
 
 	renderer->PushMatrix();
@@ -109,6 +576,14 @@ void Game::Render() const
 
 	RenderUI();
 
+	if( m_frameStatisticsVisible )
+	{
+		static const float STATISTICS_TEXT_HEIGHT = 20.f;
+		FloatVector2 statisticsLowerLeftCorner( 5.f, static_cast< float >( m_screenHeight ) - STATISTICS_TEXT_HEIGHT - 5.f );
+		renderer->Render2DText( m_frameStatisticsLine, m_console->GetFont(), STATISTICS_TEXT_HEIGHT, statisticsLowerLeftCorner, 
+								Color( 1.f, 1.f, 1.f, 1.f ), Color( 0.f, 0.f, 0.f, 0.5f ) );
+	}
+
 	if( m_consoleVisible )
 		m_console->Render();
 
@@ -116,25 +591,33 @@ void Game::Render() const
 	renderer->EnableFeature( Renderer::DEPTH_TESTING );
 
 	renderer->PopMatrix();
+
+	double renderSeconds = GetCurrentTimeSeconds() - renderStartSeconds;
+	m_renderSecondsInInterval += renderSeconds;
+	if( m_isCapturing )
+		m_captureRenderSeconds += renderSeconds;
 }
 
 //-----------------------------------------------------------------------------------------------
 void Game::Update( float deltaSeconds, Keyboard& keyInput, const Mouse& mouseInput, const Xbox::Controller& xboxInput )
 {
+	PROFILE_ZONE( "Game::Update" );
+
+	double updateStartSeconds = GetCurrentTimeSeconds();
 	Debug::UpdateDrawings( deltaSeconds );
 
 	if( keyInput.KeyIsPressed( Keyboard::GRAVE ) )
 		m_consoleVisible = !m_consoleVisible;
 
 	if( m_consoleVisible )
-	{
 		UpdateConsoleInput( deltaSeconds, keyInput, mouseInput );
-		m_console->Update( deltaSeconds );
-	}
 	else
-	{
 		InputUpdate( deltaSeconds, keyInput, mouseInput, xboxInput );
-	}
 
+	//Even while hidden, so lines posted from other threads are collected and the log file keeps up
+	m_console->Update( deltaSeconds );
+
+	double simulationStartSeconds = GetCurrentTimeSeconds();
 	GameUpdate( deltaSeconds );
+	UpdateFrameStatistics( updateStartSeconds, GetCurrentTimeSeconds() - simulationStartSeconds );
 }
\ No newline at end of file
@@ -3,6 +3,7 @@
 #pragma once
 
 //-----------------------------------------------------------------------------------------------
+#include <string>
 #include "Input/Keyboard.hpp"
 #include "Input/Mouse.hpp"
 #include "Input/Xbox.hpp"
@@ -24,23 +25,62 @@ protected:
 	virtual void GameUpdate( float deltaSeconds ) = 0;
 	virtual void InputUpdate(  float deltaSeconds, Keyboard& keyInput, const Mouse& mouseInput, const Xbox::Controller& xboxInput ) = 0;
 
+	//A game that steps its simulation on a thread of its own reports running totals here, so stats and
+	//capture can show that thread's cost; GameUpdate alone no longer covers it. Totals only ever grow.
+	virtual void GetSimulationThreadTotals( unsigned int& out_numberOfSteps, double& out_stepSeconds ) const { out_numberOfSteps = 0; out_stepSeconds = 0.0; }
+
 
 private:
+	static const double FRAME_STATISTICS_INTERVAL_SECONDS;
+
 	CommandConsole*	m_console;
 	bool			m_consoleVisible;
 
+	//Summed over each statistics interval, then published as per-frame averages for the stats overlay
+	bool			m_frameStatisticsVisible;
+	double			m_statisticsIntervalStartSeconds;
+	unsigned int	m_framesInStatisticsInterval;
+	double			m_simulationSecondsInInterval;
+	mutable double	m_renderSecondsInInterval;
+	unsigned int	m_simulationThreadStepsAtIntervalStart;
+	double			m_simulationThreadSecondsAtIntervalStart;
+	std::string		m_frameStatisticsLine;
+
+	//Totals since "capture start", reported as per-frame averages by "capture stop"
+	bool			m_isCapturing;
+	bool			m_captureOwnsTrace; //False when a trace was already recording, which the capture only marks
+	std::string		m_captureName;
+	double			m_captureStartSeconds;
+	unsigned int	m_framesInCapture;
+	double			m_captureSimulationSeconds;
+	mutable double	m_captureRenderSeconds;
+	unsigned int	m_simulationThreadStepsAtCaptureStart;
+	double			m_simulationThreadSecondsAtCaptureStart;
+
+	unsigned int	m_numberOfFailedChecks;
+
 	//We have no need of a pithy assignment or copy operator!
 	Game( const Game& other );
 	Game& operator=( const Game& other );
 
 	void UpdateConsoleInput( float deltaSeconds, Keyboard& keyInput, const Mouse& mouseInput );
+	void UpdateFrameStatistics( double updateStartSeconds, double simulationSeconds );
+	void ToggleFrameStatistics( const CommandConsole::CommandArguments& arguments );
+	void ControlCapture( const CommandConsole::CommandArguments& arguments );
+	void ControlRenderStatistics( const CommandConsole::CommandArguments& arguments );
 
 public:
 	Game( bool& quitVariable, unsigned int screenWidth, unsigned int screenHeight, float horizontalFOVDegrees );
 
+	virtual ~Game() { }
+
 	virtual void Initialize();
+	//Called once the main loop ends, while the engine's systems are still up.
+	virtual void Shutdown() { }
 
 	void Quit() { m_quitVariable = true; }
+	//Nonzero once any scripted check has failed, for the process to exit with
+	int GetExitCode() const { return ( m_numberOfFailedChecks == 0 ) ? 0 : 1; }
 	void Render() const;
 	void Update( float deltaSeconds, Keyboard& keyInput, const Mouse& mouseInput, const Xbox::Controller& xboxInput );
 };
@@ -5,6 +5,7 @@
 //-----------------------------------------------------------------------------------------------
 #include <string>
 #include "Renderer.hpp"
+#include "RenderStateCache.hpp"
 #include "ShaderProgram.hpp"
 
 //-----------------------------------------------------------------------------------------------
@@ -65,7 +66,9 @@ public:
 	{ }
 
 	void Apply( Renderer* renderer );
+	void Apply( Renderer* renderer, RenderStateCache& stateCache );
 	void Remove( Renderer* renderer );
+	void Remove( RenderStateCache& stateCache );
 
 	const ShaderProgram* GetShaderProgram() const { return m_program; }
 	bool SetArrayOntoAttribute( const std::string& attributeName, const ArrayInfo& arrayInfo );
@@ -124,6 +127,48 @@ inline void Material::Apply( Renderer* renderer )
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+//Program, feature and array changes go through the cache so any that are already in place are dropped.
+//Matrices are uploaded every time, and textures are bound directly since the cache doesn't track units.
+inline void Material::Apply( Renderer* renderer, RenderStateCache& stateCache )
+{
+	stateCache.UseShaderProgram( m_program );
+
+	renderer->SetUniformVariable( m_modelMatrixUniformLocation, renderer->GetModelMatrix() );
+	renderer->SetUniformVariable( m_viewMatrixUniformLocation, renderer->GetViewMatrix() );
+	renderer->SetUniformVariable( m_projectionMatrixUniformLocation, renderer->GetProjectionMatrix() );
+
+	for( unsigned int i = 0; i < m_infoForTextures.size(); ++i )
+	{
+		TextureInfo& texInfo = m_infoForTextures[ i ];
+		renderer->SetActiveTextureUnit( texInfo.textureUnitID );
+		renderer->BindTexture( Renderer::TEXTURES_2D, texInfo.texture );
+		renderer->SetUniformVariable( texInfo.samplerUniformID, texInfo.textureUnitID );
+	}
+
+	renderer->BindBufferObject( Renderer::ARRAY_BUFFER, m_vertexBufferID );
+	renderer->BindBufferObject( Renderer::INDEX_BUFFER, m_indexBufferID );
+
+	for( unsigned int i = 0; i < m_featuresToEnableBeforeRender.size(); ++i )
+	{
+		stateCache.EnableFeature( m_featuresToEnableBeforeRender[ i ] );
+	}
+
+	for( unsigned int i = 0; i < m_featuresToDisableBeforeRender.size(); ++i )
+	{
+		stateCache.DisableFeature( m_featuresToDisableBeforeRender[ i ] );
+	}
+
+	for( unsigned int i = 0; i < m_genericArrays.size(); ++i )
+	{
+		const ArrayInfo& genericArray = m_genericArrays[ i ];
+
+		stateCache.EnableAttributeArray( genericArray.attributeID );
+		renderer->SetPointerToGenericArray( genericArray.attributeID, genericArray.numberOfVertexCoordinates, genericArray.coordinateType, 
+											false, genericArray.sizeOfVertexArrayStructure, genericArray.vertexArrayStartLocation );
+	}
+}
+
 //-----------------------------------------------------------------------------------------------
 inline void Material::Remove( Renderer* renderer )
 {
@@ -135,6 +180,15 @@ inline void Material::Remove( Renderer* renderer )
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+inline void Material::Remove( RenderStateCache& stateCache )
+{
+	for( unsigned int i = 0; i < m_genericArrays.size(); ++i )
+	{
+		stateCache.DisableAttributeArray( m_genericArrays[ i ].attributeID );
+	}
+}
+
 //-----------------------------------------------------------------------------------------------
 inline bool Material::SetArrayOntoAttribute( const std::string& attributeName, const ArrayInfo& arrayInfo )
 {
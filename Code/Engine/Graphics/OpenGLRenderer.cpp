@@ -1,3 +1,6 @@
+#include "../../Game/EngineSettings.hpp"
+
+#ifdef GRAPHICS_USE_OPENGL
 #include "OpenGLRenderer.hpp"
 
 #pragma region OpenGL_Function_Pointer_Definitions
@@ -240,3 +243,4 @@ int OpenGLRenderer::CreateProgramFromShaders( int vertexShaderID, int geometrySh
 	}
 	return programID;
 }
+#endif //GRAPHICS_USE_OPENGL
@@ -100,6 +100,7 @@ public:
 
 	void EnableFeature( Feature feature ) const;
 	void DisableFeature( Feature feature ) const;
+	bool IsFeatureEnabled( Feature feature ) const;
 
 	//Color and Depth Buffers
 	void ClearColorBuffer() const;
@@ -110,6 +111,7 @@ public:
 	void EnableDepthBufferWriting() const;
 
 	//Draw Modification
+	void GetAlphaBlendingFunction( ColorBlendingMode& out_sourceBlendingFactor, ColorBlendingMode& out_destinationBlendingFactor ) const;
 	void SetAlphaBlendingFunction( ColorBlendingMode sourceBlendingFactor, ColorBlendingMode destinationBlendingFactor ) const;
 	void SetColor( float red, float green, float blue, float alpha ) const;
 	void SetLineWidth( float widthPixels ) const;
@@ -195,6 +197,9 @@ inline void OpenGLRenderer::EnableFeature( Feature feature ) const { glEnable( f
 //-----------------------------------------------------------------------------------------------
 inline void OpenGLRenderer::DisableFeature( Feature feature ) const { glDisable( feature ); }
 
+//-----------------------------------------------------------------------------------------------
+inline bool OpenGLRenderer::IsFeatureEnabled( Feature feature ) const { return glIsEnabled( feature ) == GL_TRUE; }
+
 
 
 
@@ -232,6 +237,16 @@ inline void OpenGLRenderer::EnableDepthBufferWriting() const { glDepthMask( GL_T
 
 
 //+++++++++++++++++++++++++++++++++++++++++++++++++++ Draw Modification +++++++++++++++++++++++++++++++++++++++++++++++++++
+//-----------------------------------------------------------------------------------------------
+inline void OpenGLRenderer::GetAlphaBlendingFunction( ColorBlendingMode& out_sourceBlendingFactor, ColorBlendingMode& out_destinationBlendingFactor ) const
+{
+	GLint sourceBlendingFactor = 0, destinationBlendingFactor = 0;
+	glGetIntegerv( GL_BLEND_SRC, &sourceBlendingFactor );
+	glGetIntegerv( GL_BLEND_DST, &destinationBlendingFactor );
+	out_sourceBlendingFactor = static_cast< ColorBlendingMode >( sourceBlendingFactor );
+	out_destinationBlendingFactor = static_cast< ColorBlendingMode >( destinationBlendingFactor );
+}
+
 //-----------------------------------------------------------------------------------------------
 inline void OpenGLRenderer::SetAlphaBlendingFunction( ColorBlendingMode sourceBlendingFactor, ColorBlendingMode destinationBlendingFactor ) const
 {
@@ -0,0 +1,716 @@
+#include <algorithm>
+#include <sstream>
+#include "RecordingRenderer.hpp"
+#include "../../Game/EngineSettings.hpp"
+
+#ifdef GRAPHICS_USE_RECORDING
+//-----------------------------------------------------------------------------------------------
+//These match the OpenGL enum values so that recorded commands read the same as a GL trace.
+STATIC const Renderer::ArrayType Renderer::COLOR_ARRAYS			= 0x8076;
+STATIC const Renderer::ArrayType Renderer::TEXTURE_COORD_ARRAYS = 0x8078;
+STATIC const Renderer::ArrayType Renderer::VERTEX_ARRAYS		= 0x8074;
+
+STATIC const Renderer::BufferType Renderer::ARRAY_BUFFER = 0x8892;
+STATIC const Renderer::BufferType Renderer::INDEX_BUFFER = 0x8893;
+
+STATIC const Renderer::ColorComponents Renderer::RGB = 0x1907;
+STATIC const Renderer::ColorComponents Renderer::RGBA = 0x1908;
+
+STATIC const Renderer::ColorBlendingMode Renderer::NO_COLOR						= 0x0000;
+STATIC const Renderer::ColorBlendingMode Renderer::ONE_MINUS_DESTINATION_COLOR	= 0x0307;
+STATIC const Renderer::ColorBlendingMode Renderer::ONE_MINUS_SOURCE_ALPHA		= 0x0303;
+STATIC const Renderer::ColorBlendingMode Renderer::SOURCE_ALPHA					= 0x0302;
+
+STATIC const Renderer::CoordinateType Renderer::SHORT_TYPE		= 0x1402;
+STATIC const Renderer::CoordinateType Renderer::INTEGER_TYPE	= 0x1404;
+STATIC const Renderer::CoordinateType Renderer::FLOAT_TYPE		= 0x1406;
+STATIC const Renderer::CoordinateType Renderer::DOUBLE_TYPE		= 0x140A;
+STATIC const Renderer::CoordinateType Renderer::UNSIGNED_BYTE	= 0x1401;
+STATIC const Renderer::CoordinateType Renderer::UNSIGNED_SHORT_TYPE	= 0x1403;
+
+STATIC const Renderer::Feature Renderer::COLOR_BLENDING	= 0x0BE2;
+STATIC const Renderer::Feature Renderer::DEPTH_TESTING	= 0x0B71;
+STATIC const Renderer::Feature Renderer::FACE_CULLING	= 0x0B44;
+STATIC const Renderer::Feature Renderer::SHAPE_RESTART_INDEXING	= 0x8F9D;
+STATIC const Renderer::Feature Renderer::TEXTURES_2D	= 0x0DE1;
+
+STATIC const Renderer::QualityLevel Renderer::FASTEST = 0x1101;
+
+STATIC const Renderer::Shader Renderer::GEOMETRY_SHADER = 0x8DD9;
+STATIC const Renderer::Shader Renderer::PIXEL_FRAGMENT_SHADER = 0x8B30;
+STATIC const Renderer::Shader Renderer::VERTEX_SHADER = 0x8B31;
+
+STATIC const Renderer::Shape Renderer::POINTS			= 0x0000;
+STATIC const Renderer::Shape Renderer::LINES			= 0x0001;
+STATIC const Renderer::Shape Renderer::LINE_LOOP		= 0x0002;
+STATIC const Renderer::Shape Renderer::LINE_STRIP		= 0x0003;
+STATIC const Renderer::Shape Renderer::TRIANGLES		= 0x0004;
+STATIC const Renderer::Shape Renderer::TRIANGLE_STRIP	= 0x0005;
+STATIC const Renderer::Shape Renderer::QUADS			= 0x0007;
+
+STATIC const Renderer::TextureFilteringMethod Renderer::NEAREST_NEIGHBOR = 0x2600;
+STATIC const Renderer::TextureFilteringMethod Renderer::LINEAR_INTERPOLATION = 0x2601;
+STATIC const Renderer::TextureFilteringMethod Renderer::NEAREST_MIPMAP_NEAREST_TEXTURE = 0x2700;
+STATIC const Renderer::TextureFilteringMethod Renderer::NEAREST_MIPMAP_INTERPOLATE_TEXTURES = 0x2701;
+STATIC const Renderer::TextureFilteringMethod Renderer::INTERPOLATE_MIPMAPS_NEAREST_TEXTURE = 0x2702;
+STATIC const Renderer::TextureFilteringMethod Renderer::INTERPOLATE_MIPMAPS_INTERPOLATE_TEXTURES = 0x2703;
+
+STATIC const Renderer::TextureWrapMode Renderer::CLAMP_TO_EDGE		  = 0x2900;
+STATIC const Renderer::TextureWrapMode Renderer::REPEAT_OVER_GEOMETRY = 0x2901;
+
+
+
+#pragma region Helper_Functions
+//-----------------------------------------------------------------------------------------------
+static unsigned int GetSizeOfCoordinateType( Renderer::CoordinateType coordinateType )
+{
+	if( coordinateType == Renderer::UNSIGNED_BYTE )
+		return sizeof( unsigned char );
+	if( coordinateType == Renderer::SHORT_TYPE || coordinateType == Renderer::UNSIGNED_SHORT_TYPE )
+		return sizeof( short );
+	if( coordinateType == Renderer::DOUBLE_TYPE )
+		return sizeof( double );
+	return sizeof( float );
+}
+
+//-----------------------------------------------------------------------------------------------
+static void AddNameIfUnique( std::vector< std::string >& names, const std::string& name )
+{
+	if( std::find( names.begin(), names.end(), name ) == names.end() )
+		names.push_back( name );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Pulls the variable names out of declarations such as "uniform mat4 u_modelMatrix;". We have no
+//driver to link against, so this is how the recorder knows which attributes and uniforms exist.
+static void FindDeclaredVariables( const char* sourceString, const std::string& qualifier, std::vector< std::string >& out_variableNames )
+{
+	std::istringstream sourceStream( sourceString );
+	std::string line;
+	while( std::getline( sourceStream, line ) )
+	{
+		std::istringstream lineStream( line );
+		std::string firstWord, typeName, variableName;
+		if( !( lineStream >> firstWord >> typeName >> variableName ) || firstWord != qualifier )
+			continue;
+
+		variableName = variableName.substr( 0, variableName.find_first_of( ";[" ) );
+		if( !variableName.empty() )
+			AddNameIfUnique( out_variableNames, variableName );
+	}
+}
+#pragma endregion
+
+
+
+//-----------------------------------------------------------------------------------------------
+RecordingRenderer::RecordingRenderer()
+	: Renderer()
+	, m_boundTextureID( 0 )
+	, m_depthWritingEnabled( true )
+	, m_blendingSource( 0 )
+	, m_blendingDestination( 0 )
+	, m_lineWidth( 1.f )
+	, m_pointSize( 1.f )
+	, m_activeTextureUnit( 0 )
+	, m_boundArrayBufferID( 0 )
+	, m_boundIndexBufferID( 0 )
+	, m_nextObjectID( 1 )
+{ }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::Initialize()
+{
+	s_activeShaderProgram = nullptr;
+	SetShapeRestartIndex( 0xFFFF );
+	BeginRecording();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Clears the command list and counters, but not the tracked state, so redundant changes made
+//right after this call are still caught.
+void RecordingRenderer::BeginRecording()
+{
+	m_commands.clear();
+	m_statistics = RecordingStatistics();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Swapping rather than copying keeps both lists' capacity, so a steady frame allocates nothing.
+void RecordingRenderer::EndFrame()
+{
+	m_lastFrameCommands.swap( m_commands );
+	m_lastFrameStatistics = m_statistics;
+	BeginRecording();
+}
+
+//-----------------------------------------------------------------------------------------------
+bool RecordingStatistics::FindValueByName( const std::string& statisticName, unsigned int& out_value ) const
+{
+	struct NamedStatistic
+	{
+		const char* name;
+		unsigned int RecordingStatistics::* member;
+	};
+	static const NamedStatistic NAMED_STATISTICS[] =
+	{
+		{ "commands",				&RecordingStatistics::commands },
+		{ "drawCalls",				&RecordingStatistics::drawCalls },
+		{ "verticesSubmitted",		&RecordingStatistics::verticesSubmitted },
+		{ "bytesSubmitted",			&RecordingStatistics::bytesSubmitted },
+		{ "stateChanges",			&RecordingStatistics::stateChanges },
+		{ "redundantStateChanges",	&RecordingStatistics::redundantStateChanges },
+		{ "uniformUpdates",			&RecordingStatistics::uniformUpdates },
+		{ "shaderBinds",			&RecordingStatistics::shaderBinds },
+		{ "textureBinds",			&RecordingStatistics::textureBinds },
+		{ "bufferUploadBytes",		&RecordingStatistics::bufferUploadBytes }
+	};
+
+	for( unsigned int i = 0; i < sizeof( NAMED_STATISTICS ) / sizeof( NamedStatistic ); ++i )
+	{
+		if( statisticName == NAMED_STATISTICS[ i ].name )
+		{
+			out_value = this->*NAMED_STATISTICS[ i ].member;
+			return true;
+		}
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::Record( RecordedCommand::Type type, unsigned short enumValue, unsigned int first, unsigned int second ) const
+{
+	m_commands.push_back( RecordedCommand( type, enumValue, first, second ) );
+	++m_statistics.commands;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::RecordStateChange( bool stateWasAlreadySet ) const
+{
+	++m_statistics.stateChanges;
+	if( stateWasAlreadySet )
+		++m_statistics.redundantStateChanges;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::RecordDraw( unsigned int numberOfVertices ) const
+{
+	++m_statistics.drawCalls;
+	m_statistics.verticesSubmitted += numberOfVertices;
+	m_statistics.bytesSubmitted += numberOfVertices * CalculateBytesPerVertexSubmitted();
+}
+
+//-----------------------------------------------------------------------------------------------
+RecordingRenderer::ArrayPointer& RecordingRenderer::GetArrayPointer( ArrayType type ) const
+{
+	if( type == COLOR_ARRAYS )
+		return m_colorArray;
+	if( type == TEXTURE_COORD_ARRAYS )
+		return m_textureCoordinateArray;
+	return m_vertexArray;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetArrayPointer( ArrayPointer& arrayPointer, unsigned int coordinatesPerVertex, CoordinateType coordinateType ) const
+{
+	arrayPointer.bytesPerVertex = coordinatesPerVertex * GetSizeOfCoordinateType( coordinateType );
+	arrayPointer.readFromBuffer = ( m_boundArrayBufferID != 0 );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Arrays that point into a bound buffer object already live on the card, so only client-side
+//arrays count toward the bytes a draw call has to push across.
+unsigned int RecordingRenderer::CalculateBytesPerVertexSubmitted() const
+{
+	unsigned int bytesPerVertex = 0;
+
+	const ArrayPointer* fixedArrays[] = { &m_colorArray, &m_textureCoordinateArray, &m_vertexArray };
+	for( unsigned int i = 0; i < 3; ++i )
+	{
+		if( fixedArrays[ i ]->enabled && !fixedArrays[ i ]->readFromBuffer )
+			bytesPerVertex += fixedArrays[ i ]->bytesPerVertex;
+	}
+
+	for( std::map< unsigned int, ArrayPointer >::const_iterator genericArray = m_genericArrays.begin();
+		 genericArray != m_genericArrays.end(); ++genericArray )
+	{
+		if( genericArray->second.enabled && !genericArray->second.readFromBuffer )
+			bytesPerVertex += genericArray->second.bytesPerVertex;
+	}
+	return bytesPerVertex;
+}
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::GetVariableLocation( const std::string& variableName )
+{
+	std::map< std::string, int >::iterator location = m_variableLocations.find( variableName );
+	if( location != m_variableLocations.end() )
+		return location->second;
+
+	int newLocation = static_cast< int >( m_variableLocations.size() );
+	m_variableLocations[ variableName ] = newLocation;
+	return newLocation;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::RecordUniformUpdate( int programConstantLocation )
+{
+	//Like GL, silently ignore uniforms the shader doesn't have.
+	if( programConstantLocation < 0 )
+		return;
+
+	Record( RecordedCommand::SET_UNIFORM, 0, programConstantLocation );
+	++m_statistics.uniformUpdates;
+}
+
+
+
+#pragma region Feature_Enabling
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::EnableArrayType( ArrayType type ) const
+{
+	ArrayPointer& arrayPointer = GetArrayPointer( type );
+	RecordStateChange( arrayPointer.enabled );
+	arrayPointer.enabled = true;
+	Record( RecordedCommand::ENABLE_ARRAY, type );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DisableArrayType( ArrayType type ) const
+{
+	ArrayPointer& arrayPointer = GetArrayPointer( type );
+	RecordStateChange( !arrayPointer.enabled );
+	arrayPointer.enabled = false;
+	Record( RecordedCommand::DISABLE_ARRAY, type );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::BindVertexArraysToAttributeLocation( unsigned int location ) const
+{
+	ArrayPointer& arrayPointer = m_genericArrays[ location ];
+	RecordStateChange( arrayPointer.enabled );
+	arrayPointer.enabled = true;
+	Record( RecordedCommand::ENABLE_ATTRIBUTE_ARRAY, 0, location );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::UnbindVertexArraysFromAttributeLocation( unsigned int location ) const
+{
+	ArrayPointer& arrayPointer = m_genericArrays[ location ];
+	RecordStateChange( !arrayPointer.enabled );
+	arrayPointer.enabled = false;
+	Record( RecordedCommand::DISABLE_ATTRIBUTE_ARRAY, 0, location );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::EnableFeature( Feature feature ) const
+{
+	RecordStateChange( !m_enabledFeatures.insert( feature ).second );
+	Record( RecordedCommand::ENABLE_FEATURE, feature );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DisableFeature( Feature feature ) const
+{
+	RecordStateChange( m_enabledFeatures.erase( feature ) == 0 );
+	Record( RecordedCommand::DISABLE_FEATURE, feature );
+}
+
+//-----------------------------------------------------------------------------------------------
+bool RecordingRenderer::IsFeatureEnabled( Feature feature ) const
+{
+	return m_enabledFeatures.count( feature ) != 0;
+}
+#pragma endregion
+
+
+
+#pragma region Color_And_Depth_Buffers
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::ClearColorBuffer() const { Record( RecordedCommand::CLEAR_COLOR_BUFFER ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::ClearDepthBuffer() const { Record( RecordedCommand::CLEAR_DEPTH_BUFFER ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetColorBufferClearValue( float, float, float, float )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_CLEAR_VALUE, 0, 0 );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetDepthBufferClearValue( float )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_CLEAR_VALUE, 0, 1 );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DisableDepthBufferWriting() const
+{
+	RecordStateChange( !m_depthWritingEnabled );
+	m_depthWritingEnabled = false;
+	Record( RecordedCommand::SET_DEPTH_WRITING, 0, 0 );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::EnableDepthBufferWriting() const
+{
+	RecordStateChange( m_depthWritingEnabled );
+	m_depthWritingEnabled = true;
+	Record( RecordedCommand::SET_DEPTH_WRITING, 0, 1 );
+}
+#pragma endregion
+
+
+
+#pragma region Draw_Modification
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GetAlphaBlendingFunction( ColorBlendingMode& out_sourceBlendingFactor, ColorBlendingMode& out_destinationBlendingFactor ) const
+{
+	out_sourceBlendingFactor = m_blendingSource;
+	out_destinationBlendingFactor = m_blendingDestination;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetAlphaBlendingFunction( ColorBlendingMode sourceBlendingFactor, ColorBlendingMode destinationBlendingFactor ) const
+{
+	RecordStateChange( sourceBlendingFactor == m_blendingSource && destinationBlendingFactor == m_blendingDestination );
+	m_blendingSource = sourceBlendingFactor;
+	m_blendingDestination = destinationBlendingFactor;
+	Record( RecordedCommand::SET_BLENDING_FUNCTION, 0, sourceBlendingFactor, destinationBlendingFactor );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetColor( float, float, float, float ) const
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetLineWidth( float widthPixels ) const
+{
+	RecordStateChange( widthPixels == m_lineWidth );
+	m_lineWidth = widthPixels;
+	Record( RecordedCommand::SET_LINE_WIDTH );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetPointSize( float pointSize ) const
+{
+	RecordStateChange( pointSize == m_pointSize );
+	m_pointSize = pointSize;
+	Record( RecordedCommand::SET_POINT_SIZE );
+}
+#pragma endregion
+
+
+
+#pragma region Mipmaps
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GenerateMipmaps( Feature textureType ) { Record( RecordedCommand::GENERATE_MIPMAPS, textureType, m_boundTextureID ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetMaximumMipmapLevel( Feature textureType, unsigned int maxLevel )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, textureType, m_boundTextureID, maxLevel );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetMipmapQuality( QualityLevel qualityLevel )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, 0, m_boundTextureID, qualityLevel );
+}
+#pragma endregion
+
+
+
+#pragma region Shaders
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::CompileShader( Shader shaderType, const char* sourceString, std::string& out_errors )
+{
+	out_errors.clear();
+	int shaderID = m_nextObjectID++;
+
+	ShaderVariables& variables = m_shaderVariables[ shaderID ];
+	if( shaderType == VERTEX_SHADER )
+	{
+		FindDeclaredVariables( sourceString, "in", variables.attributeNames );
+		FindDeclaredVariables( sourceString, "attribute", variables.attributeNames );
+	}
+	FindDeclaredVariables( sourceString, "uniform", variables.uniformNames );
+
+	Record( RecordedCommand::COMPILE_SHADER, shaderType, shaderID );
+	return shaderID;
+}
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::CreateProgramFromShaders( int vertexShaderID, int geometryShaderID, int pixelFragmentShaderID, std::string& out_errors )
+{
+	out_errors.clear();
+	int programID = m_nextObjectID++;
+
+	ShaderVariables& programVariables = m_programVariables[ programID ];
+	int shaderIDs[] = { vertexShaderID, geometryShaderID, pixelFragmentShaderID };
+	for( unsigned int i = 0; i < 3; ++i )
+	{
+		std::map< int, ShaderVariables >::const_iterator shader = m_shaderVariables.find( shaderIDs[ i ] );
+		if( shader == m_shaderVariables.end() )
+			continue;
+
+		for( unsigned int j = 0; j < shader->second.attributeNames.size(); ++j )
+			AddNameIfUnique( programVariables.attributeNames, shader->second.attributeNames[ j ] );
+		for( unsigned int j = 0; j < shader->second.uniformNames.size(); ++j )
+			AddNameIfUnique( programVariables.uniformNames, shader->second.uniformNames[ j ] );
+	}
+
+	Record( RecordedCommand::LINK_PROGRAM, 0, programID );
+	return programID;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DeleteProgramDataOnCard( ShaderProgram* program )
+{
+	m_programVariables.erase( program->GetID() );
+	Record( RecordedCommand::DELETE_PROGRAM, 0, program->GetID() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DeleteShaderDataOnCard( int shaderID )
+{
+	m_shaderVariables.erase( shaderID );
+	Record( RecordedCommand::DELETE_SHADER, 0, shaderID );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DetachShaderFromProgram( int shaderID, int programID ) { Record( RecordedCommand::DETACH_SHADER, 0, shaderID, programID ); }
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::GetAttributeLocation( const ShaderProgram*, const std::string& attributeName )
+{
+	return GetVariableLocation( attributeName );
+}
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::GetNumberOfAttributesInProgram( const ShaderProgram* program ) const
+{
+	std::map< int, ShaderVariables >::const_iterator variables = m_programVariables.find( program->GetID() );
+	if( variables == m_programVariables.end() )
+		return 0;
+	return static_cast< int >( variables->second.attributeNames.size() );
+}
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::GetNumberOfUniformsInProgram( const ShaderProgram* program ) const
+{
+	std::map< int, ShaderVariables >::const_iterator variables = m_programVariables.find( program->GetID() );
+	if( variables == m_programVariables.end() )
+		return 0;
+	return static_cast< int >( variables->second.uniformNames.size() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GetShaderAttributeName( const ShaderProgram* program, unsigned int attributeIndex, std::string& out_attributeName )
+{
+	out_attributeName = m_programVariables[ program->GetID() ].attributeNames[ attributeIndex ];
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GetShaderUniformName( const ShaderProgram* program, unsigned int uniformIndex, std::string& out_uniformName )
+{
+	out_uniformName = m_programVariables[ program->GetID() ].uniformNames[ uniformIndex ];
+}
+
+//-----------------------------------------------------------------------------------------------
+int RecordingRenderer::GetUniformVariableLocation( const ShaderProgram* program, const std::string& constantName )
+{
+	const std::vector< std::string >& uniformNames = m_programVariables[ program->GetID() ].uniformNames;
+	if( std::find( uniformNames.begin(), uniformNames.end(), constantName ) == uniformNames.end() )
+		return -1;
+	return GetVariableLocation( constantName );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, int ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, float ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, const IntVector2& ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, const FloatVector2& ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, const FloatVector3& ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, const FloatVector4& ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetUniformVariable( int programConstantLocation, const Float4x4Matrix& ) { RecordUniformUpdate( programConstantLocation ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::UseShaderProgram( const ShaderProgram* program )
+{
+	RecordStateChange( program == s_activeShaderProgram );
+	++m_statistics.shaderBinds;
+	s_activeShaderProgram = program;
+	Record( RecordedCommand::USE_PROGRAM, 0, program->GetID() );
+}
+#pragma endregion
+
+
+
+#pragma region Textures
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::BindTexture( Feature textureType, const Texture* texture ) const
+{
+	RecordStateChange( texture->GetID() == m_boundTextureID );
+	++m_statistics.textureBinds;
+	m_boundTextureID = texture->GetID();
+	Record( RecordedCommand::BIND_TEXTURE, textureType, m_boundTextureID );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::CreateTextureFrom2DImage( Feature textureType, unsigned int, ColorComponents,
+												  unsigned int imageWidth, unsigned int imageHeight, ColorComponents inputColorComponentFormat,
+												  CoordinateType pixelDataType, const void* )
+{
+	unsigned int componentsPerPixel = ( inputColorComponentFormat == RGBA ) ? 4 : 3;
+	unsigned int imageSizeBytes = imageWidth * imageHeight * componentsPerPixel * GetSizeOfCoordinateType( pixelDataType );
+	m_statistics.bufferUploadBytes += imageSizeBytes;
+	Record( RecordedCommand::UPLOAD_TEXTURE, textureType, m_boundTextureID, imageSizeBytes );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::DeleteTextureDataOnCard( Texture* texture ) { Record( RecordedCommand::DELETE_TEXTURE, 0, texture->GetID() ); }
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GenerateTextureIDs( unsigned int numberOfTextureIDs, unsigned int *arrayOfTextureIDs )
+{
+	for( unsigned int i = 0; i < numberOfTextureIDs; ++i )
+		arrayOfTextureIDs[ i ] = m_nextObjectID++;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetActiveTextureUnit( unsigned int textureUnitNumber )
+{
+	RecordStateChange( textureUnitNumber == m_activeTextureUnit );
+	m_activeTextureUnit = textureUnitNumber;
+	Record( RecordedCommand::SET_ACTIVE_TEXTURE_UNIT, 0, textureUnitNumber );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetTextureInputImageAlignment( unsigned int bytePackingOneTwoFourOrEight )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, 0, 0, bytePackingOneTwoFourOrEight );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetTextureMagnificationMode( Feature textureType, TextureFilteringMethod magnificationMethod )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, textureType, m_boundTextureID, magnificationMethod );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetTextureMinificationMode( Feature textureType, TextureFilteringMethod minificationMethod )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, textureType, m_boundTextureID, minificationMethod );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetTextureWrappingMode( Feature textureType, TextureWrapMode wrapMode )
+{
+	RecordStateChange( false );
+	Record( RecordedCommand::SET_TEXTURE_PARAMETER, textureType, m_boundTextureID, wrapMode );
+}
+#pragma endregion
+
+
+
+#pragma region Vertex_Arrays
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::RenderPartOfArray( Shape drawingShape, unsigned int numberPointsToDraw, CoordinateType indexType, const void* ) const
+{
+	RecordDraw( numberPointsToDraw );
+	if( m_boundIndexBufferID == 0 )
+		m_statistics.bytesSubmitted += numberPointsToDraw * GetSizeOfCoordinateType( indexType );
+	Record( RecordedCommand::DRAW_INDEXED, drawingShape, 0, numberPointsToDraw );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::RenderVertexArray( Shape drawingShape, unsigned int startingArrayIndex, unsigned int numberPointsInArray ) const
+{
+	RecordDraw( numberPointsInArray );
+	Record( RecordedCommand::DRAW_ARRAY, drawingShape, startingArrayIndex, numberPointsInArray );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetPointerToColorArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int, const void* ) const
+{
+	SetArrayPointer( m_colorArray, coordinatesPerVertex, coordinateType );
+	Record( RecordedCommand::SET_ARRAY_POINTER, COLOR_ARRAYS, 0, m_colorArray.bytesPerVertex );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetPointerToGenericArray( unsigned int variableLocation, int numberOfVertexCoordinates, CoordinateType coordinateType, bool, unsigned int, const void* ) const
+{
+	ArrayPointer& arrayPointer = m_genericArrays[ variableLocation ];
+	SetArrayPointer( arrayPointer, numberOfVertexCoordinates, coordinateType );
+	Record( RecordedCommand::SET_ARRAY_POINTER, 0, variableLocation, arrayPointer.bytesPerVertex );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetPointerToTextureCoordinateArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int, const void* ) const
+{
+	SetArrayPointer( m_textureCoordinateArray, coordinatesPerVertex, coordinateType );
+	Record( RecordedCommand::SET_ARRAY_POINTER, TEXTURE_COORD_ARRAYS, 0, m_textureCoordinateArray.bytesPerVertex );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetPointerToVertexArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int, const void* ) const
+{
+	SetArrayPointer( m_vertexArray, coordinatesPerVertex, coordinateType );
+	Record( RecordedCommand::SET_ARRAY_POINTER, VERTEX_ARRAYS, 0, m_vertexArray.bytesPerVertex );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SetShapeRestartIndex( unsigned int index ) { Record( RecordedCommand::SET_SHAPE_RESTART_INDEX, 0, index ); }
+#pragma endregion
+
+
+
+#pragma region Vertex_Buffer_Objects
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::BindBufferObject( BufferType bufferType, unsigned int bufferID )
+{
+	unsigned int& boundBufferID = ( bufferType == INDEX_BUFFER ) ? m_boundIndexBufferID : m_boundArrayBufferID;
+	RecordStateChange( bufferID == boundBufferID );
+	boundBufferID = bufferID;
+	Record( RecordedCommand::BIND_BUFFER, bufferType, bufferID );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::GenerateBuffer( unsigned int numberOfBuffersToGenerate, unsigned int* arrayOfBufferIDs )
+{
+	for( unsigned int i = 0; i < numberOfBuffersToGenerate; ++i )
+		arrayOfBufferIDs[ i ] = m_nextObjectID++;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RecordingRenderer::SendDataToBuffer( BufferType bufferType, unsigned int sizeOfBufferBytes, const void* )
+{
+	m_statistics.bufferUploadBytes += sizeOfBufferBytes;
+	Record( RecordedCommand::UPLOAD_BUFFER, bufferType, ( bufferType == INDEX_BUFFER ) ? m_boundIndexBufferID : m_boundArrayBufferID, sizeOfBufferBytes );
+}
+#pragma endregion
+#endif //GRAPHICS_USE_RECORDING
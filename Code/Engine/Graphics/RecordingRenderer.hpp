@@ -0,0 +1,250 @@
+#ifndef INCLUDED_RECORDING_RENDERER_HPP
+#define INCLUDED_RECORDING_RENDERER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <map>
+#include <set>
+#include <string>
+#include <vector>
+#include "Renderer.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A Renderer that never touches a graphics card. Every call is appended to a command list and
+//tallied, so that render paths can be profiled and checked on machines without a GL context.
+//-----------------------------------------------------------------------------------------------
+struct RecordedCommand
+{
+	enum Type
+	{
+		ENABLE_ARRAY,
+		DISABLE_ARRAY,
+		ENABLE_ATTRIBUTE_ARRAY,
+		DISABLE_ATTRIBUTE_ARRAY,
+		ENABLE_FEATURE,
+		DISABLE_FEATURE,
+		CLEAR_COLOR_BUFFER,
+		CLEAR_DEPTH_BUFFER,
+		SET_CLEAR_VALUE,
+		SET_DEPTH_WRITING,
+		SET_BLENDING_FUNCTION,
+		SET_COLOR,
+		SET_LINE_WIDTH,
+		SET_POINT_SIZE,
+		GENERATE_MIPMAPS,
+		SET_TEXTURE_PARAMETER,
+		COMPILE_SHADER,
+		LINK_PROGRAM,
+		DELETE_PROGRAM,
+		DELETE_SHADER,
+		DETACH_SHADER,
+		SET_UNIFORM,
+		USE_PROGRAM,
+		BIND_TEXTURE,
+		UPLOAD_TEXTURE,
+		DELETE_TEXTURE,
+		SET_ACTIVE_TEXTURE_UNIT,
+		DRAW_INDEXED,
+		DRAW_ARRAY,
+		SET_ARRAY_POINTER,
+		SET_SHAPE_RESTART_INDEX,
+		BIND_BUFFER,
+		UPLOAD_BUFFER
+	};
+
+	unsigned short type;
+	unsigned short enumArgument;
+	unsigned int firstArgument;
+	unsigned int secondArgument;
+
+	RecordedCommand( Type commandType, unsigned short enumValue, unsigned int first, unsigned int second )
+		: type( static_cast< unsigned short >( commandType ) )
+		, enumArgument( enumValue )
+		, firstArgument( first )
+		, secondArgument( second )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+struct RecordingStatistics
+{
+	unsigned int commands;
+	unsigned int drawCalls;
+	unsigned int verticesSubmitted;
+	unsigned int bytesSubmitted;
+	unsigned int stateChanges;
+	unsigned int redundantStateChanges;
+	unsigned int uniformUpdates;
+	unsigned int shaderBinds;
+	unsigned int textureBinds;
+	unsigned int bufferUploadBytes;
+
+	RecordingStatistics()
+		: commands( 0 )
+		, drawCalls( 0 )
+		, verticesSubmitted( 0 )
+		, bytesSubmitted( 0 )
+		, stateChanges( 0 )
+		, redundantStateChanges( 0 )
+		, uniformUpdates( 0 )
+		, shaderBinds( 0 )
+		, textureBinds( 0 )
+		, bufferUploadBytes( 0 )
+	{ }
+
+	//Looks a counter up by its member name, e.g. "drawCalls", for checks written in console scripts.
+	bool FindValueByName( const std::string& statisticName, unsigned int& out_value ) const;
+};
+
+//-----------------------------------------------------------------------------------------------
+STATIC class RecordingRenderer : public Renderer
+{
+	friend class Renderer;
+
+	struct ArrayPointer
+	{
+		bool enabled;
+		bool readFromBuffer;
+		unsigned int bytesPerVertex;
+
+		ArrayPointer() : enabled( false ), readFromBuffer( false ), bytesPerVertex( 0 ) { }
+	};
+
+	struct ShaderVariables
+	{
+		std::vector< std::string > attributeNames;
+		std::vector< std::string > uniformNames;
+	};
+
+	//The interface is const-heavy because the GL calls it wraps have no CPU-side state;
+	//ours do, so everything we track has to be mutable.
+	mutable std::vector< RecordedCommand > m_commands;
+	mutable RecordingStatistics m_statistics;
+	std::vector< RecordedCommand > m_lastFrameCommands;
+	RecordingStatistics m_lastFrameStatistics;
+
+	mutable std::set< Feature > m_enabledFeatures;
+	mutable std::map< unsigned int, ArrayPointer > m_genericArrays;
+	mutable ArrayPointer m_colorArray;
+	mutable ArrayPointer m_textureCoordinateArray;
+	mutable ArrayPointer m_vertexArray;
+	mutable unsigned int m_boundTextureID;
+	mutable bool m_depthWritingEnabled;
+	mutable ColorBlendingMode m_blendingSource;
+	mutable ColorBlendingMode m_blendingDestination;
+	mutable float m_lineWidth;
+	mutable float m_pointSize;
+	unsigned int m_activeTextureUnit;
+	unsigned int m_boundArrayBufferID;
+	unsigned int m_boundIndexBufferID;
+
+	unsigned int m_nextObjectID;
+	std::map< int, ShaderVariables > m_shaderVariables;
+	std::map< int, ShaderVariables > m_programVariables;
+	std::map< std::string, int > m_variableLocations;
+
+	//Don't allow other Plebian programmers to call our singleton's constructor.
+	RecordingRenderer();
+
+	//Copy and assign are not allowed
+	RecordingRenderer( const RecordingRenderer& );
+	void operator=( const RecordingRenderer& );
+
+	void Initialize();
+
+	void Record( RecordedCommand::Type type, unsigned short enumValue = 0, unsigned int first = 0, unsigned int second = 0 ) const;
+	void RecordStateChange( bool stateWasAlreadySet ) const;
+	void RecordDraw( unsigned int numberOfVertices ) const;
+	ArrayPointer& GetArrayPointer( ArrayType type ) const;
+	void SetArrayPointer( ArrayPointer& arrayPointer, unsigned int coordinatesPerVertex, CoordinateType coordinateType ) const;
+	unsigned int CalculateBytesPerVertexSubmitted() const;
+	int GetVariableLocation( const std::string& variableName );
+	void RecordUniformUpdate( int programConstantLocation );
+
+public:
+	//Recording. Each EndFrame keeps the frame just finished and begins recording the next.
+	void BeginRecording();
+	void EndFrame();
+	const std::vector< RecordedCommand >& GetLastFrameCommands() const { return m_lastFrameCommands; }
+	const RecordingStatistics& GetLastFrameStatistics() const { return m_lastFrameStatistics; }
+
+	//Feature Enabling
+	void EnableArrayType( ArrayType type ) const;
+	void DisableArrayType( ArrayType type ) const;
+	void BindVertexArraysToAttributeLocation( unsigned int location ) const;
+	void UnbindVertexArraysFromAttributeLocation( unsigned int location ) const;
+
+	void EnableFeature( Feature feature ) const;
+	void DisableFeature( Feature feature ) const;
+	bool IsFeatureEnabled( Feature feature ) const;
+
+	//Color and Depth Buffers
+	void ClearColorBuffer() const;
+	void ClearDepthBuffer() const;
+	void SetColorBufferClearValue( float red, float green, float blue, float alpha );
+	void SetDepthBufferClearValue( float depthBetweenZeroAndOne );
+	void DisableDepthBufferWriting() const;
+	void EnableDepthBufferWriting() const;
+
+	//Draw Modification
+	void GetAlphaBlendingFunction( ColorBlendingMode& out_sourceBlendingFactor, ColorBlendingMode& out_destinationBlendingFactor ) const;
+	void SetAlphaBlendingFunction( ColorBlendingMode sourceBlendingFactor, ColorBlendingMode destinationBlendingFactor ) const;
+	void SetColor( float red, float green, float blue, float alpha ) const;
+	void SetLineWidth( float widthPixels ) const;
+	void SetPointSize( float pointSize ) const;
+
+	//Mipmaps
+	void GenerateMipmaps( Feature textureType );
+	void SetMaximumMipmapLevel( Feature textureType, unsigned int maxLevel );
+	void SetMipmapQuality( QualityLevel qualityLevel );
+
+	//Shaders
+	int CompileShader( Shader shaderType, const char* sourceString, std::string& out_errors );
+	int CreateProgramFromShaders( int vertexShaderID, int geometryShaderID, int pixelFragmentShaderID, std::string& out_errors );
+	void DeleteProgramDataOnCard( ShaderProgram* program );
+	void DeleteShaderDataOnCard( int shaderID );
+	void DetachShaderFromProgram( int shaderID, int programID );
+	int GetAttributeLocation( const ShaderProgram* program, const std::string& attributeName );
+	int GetNumberOfAttributesInProgram( const ShaderProgram* program ) const;
+	int GetNumberOfUniformsInProgram( const ShaderProgram* program ) const;
+	void GetShaderAttributeName( const ShaderProgram* program, unsigned int attributeIndex, std::string& out_attributeName );
+	void GetShaderUniformName( const ShaderProgram* program, unsigned int uniformIndex, std::string& out_uniformName );
+	int GetUniformVariableLocation( const ShaderProgram* program, const std::string& constantName );
+	void SetUniformVariable( int programConstantLocation, int setting );
+	void SetUniformVariable( int programConstantLocation, float setting );
+	void SetUniformVariable( int programConstantLocation, const IntVector2& vector2 );
+	void SetUniformVariable( int programConstantLocation, const FloatVector2& vector2 );
+	void SetUniformVariable( int programConstantLocation, const FloatVector3& vector3 );
+	void SetUniformVariable( int programConstantLocation, const FloatVector4& vector4 );
+	void SetUniformVariable( int programConstantLocation, const Float4x4Matrix& matrix );
+	void UseShaderProgram( const ShaderProgram* program );
+
+	//Textures
+	void BindTexture( Feature textureType, const Texture* texture ) const;
+	void CreateTextureFrom2DImage( Feature textureType, unsigned int mipmapLevel, ColorComponents cardColorComponentFormat,
+								   unsigned int imageWidth, unsigned int imageHeight, ColorComponents inputColorComponentFormat,
+								   CoordinateType pixelDataType, const void* imageData );
+	void DeleteTextureDataOnCard( Texture* texture );
+	void GenerateTextureIDs( unsigned int numberOfTextureIDs, unsigned int *arrayOfTextureIDs );
+	void SetActiveTextureUnit( unsigned int textureUnitNumber );
+	void SetTextureInputImageAlignment( unsigned int bytePackingOneTwoFourOrEight );
+	void SetTextureMagnificationMode( Feature textureType, TextureFilteringMethod magnificationMethod );
+	void SetTextureMinificationMode( Feature textureType, TextureFilteringMethod minificationMethod );
+	void SetTextureWrappingMode( Feature textureType, TextureWrapMode wrapMode );
+
+	//Vertex Arrays
+	void RenderPartOfArray( Shape drawingShape, unsigned int numberPointsToDraw, CoordinateType indexType, const void* firstIndexToRender ) const;
+	void RenderVertexArray( Shape drawingShape, unsigned int startingArrayIndex, unsigned int numberPointsInArray ) const;
+	void SetPointerToColorArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int gapBetweenVertices, const void* firstVertexInArray ) const;
+	void SetPointerToGenericArray( unsigned int variableLocation, int numberOfVertexCoordinates, CoordinateType coordinateType, bool normalizeData, unsigned int gapBetweenVertices, const void* firstVertexInArray ) const;
+	void SetPointerToTextureCoordinateArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int gapBetweenVertices, const void* firstVertexInArray ) const;
+	void SetPointerToVertexArray( unsigned int coordinatesPerVertex, CoordinateType coordinateType, unsigned int gapBetweenVertices, const void* firstVertexInArray ) const;
+	void SetShapeRestartIndex( unsigned int index );
+
+	//Vertex Buffer Objects
+	void BindBufferObject( BufferType bufferType, unsigned int bufferID );
+	void GenerateBuffer( unsigned int numberOfBuffersToGenerate, unsigned int* arrayOfBufferIDs );
+	void SendDataToBuffer( BufferType bufferType, unsigned int sizeOfBufferBytes, const void* dataToSendToBuffer );
+};
+
+#endif //INCLUDED_RECORDING_RENDERER_HPP
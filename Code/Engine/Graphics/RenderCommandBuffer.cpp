@@ -0,0 +1,250 @@
+#include <algorithm>
+#include <cstring>
+#include "RenderCommandBuffer.hpp"
+#include "RenderStateCache.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC RenderCommandBuffer::FrameStatistics RenderCommandBuffer::s_statisticsThisFrame;
+STATIC RenderCommandBuffer::FrameStatistics RenderCommandBuffer::s_statisticsLastFrame;
+
+//-----------------------------------------------------------------------------------------------
+static bool InputsShareArray( const RenderCommandBuffer::VertexInput& first, const RenderCommandBuffer::VertexInput& second )
+{
+	if( first.attributeLocation < 0 || second.attributeLocation < 0 )
+		return first.attributeLocation < 0 && second.attributeLocation < 0 && first.arrayType == second.arrayType;
+	return first.attributeLocation == second.attributeLocation;
+}
+
+//-----------------------------------------------------------------------------------------------
+static void SetPointerForInput( const Renderer* renderer, const RenderCommandBuffer::VertexInput& input, unsigned int sizeOfVertex, const unsigned char* firstVertex )
+{
+	const void* firstCoordinate = firstVertex + input.offsetInVertex;
+
+	if( input.attributeLocation >= 0 )
+		renderer->SetPointerToGenericArray( input.attributeLocation, input.numberOfCoordinates, input.coordinateType, input.normalizeData, sizeOfVertex, firstCoordinate );
+	else if( input.arrayType == Renderer::COLOR_ARRAYS )
+		renderer->SetPointerToColorArray( input.numberOfCoordinates, input.coordinateType, sizeOfVertex, firstCoordinate );
+	else if( input.arrayType == Renderer::TEXTURE_COORD_ARRAYS )
+		renderer->SetPointerToTextureCoordinateArray( input.numberOfCoordinates, input.coordinateType, sizeOfVertex, firstCoordinate );
+	else
+		renderer->SetPointerToVertexArray( input.numberOfCoordinates, input.coordinateType, sizeOfVertex, firstCoordinate );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Layer comes first so sorting can never reorder passes; within a layer, draws group by program,
+//then texture, then blend state. Only the low bits of each ID fit, so two different states can
+//share a key--that costs a state change, never correctness, since every draw sets its own state.
+STATIC unsigned long long RenderCommandBuffer::BuildSortKey( const DrawState& state )
+{
+	unsigned long long programID = ( state.program != nullptr ) ? ( state.program->GetID() & 0xFFFF ) : 0;
+	unsigned long long textureID = ( state.texture != nullptr ) ? ( state.texture->GetID() & 0xFFFF ) : 0;
+	unsigned long long blendingKey = ( ( state.blendingSource & 0xFF ) << 8 ) | ( state.blendingDestination & 0xFF );
+
+	return ( static_cast< unsigned long long >( state.layer ) << 56 )
+		 | ( programID << 40 )
+		 | ( textureID << 24 )
+		 | ( blendingKey << 8 )
+		 | ( static_cast< unsigned long long >( state.blending ) << 4 )
+		 | ( static_cast< unsigned long long >( state.depthTesting ) << 2 );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Looked up once per program rather than asking the card for it every draw.
+int RenderCommandBuffer::GetTexturesEnabledLocation( const ShaderProgram* program )
+{
+	if( program == nullptr )
+		return -1;
+
+	for( unsigned int i = 0; i < m_programUniforms.size(); ++i )
+	{
+		if( m_programUniforms[ i ].program == program )
+			return m_programUniforms[ i ].texturesEnabledLocation;
+	}
+
+	ProgramUniforms uniforms;
+	uniforms.program = program;
+	uniforms.texturesEnabledLocation = program->GetUniformVariableIDFromName( STRING_ID( "u_texturesEnabled" ) );
+	m_programUniforms.push_back( uniforms );
+	return uniforms.texturesEnabledLocation;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void RenderCommandBuffer::EndFrame()
+{
+	s_statisticsLastFrame = s_statisticsThisFrame;
+	s_statisticsThisFrame = FrameStatistics();
+}
+
+//-----------------------------------------------------------------------------------------------
+//For code that drives a RenderStateCache of its own, so its savings show up in the frame's totals.
+STATIC void RenderCommandBuffer::AddStateCacheStatistics( const RenderStateCache& stateCache )
+{
+	s_statisticsThisFrame.stateChangesIssued += stateCache.GetStateChangesIssued();
+	s_statisticsThisFrame.stateChangesAvoided += stateCache.GetStateChangesAvoided();
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderCommandBuffer::Clear()
+{
+	m_commands.clear();
+	m_vertexData.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Returns space for the draw's vertices; it is only valid until the next draw is recorded.
+void* RenderCommandBuffer::AllocateDraw( const DrawState& state, Renderer::Shape shape, unsigned int numberOfVertices, unsigned int sizeOfVertex,
+										 const VertexInput* inputs, unsigned int numberOfInputs )
+{
+	static const unsigned int VERTEX_DATA_ALIGNMENT = 8;
+	assert( numberOfInputs <= MAX_VERTEX_INPUTS );
+
+	DrawCommand command;
+	command.sortKey = BuildSortKey( state );
+	command.state = state;
+	command.shape = shape;
+	command.numberOfVertices = numberOfVertices;
+	command.sizeOfVertex = sizeOfVertex;
+	command.vertexDataOffset = ( m_vertexData.size() + VERTEX_DATA_ALIGNMENT - 1 ) & ~( VERTEX_DATA_ALIGNMENT - 1 );
+	command.numberOfInputs = numberOfInputs;
+	std::copy( inputs, inputs + numberOfInputs, command.inputs );
+	m_commands.push_back( command );
+
+	m_vertexData.resize( command.vertexDataOffset + numberOfVertices * sizeOfVertex );
+	return &m_vertexData[ command.vertexDataOffset ];
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderCommandBuffer::RecordDraw( const DrawState& state, Renderer::Shape shape, unsigned int numberOfVertices, unsigned int sizeOfVertex,
+									  const VertexInput* inputs, unsigned int numberOfInputs, const void* vertexData )
+{
+	if( numberOfVertices == 0 )
+		return;
+
+	void* vertexSpace = AllocateDraw( state, shape, numberOfVertices, sizeOfVertex, inputs, numberOfInputs );
+	memcpy( vertexSpace, vertexData, numberOfVertices * sizeOfVertex );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RenderCommandBuffer::Submit( Renderer* renderer )
+{
+	if( m_commands.empty() )
+		return;
+
+	m_submissionOrder.resize( m_commands.size() );
+	for( unsigned int i = 0; i < m_submissionOrder.size(); ++i )
+		m_submissionOrder[ i ] = i;
+
+	//Stable, so draws with matching state still go out in the order they were recorded
+	std::stable_sort( m_submissionOrder.begin(), m_submissionOrder.end(),
+		[ this ]( unsigned int first, unsigned int second ) { return m_commands[ first ].sortKey < m_commands[ second ].sortKey; } );
+
+	//Blend and depth state is put back how the draws found it, so a Submit can sit between any two other draws.
+	//It's only read back from the Renderer the first time a draw wants to change it.
+	bool blendingWasSaved = false, blendingWasEnabled = false;
+	Renderer::ColorBlendingMode previousBlendingSource = 0, previousBlendingDestination = 0;
+	bool depthTestingWasSaved = false, depthTestingWasEnabled = false;
+
+	RenderStateCache stateCache( renderer );
+	const DrawCommand* previousCommand = nullptr;
+	for( unsigned int i = 0; i < m_submissionOrder.size(); ++i )
+	{
+		const DrawCommand& command = m_commands[ m_submissionOrder[ i ] ];
+		const DrawState& state = command.state;
+
+		if( state.program != nullptr )
+			stateCache.UseShaderProgram( state.program );
+
+		int texturesEnabledLocation = GetTexturesEnabledLocation( renderer->GetActiveShaderProgram() );
+		if( state.texture != nullptr )
+		{
+			stateCache.SetIntegerUniform( texturesEnabledLocation, 1 );
+			stateCache.BindTexture( state.texture );
+		}
+		else
+			stateCache.SetIntegerUniform( texturesEnabledLocation, 0 );
+
+		if( state.blending != LEAVE_UNCHANGED && !blendingWasSaved )
+		{
+			blendingWasSaved = true;
+			blendingWasEnabled = renderer->IsFeatureEnabled( Renderer::COLOR_BLENDING );
+			renderer->GetAlphaBlendingFunction( previousBlendingSource, previousBlendingDestination );
+		}
+		if( state.depthTesting != LEAVE_UNCHANGED && !depthTestingWasSaved )
+		{
+			depthTestingWasSaved = true;
+			depthTestingWasEnabled = renderer->IsFeatureEnabled( Renderer::DEPTH_TESTING );
+		}
+
+		if( state.blending == SET_ENABLED )
+		{
+			stateCache.EnableFeature( Renderer::COLOR_BLENDING );
+			stateCache.SetAlphaBlendingFunction( state.blendingSource, state.blendingDestination );
+		}
+		else if( state.blending == SET_DISABLED )
+			stateCache.DisableFeature( Renderer::COLOR_BLENDING );
+
+		if( state.depthTesting == SET_ENABLED )
+			stateCache.EnableFeature( Renderer::DEPTH_TESTING );
+		else if( state.depthTesting == SET_DISABLED )
+			stateCache.DisableFeature( Renderer::DEPTH_TESTING );
+
+		if( state.lineWidth > 0.f )
+			stateCache.SetLineWidth( state.lineWidth );
+
+		//Anything the last draw fed that this one doesn't must be switched off, or it would read past our vertices
+		if( previousCommand != nullptr )
+		{
+			for( unsigned int j = 0; j < previousCommand->numberOfInputs; ++j )
+			{
+				const VertexInput& previousInput = previousCommand->inputs[ j ];
+				bool isStillUsed = false;
+				for( unsigned int k = 0; k < command.numberOfInputs; ++k )
+					isStillUsed = isStillUsed || InputsShareArray( previousInput, command.inputs[ k ] );
+
+				if( isStillUsed )
+					continue;
+				if( previousInput.attributeLocation >= 0 )
+					stateCache.DisableAttributeArray( previousInput.attributeLocation );
+				else
+					stateCache.DisableArrayType( previousInput.arrayType );
+			}
+		}
+
+		const unsigned char* firstVertex = &m_vertexData[ command.vertexDataOffset ];
+		for( unsigned int j = 0; j < command.numberOfInputs; ++j )
+		{
+			const VertexInput& input = command.inputs[ j ];
+			if( input.attributeLocation >= 0 )
+				stateCache.EnableAttributeArray( input.attributeLocation );
+			else
+				stateCache.EnableArrayType( input.arrayType );
+			SetPointerForInput( renderer, input, command.sizeOfVertex, firstVertex );
+		}
+
+		static const unsigned int VERTEX_ARRAY_START = 0;
+		renderer->RenderVertexArray( command.shape, VERTEX_ARRAY_START, command.numberOfVertices );
+		previousCommand = &command;
+	}
+	stateCache.DisableAllArrays();
+
+	if( blendingWasSaved )
+	{
+		if( blendingWasEnabled )
+			stateCache.EnableFeature( Renderer::COLOR_BLENDING );
+		else
+			stateCache.DisableFeature( Renderer::COLOR_BLENDING );
+		stateCache.SetAlphaBlendingFunction( previousBlendingSource, previousBlendingDestination );
+	}
+	if( depthTestingWasSaved )
+	{
+		if( depthTestingWasEnabled )
+			stateCache.EnableFeature( Renderer::DEPTH_TESTING );
+		else
+			stateCache.DisableFeature( Renderer::DEPTH_TESTING );
+	}
+
+	s_statisticsThisFrame.drawsSubmitted += m_commands.size();
+	AddStateCacheStatistics( stateCache );
+
+	Clear();
+}
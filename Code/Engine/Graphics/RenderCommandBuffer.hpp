@@ -0,0 +1,122 @@
+#ifndef INCLUDED_RENDER_COMMAND_BUFFER_HPP
+#define INCLUDED_RENDER_COMMAND_BUFFER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <vector>
+#include "Renderer.hpp"
+
+class RenderStateCache;
+
+//-----------------------------------------------------------------------------------------------
+//Collects draws instead of issuing them, then submits them all at once sorted by the state they
+//need, so draws that share a program, texture and blend state go out back to back and the
+//changes between them can be skipped. Vertex data is copied in at record time, so callers may
+//throw their arrays away as soon as a draw is recorded.
+//-----------------------------------------------------------------------------------------------
+class RenderCommandBuffer
+{
+public:
+	enum FeatureSetting
+	{
+		LEAVE_UNCHANGED,
+		SET_ENABLED,
+		SET_DISABLED
+	};
+
+	struct DrawState
+	{
+		unsigned char layer; //Draws are never sorted ahead of a lower layer.
+		const ShaderProgram* program; //Null leaves the active program bound.
+		const Texture* texture; //Null draws with u_texturesEnabled turned off.
+		FeatureSetting blending;
+		Renderer::ColorBlendingMode blendingSource;
+		Renderer::ColorBlendingMode blendingDestination;
+		FeatureSetting depthTesting;
+		float lineWidth; //Zero leaves the line width alone.
+
+		DrawState()
+			: layer( 0 )
+			, program( nullptr )
+			, texture( nullptr )
+			, blending( LEAVE_UNCHANGED )
+			, blendingSource( 0 )
+			, blendingDestination( 0 )
+			, depthTesting( LEAVE_UNCHANGED )
+			, lineWidth( 0.f )
+		{ }
+	};
+
+	//One interleaved piece of each vertex, fed either to a fixed-function array or to a shader attribute.
+	struct VertexInput
+	{
+		int attributeLocation; //Negative feeds arrayType instead.
+		Renderer::ArrayType arrayType;
+		unsigned int numberOfCoordinates;
+		Renderer::CoordinateType coordinateType;
+		bool normalizeData;
+		unsigned int offsetInVertex;
+	};
+
+	struct FrameStatistics
+	{
+		unsigned int drawsSubmitted;
+		unsigned int stateChangesIssued;
+		unsigned int stateChangesAvoided;
+
+		FrameStatistics()
+			: drawsSubmitted( 0 )
+			, stateChangesIssued( 0 )
+			, stateChangesAvoided( 0 )
+		{ }
+	};
+
+	static const unsigned int MAX_VERTEX_INPUTS = 4;
+
+private:
+	struct DrawCommand
+	{
+		unsigned long long sortKey;
+		DrawState state;
+		Renderer::Shape shape;
+		unsigned int numberOfVertices;
+		unsigned int sizeOfVertex;
+		unsigned int vertexDataOffset;
+		unsigned int numberOfInputs;
+		VertexInput inputs[ MAX_VERTEX_INPUTS ];
+	};
+
+	struct ProgramUniforms
+	{
+		const ShaderProgram* program;
+		int texturesEnabledLocation;
+	};
+
+	static FrameStatistics s_statisticsThisFrame;
+	static FrameStatistics s_statisticsLastFrame;
+
+	std::vector< DrawCommand > m_commands;
+	std::vector< unsigned int > m_submissionOrder;
+	std::vector< unsigned char > m_vertexData;
+	std::vector< ProgramUniforms > m_programUniforms;
+
+	static unsigned long long BuildSortKey( const DrawState& state );
+	int GetTexturesEnabledLocation( const ShaderProgram* program );
+
+public:
+	RenderCommandBuffer() { }
+
+	static void EndFrame();
+	static const FrameStatistics& GetLastFrameStatistics() { return s_statisticsLastFrame; }
+	static void AddStateCacheStatistics( const RenderStateCache& stateCache );
+
+	void Clear();
+	bool IsEmpty() const { return m_commands.empty(); }
+	void* AllocateDraw( const DrawState& state, Renderer::Shape shape, unsigned int numberOfVertices, unsigned int sizeOfVertex,
+						const VertexInput* inputs, unsigned int numberOfInputs );
+	void RecordDraw( const DrawState& state, Renderer::Shape shape, unsigned int numberOfVertices, unsigned int sizeOfVertex,
+					 const VertexInput* inputs, unsigned int numberOfInputs, const void* vertexData );
+	void Submit( Renderer* renderer );
+};
+
+#endif //INCLUDED_RENDER_COMMAND_BUFFER_HPP
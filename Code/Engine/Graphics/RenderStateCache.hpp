@@ -0,0 +1,329 @@
+#ifndef INCLUDED_RENDER_STATE_CACHE_HPP
+#define INCLUDED_RENDER_STATE_CACHE_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include "Renderer.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Sits between a batch of draws and the Renderer and drops any state change that would set what
+//is already set. It only knows about changes made through it, so call Invalidate() whenever
+//anything may have talked to the Renderer directly since it was last used.
+//-----------------------------------------------------------------------------------------------
+class RenderStateCache
+{
+	static const unsigned int MAX_CACHED_FEATURES = 8;
+	static const unsigned int MAX_CACHED_INTEGER_UNIFORMS = 8;
+	static const unsigned int NUMBER_OF_ARRAY_TYPES = 3;
+	static const unsigned int MAX_CACHED_ATTRIBUTE_LOCATION = 32;
+
+	enum KnownState
+	{
+		STATE_UNKNOWN,
+		STATE_OFF,
+		STATE_ON
+	};
+
+	struct CachedFeature
+	{
+		Renderer::Feature feature;
+		KnownState state;
+	};
+
+	struct CachedIntegerUniform
+	{
+		int location;
+		int value;
+	};
+
+	Renderer* m_renderer;
+
+	bool m_programIsKnown;
+	const ShaderProgram* m_program;
+	bool m_textureIsKnown;
+	const Texture* m_texture;
+	bool m_blendingIsKnown;
+	Renderer::ColorBlendingMode m_blendingSource;
+	Renderer::ColorBlendingMode m_blendingDestination;
+	float m_lineWidth;
+
+	unsigned int m_numberOfCachedFeatures;
+	CachedFeature m_features[ MAX_CACHED_FEATURES ];
+	KnownState m_arrayTypes[ NUMBER_OF_ARRAY_TYPES ];
+	unsigned int m_enabledAttributeArrays;
+	unsigned int m_numberOfCachedIntegerUniforms;
+	CachedIntegerUniform m_integerUniforms[ MAX_CACHED_INTEGER_UNIFORMS ];
+
+	unsigned int m_stateChangesIssued;
+	unsigned int m_stateChangesAvoided;
+
+	bool ShouldIssue( bool stateIsAlreadySet );
+	KnownState& GetArrayTypeState( Renderer::ArrayType type );
+	KnownState* GetFeatureState( Renderer::Feature feature );
+
+	//We have no need of a pithy assignment or copy operator!
+	RenderStateCache( const RenderStateCache& );
+	void operator=( const RenderStateCache& );
+
+public:
+	explicit RenderStateCache( Renderer* renderer )
+		: m_renderer( renderer )
+		, m_stateChangesIssued( 0 )
+		, m_stateChangesAvoided( 0 )
+	{
+		Invalidate();
+	}
+
+	void Invalidate();
+	void ResetCounters() { m_stateChangesIssued = 0; m_stateChangesAvoided = 0; }
+	unsigned int GetStateChangesAvoided() const { return m_stateChangesAvoided; }
+	unsigned int GetStateChangesIssued() const { return m_stateChangesIssued; }
+
+	void BindTexture( const Texture* texture );
+	void DisableArrayType( Renderer::ArrayType type );
+	void DisableAllArrays();
+	void DisableAttributeArray( unsigned int location );
+	void DisableFeature( Renderer::Feature feature );
+	void EnableArrayType( Renderer::ArrayType type );
+	void EnableAttributeArray( unsigned int location );
+	void EnableFeature( Renderer::Feature feature );
+	void SetAlphaBlendingFunction( Renderer::ColorBlendingMode sourceBlendingFactor, Renderer::ColorBlendingMode destinationBlendingFactor );
+	void SetIntegerUniform( int location, int value );
+	void SetLineWidth( float widthPixels );
+	void UseShaderProgram( const ShaderProgram* program );
+};
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::Invalidate()
+{
+	m_programIsKnown = false;
+	m_program = nullptr;
+	m_textureIsKnown = false;
+	m_texture = nullptr;
+	m_blendingIsKnown = false;
+	m_blendingSource = 0;
+	m_blendingDestination = 0;
+	m_lineWidth = -1.f;
+
+	m_numberOfCachedFeatures = 0;
+	for( unsigned int i = 0; i < NUMBER_OF_ARRAY_TYPES; ++i )
+		m_arrayTypes[ i ] = STATE_UNKNOWN;
+	m_enabledAttributeArrays = 0;
+	m_numberOfCachedIntegerUniforms = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline bool RenderStateCache::ShouldIssue( bool stateIsAlreadySet )
+{
+	if( stateIsAlreadySet )
+	{
+		++m_stateChangesAvoided;
+		return false;
+	}
+
+	++m_stateChangesIssued;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline RenderStateCache::KnownState& RenderStateCache::GetArrayTypeState( Renderer::ArrayType type )
+{
+	if( type == Renderer::VERTEX_ARRAYS )
+		return m_arrayTypes[ 0 ];
+	if( type == Renderer::COLOR_ARRAYS )
+		return m_arrayTypes[ 1 ];
+	return m_arrayTypes[ 2 ];
+}
+
+//-----------------------------------------------------------------------------------------------
+//Returns null only when the cache is full, in which case the feature just goes uncached.
+inline RenderStateCache::KnownState* RenderStateCache::GetFeatureState( Renderer::Feature feature )
+{
+	for( unsigned int i = 0; i < m_numberOfCachedFeatures; ++i )
+	{
+		if( m_features[ i ].feature == feature )
+			return &m_features[ i ].state;
+	}
+
+	if( m_numberOfCachedFeatures == MAX_CACHED_FEATURES )
+		return nullptr;
+
+	CachedFeature& newFeature = m_features[ m_numberOfCachedFeatures++ ];
+	newFeature.feature = feature;
+	newFeature.state = STATE_UNKNOWN;
+	return &newFeature.state;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::BindTexture( const Texture* texture )
+{
+	if( !ShouldIssue( m_textureIsKnown && texture == m_texture ) )
+		return;
+
+	m_renderer->BindTexture( Renderer::TEXTURES_2D, texture );
+	m_textureIsKnown = true;
+	m_texture = texture;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::DisableArrayType( Renderer::ArrayType type )
+{
+	KnownState& arrayState = GetArrayTypeState( type );
+	if( !ShouldIssue( arrayState == STATE_OFF ) )
+		return;
+
+	m_renderer->DisableArrayType( type );
+	arrayState = STATE_OFF;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Turns off every array this cache may have turned on, leaving the Renderer how a batch found it.
+inline void RenderStateCache::DisableAllArrays()
+{
+	static const Renderer::ArrayType ARRAY_TYPES[ NUMBER_OF_ARRAY_TYPES ] = { Renderer::TEXTURE_COORD_ARRAYS, Renderer::COLOR_ARRAYS, Renderer::VERTEX_ARRAYS };
+	for( unsigned int i = 0; i < NUMBER_OF_ARRAY_TYPES; ++i )
+	{
+		if( GetArrayTypeState( ARRAY_TYPES[ i ] ) == STATE_ON )
+			DisableArrayType( ARRAY_TYPES[ i ] );
+	}
+
+	for( unsigned int location = 0; location < MAX_CACHED_ATTRIBUTE_LOCATION; ++location )
+	{
+		unsigned int locationBit = 1u << location;
+		if( ( m_enabledAttributeArrays & locationBit ) == 0 )
+			continue;
+
+		++m_stateChangesIssued;
+		m_renderer->UnbindVertexArraysFromAttributeLocation( location );
+	}
+	m_enabledAttributeArrays = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::DisableAttributeArray( unsigned int location )
+{
+	unsigned int locationBit = ( location < MAX_CACHED_ATTRIBUTE_LOCATION ) ? ( 1u << location ) : 0;
+	if( ( m_enabledAttributeArrays & locationBit ) == 0 && locationBit != 0 )
+	{
+		//Only arrays we enabled are known to be on; the rest we leave to whoever turned them on
+		++m_stateChangesAvoided;
+		return;
+	}
+
+	++m_stateChangesIssued;
+	m_renderer->UnbindVertexArraysFromAttributeLocation( location );
+	m_enabledAttributeArrays &= ~locationBit;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::DisableFeature( Renderer::Feature feature )
+{
+	KnownState* featureState = GetFeatureState( feature );
+	if( !ShouldIssue( featureState != nullptr && *featureState == STATE_OFF ) )
+		return;
+
+	m_renderer->DisableFeature( feature );
+	if( featureState != nullptr )
+		*featureState = STATE_OFF;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::EnableArrayType( Renderer::ArrayType type )
+{
+	KnownState& arrayState = GetArrayTypeState( type );
+	if( !ShouldIssue( arrayState == STATE_ON ) )
+		return;
+
+	m_renderer->EnableArrayType( type );
+	arrayState = STATE_ON;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::EnableAttributeArray( unsigned int location )
+{
+	unsigned int locationBit = ( location < MAX_CACHED_ATTRIBUTE_LOCATION ) ? ( 1u << location ) : 0;
+	if( !ShouldIssue( ( m_enabledAttributeArrays & locationBit ) != 0 ) )
+		return;
+
+	m_renderer->BindVertexArraysToAttributeLocation( location );
+	m_enabledAttributeArrays |= locationBit;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::EnableFeature( Renderer::Feature feature )
+{
+	KnownState* featureState = GetFeatureState( feature );
+	if( !ShouldIssue( featureState != nullptr && *featureState == STATE_ON ) )
+		return;
+
+	m_renderer->EnableFeature( feature );
+	if( featureState != nullptr )
+		*featureState = STATE_ON;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::SetAlphaBlendingFunction( Renderer::ColorBlendingMode sourceBlendingFactor, Renderer::ColorBlendingMode destinationBlendingFactor )
+{
+	if( !ShouldIssue( m_blendingIsKnown && sourceBlendingFactor == m_blendingSource && destinationBlendingFactor == m_blendingDestination ) )
+		return;
+
+	m_renderer->SetAlphaBlendingFunction( sourceBlendingFactor, destinationBlendingFactor );
+	m_blendingIsKnown = true;
+	m_blendingSource = sourceBlendingFactor;
+	m_blendingDestination = destinationBlendingFactor;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Uniform values belong to the program, so these are forgotten whenever the program changes.
+inline void RenderStateCache::SetIntegerUniform( int location, int value )
+{
+	if( location < 0 )
+		return;
+
+	for( unsigned int i = 0; i < m_numberOfCachedIntegerUniforms; ++i )
+	{
+		CachedIntegerUniform& uniform = m_integerUniforms[ i ];
+		if( uniform.location != location )
+			continue;
+
+		if( ShouldIssue( uniform.value == value ) )
+		{
+			m_renderer->SetUniformVariable( location, value );
+			uniform.value = value;
+		}
+		return;
+	}
+
+	++m_stateChangesIssued;
+	m_renderer->SetUniformVariable( location, value );
+	if( m_numberOfCachedIntegerUniforms < MAX_CACHED_INTEGER_UNIFORMS )
+	{
+		CachedIntegerUniform& newUniform = m_integerUniforms[ m_numberOfCachedIntegerUniforms++ ];
+		newUniform.location = location;
+		newUniform.value = value;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::SetLineWidth( float widthPixels )
+{
+	if( !ShouldIssue( widthPixels == m_lineWidth ) )
+		return;
+
+	m_renderer->SetLineWidth( widthPixels );
+	m_lineWidth = widthPixels;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void RenderStateCache::UseShaderProgram( const ShaderProgram* program )
+{
+	if( !ShouldIssue( m_programIsKnown && program == m_program ) )
+		return;
+
+	m_renderer->UseShaderProgram( program );
+	m_programIsKnown = true;
+	m_program = program;
+	m_numberOfCachedIntegerUniforms = 0;
+}
+
+#endif //INCLUDED_RENDER_STATE_CACHE_HPP
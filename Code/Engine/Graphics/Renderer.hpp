@@ -17,6 +17,9 @@
 #include "Texture.hpp"
 #include "VertexDataContainers.hpp"
 
+//-----------------------------------------------------------------------------------------------
+class RenderCommandBuffer;
+
 //-----------------------------------------------------------------------------------------------
 ABSTRACT STATIC class Renderer
 {
@@ -24,8 +27,6 @@ ABSTRACT STATIC class Renderer
 
 
 	virtual void Initialize() = 0;
-	VertexColorTextureData2D* BuildGlyphArrayFromString( unsigned int& out_totalGlyphVertices, const std::string& textString, const BitmapFont& font, 
-														 float cellHeight, const FloatVector2& textStartLowerLeftCorner, const Color& textColor );
 
 protected:
 	const ShaderProgram* s_activeShaderProgram;
@@ -108,6 +109,9 @@ public:
 	static void CreateRenderer();
 	static Renderer* GetRenderer();
 
+	//Called once a frame after the buffers are swapped, for backends that keep per-frame records
+	virtual void EndFrame() { }
+
 	//Feature Enabling
 	virtual void EnableArrayType( ArrayType type ) const = 0;
 	virtual void DisableArrayType( ArrayType type ) const = 0;
@@ -116,6 +120,7 @@ public:
 
 	virtual void EnableFeature( Feature feature ) const = 0;
 	virtual void DisableFeature( Feature feature ) const = 0;
+	virtual bool IsFeatureEnabled( Feature feature ) const = 0;
 
 	//Color and Depth Buffers
 	virtual void ClearColorBuffer() const = 0;
@@ -140,6 +145,7 @@ public:
 	void TranslateWorld( const FloatVector3& translationDirection );
 
 	//Draw modification
+	virtual void GetAlphaBlendingFunction( ColorBlendingMode& out_sourceBlendingFactor, ColorBlendingMode& out_destinationBlendingFactor ) const = 0;
 	virtual void SetAlphaBlendingFunction( ColorBlendingMode sourceBlendingFactor, ColorBlendingMode destinationBlendingFactor ) const = 0;
 	virtual void SetColor( float red, float green, float blue, float alpha ) const = 0;
 	virtual void SetLineWidth( float widthPixels ) const = 0;
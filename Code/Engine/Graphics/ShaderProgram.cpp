@@ -1,5 +1,9 @@
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
+#include <cassert>
+#include <cstdio>
+#if defined( _WIN32 )
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+#endif
 #include "Renderer.hpp"
 #include "ShaderProgram.hpp"
 
@@ -10,7 +14,21 @@ STATIC std::map< ShaderSet, ShaderProgram* > ShaderProgram::s_programRegistry;
 //-----------------------------------------------------------------------------------------------
 void PopUpSystemDialog( const std::string& titleText, const std::string& messageText )
 {
+#if defined( _WIN32 )
 	MessageBoxA( NULL, messageText.c_str(), titleText.c_str(), MB_OK );
+#else
+	fprintf( stderr, "%s\n%s\n", titleText.c_str(), messageText.c_str() );
+#endif
+}
+
+//-----------------------------------------------------------------------------------------------
+void WriteToDebugOutput( const std::string& debugMessage )
+{
+#if defined( _WIN32 )
+	OutputDebugStringA( debugMessage.c_str() );
+#else
+	fputs( debugMessage.c_str(), stderr );
+#endif
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -30,9 +48,15 @@ void ShaderProgram::LoadShaderFromFile( std::string& out_shaderData, const char*
 {
 	char* shaderData = nullptr;
 	FILE* shaderFile = nullptr;
+#if defined( _WIN32 )
 	int errorResult = fopen_s( &shaderFile, shaderFileName, "rb" );
 	if( errorResult != 0 )
 		exit( -5 );
+#else
+	shaderFile = fopen( shaderFileName, "rb" );
+	if( shaderFile == nullptr )
+		exit( -5 );
+#endif
 
 	fseek( shaderFile, 0, SEEK_END );
 	long fileSize = ftell( shaderFile );
@@ -57,7 +81,7 @@ int ShaderProgram::CompileGeometryShaderOrDie( Renderer* renderer, const std::st
 	{
 		std::string visualStudioDebugMessage;
 		BuildVisualStudioDebugMessage( visualStudioDebugMessage, geometryShaderFileLocation, rawErrorText );
-		OutputDebugStringA( visualStudioDebugMessage.c_str() );
+		WriteToDebugOutput( visualStudioDebugMessage );
 
 		std::string systemDialogMessage;
 		systemDialogMessage.append( "FATAL ERROR:\n\tGeometry Shader Compilation Error!\n\n");
@@ -80,7 +104,7 @@ int ShaderProgram::CompilePixelShaderOrDie( Renderer* renderer, const std::strin
 	{
 		std::string visualStudioDebugMessage;
 		BuildVisualStudioDebugMessage( visualStudioDebugMessage, pixelShaderFileLocation, rawErrorText );
-		OutputDebugStringA( visualStudioDebugMessage.c_str() );
+		WriteToDebugOutput( visualStudioDebugMessage );
 
 		std::string systemDialogMessage;
 		systemDialogMessage.append( "FATAL ERROR:\n\tPixel Shader Compilation Error!\n\n");
@@ -103,7 +127,7 @@ int ShaderProgram::CompileVertexShaderOrDie( Renderer* renderer, const std::stri
 	{
 		std::string visualStudioDebugMessage;
 		BuildVisualStudioDebugMessage( visualStudioDebugMessage, vertexShaderFileLocation, rawErrorText );
-		OutputDebugStringA( visualStudioDebugMessage.c_str() );
+		WriteToDebugOutput( visualStudioDebugMessage );
 
 		std::string systemDialogMessage;
 		systemDialogMessage.append( "FATAL ERROR:\n\tVertex Shader Compilation Error!\n\n");
@@ -123,7 +147,7 @@ int ShaderProgram::LinkShadersIntoProgramOrDie( Renderer* renderer, const std::s
 
 	if( programID == -1 )
 	{
-		OutputDebugStringA( rawErrorText.c_str() );
+		WriteToDebugOutput( rawErrorText );
 
 		std::string systemDialogMessage;
 		systemDialogMessage.append( "FATAL ERROR:\n\tVShader Program Linking Error!\n\n");
@@ -148,7 +172,7 @@ int ShaderProgram::LinkShadersIntoProgramOrDie( Renderer* renderer, const std::s
 
 	if( programID == -1 )
 	{
-		OutputDebugStringA( rawErrorText.c_str() );
+		WriteToDebugOutput( rawErrorText );
 
 		std::string systemDialogMessage;
 		systemDialogMessage.append( "FATAL ERROR:\n\tVShader Program Linking Error!\n\n");
@@ -174,7 +198,10 @@ void ShaderProgram::RegisterAttributeVariables( Renderer* renderer )
 	for( int attributeIndex = 0; attributeIndex < numberOfAttributes; ++attributeIndex )
 	{
 		renderer->GetShaderAttributeName( this, attributeIndex, attributeName );
-		m_attributeRegistry[ attributeName ] = renderer->GetAttributeLocation( this, attributeName );
+
+		StringID attributeID = HashString( attributeName );
+		assert( !m_attributeRegistry.Contains( attributeID ) ); //Two attribute names hash the same; rename one of them.
+		m_attributeRegistry.Insert( attributeID, renderer->GetAttributeLocation( this, attributeName ) );
 	}
 }
 
@@ -187,7 +214,10 @@ void ShaderProgram::RegisterUniformVariables( Renderer* renderer )
 	for( int uniformIndex = 0; uniformIndex < numberOfUniforms; ++uniformIndex )
 	{
 		renderer->GetShaderUniformName( this, uniformIndex, uniformName );
-		m_uniformRegistry[ uniformName ] = renderer->GetUniformVariableLocation( this, uniformName );
+
+		StringID uniformID = HashString( uniformName );
+		assert( !m_uniformRegistry.Contains( uniformID ) ); //Two uniform names hash the same; rename one of them.
+		m_uniformRegistry.Insert( uniformID, renderer->GetUniformVariableLocation( this, uniformName ) );
 	}
 }
 
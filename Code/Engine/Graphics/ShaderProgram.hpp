@@ -4,6 +4,8 @@
 
 //-----------------------------------------------------------------------------------------------
 #include <map>
+#include <string>
+#include "../StringID.hpp"
 
 class Renderer;
 
@@ -14,21 +16,35 @@ struct ShaderSet
 	std::string vertexShaderFileLocation;
 	std::string geometryShaderFileLocation;
 	std::string pixelShaderFileLocation;
+	StringID setID;
 
-	ShaderSet() { }
+	ShaderSet() : setID( 0 ) { }
 	ShaderSet( const std::string& vertexShaderFileLoc, const std::string& pixelShaderFileLoc )
 		: vertexShaderFileLocation( vertexShaderFileLoc )
 		, pixelShaderFileLocation( pixelShaderFileLoc )
+		, setID( BuildSetID() )
 	{ }
 
 	ShaderSet( const std::string& vertexShaderFileLoc, const std::string& geometryShaderFileLoc, const std::string& pixelShaderFileLoc )
 		: vertexShaderFileLocation( vertexShaderFileLoc )
 		, geometryShaderFileLocation( geometryShaderFileLoc )
 		, pixelShaderFileLocation( pixelShaderFileLoc )
+		, setID( BuildSetID() )
 	{ }
 
+	StringID BuildSetID() const
+	{
+		StringID combinedID = HashString( vertexShaderFileLocation );
+		combinedID = CombineStringIDs( combinedID, HashString( pixelShaderFileLocation ) );
+		return CombineStringIDs( combinedID, HashString( geometryShaderFileLocation ) );
+	}
+
+	//Sets almost always differ by ID, so the paths are only compared when the IDs collide.
 	bool operator<( const ShaderSet& rhs ) const 
 	{
+		if( this->setID != rhs.setID )
+			return this->setID < rhs.setID;
+
 		if( this->vertexShaderFileLocation < rhs.vertexShaderFileLocation )
 		{
 			return true;
@@ -57,8 +73,8 @@ class ShaderProgram
 
 	int m_vertexShaderID, m_geometryShaderID, m_pixelShaderID;
 	int m_shaderProgramID;
-	std::map< std::string, int > m_attributeRegistry;
-	std::map< std::string, int > m_uniformRegistry;
+	StringIDTable m_attributeRegistry;
+	StringIDTable m_uniformRegistry;
 
 	void LoadShaderFromFile( std::string& out_shaderData, const char* shaderFileName );
 
@@ -83,26 +99,11 @@ public:
 	static ShaderProgram* CreateOrGetShaderProgram( const std::string& vertexShaderFileLocation, const std::string& geometryShaderFileLocation, const std::string& pixelShaderFileLocation );
 	static void CleanUpProgramRepository();
 
-	int GetAttributeIDFromName( const std::string& attributeName ) const;
-	int GetUniformVariableIDFromName( const std::string& uniformName ) const;
+	//Prefer the StringID versions, with STRING_ID( "name" ), anywhere that runs every frame.
+	int GetAttributeIDFromName( StringID attributeName ) const { return m_attributeRegistry.Find( attributeName, -1 ); }
+	int GetAttributeIDFromName( const std::string& attributeName ) const { return GetAttributeIDFromName( HashString( attributeName ) ); }
+	int GetUniformVariableIDFromName( StringID uniformName ) const { return m_uniformRegistry.Find( uniformName, -1 ); }
+	int GetUniformVariableIDFromName( const std::string& uniformName ) const { return GetUniformVariableIDFromName( HashString( uniformName ) ); }
 };
 
-//-----------------------------------------------------------------------------------------------
-inline int ShaderProgram::GetAttributeIDFromName( const std::string& attributeName ) const
-{
-	std::map< std::string, int >::const_iterator attribute = m_attributeRegistry.find( attributeName );
-	//assert( attribute != m_attributeRegistry.end() );
-
-	return attribute->second;
-}
-
-//-----------------------------------------------------------------------------------------------
-inline int ShaderProgram::GetUniformVariableIDFromName( const std::string& uniformName ) const
-{
-	std::map< std::string, int >::const_iterator uniform = m_uniformRegistry.find( uniformName );
-	//assert( uniform != m_uniformRegistry.end() );
-
-	return uniform->second;
-}
-
 #endif //INCLUDED_SHADER_PROGRAM_HPP
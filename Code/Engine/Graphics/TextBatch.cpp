@@ -0,0 +1,444 @@
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include "TextBatch.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC std::map< StringID, TextBatch::TextLayout > TextBatch::s_layoutCache;
+STATIC unsigned int TextBatch::s_frameNumber = 0;
+STATIC unsigned int TextBatch::s_nextLayoutNumber = 1;
+STATIC TextBatch::CacheStatistics TextBatch::s_statisticsThisFrame;
+STATIC TextBatch::CacheStatistics TextBatch::s_statisticsLastFrame;
+
+//-----------------------------------------------------------------------------------------------
+static bool ColorsMatch( const Color& first, const Color& second )
+{
+	return first.r == second.r && first.g == second.g && first.b == second.b && first.a == second.a;
+}
+
+//-----------------------------------------------------------------------------------------------
+static StringID CombineWithBytes( StringID hash, const void* data, size_t numberOfBytes )
+{
+	return CombineStringIDs( hash, HashString( static_cast< const char* >( data ), numberOfBytes ) );
+}
+
+#pragma region Layout Cache
+//-----------------------------------------------------------------------------------------------
+STATIC StringID TextBatch::BuildLayoutKey( const std::string& textString, const BitmapFont& font, float cellHeight,
+										   const Color& textColor, const Color& backgroundColor, const Color& shadowColor )
+{
+	const BitmapFont* fontAddress = &font;
+
+	StringID key = HashString( textString );
+	key = CombineWithBytes( key, &fontAddress, sizeof( fontAddress ) );
+	key = CombineWithBytes( key, &cellHeight, sizeof( cellHeight ) );
+	key = CombineWithBytes( key, &textColor, sizeof( textColor ) );
+	key = CombineWithBytes( key, &backgroundColor, sizeof( backgroundColor ) );
+	return CombineWithBytes( key, &shadowColor, sizeof( shadowColor ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Each glyph is a pair of triangles rather than a strip piece, so laid out strings can be appended
+//to one another without sewing vertices between them.
+STATIC void TextBatch::LayOutGlyphs( TextLayout& out_layout, const std::vector< float >& penPositions, const FloatVector2& lowerLeftCorner, const Color& color )
+{
+	float minY = lowerLeftCorner.y;
+	float maxY = minY + out_layout.cellHeight;
+
+	for( unsigned int i = 0; i < out_layout.textString.length(); ++i )
+	{
+		const Glyph& glyph = out_layout.font->GetGlyphForCharacter( out_layout.textString[ i ] );
+
+		float startX = lowerLeftCorner.x + penPositions[ i ] + glyph.m_advanceBeforeDrawA * out_layout.cellHeight;
+		float endX = startX + glyph.m_fontWidthB * out_layout.cellHeight;
+
+		SheetGlyphs* sheetGlyphs = nullptr;
+		for( unsigned int j = 0; j < out_layout.glyphsPerSheet.size(); ++j )
+		{
+			if( out_layout.glyphsPerSheet[ j ].sheetNumber == glyph.m_textureSheetID )
+				sheetGlyphs = &out_layout.glyphsPerSheet[ j ];
+		}
+		if( sheetGlyphs == nullptr )
+		{
+			out_layout.glyphsPerSheet.push_back( SheetGlyphs() );
+			sheetGlyphs = &out_layout.glyphsPerSheet.back();
+			sheetGlyphs->sheetNumber = glyph.m_textureSheetID;
+		}
+
+		VertexColorTextureData2D lowerLeft( FloatVector2( startX, minY ), color, FloatVector2( glyph.m_textureUVMins.x, glyph.m_textureUVMaxs.y ) );
+		VertexColorTextureData2D lowerRight( FloatVector2( endX, minY ), color, glyph.m_textureUVMaxs );
+		VertexColorTextureData2D upperLeft( FloatVector2( startX, maxY ), color, glyph.m_textureUVMins );
+		VertexColorTextureData2D upperRight( FloatVector2( endX, maxY ), color, FloatVector2( glyph.m_textureUVMaxs.x, glyph.m_textureUVMins.y ) );
+
+		std::vector< VertexColorTextureData2D >& vertices = sheetGlyphs->vertices;
+		vertices.push_back( lowerLeft );
+		vertices.push_back( lowerRight );
+		vertices.push_back( upperLeft );
+		vertices.push_back( upperLeft );
+		vertices.push_back( lowerRight );
+		vertices.push_back( upperRight );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC const TextBatch::TextLayout& TextBatch::CreateOrGetLayout( const std::string& textString, const BitmapFont& font, float cellHeight,
+																   const Color& textColor, const Color& backgroundColor, const Color& shadowColor )
+{
+	StringID key = BuildLayoutKey( textString, font, cellHeight, textColor, backgroundColor, shadowColor );
+	TextLayout& layout = s_layoutCache[ key ];
+	layout.lastFrameUsed = s_frameNumber;
+
+	//A fresh entry has no font yet; a mismatched one is a key collision and is simply laid out again
+	if( layout.font == &font && layout.cellHeight == cellHeight && layout.textString == textString && ColorsMatch( layout.textColor, textColor )
+		&& ColorsMatch( layout.backgroundColor, backgroundColor ) && ColorsMatch( layout.shadowColor, shadowColor ) )
+	{
+		++s_statisticsThisFrame.layoutsReused;
+		return layout;
+	}
+
+	++s_statisticsThisFrame.layoutsBuilt;
+	layout.textString = textString;
+	layout.font = &font;
+	layout.cellHeight = cellHeight;
+	layout.textColor = textColor;
+	layout.backgroundColor = backgroundColor;
+	layout.shadowColor = shadowColor;
+	layout.glyphsPerSheet.clear();
+	layout.layoutNumber = s_nextLayoutNumber++;
+
+	std::vector< float > penPositions( textString.length() + 1 );
+	font.CalculateAdvancePrefixSums( textString.data(), textString.length(), cellHeight, &penPositions[ 0 ] );
+	layout.width = penPositions.back();
+
+	float shadowOffset = .05f * cellHeight;
+	LayOutGlyphs( layout, penPositions, FloatVector2( shadowOffset, -shadowOffset ), shadowColor );
+	LayOutGlyphs( layout, penPositions, FloatVector2( 0.f, 0.f ), textColor );
+	return layout;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Layouts untouched for a couple of seconds are dropped, so the cache holds roughly what is on screen.
+STATIC void TextBatch::EndFrame()
+{
+	unsigned int layoutsEvicted = 0;
+	std::map< StringID, TextLayout >::iterator layout = s_layoutCache.begin();
+	while( layout != s_layoutCache.end() )
+	{
+		if( s_frameNumber - layout->second.lastFrameUsed > FRAMES_TO_KEEP_UNUSED_LAYOUTS )
+		{
+			layout = s_layoutCache.erase( layout );
+			++layoutsEvicted;
+		}
+		else
+			++layout;
+	}
+
+	s_statisticsThisFrame.layoutsEvicted = layoutsEvicted;
+	s_statisticsThisFrame.layoutsCached = s_layoutCache.size();
+	s_statisticsLastFrame = s_statisticsThisFrame;
+	s_statisticsThisFrame = CacheStatistics();
+	++s_frameNumber;
+}
+#pragma endregion
+
+#pragma region Spans
+//-----------------------------------------------------------------------------------------------
+unsigned int TextBatch::GetBatchIndexForSheet( const Texture* sheet )
+{
+	for( unsigned int i = 0; i < m_glyphBatches.size(); ++i )
+	{
+		if( m_glyphBatches[ i ].sheet == sheet )
+			return i;
+	}
+
+	m_glyphBatches.push_back( SheetBatch() );
+	m_glyphBatches.back().sheet = sheet;
+	return m_glyphBatches.size() - 1;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Returns the number of spans if no span from an earlier recording holds this layout. The same
+//string can be added more than once, so spans already added this time around are skipped.
+unsigned int TextBatch::FindUnaddedSpanForLayout( unsigned int layoutNumber ) const
+{
+	typedef std::multimap< unsigned int, unsigned int >::const_iterator SpanIterator;
+	std::pair< SpanIterator, SpanIterator > spansWithLayout = m_spanIndicesByLayoutNumber.equal_range( layoutNumber );
+	for( SpanIterator span = spansWithLayout.first; span != spansWithLayout.second; ++span )
+	{
+		if( m_spans[ span->second ].lastRecordingAdded != m_recordingNumber )
+			return span->second;
+	}
+	return m_spans.size();
+}
+
+//-----------------------------------------------------------------------------------------------
+bool TextBatch::SpanHasRoomForLayout( const TextSpan& span, const TextLayout& layout )
+{
+	for( unsigned int i = 0; i < layout.glyphsPerSheet.size(); ++i )
+	{
+		const SheetGlyphs& sheetGlyphs = layout.glyphsPerSheet[ i ];
+		unsigned int batchIndex = GetBatchIndexForSheet( layout.font->GetTextureSheet( sheetGlyphs.sheetNumber ) );
+
+		bool hasRoomOnSheet = false;
+		for( unsigned int j = 0; j < span.glyphRanges.size(); ++j )
+		{
+			if( span.glyphRanges[ j ].batchIndex == batchIndex && span.glyphRanges[ j ].capacity >= sheetGlyphs.vertices.size() )
+				hasRoomOnSheet = true;
+		}
+		if( !hasRoomOnSheet )
+			return false;
+	}
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Reuses a free slot the layout fits in, or else adds a slot of exactly its size to the ends of the arrays.
+unsigned int TextBatch::AllocateSpanForLayout( const TextLayout& layout )
+{
+	for( unsigned int i = 0; i < m_freeSpanIndices.size(); ++i )
+	{
+		unsigned int spanIndex = m_freeSpanIndices[ i ];
+		if( SpanHasRoomForLayout( m_spans[ spanIndex ], layout ) )
+		{
+			m_freeSpanIndices[ i ] = m_freeSpanIndices.back();
+			m_freeSpanIndices.pop_back();
+			return spanIndex;
+		}
+	}
+
+	unsigned int spanIndex = m_spans.size();
+	m_spans.push_back( TextSpan() );
+	m_backgroundVertices.resize( m_backgroundVertices.size() + VERTICES_PER_BACKGROUND );
+
+	for( unsigned int i = 0; i < layout.glyphsPerSheet.size(); ++i )
+	{
+		const SheetGlyphs& sheetGlyphs = layout.glyphsPerSheet[ i ];
+
+		GlyphRange range;
+		range.batchIndex = GetBatchIndexForSheet( layout.font->GetTextureSheet( sheetGlyphs.sheetNumber ) );
+		std::vector< VertexColorTextureData2D >& batchVertices = m_glyphBatches[ range.batchIndex ].vertices;
+		range.firstVertex = batchVertices.size();
+		range.numberOfVertices = 0;
+		range.capacity = sheetGlyphs.vertices.size();
+		batchVertices.resize( batchVertices.size() + range.capacity );
+
+		m_spans.back().glyphRanges.push_back( range );
+	}
+	return spanIndex;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Writes the layout's quads at the given corner, leaving whatever room the slot has left over as zero-area quads.
+void TextBatch::WriteSpan( unsigned int spanIndex, const TextLayout& layout, const FloatVector2& lowerLeftCorner )
+{
+	TextSpan& span = m_spans[ spanIndex ];
+	span.layoutNumber = layout.layoutNumber;
+	span.lowerLeftCorner = lowerLeftCorner;
+
+	float minX = lowerLeftCorner.x;
+	float minY = lowerLeftCorner.y;
+	float maxX = minX + layout.width;
+	float maxY = minY + layout.cellHeight;
+	VertexColorData2D* background = &m_backgroundVertices[ spanIndex * VERTICES_PER_BACKGROUND ];
+	background[ 0 ] = VertexColorData2D( FloatVector2( minX, minY ), layout.backgroundColor );
+	background[ 1 ] = VertexColorData2D( FloatVector2( maxX, minY ), layout.backgroundColor );
+	background[ 2 ] = VertexColorData2D( FloatVector2( minX, maxY ), layout.backgroundColor );
+	background[ 3 ] = VertexColorData2D( FloatVector2( minX, maxY ), layout.backgroundColor );
+	background[ 4 ] = VertexColorData2D( FloatVector2( maxX, minY ), layout.backgroundColor );
+	background[ 5 ] = VertexColorData2D( FloatVector2( maxX, maxY ), layout.backgroundColor );
+
+	for( unsigned int i = 0; i < span.glyphRanges.size(); ++i )
+		span.glyphRanges[ i ].numberOfVertices = 0;
+
+	for( unsigned int i = 0; i < layout.glyphsPerSheet.size(); ++i )
+	{
+		const SheetGlyphs& sheetGlyphs = layout.glyphsPerSheet[ i ];
+		unsigned int batchIndex = GetBatchIndexForSheet( layout.font->GetTextureSheet( sheetGlyphs.sheetNumber ) );
+
+		GlyphRange* range = nullptr;
+		for( unsigned int j = 0; j < span.glyphRanges.size(); ++j )
+		{
+			if( span.glyphRanges[ j ].batchIndex == batchIndex )
+				range = &span.glyphRanges[ j ];
+		}
+		assert( range != nullptr && range->capacity >= sheetGlyphs.vertices.size() );
+
+		VertexColorTextureData2D* batchVertices = &m_glyphBatches[ batchIndex ].vertices[ range->firstVertex ];
+		for( unsigned int j = 0; j < sheetGlyphs.vertices.size(); ++j )
+		{
+			batchVertices[ j ] = sheetGlyphs.vertices[ j ];
+			batchVertices[ j ].x += minX;
+			batchVertices[ j ].y += minY;
+		}
+		range->numberOfVertices = sheetGlyphs.vertices.size();
+	}
+
+	for( unsigned int i = 0; i < span.glyphRanges.size(); ++i )
+	{
+		const GlyphRange& range = span.glyphRanges[ i ];
+		std::vector< VertexColorTextureData2D >& batchVertices = m_glyphBatches[ range.batchIndex ].vertices;
+		std::fill( batchVertices.begin() + range.firstVertex + range.numberOfVertices, batchVertices.begin() + range.firstVertex + range.capacity, VertexColorTextureData2D() );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void TextBatch::FreeSpan( unsigned int spanIndex )
+{
+	TextSpan& span = m_spans[ spanIndex ];
+
+	typedef std::multimap< unsigned int, unsigned int >::iterator SpanIterator;
+	std::pair< SpanIterator, SpanIterator > spansWithLayout = m_spanIndicesByLayoutNumber.equal_range( span.layoutNumber );
+	for( SpanIterator spanWithLayout = spansWithLayout.first; spanWithLayout != spansWithLayout.second; ++spanWithLayout )
+	{
+		if( spanWithLayout->second == spanIndex )
+		{
+			m_spanIndicesByLayoutNumber.erase( spanWithLayout );
+			break;
+		}
+	}
+
+	std::fill( m_backgroundVertices.begin() + spanIndex * VERTICES_PER_BACKGROUND, m_backgroundVertices.begin() + ( spanIndex + 1 ) * VERTICES_PER_BACKGROUND, VertexColorData2D() );
+	for( unsigned int i = 0; i < span.glyphRanges.size(); ++i )
+	{
+		GlyphRange& range = span.glyphRanges[ i ];
+		std::vector< VertexColorTextureData2D >& batchVertices = m_glyphBatches[ range.batchIndex ].vertices;
+		std::fill( batchVertices.begin() + range.firstVertex, batchVertices.begin() + range.firstVertex + range.numberOfVertices, VertexColorTextureData2D() );
+		range.numberOfVertices = 0;
+	}
+
+	span.layoutNumber = FREE_SPAN;
+	m_freeSpanIndices.push_back( spanIndex );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Copies the live spans down over the free ones once free slots outnumber them. Rare, so it
+//doesn't mind allocating.
+void TextBatch::CompactSpans()
+{
+	std::vector< TextSpan > liveSpans;
+	std::vector< VertexColorData2D > backgroundVertices;
+	std::vector< std::vector< VertexColorTextureData2D > > batchVertices( m_glyphBatches.size() );
+	m_spanIndicesByLayoutNumber.clear();
+
+	for( unsigned int spanIndex = 0; spanIndex < m_spans.size(); ++spanIndex )
+	{
+		TextSpan& span = m_spans[ spanIndex ];
+		if( span.layoutNumber == FREE_SPAN )
+			continue;
+
+		std::vector< VertexColorData2D >::const_iterator firstBackgroundVertex = m_backgroundVertices.begin() + spanIndex * VERTICES_PER_BACKGROUND;
+		backgroundVertices.insert( backgroundVertices.end(), firstBackgroundVertex, firstBackgroundVertex + VERTICES_PER_BACKGROUND );
+
+		for( unsigned int i = 0; i < span.glyphRanges.size(); ++i )
+		{
+			GlyphRange& range = span.glyphRanges[ i ];
+			std::vector< VertexColorTextureData2D >::const_iterator firstVertex = m_glyphBatches[ range.batchIndex ].vertices.begin() + range.firstVertex;
+
+			range.firstVertex = batchVertices[ range.batchIndex ].size();
+			range.capacity = range.numberOfVertices;
+			batchVertices[ range.batchIndex ].insert( batchVertices[ range.batchIndex ].end(), firstVertex, firstVertex + range.numberOfVertices );
+		}
+
+		m_spanIndicesByLayoutNumber.insert( std::make_pair( span.layoutNumber, static_cast< unsigned int >( liveSpans.size() ) ) );
+		liveSpans.push_back( span );
+	}
+
+	m_spans.swap( liveSpans );
+	m_backgroundVertices.swap( backgroundVertices );
+	for( unsigned int i = 0; i < m_glyphBatches.size(); ++i )
+		m_glyphBatches[ i ].vertices.swap( batchVertices[ i ] );
+	m_freeSpanIndices.clear();
+}
+#pragma endregion
+
+//-----------------------------------------------------------------------------------------------
+void TextBatch::AddText( const std::string& textString, const BitmapFont& font, float cellHeight, const FloatVector2& textStartLowerLeftCorner,
+						 const Color& textColor, const Color& backgroundColor, const Color& textShadowColor )
+{
+	const TextLayout& layout = CreateOrGetLayout( textString, font, cellHeight, textColor, backgroundColor, textShadowColor );
+	++m_numberOfSpansAdded;
+
+	unsigned int spanIndex = FindUnaddedSpanForLayout( layout.layoutNumber );
+	if( spanIndex < m_spans.size() )
+	{
+		const FloatVector2& previousCorner = m_spans[ spanIndex ].lowerLeftCorner;
+		if( previousCorner.x == textStartLowerLeftCorner.x && previousCorner.y == textStartLowerLeftCorner.y )
+			++s_statisticsThisFrame.spansKept;
+		else
+		{
+			WriteSpan( spanIndex, layout, textStartLowerLeftCorner );
+			++s_statisticsThisFrame.spansMoved;
+		}
+	}
+	else
+	{
+		spanIndex = AllocateSpanForLayout( layout );
+		WriteSpan( spanIndex, layout, textStartLowerLeftCorner );
+		m_spanIndicesByLayoutNumber.insert( std::make_pair( layout.layoutNumber, spanIndex ) );
+		++s_statisticsThisFrame.spansWritten;
+	}
+	m_spans[ spanIndex ].lastRecordingAdded = m_recordingNumber;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Keeps the vectors' capacity, so a batch reused every frame stops allocating once it has warmed up.
+void TextBatch::Clear()
+{
+	m_backgroundVertices.clear();
+	for( unsigned int i = 0; i < m_glyphBatches.size(); ++i )
+		m_glyphBatches[ i ].vertices.clear();
+	m_spans.clear();
+	m_spanIndicesByLayoutNumber.clear();
+	m_freeSpanIndices.clear();
+	m_numberOfSpansAdded = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Glyphs go one layer above the backgrounds so sorting can never put a background over text.
+//Strings that weren't added again since the last recording are dropped from the arrays here.
+void TextBatch::RecordInto( RenderCommandBuffer& commandBuffer, unsigned char backgroundLayer )
+{
+	static const RenderCommandBuffer::VertexInput BACKGROUND_INPUTS[] =
+	{
+		{ -1, Renderer::VERTEX_ARRAYS, 2, Renderer::FLOAT_TYPE, false, offsetof( VertexColorData2D, x ) },
+		{ -1, Renderer::COLOR_ARRAYS,  4, Renderer::FLOAT_TYPE, false, offsetof( VertexColorData2D, red ) }
+	};
+	static const RenderCommandBuffer::VertexInput GLYPH_INPUTS[] =
+	{
+		{ -1, Renderer::VERTEX_ARRAYS,		  2, Renderer::FLOAT_TYPE, false, offsetof( VertexColorTextureData2D, x ) },
+		{ -1, Renderer::COLOR_ARRAYS,		  4, Renderer::FLOAT_TYPE, false, offsetof( VertexColorTextureData2D, red ) },
+		{ -1, Renderer::TEXTURE_COORD_ARRAYS, 2, Renderer::FLOAT_TYPE, false, offsetof( VertexColorTextureData2D, u ) }
+	};
+
+	for( unsigned int i = 0; i < m_spans.size(); ++i )
+	{
+		if( m_spans[ i ].layoutNumber != FREE_SPAN && m_spans[ i ].lastRecordingAdded != m_recordingNumber )
+			FreeSpan( i );
+	}
+	if( 2 * m_freeSpanIndices.size() > m_spans.size() )
+		CompactSpans();
+
+	bool hasText = !IsEmpty();
+	++m_recordingNumber;
+	m_numberOfSpansAdded = 0;
+	if( !hasText )
+		return;
+
+	RenderCommandBuffer::DrawState backgroundState;
+	backgroundState.layer = backgroundLayer;
+	commandBuffer.RecordDraw( backgroundState, Renderer::TRIANGLES, m_backgroundVertices.size(), sizeof( VertexColorData2D ),
+							  BACKGROUND_INPUTS, 2, &m_backgroundVertices[ 0 ] );
+
+	for( unsigned int i = 0; i < m_glyphBatches.size(); ++i )
+	{
+		const SheetBatch& batch = m_glyphBatches[ i ];
+		if( batch.vertices.empty() )
+			continue;
+
+		RenderCommandBuffer::DrawState glyphState = backgroundState;
+		glyphState.layer = static_cast< unsigned char >( backgroundLayer + 1 );
+		glyphState.texture = batch.sheet;
+		commandBuffer.RecordDraw( glyphState, Renderer::TRIANGLES, batch.vertices.size(), sizeof( VertexColorTextureData2D ),
+								  GLYPH_INPUTS, 3, &batch.vertices[ 0 ] );
+	}
+}
@@ -0,0 +1,157 @@
+#ifndef INCLUDED_TEXT_BATCH_HPP
+#define INCLUDED_TEXT_BATCH_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <map>
+#include <string>
+#include <vector>
+#include "../Font/BitmapFont.hpp"
+#include "../Math/FloatVector2.hpp"
+#include "../Color.hpp"
+#include "../StringID.hpp"
+#include "RenderCommandBuffer.hpp"
+#include "VertexDataContainers.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Gathers strings into one background draw and one glyph draw per font atlas sheet. Each distinct
+//string, font, size and color combination is laid out once and its glyph quads kept across frames.
+//The batch's combined vertex arrays are kept between recordings too: a string added again costs
+//nothing if it hasn't moved and an offset of its own vertices if it has, and only strings that
+//weren't in the last recording are written. Strings are kept in slots rather than in the order
+//they were added, so every background is drawn before any glyph and strings on the same layer may
+//overlap each other in any order.
+//-----------------------------------------------------------------------------------------------
+class TextBatch
+{
+public:
+	struct CacheStatistics
+	{
+		unsigned int layoutsBuilt;
+		unsigned int layoutsReused;
+		unsigned int layoutsEvicted;
+		unsigned int layoutsCached;
+		unsigned int spansKept;
+		unsigned int spansMoved;
+		unsigned int spansWritten;
+
+		CacheStatistics()
+			: layoutsBuilt( 0 )
+			, layoutsReused( 0 )
+			, layoutsEvicted( 0 )
+			, layoutsCached( 0 )
+			, spansKept( 0 )
+			, spansMoved( 0 )
+			, spansWritten( 0 )
+		{ }
+	};
+
+private:
+	static const unsigned int FRAMES_TO_KEEP_UNUSED_LAYOUTS = 120;
+
+	struct SheetGlyphs
+	{
+		unsigned int sheetNumber;
+		std::vector< VertexColorTextureData2D > vertices;
+	};
+
+	//Everything is laid out from a lower left corner at the origin and offset when added.
+	struct TextLayout
+	{
+		std::string textString;
+		const BitmapFont* font;
+		float cellHeight;
+		Color textColor;
+		Color backgroundColor;
+		Color shadowColor;
+
+		float width;
+		std::vector< SheetGlyphs > glyphsPerSheet; //Each string's shadow is laid out ahead of its text.
+		unsigned int lastFrameUsed;
+		unsigned int layoutNumber; //New every time it's laid out, so batches can tell a rebuilt layout apart
+
+		TextLayout()
+			: font( nullptr )
+			, cellHeight( 0.f )
+			, width( 0.f )
+			, lastFrameUsed( 0 )
+			, layoutNumber( 0 )
+		{ }
+	};
+
+	struct SheetBatch
+	{
+		const Texture* sheet;
+		std::vector< VertexColorTextureData2D > vertices;
+	};
+
+	struct GlyphRange
+	{
+		unsigned int batchIndex;
+		unsigned int firstVertex;
+		unsigned int numberOfVertices;
+		unsigned int capacity;
+	};
+
+	//A slot in the combined arrays holding one string: six background vertices at six times its index
+	//and a range of glyph vertices in each sheet batch it uses. Free slots are left as zero-area quads.
+	struct TextSpan
+	{
+		unsigned int layoutNumber; //0 when the slot is free
+		FloatVector2 lowerLeftCorner;
+		unsigned int lastRecordingAdded;
+		std::vector< GlyphRange > glyphRanges;
+	};
+
+	static const unsigned int FREE_SPAN = 0;
+	static const unsigned int VERTICES_PER_BACKGROUND = 6;
+
+	static std::map< StringID, TextLayout > s_layoutCache;
+	static unsigned int s_frameNumber;
+	static unsigned int s_nextLayoutNumber;
+	static CacheStatistics s_statisticsThisFrame;
+	static CacheStatistics s_statisticsLastFrame;
+
+	std::vector< VertexColorData2D > m_backgroundVertices;
+	std::vector< SheetBatch > m_glyphBatches;
+	std::vector< TextSpan > m_spans;
+	std::multimap< unsigned int, unsigned int > m_spanIndicesByLayoutNumber;
+	std::vector< unsigned int > m_freeSpanIndices;
+	unsigned int m_recordingNumber;
+	unsigned int m_numberOfSpansAdded;
+
+	static StringID BuildLayoutKey( const std::string& textString, const BitmapFont& font, float cellHeight,
+									const Color& textColor, const Color& backgroundColor, const Color& shadowColor );
+	static const TextLayout& CreateOrGetLayout( const std::string& textString, const BitmapFont& font, float cellHeight,
+												const Color& textColor, const Color& backgroundColor, const Color& shadowColor );
+	static void LayOutGlyphs( TextLayout& out_layout, const std::vector< float >& penPositions, const FloatVector2& lowerLeftCorner, const Color& color );
+
+	unsigned int GetBatchIndexForSheet( const Texture* sheet );
+	unsigned int FindUnaddedSpanForLayout( unsigned int layoutNumber ) const;
+	unsigned int AllocateSpanForLayout( const TextLayout& layout );
+	bool SpanHasRoomForLayout( const TextSpan& span, const TextLayout& layout );
+	void WriteSpan( unsigned int spanIndex, const TextLayout& layout, const FloatVector2& lowerLeftCorner );
+	void FreeSpan( unsigned int spanIndex );
+	void CompactSpans();
+
+	//We have no need of a pithy assignment or copy operator!
+	TextBatch( const TextBatch& );
+	void operator=( const TextBatch& );
+
+public:
+	TextBatch()
+		: m_recordingNumber( 1 )
+		, m_numberOfSpansAdded( 0 )
+	{ }
+
+	static void EndFrame();
+	static const CacheStatistics& GetLastFrameStatistics() { return s_statisticsLastFrame; }
+
+	void AddText( const std::string& textString, const BitmapFont& font, float cellHeight, const FloatVector2& textStartLowerLeftCorner,
+				  const Color& textColor = Color( 1.f, 1.f, 1.f, 1.f ), const Color& backgroundColor = Color( 0.f, 0.f, 0.f, 0.f ), const Color& textShadowColor = Color( 0.f, 0.f, 0.f, 0.f ) );
+	void Clear();
+	bool IsEmpty() const { return m_numberOfSpansAdded == 0; }
+	void RecordInto( RenderCommandBuffer& commandBuffer, unsigned char backgroundLayer = 0 );
+};
+
+#endif //INCLUDED_TEXT_BATCH_HPP
@@ -11,13 +11,13 @@
 class Texture
 {
 public:
-	static enum FilteringMethod
+	enum FilteringMethod
 	{
 		nearestNeighbor		= 0,
 		linearInterpolation = 1
 	};
 
-	static enum WrappingMode
+	enum WrappingMode
 	{
 		clampToEdge			= 0,
 		repeatOverGeometry  = 1
@@ -10,7 +10,7 @@ class Keyboard
 {
 	static const unsigned int NUMBER_OF_KEYS = 256;
 public:
-	static enum Key
+	enum Key
 	{
 		A = 'A',
 		B = 'B',
@@ -10,7 +10,7 @@ class Mouse
 {
 	static const unsigned int NUMBER_OF_BUTTONS = 7;
 public:
-	static enum Button
+	enum Button
 	{
 		LEFT_BUTTON = 1,
 		RIGHT_BUTTON = 2,
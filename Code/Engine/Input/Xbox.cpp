@@ -1,4 +1,5 @@
 #include <math.h>
+#include <string.h>
 #include "../Math/EngineMath.hpp"
 #include "../Math/FloatVector2.hpp"
 #include "Xbox.hpp"
@@ -26,8 +27,10 @@ Xbox::Controller::Controller()
 	, m_lastLeftTrigger( m_currentLeftTrigger )
 	, m_lastRightTrigger( m_currentRightTrigger )
 {
+#if defined( _WIN32 )
 	memset( &m_controllerState, 0, sizeof( m_controllerState ) );
 	memset( &m_vibration, 0, sizeof(XINPUT_VIBRATION) );
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -40,8 +43,10 @@ Xbox::Controller::Controller( PadNumber padNumber )
 	, m_lastLeftTrigger( m_currentLeftTrigger )
 	, m_lastRightTrigger( m_currentRightTrigger )
 {
+#if defined( _WIN32 )
 	memset( &m_controllerState, 0, sizeof( m_controllerState ) );
 	memset( &m_vibration, 0, sizeof(XINPUT_VIBRATION) );
+#endif
 }
 
 //----------------------------------------------------------------------------------------------------
@@ -176,6 +181,7 @@ void Xbox::Controller::Update( float deltaSeconds )
 		m_vibrationTimeSeconds = 0.f;
 		this->Vibrate( 0.f, 0.f, 0.f );
 	}
+#if defined( _WIN32 )
 	DWORD errorStatus = XInputGetState( m_padNumber, &m_controllerState );
 
 	if( errorStatus != ERROR_SUCCESS )
@@ -194,15 +200,19 @@ void Xbox::Controller::Update( float deltaSeconds )
 	m_currentLeftTrigger *= TRIGGER_NORMALIZER;
 	m_currentRightTrigger = m_controllerState.Gamepad.bRightTrigger;
 	m_currentRightTrigger *= TRIGGER_NORMALIZER;
+#endif //No XInput off Windows, so the pad simply reads as disconnected.
 }
 
 //----------------------------------------------------------------------------------------------------
 void Xbox::Controller::Vibrate( float leftIntensityZeroToOne, float rightIntensityZeroToOne, float durationSeconds )
 {
+	m_vibrationTimeSeconds = durationSeconds;
+
+#if defined( _WIN32 )
 	m_vibration.wLeftMotorSpeed = static_cast< WORD >( leftIntensityZeroToOne * VIBRATION_MAXIMUM ); 
 	m_vibration.wRightMotorSpeed = static_cast< WORD >( rightIntensityZeroToOne * VIBRATION_MAXIMUM ); 
-	m_vibrationTimeSeconds = durationSeconds;
 
 	//Vibrate the controller 
 	XInputSetState( m_padNumber, &m_vibration ); 
+#endif
 }
\ No newline at end of file
@@ -3,18 +3,19 @@
 #pragma once
 
 //----------------------------------------------------------------------------------------------------
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
-#include <Xinput.h>
+#if defined( _WIN32 )
+	#define WIN32_LEAN_AND_MEAN
+	#include <windows.h>
+	#include <Xinput.h>
+	#pragma comment( lib, "xinput" ) // Link in the xinput.lib static library
+#endif
 #include "../Math/FloatVector2.hpp"
 
-#pragma comment( lib, "xinput" ) // Link in the xinput.lib static library
-
 //----------------------------------------------------------------------------------------------------
 namespace Xbox
 {
 	//----------------------------------------------------------------------------------------------------
-	static enum Button
+	enum Button
 	{
 		NONE = 0,
 		DPAD_UP = 0x1,
@@ -34,14 +35,14 @@ namespace Xbox
 	};
 
 	//----------------------------------------------------------------------------------------------------
-	static enum Stick
+	enum Stick
 	{
 		LEFT_STICK = 0,
 		RIGHT_STICK = 1
 	};
 
 	//----------------------------------------------------------------------------------------------------
-	static enum Trigger
+	enum Trigger
 	{
 		LEFT_TRIGGER  = 1,
 		RIGHT_TRIGGER = 2
@@ -69,10 +70,12 @@ namespace Xbox
 		static const unsigned int	VIBRATION_MAXIMUM = 65535;
 
 		PadNumber			m_padNumber;
+#if defined( _WIN32 )
 		XINPUT_STATE		m_controllerState;
 		XINPUT_VIBRATION	m_vibration;
+#endif
 		float				m_vibrationTimeSeconds;
-		WORD m_currentButtonState, m_lastButtonState;
+		unsigned short m_currentButtonState, m_lastButtonState;
 		FloatVector2 m_leftStick, m_rightStick;
 		float m_currentLeftTrigger, m_currentRightTrigger;
 		float m_lastLeftTrigger, m_lastRightTrigger;
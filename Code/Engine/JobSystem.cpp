@@ -0,0 +1,285 @@
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+#include "JobSystem.hpp"
+#include "TraceRecorder.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Lives on the stack of the thread calling ParallelFor, which doesn't return until every worker
+//that picked it up has let go of it.
+struct ParallelForJob
+{
+	const JobSystem::ChunkFunction* function;
+	unsigned int numberOfItems;
+	unsigned int numberOfChunks;
+	std::atomic< unsigned int > nextChunk;
+	std::atomic< unsigned int > chunksCompleted;
+	unsigned int workersInside; //Guarded by g_jobLock
+};
+
+//-----------------------------------------------------------------------------------------------
+class JobSystem::BackgroundJob
+{
+public:
+	BackgroundFunction function;
+	bool isFinished; //Guarded by g_jobLock
+
+	explicit BackgroundJob( const BackgroundFunction& backgroundFunction )
+		: function( backgroundFunction )
+		, isFinished( false )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+//More chunks than threads lets a thread that finishes early take work from one that's slow.
+static const unsigned int CHUNKS_PER_THREAD = 4;
+
+static std::vector< std::thread > g_workerThreads;
+static std::mutex g_driverLock; //Held by the thread driving the pool's ParallelFor, and while resizing the pool
+static std::mutex g_jobLock;
+static std::condition_variable g_jobStarted;
+static std::condition_variable g_workerLeftJob;
+static std::condition_variable g_backgroundJobFinished;
+static std::deque< JobSystem::BackgroundJobHandle > g_queuedBackgroundJobs; //Guarded by g_jobLock
+static ParallelForJob* g_currentJob = nullptr;
+static unsigned long long g_jobGeneration = 0;
+static bool g_workersShouldExit = false;
+static std::atomic< unsigned int > g_numberOfThreads( 1 );
+static thread_local bool t_isRunningChunks = false;
+
+//-----------------------------------------------------------------------------------------------
+static void RunChunks( ParallelForJob& job )
+{
+	bool wasRunningChunks = t_isRunningChunks;
+	t_isRunningChunks = true;
+	for( ;; )
+	{
+		unsigned int chunkIndex = job.nextChunk.fetch_add( 1, std::memory_order_relaxed );
+		if( chunkIndex >= job.numberOfChunks )
+			break;
+
+		//Spread the remainder over the chunks, so none is ever empty while there are at least as many items
+		unsigned int firstItem = static_cast< unsigned int >( static_cast< unsigned long long >( chunkIndex ) * job.numberOfItems / job.numberOfChunks );
+		unsigned int endItem = static_cast< unsigned int >( static_cast< unsigned long long >( chunkIndex + 1 ) * job.numberOfItems / job.numberOfChunks );
+
+		( *job.function )( chunkIndex, firstItem, endItem );
+		job.chunksCompleted.fetch_add( 1, std::memory_order_release );
+	}
+	t_isRunningChunks = wasRunningChunks;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Expects g_jobLock held by jobLock, and holds it again on return.
+static void RunBackgroundJob( JobSystem::BackgroundJob& job, std::unique_lock< std::mutex >& jobLock )
+{
+	jobLock.unlock();
+	job.function();
+	jobLock.lock();
+
+	job.isFinished = true;
+	g_backgroundJobFinished.notify_all();
+}
+
+//-----------------------------------------------------------------------------------------------
+static void RunWorkerThread( unsigned int workerIndex )
+{
+	std::ostringstream threadName;
+	threadName << "Job Worker " << workerIndex;
+	TraceRecorder::SetCurrentThreadName( threadName.str() );
+
+	std::unique_lock< std::mutex > jobLock( g_jobLock );
+	unsigned long long lastJobGenerationSeen = g_jobGeneration;
+	for( ;; )
+	{
+		while( !g_workersShouldExit && g_jobGeneration == lastJobGenerationSeen && g_queuedBackgroundJobs.empty() )
+			g_jobStarted.wait( jobLock );
+		if( g_workersShouldExit )
+			return;
+
+		//Someone is blocked on a ParallelFor, so that comes before anything queued
+		if( g_jobGeneration == lastJobGenerationSeen )
+		{
+			JobSystem::BackgroundJobHandle backgroundJob = g_queuedBackgroundJobs.front();
+			g_queuedBackgroundJobs.pop_front();
+			RunBackgroundJob( *backgroundJob, jobLock );
+			continue;
+		}
+
+		lastJobGenerationSeen = g_jobGeneration;
+		ParallelForJob* job = g_currentJob;
+		if( job == nullptr )
+			continue; //Woke up after the job had already finished
+
+		++job->workersInside;
+		jobLock.unlock();
+		RunChunks( *job );
+		jobLock.lock();
+
+		--job->workersInside;
+		if( job->workersInside == 0 )
+			g_workerLeftJob.notify_all();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void JobSystem::SetNumberOfThreads( unsigned int numberOfThreads )
+{
+	if( numberOfThreads < 1 )
+		numberOfThreads = 1;
+	if( numberOfThreads > MAXIMUM_NUMBER_OF_THREADS )
+		numberOfThreads = MAXIMUM_NUMBER_OF_THREADS;
+
+	std::lock_guard< std::mutex > driverLock( g_driverLock );
+	{
+		std::lock_guard< std::mutex > jobLock( g_jobLock );
+		g_workersShouldExit = true;
+	}
+	g_jobStarted.notify_all();
+	for( unsigned int i = 0; i < g_workerThreads.size(); ++i )
+		g_workerThreads[ i ].join();
+	g_workerThreads.clear();
+
+	g_workersShouldExit = false;
+	g_numberOfThreads = numberOfThreads;
+	for( unsigned int i = 1; i < numberOfThreads; ++i )
+		g_workerThreads.push_back( std::thread( RunWorkerThread, i ) );
+
+	//Nobody is left to pick up queued jobs, so finish them here
+	if( numberOfThreads == 1 )
+	{
+		std::unique_lock< std::mutex > jobLock( g_jobLock );
+		while( !g_queuedBackgroundJobs.empty() )
+		{
+			BackgroundJobHandle backgroundJob = g_queuedBackgroundJobs.front();
+			g_queuedBackgroundJobs.pop_front();
+			RunBackgroundJob( *backgroundJob, jobLock );
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int JobSystem::GetNumberOfThreads()
+{
+	return g_numberOfThreads;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int JobSystem::GetNumberOfHardwareThreads()
+{
+	unsigned int numberOfHardwareThreads = std::thread::hardware_concurrency();
+	return ( numberOfHardwareThreads == 0 ) ? 1 : numberOfHardwareThreads;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int JobSystem::CalculateNumberOfChunks( unsigned int numberOfItems, unsigned int minimumItemsPerChunk )
+{
+	if( numberOfItems == 0 )
+		return 0;
+	if( minimumItemsPerChunk == 0 )
+		minimumItemsPerChunk = 1;
+
+	unsigned int numberOfChunks = ( numberOfItems + minimumItemsPerChunk - 1 ) / minimumItemsPerChunk;
+	unsigned int numberOfThreads = g_numberOfThreads.load( std::memory_order_relaxed );
+	unsigned int maximumNumberOfChunks = ( numberOfThreads == 1 || t_isRunningChunks ) ? 1 : numberOfThreads * CHUNKS_PER_THREAD;
+	if( numberOfChunks > maximumNumberOfChunks )
+		numberOfChunks = maximumNumberOfChunks;
+	return numberOfChunks;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void JobSystem::ParallelFor( unsigned int numberOfItems, unsigned int numberOfChunks, const ChunkFunction& function )
+{
+	if( numberOfItems == 0 || numberOfChunks == 0 )
+		return;
+	if( numberOfChunks > numberOfItems )
+		numberOfChunks = numberOfItems;
+
+	ParallelForJob job;
+	job.function = &function;
+	job.numberOfItems = numberOfItems;
+	job.numberOfChunks = numberOfChunks;
+	job.nextChunk.store( 0, std::memory_order_relaxed );
+	job.chunksCompleted.store( 0, std::memory_order_relaxed );
+	job.workersInside = 0;
+
+	if( numberOfChunks == 1 )
+	{
+		RunChunks( job );
+		return;
+	}
+
+	//The pool is busy with another thread's loop (or being resized), so do this one alone
+	std::unique_lock< std::mutex > driverLock( g_driverLock, std::try_to_lock );
+	if( !driverLock.owns_lock() )
+	{
+		RunChunks( job );
+		return;
+	}
+
+	{
+		std::lock_guard< std::mutex > jobLock( g_jobLock );
+		g_currentJob = &job;
+		++g_jobGeneration;
+	}
+	g_jobStarted.notify_all();
+
+	RunChunks( job );
+
+	//Stop late wakers from picking the job up, then wait out anyone still inside it
+	std::unique_lock< std::mutex > jobLock( g_jobLock );
+	g_currentJob = nullptr;
+	while( job.workersInside > 0 || job.chunksCompleted.load( std::memory_order_acquire ) < numberOfChunks )
+		g_workerLeftJob.wait( jobLock );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC JobSystem::BackgroundJobHandle JobSystem::RunInBackground( const BackgroundFunction& function )
+{
+	BackgroundJobHandle job = std::make_shared< BackgroundJob >( function );
+
+	//Checked under the lock, so a job queued while the pool shrinks to one thread is still drained
+	std::unique_lock< std::mutex > jobLock( g_jobLock );
+	if( g_numberOfThreads == 1 )
+	{
+		RunBackgroundJob( *job, jobLock );
+		return job;
+	}
+
+	g_queuedBackgroundJobs.push_back( job );
+	jobLock.unlock();
+	g_jobStarted.notify_one();
+	return job;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool JobSystem::IsFinished( const BackgroundJobHandle& job )
+{
+	std::lock_guard< std::mutex > jobLock( g_jobLock );
+	return job->isFinished;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void JobSystem::WaitFor( const BackgroundJobHandle& job )
+{
+	std::unique_lock< std::mutex > jobLock( g_jobLock );
+	if( job->isFinished )
+		return;
+
+	//Rather than wait on a job nobody has started, take it out of the queue and run it here
+	for( std::deque< BackgroundJobHandle >::iterator queuedJob = g_queuedBackgroundJobs.begin(); queuedJob != g_queuedBackgroundJobs.end(); ++queuedJob )
+	{
+		if( *queuedJob == job )
+		{
+			g_queuedBackgroundJobs.erase( queuedJob );
+			RunBackgroundJob( *job, jobLock );
+			return;
+		}
+	}
+
+	while( !job->isFinished )
+		g_backgroundJobFinished.wait( jobLock );
+}
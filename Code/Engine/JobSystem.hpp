@@ -0,0 +1,48 @@
+#ifndef INCLUDED_JOB_SYSTEM_HPP
+#define INCLUDED_JOB_SYSTEM_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <functional>
+#include <memory>
+#include "EngineDefines.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A fixed pool of worker threads for splitting loops whose iterations don't touch each other.
+//ParallelFor cuts the range into chunks which the workers and the calling thread claim one at a
+//time, and returns once every chunk is done. Any thread may call it, but the pool serves one
+//ParallelFor at a time: one started while another is in progress, or from inside one, runs inline.
+//Background jobs are queued for whichever worker is free next, for work the caller picks up later;
+//waiting on one that no worker has claimed yet runs it on the waiting thread instead.
+//-----------------------------------------------------------------------------------------------
+STATIC class JobSystem
+{
+public:
+	typedef std::function< void( unsigned int chunkIndex, unsigned int firstItem, unsigned int endItem ) > ChunkFunction;
+	typedef std::function< void() > BackgroundFunction;
+
+	class BackgroundJob;
+	typedef std::shared_ptr< BackgroundJob > BackgroundJobHandle;
+
+	static const unsigned int MAXIMUM_NUMBER_OF_THREADS = 64;
+
+	//Counts the calling thread, so 1 (the default) runs everything inline with no workers at all.
+	//Waits for any ParallelFor in progress to finish first.
+	static void SetNumberOfThreads( unsigned int numberOfThreads );
+	static unsigned int GetNumberOfThreads();
+	static unsigned int GetNumberOfHardwareThreads();
+	static void Shutdown() { SetNumberOfThreads( 1 ); }
+
+	//Callers size any per-chunk results (partial sums, bounds) from this, then hand the same count to
+	//ParallelFor, whose chunk indices run from 0 to numberOfChunks - 1. Passing the count along keeps
+	//the two in step even if the thread count changes in between.
+	static unsigned int CalculateNumberOfChunks( unsigned int numberOfItems, unsigned int minimumItemsPerChunk );
+	static void ParallelFor( unsigned int numberOfItems, unsigned int numberOfChunks, const ChunkFunction& function );
+
+	//With no workers the function runs before this returns.
+	static BackgroundJobHandle RunInBackground( const BackgroundFunction& function );
+	static bool IsFinished( const BackgroundJobHandle& job );
+	static void WaitFor( const BackgroundJobHandle& job );
+};
+
+#endif //INCLUDED_JOB_SYSTEM_HPP
@@ -3,6 +3,7 @@
 #pragma once
 
 //----------------------------------------------------------------------------------------------------
+#include <algorithm>
 #include <cstdlib>
 #include <math.h>
 #include "FloatVector2.hpp"
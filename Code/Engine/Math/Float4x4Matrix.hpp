@@ -3,17 +3,262 @@
 #pragma once
 
 //-----------------------------------------------------------------------------------------------
+#include "FloatVector3.hpp"
 #include "Matrix.hpp"
 
+//Every x86 target we build for has SSE, so the specializations below only fall back to the
+//loops on other processors.
+#if defined( __SSE__ ) || defined( _M_X64 ) || defined( _M_IX86 )
+#define FLOAT_4X4_MATRIX_USE_SSE
+#include "FloatVector3A.hpp"
+#endif
+
 //-----------------------------------------------------------------------------------------------
 typedef Matrix< float, 4, 4 > Float4x4Matrix;
 
 //-----------------------------------------------------------------------------------------------
-static const float F4X4_IDENTITY_ARRAY[ 16 ] = { 1.f, 0.f, 0.f, 0.f, 
-												0.f, 1.f, 0.f, 0.f, 
+static const float F4X4_IDENTITY_ARRAY[ 16 ] = { 1.f, 0.f, 0.f, 0.f,
+												0.f, 1.f, 0.f, 0.f,
 												0.f, 0.f, 1.f, 0.f,
 												0.f, 0.f, 0.f, 1.f };
 
 static const Float4x4Matrix F4X4_IDENTITY_MATRIX = Float4x4Matrix( F4X4_IDENTITY_ARRAY );
 
+
+
+#pragma region Scalar Versions
+//-----------------------------------------------------------------------------------------------
+//These matrices hold one row per basis axis and the translation in the last row ([12], [13], [14]),
+//so a point is transformed as the row vector ( x, y, z, 1 ) times the matrix.
+inline Float4x4Matrix CalculateAffineInverseWithLoops( const Float4x4Matrix& matrix )
+{
+	const float* m = matrix.GetRawBuffer();
+
+	//The inverse of the upper 3x3 is its cofactors over the determinant, stored here already transposed
+	float inverseLinear[ 9 ];
+	inverseLinear[ 0 ] = m[ 5 ] * m[ 10 ] - m[ 6 ] * m[ 9 ];
+	inverseLinear[ 1 ] = m[ 2 ] * m[ 9 ] - m[ 1 ] * m[ 10 ];
+	inverseLinear[ 2 ] = m[ 1 ] * m[ 6 ] - m[ 2 ] * m[ 5 ];
+	inverseLinear[ 3 ] = m[ 6 ] * m[ 8 ] - m[ 4 ] * m[ 10 ];
+	inverseLinear[ 4 ] = m[ 0 ] * m[ 10 ] - m[ 2 ] * m[ 8 ];
+	inverseLinear[ 5 ] = m[ 2 ] * m[ 4 ] - m[ 0 ] * m[ 6 ];
+	inverseLinear[ 6 ] = m[ 4 ] * m[ 9 ] - m[ 5 ] * m[ 8 ];
+	inverseLinear[ 7 ] = m[ 1 ] * m[ 8 ] - m[ 0 ] * m[ 9 ];
+	inverseLinear[ 8 ] = m[ 0 ] * m[ 5 ] - m[ 1 ] * m[ 4 ];
+
+	float determinant = m[ 0 ] * inverseLinear[ 0 ] + m[ 1 ] * inverseLinear[ 3 ] + m[ 2 ] * inverseLinear[ 6 ];
+	assert( determinant != 0.f );
+	float inverseDeterminant = 1.f / determinant;
+
+	Float4x4Matrix result;
+	for( unsigned int row = 0; row < 3; ++row )
+	{
+		for( unsigned int column = 0; column < 3; ++column )
+			result[ row * 4 + column ] = inverseLinear[ row * 3 + column ] * inverseDeterminant;
+	}
+
+	for( unsigned int column = 0; column < 3; ++column )
+	{
+		result[ 12 + column ] = -( m[ 12 ] * result[ column ] + m[ 13 ] * result[ 4 + column ] + m[ 14 ] * result[ 8 + column ] );
+	}
+	result[ 15 ] = 1.f;
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void TransformPointsWithLoops( const Float4x4Matrix& matrix, const FloatVector3* points, FloatVector3* out_points, unsigned int numberOfPoints )
+{
+	const float* m = matrix.GetRawBuffer();
+	for( unsigned int i = 0; i < numberOfPoints; ++i )
+	{
+		FloatVector3 point = points[ i ];
+		out_points[ i ].x = point.x * m[ 0 ] + point.y * m[ 4 ] + point.z * m[ 8 ]  + m[ 12 ];
+		out_points[ i ].y = point.x * m[ 1 ] + point.y * m[ 5 ] + point.z * m[ 9 ]  + m[ 13 ];
+		out_points[ i ].z = point.x * m[ 2 ] + point.y * m[ 6 ] + point.z * m[ 10 ] + m[ 14 ];
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void TransformVectorsWithLoops( const Float4x4Matrix& matrix, const FloatVector3* vectors, FloatVector3* out_vectors, unsigned int numberOfVectors )
+{
+	const float* m = matrix.GetRawBuffer();
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+	{
+		FloatVector3 vector = vectors[ i ];
+		out_vectors[ i ].x = vector.x * m[ 0 ] + vector.y * m[ 4 ] + vector.z * m[ 8 ];
+		out_vectors[ i ].y = vector.x * m[ 1 ] + vector.y * m[ 5 ] + vector.z * m[ 9 ];
+		out_vectors[ i ].z = vector.x * m[ 2 ] + vector.y * m[ 6 ] + vector.z * m[ 10 ];
+	}
+}
+#pragma endregion
+
+
+
+#ifdef FLOAT_4X4_MATRIX_USE_SSE
+#pragma region SSE Versions
+//-----------------------------------------------------------------------------------------------
+//Row i of u * v is the rows of v weighted by the entries of row i of u, so each result row is four
+//broadcast multiply-adds. Loads and stores are unaligned since matrices live wherever they like.
+template<>
+inline Float4x4Matrix operator*< float, 4, 4, 4 >( const Float4x4Matrix& u, const Float4x4Matrix& v )
+{
+	const float* uData = u.GetRawBuffer();
+	const float* vData = v.GetRawBuffer();
+	__m128 vRow0 = _mm_loadu_ps( vData );
+	__m128 vRow1 = _mm_loadu_ps( vData + 4 );
+	__m128 vRow2 = _mm_loadu_ps( vData + 8 );
+	__m128 vRow3 = _mm_loadu_ps( vData + 12 );
+
+	Float4x4Matrix result;
+	float* resultData = &result[ 0 ];
+	for( unsigned int row = 0; row < 4; ++row )
+	{
+		const float* uRow = uData + row * 4;
+		__m128 resultRow = _mm_mul_ps( _mm_set1_ps( uRow[ 0 ] ), vRow0 );
+		resultRow = _mm_add_ps( resultRow, _mm_mul_ps( _mm_set1_ps( uRow[ 1 ] ), vRow1 ) );
+		resultRow = _mm_add_ps( resultRow, _mm_mul_ps( _mm_set1_ps( uRow[ 2 ] ), vRow2 ) );
+		resultRow = _mm_add_ps( resultRow, _mm_mul_ps( _mm_set1_ps( uRow[ 3 ] ), vRow3 ) );
+		_mm_storeu_ps( resultData + row * 4, resultRow );
+	}
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+template<>
+inline Float4x4Matrix Transpose< float, 4, 4 >( const Float4x4Matrix& u )
+{
+	const float* uData = u.GetRawBuffer();
+	__m128 row0 = _mm_loadu_ps( uData );
+	__m128 row1 = _mm_loadu_ps( uData + 4 );
+	__m128 row2 = _mm_loadu_ps( uData + 8 );
+	__m128 row3 = _mm_loadu_ps( uData + 12 );
+	_MM_TRANSPOSE4_PS( row0, row1, row2, row3 );
+
+	Float4x4Matrix result;
+	float* resultData = &result[ 0 ];
+	_mm_storeu_ps( resultData, row0 );
+	_mm_storeu_ps( resultData + 4, row1 );
+	_mm_storeu_ps( resultData + 8, row2 );
+	_mm_storeu_ps( resultData + 12, row3 );
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+//( y, z, x ) rotation of each lane, for cross products.
+inline __m128 RotateLanesYZX( __m128 vector )
+{
+	return _mm_shuffle_ps( vector, vector, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Valid for any affine matrix (rotation, scale, shear and translation), not just rigid ones.
+inline Float4x4Matrix CalculateAffineInverse( const Float4x4Matrix& matrix )
+{
+	const float* m = matrix.GetRawBuffer();
+	__m128 row0 = _mm_loadu_ps( m );
+	__m128 row1 = _mm_loadu_ps( m + 4 );
+	__m128 row2 = _mm_loadu_ps( m + 8 );
+	__m128 translation = _mm_loadu_ps( m + 12 );
+
+	//Cross products of row pairs are the rows of the cofactor matrix
+	__m128 row0YZX = RotateLanesYZX( row0 );
+	__m128 row1YZX = RotateLanesYZX( row1 );
+	__m128 row2YZX = RotateLanesYZX( row2 );
+	__m128 cofactor0 = RotateLanesYZX( _mm_sub_ps( _mm_mul_ps( row1, row2YZX ), _mm_mul_ps( row1YZX, row2 ) ) );
+	__m128 cofactor1 = RotateLanesYZX( _mm_sub_ps( _mm_mul_ps( row2, row0YZX ), _mm_mul_ps( row2YZX, row0 ) ) );
+	__m128 cofactor2 = RotateLanesYZX( _mm_sub_ps( _mm_mul_ps( row0, row1YZX ), _mm_mul_ps( row0YZX, row1 ) ) );
+
+	__m128 determinantProducts = _mm_mul_ps( row0, cofactor0 );
+	float determinantTerms[ 4 ];
+	_mm_storeu_ps( determinantTerms, determinantProducts );
+	float determinant = determinantTerms[ 0 ] + determinantTerms[ 1 ] + determinantTerms[ 2 ];
+	assert( determinant != 0.f );
+	__m128 inverseDeterminant = _mm_set1_ps( 1.f / determinant );
+
+	//The inverse is the transposed cofactors over the determinant; the zero row leaves each w at 0
+	__m128 inverseRow0 = cofactor0;
+	__m128 inverseRow1 = cofactor1;
+	__m128 inverseRow2 = cofactor2;
+	__m128 inverseRow3 = _mm_setzero_ps();
+	_MM_TRANSPOSE4_PS( inverseRow0, inverseRow1, inverseRow2, inverseRow3 );
+	inverseRow0 = _mm_mul_ps( inverseRow0, inverseDeterminant );
+	inverseRow1 = _mm_mul_ps( inverseRow1, inverseDeterminant );
+	inverseRow2 = _mm_mul_ps( inverseRow2, inverseDeterminant );
+
+	__m128 inverseTranslation = _mm_mul_ps( _mm_shuffle_ps( translation, translation, _MM_SHUFFLE( 0, 0, 0, 0 ) ), inverseRow0 );
+	inverseTranslation = _mm_add_ps( inverseTranslation, _mm_mul_ps( _mm_shuffle_ps( translation, translation, _MM_SHUFFLE( 1, 1, 1, 1 ) ), inverseRow1 ) );
+	inverseTranslation = _mm_add_ps( inverseTranslation, _mm_mul_ps( _mm_shuffle_ps( translation, translation, _MM_SHUFFLE( 2, 2, 2, 2 ) ), inverseRow2 ) );
+	inverseTranslation = _mm_sub_ps( _mm_setzero_ps(), inverseTranslation );
+
+	Float4x4Matrix result;
+	float* resultData = &result[ 0 ];
+	_mm_storeu_ps( resultData, inverseRow0 );
+	_mm_storeu_ps( resultData + 4, inverseRow1 );
+	_mm_storeu_ps( resultData + 8, inverseRow2 );
+	_mm_storeu_ps( resultData + 12, inverseTranslation );
+	resultData[ 15 ] = 1.f;
+	return result;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Treats every point as ( x, y, z, 1 ) and skips the divide by w, so use this for affine matrices only.
+inline void TransformPoints( const Float4x4Matrix& matrix, const FloatVector3* points, FloatVector3* out_points, unsigned int numberOfPoints )
+{
+	const float* m = matrix.GetRawBuffer();
+	__m128 row0 = _mm_loadu_ps( m );
+	__m128 row1 = _mm_loadu_ps( m + 4 );
+	__m128 row2 = _mm_loadu_ps( m + 8 );
+	__m128 translation = _mm_loadu_ps( m + 12 );
+
+	for( unsigned int i = 0; i < numberOfPoints; ++i )
+	{
+		const FloatVector3& point = points[ i ];
+		__m128 transformedPoint = _mm_add_ps( translation, _mm_mul_ps( _mm_set1_ps( point.x ), row0 ) );
+		transformedPoint = _mm_add_ps( transformedPoint, _mm_mul_ps( _mm_set1_ps( point.y ), row1 ) );
+		transformedPoint = _mm_add_ps( transformedPoint, _mm_mul_ps( _mm_set1_ps( point.z ), row2 ) );
+		StoreFloatVector3( out_points[ i ], transformedPoint );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+//Directions ignore the translation row.
+inline void TransformVectors( const Float4x4Matrix& matrix, const FloatVector3* vectors, FloatVector3* out_vectors, unsigned int numberOfVectors )
+{
+	const float* m = matrix.GetRawBuffer();
+	__m128 row0 = _mm_loadu_ps( m );
+	__m128 row1 = _mm_loadu_ps( m + 4 );
+	__m128 row2 = _mm_loadu_ps( m + 8 );
+
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+	{
+		const FloatVector3& vector = vectors[ i ];
+		__m128 transformedVector = _mm_mul_ps( _mm_set1_ps( vector.x ), row0 );
+		transformedVector = _mm_add_ps( transformedVector, _mm_mul_ps( _mm_set1_ps( vector.y ), row1 ) );
+		transformedVector = _mm_add_ps( transformedVector, _mm_mul_ps( _mm_set1_ps( vector.z ), row2 ) );
+		StoreFloatVector3( out_vectors[ i ], transformedVector );
+	}
+}
+#pragma endregion
+
+#else //!FLOAT_4X4_MATRIX_USE_SSE
+
+//-----------------------------------------------------------------------------------------------
+inline Float4x4Matrix CalculateAffineInverse( const Float4x4Matrix& matrix )
+{
+	return CalculateAffineInverseWithLoops( matrix );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void TransformPoints( const Float4x4Matrix& matrix, const FloatVector3* points, FloatVector3* out_points, unsigned int numberOfPoints )
+{
+	TransformPointsWithLoops( matrix, points, out_points, numberOfPoints );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void TransformVectors( const Float4x4Matrix& matrix, const FloatVector3* vectors, FloatVector3* out_vectors, unsigned int numberOfVectors )
+{
+	TransformVectorsWithLoops( matrix, vectors, out_vectors, numberOfVectors );
+}
+#endif //FLOAT_4X4_MATRIX_USE_SSE
+
 #endif //INCLUDED_FLOAT_4X4_MATRIX_HPP
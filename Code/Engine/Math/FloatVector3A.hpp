@@ -0,0 +1,237 @@
+#ifndef INCLUDED_FLOAT_VECTOR_3A_HPP
+#define INCLUDED_FLOAT_VECTOR_3A_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <xmmintrin.h>
+#include "../EngineDefines.hpp"
+#include "EngineMath.hpp"
+#include "FloatVector3.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Loads and stores touch only x, y and z, so these are safe on packed FloatVector3 arrays and
+//leave w zero in the register.
+inline __m128 LoadFloatVector3( const FloatVector3& vector )
+{
+	__m128 xy = _mm_loadl_pi( _mm_setzero_ps(), reinterpret_cast< const __m64* >( &vector.x ) );
+	__m128 z = _mm_load_ss( &vector.z );
+	return _mm_movelh_ps( xy, z );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void StoreFloatVector3( FloatVector3& out_vector, __m128 vector )
+{
+	_mm_storel_pi( reinterpret_cast< __m64* >( &out_vector.x ), vector );
+	_mm_store_ss( &out_vector.z, _mm_movehl_ps( vector, vector ) );
+}
+
+
+
+//-----------------------------------------------------------------------------------------------
+//A three-component float vector held in a 16-byte SSE register, for math-heavy inner loops.
+//It is not a replacement for FloatVector3: load into it at the start of a kernel, do the math
+//here, and store back out. The unused w lane is kept at zero so dot products and norms can
+//sum all four lanes. Pass these by reference; 32-bit MSVC can't pass aligned types by value.
+//-----------------------------------------------------------------------------------------------
+struct FloatVector3A
+{
+	//members
+	__m128 xyzw;
+
+	FloatVector3A()
+		: xyzw( _mm_setzero_ps() )
+	{ }
+
+	explicit FloatVector3A( __m128 vector )
+		: xyzw( vector )
+	{ }
+
+	FloatVector3A( float X, float Y, float Z )
+		: xyzw( _mm_set_ps( 0.f, Z, Y, X ) )
+	{ }
+
+	explicit FloatVector3A( const FloatVector3& vector )
+		: xyzw( LoadFloatVector3( vector ) )
+	{ }
+
+	float GetX() const { return _mm_cvtss_f32( xyzw ); }
+	float GetY() const { return _mm_cvtss_f32( _mm_shuffle_ps( xyzw, xyzw, _MM_SHUFFLE( 1, 1, 1, 1 ) ) ); }
+	float GetZ() const { return _mm_cvtss_f32( _mm_movehl_ps( xyzw, xyzw ) ); }
+	FloatVector3 ToFloatVector3() const { FloatVector3 result; StoreFloatVector3( result, xyzw ); return result; }
+	void StoreTo( FloatVector3& out_vector ) const { StoreFloatVector3( out_vector, xyzw ); }
+
+	float CalculateNorm() const;
+	float CalculateSquaredNorm() const;
+	void Normalize();
+
+	FloatVector3A operator-() const;
+
+	FloatVector3A& operator+=( const FloatVector3A& rhs );
+	FloatVector3A& operator-=( const FloatVector3A& rhs );
+	FloatVector3A& operator*=( float alpha );
+
+	//Other defined operations:
+	//const FloatVector3A operator+( const FloatVector3A& u, const FloatVector3A& v );
+	//const FloatVector3A operator-( const FloatVector3A& u, const FloatVector3A& v );
+	//const FloatVector3A operator*( const FloatVector3A& u, float alpha );
+	//const FloatVector3A operator*( float alpha, const FloatVector3A& u );
+	//const FloatVector3A operator/( const FloatVector3A& u, float alpha );
+	//const FloatVector3A ComponentwiseProduct( const FloatVector3A& u, const FloatVector3A& v );
+	//const FloatVector3A CrossProduct( const FloatVector3A& u, const FloatVector3A& v );
+	//float DotProduct( const FloatVector3A& u, const FloatVector3A& v );
+};
+
+
+
+//-----------------------------------------------------------------------------------------------
+//Leaves the sum of all four lanes in every lane.
+inline __m128 SumLanes( __m128 vector )
+{
+	__m128 pairSums = _mm_add_ps( vector, _mm_shuffle_ps( vector, vector, _MM_SHUFFLE( 2, 3, 0, 1 ) ) );
+	return _mm_add_ps( pairSums, _mm_shuffle_ps( pairSums, pairSums, _MM_SHUFFLE( 1, 0, 3, 2 ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline float DotProduct( const FloatVector3A& u, const FloatVector3A& v )
+{
+	return _mm_cvtss_f32( SumLanes( _mm_mul_ps( u.xyzw, v.xyzw ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline float FloatVector3A::CalculateNorm() const
+{
+	__m128 squaredNorm = SumLanes( _mm_mul_ps( xyzw, xyzw ) );
+	return _mm_cvtss_f32( _mm_sqrt_ss( squaredNorm ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline float FloatVector3A::CalculateSquaredNorm() const
+{
+	return DotProduct( *this, *this );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void FloatVector3A::Normalize()
+{
+	__m128 norm = _mm_sqrt_ps( SumLanes( _mm_mul_ps( xyzw, xyzw ) ) );
+	if( _mm_cvtss_f32( norm ) == 0.f )
+		return;
+
+	xyzw = _mm_div_ps( xyzw, norm );
+
+	ONLY_DURING_MATH_DEBUGGING( assert( AreAlmostEqual( this->CalculateNorm(), 1.f ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3A FloatVector3A::operator-() const
+{
+	return FloatVector3A( _mm_sub_ps( _mm_setzero_ps(), xyzw ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3A& FloatVector3A::operator+=( const FloatVector3A& rhs )
+{
+	xyzw = _mm_add_ps( xyzw, rhs.xyzw );
+	return *this;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3A& FloatVector3A::operator-=( const FloatVector3A& rhs )
+{
+	xyzw = _mm_sub_ps( xyzw, rhs.xyzw );
+	return *this;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3A& FloatVector3A::operator*=( float alpha )
+{
+	xyzw = _mm_mul_ps( xyzw, _mm_set1_ps( alpha ) );
+	return *this;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A operator+( const FloatVector3A& u, const FloatVector3A& v )
+{
+	return FloatVector3A( _mm_add_ps( u.xyzw, v.xyzw ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A operator-( const FloatVector3A& u, const FloatVector3A& v )
+{
+	return FloatVector3A( _mm_sub_ps( u.xyzw, v.xyzw ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A operator*( const FloatVector3A& u, float alpha )
+{
+	return FloatVector3A( _mm_mul_ps( u.xyzw, _mm_set1_ps( alpha ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A operator*( float alpha, const FloatVector3A& u )
+{
+	return FloatVector3A( _mm_mul_ps( u.xyzw, _mm_set1_ps( alpha ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Multiplies by the reciprocal, as dividing the zero w lane by a zero alpha would make it NaN.
+inline const FloatVector3A operator/( const FloatVector3A& u, float alpha )
+{
+	return FloatVector3A( _mm_mul_ps( u.xyzw, _mm_set1_ps( 1.f / alpha ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A ComponentwiseProduct( const FloatVector3A& u, const FloatVector3A& v )
+{
+	return FloatVector3A( _mm_mul_ps( u.xyzw, v.xyzw ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline const FloatVector3A CrossProduct( const FloatVector3A& u, const FloatVector3A& v )
+{
+	//u * v.yzx - u.yzx * v gives the cross product in zxy order; one more rotation puts it right
+	__m128 uYZX = _mm_shuffle_ps( u.xyzw, u.xyzw, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 vYZX = _mm_shuffle_ps( v.xyzw, v.xyzw, _MM_SHUFFLE( 3, 0, 2, 1 ) );
+	__m128 crossZXY = _mm_sub_ps( _mm_mul_ps( u.xyzw, vYZX ), _mm_mul_ps( uYZX, v.xyzw ) );
+	FloatVector3A result( _mm_shuffle_ps( crossZXY, crossZXY, _MM_SHUFFLE( 3, 0, 2, 1 ) ) );
+
+	ONLY_DURING_MATH_DEBUGGING( assert( AreAlmostEqual( DotProduct( result, u ), 0.f ) ) );
+	ONLY_DURING_MATH_DEBUGGING( assert( AreAlmostEqual( DotProduct( result, v ), 0.f ) ) );
+	return result;
+}
+
+
+
+#pragma region Batch Helpers
+//-----------------------------------------------------------------------------------------------
+inline void LoadFloatVector3s( const FloatVector3* vectors, FloatVector3A* out_vectors, unsigned int numberOfVectors )
+{
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+		out_vectors[ i ].xyzw = LoadFloatVector3( vectors[ i ] );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void StoreFloatVector3s( const FloatVector3A* vectors, FloatVector3* out_vectors, unsigned int numberOfVectors )
+{
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+		StoreFloatVector3( out_vectors[ i ], vectors[ i ].xyzw );
+}
+
+//-----------------------------------------------------------------------------------------------
+//out_sums[ i ] = vectors[ i ] + alpha * directions[ i ]; out_sums may be either input.
+inline void AddScaledFloatVector3As( const FloatVector3A* vectors, const FloatVector3A* directions, float alpha, FloatVector3A* out_sums, unsigned int numberOfVectors )
+{
+	__m128 alphas = _mm_set1_ps( alpha );
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+		out_sums[ i ].xyzw = _mm_add_ps( vectors[ i ].xyzw, _mm_mul_ps( alphas, directions[ i ].xyzw ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void NormalizeFloatVector3As( FloatVector3A* vectors, unsigned int numberOfVectors )
+{
+	for( unsigned int i = 0; i < numberOfVectors; ++i )
+		vectors[ i ].Normalize();
+}
+#pragma endregion
+
+#endif //INCLUDED_FLOAT_VECTOR_3A_HPP
@@ -9,12 +9,14 @@
 typedef Vector4< float > FloatVector4;
 
 //-----------------------------------------------------------------------------------------------
+template<>
 inline float FloatVector4::CalculateNorm() const
 {
 	return sqrt( CalculateSquaredNorm() );
 }
 
 //-----------------------------------------------------------------------------------------------
+template<>
 inline void FloatVector4::Normalize()
 {
 	float norm = this->CalculateNorm();
@@ -27,4 +27,13 @@ inline float SmootherStep( float value )
 	return ( 6 * valueSquared * valueCubed ) - ( 15 * valueSquared * valueSquared ) + ( 10 * valueCubed );
 }
 
+//-----------------------------------------------------------------------------------------------
+//A fraction of 0 gives start and 1 gives end; beyond either it carries on along the same line.
+//Ease the fraction first with one of the curves above for a smoothed blend.
+template< typename ValueType >
+inline ValueType LinearInterpolate( const ValueType& start, const ValueType& end, float fraction )
+{
+	return start + ( end - start ) * fraction;
+}
+
 #endif //INCLUDED_INTERPOLATION_HPP
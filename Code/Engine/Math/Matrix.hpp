@@ -171,8 +171,11 @@ inline Matrix<T, COLUMN_SIZE, ROW_SIZE> operator*( const T& alpha, const Matrix<
 }
 
 //-----------------------------------------------------------------------------------------------
+//The plain loop versions of multiply and transpose. operator* and Transpose forward here unless a
+//faster version is specialized for a particular size (see Float4x4Matrix.hpp); these stay callable
+//so the specialized versions can be checked and timed against them.
 template <typename T, unsigned int U_COLUMN_SIZE, unsigned int SHARED_SIZE, unsigned int V_ROW_SIZE>
-Matrix<T, U_COLUMN_SIZE, V_ROW_SIZE> operator*( const Matrix<T, U_COLUMN_SIZE, SHARED_SIZE>& u, const Matrix<T, SHARED_SIZE, V_ROW_SIZE>& v )
+Matrix<T, U_COLUMN_SIZE, V_ROW_SIZE> MultiplyMatricesWithLoops( const Matrix<T, U_COLUMN_SIZE, SHARED_SIZE>& u, const Matrix<T, SHARED_SIZE, V_ROW_SIZE>& v )
 {
 	Matrix<T, U_COLUMN_SIZE, V_ROW_SIZE> result;
 	for( unsigned int i = 0; i < U_COLUMN_SIZE; ++i )
@@ -190,7 +193,7 @@ Matrix<T, U_COLUMN_SIZE, V_ROW_SIZE> operator*( const Matrix<T, U_COLUMN_SIZE, S
 
 //-----------------------------------------------------------------------------------------------
 template <typename T, unsigned int COLUMN_SIZE, unsigned int ROW_SIZE>
-Matrix<T, ROW_SIZE, COLUMN_SIZE> Transpose( const Matrix<T, COLUMN_SIZE, ROW_SIZE>& u )
+Matrix<T, ROW_SIZE, COLUMN_SIZE> TransposeWithLoops( const Matrix<T, COLUMN_SIZE, ROW_SIZE>& u )
 {
 	Matrix<T, ROW_SIZE, COLUMN_SIZE> result;
 	for( unsigned int i = 0; i < COLUMN_SIZE; ++i )
@@ -203,4 +206,18 @@ Matrix<T, ROW_SIZE, COLUMN_SIZE> Transpose( const Matrix<T, COLUMN_SIZE, ROW_SIZ
 	return result;
 }
 
+//-----------------------------------------------------------------------------------------------
+template <typename T, unsigned int U_COLUMN_SIZE, unsigned int SHARED_SIZE, unsigned int V_ROW_SIZE>
+Matrix<T, U_COLUMN_SIZE, V_ROW_SIZE> operator*( const Matrix<T, U_COLUMN_SIZE, SHARED_SIZE>& u, const Matrix<T, SHARED_SIZE, V_ROW_SIZE>& v )
+{
+	return MultiplyMatricesWithLoops( u, v );
+}
+
+//-----------------------------------------------------------------------------------------------
+template <typename T, unsigned int COLUMN_SIZE, unsigned int ROW_SIZE>
+Matrix<T, ROW_SIZE, COLUMN_SIZE> Transpose( const Matrix<T, COLUMN_SIZE, ROW_SIZE>& u )
+{
+	return TransposeWithLoops( u );
+}
+
 #endif // INCLUDED_MATRIX_HPP
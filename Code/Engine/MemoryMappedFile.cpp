@@ -0,0 +1,113 @@
+#include "MemoryMappedFile.hpp"
+
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
+//-----------------------------------------------------------------------------------------------
+MemoryMappedFile::MemoryMappedFile()
+	: m_data( nullptr )
+	, m_sizeBytes( 0 )
+	, m_fileHandle( INVALID_HANDLE_VALUE )
+	, m_mappingHandle( nullptr )
+{ }
+
+//-----------------------------------------------------------------------------------------------
+bool MemoryMappedFile::Open( const std::string& filePath )
+{
+	Close();
+
+	m_fileHandle = CreateFileA( filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr );
+	if( m_fileHandle == INVALID_HANDLE_VALUE )
+		return false;
+
+	LARGE_INTEGER fileSize;
+	if( !GetFileSizeEx( m_fileHandle, &fileSize ) || fileSize.QuadPart == 0 )
+	{
+		Close();
+		return false;
+	}
+
+	m_mappingHandle = CreateFileMappingA( m_fileHandle, nullptr, PAGE_READONLY, 0, 0, nullptr );
+	if( m_mappingHandle == nullptr )
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast< const unsigned char* >( MapViewOfFile( m_mappingHandle, FILE_MAP_READ, 0, 0, 0 ) );
+	if( m_data == nullptr )
+	{
+		Close();
+		return false;
+	}
+
+	m_sizeBytes = static_cast< size_t >( fileSize.QuadPart );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void MemoryMappedFile::Close()
+{
+	if( m_data != nullptr )
+		UnmapViewOfFile( m_data );
+	if( m_mappingHandle != nullptr )
+		CloseHandle( m_mappingHandle );
+	if( m_fileHandle != INVALID_HANDLE_VALUE )
+		CloseHandle( m_fileHandle );
+
+	m_data = nullptr;
+	m_sizeBytes = 0;
+	m_mappingHandle = nullptr;
+	m_fileHandle = INVALID_HANDLE_VALUE;
+}
+
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+//-----------------------------------------------------------------------------------------------
+MemoryMappedFile::MemoryMappedFile()
+	: m_data( nullptr )
+	, m_sizeBytes( 0 )
+{ }
+
+//-----------------------------------------------------------------------------------------------
+//The mapping holds its own reference to the file, so the descriptor can be closed straight away.
+bool MemoryMappedFile::Open( const std::string& filePath )
+{
+	Close();
+
+	int fileDescriptor = open( filePath.c_str(), O_RDONLY );
+	if( fileDescriptor < 0 )
+		return false;
+
+	struct stat fileStatus;
+	if( fstat( fileDescriptor, &fileStatus ) != 0 || fileStatus.st_size == 0 )
+	{
+		close( fileDescriptor );
+		return false;
+	}
+
+	void* mappedData = mmap( nullptr, static_cast< size_t >( fileStatus.st_size ), PROT_READ, MAP_PRIVATE, fileDescriptor, 0 );
+	close( fileDescriptor );
+	if( mappedData == MAP_FAILED )
+		return false;
+
+	m_data = static_cast< const unsigned char* >( mappedData );
+	m_sizeBytes = static_cast< size_t >( fileStatus.st_size );
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+void MemoryMappedFile::Close()
+{
+	if( m_data != nullptr )
+		munmap( const_cast< unsigned char* >( m_data ), m_sizeBytes );
+
+	m_data = nullptr;
+	m_sizeBytes = 0;
+}
+#endif
@@ -0,0 +1,40 @@
+#ifndef INCLUDED_MEMORY_MAPPED_FILE_HPP
+#define INCLUDED_MEMORY_MAPPED_FILE_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <cstddef>
+#include <string>
+
+//-----------------------------------------------------------------------------------------------
+//A read-only view of a whole file. The operating system pages the contents in as they're touched,
+//so opening a file this way costs nothing up front and never copies it into a buffer of our own.
+//-----------------------------------------------------------------------------------------------
+class MemoryMappedFile
+{
+	const unsigned char* m_data;
+	size_t m_sizeBytes;
+
+#if defined( _WIN32 )
+	void* m_fileHandle;
+	void* m_mappingHandle;
+#endif
+
+	//We have no need of a pithy assignment or copy operator!
+	MemoryMappedFile( const MemoryMappedFile& );
+	void operator=( const MemoryMappedFile& );
+
+public:
+	MemoryMappedFile();
+	~MemoryMappedFile() { Close(); }
+
+	//Returns false, leaving the file closed, if it doesn't exist, can't be read or is empty.
+	bool Open( const std::string& filePath );
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const unsigned char* GetData() const { return m_data; }
+	size_t GetSizeBytes() const { return m_sizeBytes; }
+};
+
+#endif //INCLUDED_MEMORY_MAPPED_FILE_HPP
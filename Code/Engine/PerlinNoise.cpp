@@ -1,26 +1,40 @@
+#include <climits>
+#include <vector>
 #include "PerlinNoise.hpp"
 
+//SSE2 is part of every x64 target (and MSVC's x86 default), so the batches always get it.
+//MSVC only defines __AVX2__ under /arch:AVX2, which the project doesn't set, so as shipped the
+//3D and 4D AVX2 path below is compiled out and those batches run four lanes of SSE2 instead.
+#if defined( __SSE2__ ) || defined( _M_X64 ) || ( defined( _M_IX86_FP ) && _M_IX86_FP >= 2 )
+#define NOISE_USE_SSE2
+#include <emmintrin.h> //Includes xmmintrin.h for _MM_TRANSPOSE4_PS
+#endif
+#if defined( __AVX2__ )
+#include <immintrin.h>
+#endif
+
 //-----------------------------------------------------------------------------------------------
-float Generate2DNoise( float x, float y, float gridSize )
+//Gradients in the order 00, X0, 0Y, XY.
+static inline void Generate2DCornerGradients( int gridX, int gridY, FloatVector2* out_cornerGradients )
 {
-	float INVERSE_GRID_SIZE = 1.0f / gridSize;
-
-	//Find location in grid space
-	float xWithRespectToGridSize = x * INVERSE_GRID_SIZE;
-	float yWithRespectToGridSize = y * INVERSE_GRID_SIZE;
-	int	  gridX = static_cast< int >( floor( xWithRespectToGridSize ) );
-	int   gridY = static_cast< int >( floor( yWithRespectToGridSize ) );
-	float xInGrid = xWithRespectToGridSize - gridX;
-	float yInGrid = yWithRespectToGridSize - gridY;
+	out_cornerGradients[ 0 ] = GeneratePseudoRandomUnitVectorAtPosition( gridX,		gridY );
+	out_cornerGradients[ 1 ] = GeneratePseudoRandomUnitVectorAtPosition( gridX + 1,	gridY );
+	out_cornerGradients[ 2 ] = GeneratePseudoRandomUnitVectorAtPosition( gridX,		gridY + 1 );
+	out_cornerGradients[ 3 ] = GeneratePseudoRandomUnitVectorAtPosition( gridX + 1,	gridY + 1 );
+}
 
+//-----------------------------------------------------------------------------------------------
+//The rest of Generate2DNoise once the cell's gradients are known, shared with PerlinNoise2DBatch
+//so the two give the same values.
+static inline float Blend2DCornerGradients( float xInGrid, float yInGrid, const FloatVector2* cornerGradients )
+{
 	//Smooth values
 	FloatVector2 gridPosition( SmoothStep( xInGrid ), SmoothStep( yInGrid ) );
 
-	//Create Random Gradients
-	FloatVector2 gradient00 = GeneratePseudoRandomUnitVectorAtPosition( gridX,		gridY );
-	FloatVector2 gradientX0 = GeneratePseudoRandomUnitVectorAtPosition( gridX + 1,	gridY );
-	FloatVector2 gradient0Y = GeneratePseudoRandomUnitVectorAtPosition( gridX,		gridY + 1 );
-	FloatVector2 gradientXY = GeneratePseudoRandomUnitVectorAtPosition( gridX + 1,	gridY + 1 );
+	const FloatVector2& gradient00 = cornerGradients[ 0 ];
+	const FloatVector2& gradientX0 = cornerGradients[ 1 ];
+	const FloatVector2& gradient0Y = cornerGradients[ 2 ];
+	const FloatVector2& gradientXY = cornerGradients[ 3 ];
 
 	FloatVector2 vectorToCorner00( gridPosition.x,		 gridPosition.y );
 	FloatVector2 vectorToCornerX0( gridPosition.x - 1.f, gridPosition.y );
@@ -36,7 +50,27 @@ float Generate2DNoise( float x, float y, float gridSize )
 	//Weighted Average
 	float influenceLowerSide = influence00 + gridPosition.x * ( influenceX0 - influence00 );
 	float influenceUpperSide = influence0Y + gridPosition.x * ( influenceXY - influence0Y );
-	float influenceCenter = influenceLowerSide + gridPosition.y * ( influenceUpperSide - influenceLowerSide );
+	return influenceLowerSide + gridPosition.y * ( influenceUpperSide - influenceLowerSide );
+}
+
+//-----------------------------------------------------------------------------------------------
+float Generate2DNoise( float x, float y, float gridSize )
+{
+	float INVERSE_GRID_SIZE = 1.0f / gridSize;
+
+	//Find location in grid space
+	float xWithRespectToGridSize = x * INVERSE_GRID_SIZE;
+	float yWithRespectToGridSize = y * INVERSE_GRID_SIZE;
+	int	  gridX = static_cast< int >( floor( xWithRespectToGridSize ) );
+	int   gridY = static_cast< int >( floor( yWithRespectToGridSize ) );
+	float xInGrid = xWithRespectToGridSize - gridX;
+	float yInGrid = yWithRespectToGridSize - gridY;
+
+	//Create Random Gradients
+	FloatVector2 cornerGradients[ 4 ];
+	Generate2DCornerGradients( gridX, gridY, cornerGradients );
+
+	float influenceCenter = Blend2DCornerGradients( xInGrid, yInGrid, cornerGradients );
 	assert( influenceCenter <= 1.f);
 	assert( influenceCenter >= -1.f);
 	return influenceCenter;
@@ -60,3 +94,622 @@ float PerlinNoise2D( float x, float y, float startingBlockSize, float persistenc
 	assert( total >= -1.f);
 	return total;
 }
+
+//-----------------------------------------------------------------------------------------------
+//Direct mapped slot for a lattice position: the low bits of the column and row. Samples swept
+//along rows keep revisiting the last few rows of cells, so this rarely evicts anything in use.
+static const unsigned int LATTICE_COLUMN_BITS = 8;
+static const unsigned int LATTICE_ROW_BITS = 2;
+static const unsigned int LATTICE_COLUMN_MASK = ( 1 << LATTICE_COLUMN_BITS ) - 1;
+static const unsigned int LATTICE_ROW_MASK = ( 1 << LATTICE_ROW_BITS ) - 1;
+static const unsigned int LATTICE_CACHE_SIZE = 1 << ( LATTICE_COLUMN_BITS + LATTICE_ROW_BITS );
+static const int EMPTY_LATTICE_SLOT = INT_MIN;
+
+inline unsigned int GetLatticeCacheSlot( int gridX, int gridY )
+{
+	return ( static_cast< unsigned int >( gridX ) & LATTICE_COLUMN_MASK ) | ( ( static_cast< unsigned int >( gridY ) & LATTICE_ROW_MASK ) << LATTICE_COLUMN_BITS );
+}
+
+//-----------------------------------------------------------------------------------------------
+//One octave's gradients, cached per lattice point and per cell. Each lattice point is hashed and
+//run through cos/sin about once per batch instead of once per corner of every sample, and each
+//cell's four corners sit together so a sample fetches them with two loads. The gradients are
+//exactly the ones GeneratePseudoRandomUnitVectorAtPosition gives.
+class OctaveGradientCache
+{
+	struct PointEntry
+	{
+		int gridX, gridY;
+		FloatVector2 gradient;
+	};
+
+	struct CellEntry
+	{
+		int gridX, gridY;
+		FloatVector2 cornerGradients[ 4 ];
+	};
+
+	float m_inverseGridSize;
+	std::vector< PointEntry > m_points;
+	std::vector< CellEntry > m_cells;
+
+	//-----------------------------------------------------------------------------------------------
+	const FloatVector2& GetPointGradient( int gridX, int gridY )
+	{
+		PointEntry& point = m_points[ GetLatticeCacheSlot( gridX, gridY ) ];
+		if( point.gridX != gridX || point.gridY != gridY )
+		{
+			point.gradient = GeneratePseudoRandomUnitVectorAtPosition( gridX, gridY );
+			point.gridX = gridX;
+			point.gridY = gridY;
+		}
+		return point.gradient;
+	}
+
+	//-----------------------------------------------------------------------------------------------
+	void FillCell( CellEntry& cell, int gridX, int gridY )
+	{
+		cell.cornerGradients[ 0 ] = GetPointGradient( gridX,		gridY );
+		cell.cornerGradients[ 1 ] = GetPointGradient( gridX + 1,	gridY );
+		cell.cornerGradients[ 2 ] = GetPointGradient( gridX,		gridY + 1 );
+		cell.cornerGradients[ 3 ] = GetPointGradient( gridX + 1,	gridY + 1 );
+		cell.gridX = gridX;
+		cell.gridY = gridY;
+	}
+
+public:
+	OctaveGradientCache( float gridSize )
+		: m_inverseGridSize( 1.f / gridSize )
+		, m_points( LATTICE_CACHE_SIZE )
+		, m_cells( LATTICE_CACHE_SIZE )
+	{
+		for( unsigned int slot = 0; slot < LATTICE_CACHE_SIZE; ++slot )
+		{
+			m_points[ slot ].gridX = EMPTY_LATTICE_SLOT;
+			m_cells[ slot ].gridX = EMPTY_LATTICE_SLOT;
+		}
+	}
+
+	float GetInverseGridSize() const { return m_inverseGridSize; }
+
+	//-----------------------------------------------------------------------------------------------
+	//Gradients in the order 00, X0, 0Y, XY, valid until the slot is reused.
+	const FloatVector2* GetCornerGradients( int gridX, int gridY, unsigned int slot )
+	{
+		CellEntry& cell = m_cells[ slot ];
+		if( cell.gridX != gridX || cell.gridY != gridY )
+			FillCell( cell, gridX, gridY );
+		return cell.cornerGradients;
+	}
+
+	const FloatVector2* GetCornerGradients( int gridX, int gridY )
+	{
+		return GetCornerGradients( gridX, gridY, GetLatticeCacheSlot( gridX, gridY ) );
+	}
+};
+
+#if defined( NOISE_USE_SSE2 )
+//-----------------------------------------------------------------------------------------------
+//floor() for four lanes, as integers and as floats. SSE2 only truncates, so step the lanes that
+//were rounded up (negative, non-integral values) back down by one.
+inline void Floor4( __m128 value, __m128i& out_integer, __m128& out_float )
+{
+	__m128i truncated = _mm_cvttps_epi32( value );
+	__m128 roundedUp = _mm_cmplt_ps( value, _mm_cvtepi32_ps( truncated ) );
+	out_integer = _mm_add_epi32( truncated, _mm_castps_si128( roundedUp ) );
+	out_float = _mm_cvtepi32_ps( out_integer );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Same operation order as SmoothStep so the lanes match the scalar results bit for bit.
+inline __m128 SmoothStep4( __m128 value )
+{
+	__m128 threeTSquared = _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 3.f ), value ), value );
+	__m128 twoTCubed = _mm_mul_ps( _mm_mul_ps( _mm_mul_ps( _mm_set1_ps( 2.f ), value ), value ), value );
+	return _mm_sub_ps( threeTSquared, twoTCubed );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Four lanes of Blend2DCornerGradients for one octave.
+inline __m128 Generate2DNoise4( __m128 x, __m128 y, OctaveGradientCache& octave )
+{
+	const __m128 ONE = _mm_set1_ps( 1.f );
+	__m128 scale = _mm_set1_ps( octave.GetInverseGridSize() );
+	__m128 xWithRespectToGridSize = _mm_mul_ps( x, scale );
+	__m128 yWithRespectToGridSize = _mm_mul_ps( y, scale );
+
+	__m128i gridX, gridY;
+	__m128 gridXAsFloat, gridYAsFloat;
+	Floor4( xWithRespectToGridSize, gridX, gridXAsFloat );
+	Floor4( yWithRespectToGridSize, gridY, gridYAsFloat );
+	__m128 gridPositionX = SmoothStep4( _mm_sub_ps( xWithRespectToGridSize, gridXAsFloat ) );
+	__m128 gridPositionY = SmoothStep4( _mm_sub_ps( yWithRespectToGridSize, gridYAsFloat ) );
+
+	__m128i slot = _mm_or_si128( _mm_and_si128( gridX, _mm_set1_epi32( LATTICE_COLUMN_MASK ) ),
+								 _mm_slli_epi32( _mm_and_si128( gridY, _mm_set1_epi32( LATTICE_ROW_MASK ) ), LATTICE_COLUMN_BITS ) );
+	int gridXs[ 4 ], gridYs[ 4 ], slots[ 4 ];
+	_mm_storeu_si128( reinterpret_cast< __m128i* >( gridXs ), gridX );
+	_mm_storeu_si128( reinterpret_cast< __m128i* >( gridYs ), gridY );
+	_mm_storeu_si128( reinterpret_cast< __m128i* >( slots ), slot );
+
+	//Each cell's four corners are eight contiguous floats, x0 y0 x1 y1 | x2 y2 x3 y3
+	__m128 lowerCorners[ 4 ], upperCorners[ 4 ];
+	__m128i sameCellAsFirstLane = _mm_and_si128( _mm_cmpeq_epi32( gridX, _mm_shuffle_epi32( gridX, 0 ) ), _mm_cmpeq_epi32( gridY, _mm_shuffle_epi32( gridY, 0 ) ) );
+	if( _mm_movemask_epi8( sameCellAsFirstLane ) == 0xFFFF )
+	{
+		//Coarse octaves usually have all four lanes in one cell: broadcast its corners
+		const float* cornerGradients = &octave.GetCornerGradients( gridXs[ 0 ], gridYs[ 0 ], slots[ 0 ] )->x;
+		__m128 lower = _mm_loadu_ps( cornerGradients );
+		__m128 upper = _mm_loadu_ps( cornerGradients + 4 );
+		lowerCorners[ 0 ] = _mm_shuffle_ps( lower, lower, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		lowerCorners[ 1 ] = _mm_shuffle_ps( lower, lower, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		lowerCorners[ 2 ] = _mm_shuffle_ps( lower, lower, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		lowerCorners[ 3 ] = _mm_shuffle_ps( lower, lower, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+		upperCorners[ 0 ] = _mm_shuffle_ps( upper, upper, _MM_SHUFFLE( 0, 0, 0, 0 ) );
+		upperCorners[ 1 ] = _mm_shuffle_ps( upper, upper, _MM_SHUFFLE( 1, 1, 1, 1 ) );
+		upperCorners[ 2 ] = _mm_shuffle_ps( upper, upper, _MM_SHUFFLE( 2, 2, 2, 2 ) );
+		upperCorners[ 3 ] = _mm_shuffle_ps( upper, upper, _MM_SHUFFLE( 3, 3, 3, 3 ) );
+	}
+	else
+	{
+		//Otherwise load each lane's corners and transpose, giving one register per corner component
+		const float* lane0 = &octave.GetCornerGradients( gridXs[ 0 ], gridYs[ 0 ], slots[ 0 ] )->x;
+		const float* lane1 = &octave.GetCornerGradients( gridXs[ 1 ], gridYs[ 1 ], slots[ 1 ] )->x;
+		const float* lane2 = &octave.GetCornerGradients( gridXs[ 2 ], gridYs[ 2 ], slots[ 2 ] )->x;
+		const float* lane3 = &octave.GetCornerGradients( gridXs[ 3 ], gridYs[ 3 ], slots[ 3 ] )->x;
+		lowerCorners[ 0 ] = _mm_loadu_ps( lane0 );
+		lowerCorners[ 1 ] = _mm_loadu_ps( lane1 );
+		lowerCorners[ 2 ] = _mm_loadu_ps( lane2 );
+		lowerCorners[ 3 ] = _mm_loadu_ps( lane3 );
+		upperCorners[ 0 ] = _mm_loadu_ps( lane0 + 4 );
+		upperCorners[ 1 ] = _mm_loadu_ps( lane1 + 4 );
+		upperCorners[ 2 ] = _mm_loadu_ps( lane2 + 4 );
+		upperCorners[ 3 ] = _mm_loadu_ps( lane3 + 4 );
+		_MM_TRANSPOSE4_PS( lowerCorners[ 0 ], lowerCorners[ 1 ], lowerCorners[ 2 ], lowerCorners[ 3 ] );
+		_MM_TRANSPOSE4_PS( upperCorners[ 0 ], upperCorners[ 1 ], upperCorners[ 2 ], upperCorners[ 3 ] );
+	}
+
+	//Dot Product
+	__m128 vectorToCornerX0 = _mm_sub_ps( gridPositionX, ONE );
+	__m128 vectorToCorner0Y = _mm_sub_ps( gridPositionY, ONE );
+	__m128 influence00 = _mm_add_ps( _mm_mul_ps( lowerCorners[ 0 ], gridPositionX ), _mm_mul_ps( lowerCorners[ 1 ], gridPositionY ) );
+	__m128 influenceX0 = _mm_add_ps( _mm_mul_ps( lowerCorners[ 2 ], vectorToCornerX0 ), _mm_mul_ps( lowerCorners[ 3 ], gridPositionY ) );
+	__m128 influence0Y = _mm_add_ps( _mm_mul_ps( upperCorners[ 0 ], gridPositionX ), _mm_mul_ps( upperCorners[ 1 ], vectorToCorner0Y ) );
+	__m128 influenceXY = _mm_add_ps( _mm_mul_ps( upperCorners[ 2 ], vectorToCornerX0 ), _mm_mul_ps( upperCorners[ 3 ], vectorToCorner0Y ) );
+
+	//Weighted Average
+	__m128 influenceLowerSide = _mm_add_ps( influence00, _mm_mul_ps( gridPositionX, _mm_sub_ps( influenceX0, influence00 ) ) );
+	__m128 influenceUpperSide = _mm_add_ps( influence0Y, _mm_mul_ps( gridPositionX, _mm_sub_ps( influenceXY, influence0Y ) ) );
+	return _mm_add_ps( influenceLowerSide, _mm_mul_ps( gridPositionY, _mm_sub_ps( influenceUpperSide, influenceLowerSide ) ) );
+}
+#endif
+
+//-----------------------------------------------------------------------------------------------
+void PerlinNoise2DBatch( const float* xs, const float* ys, float* out_noise, unsigned int count,
+						 float startingBlockSize, float persistence, unsigned int octaves )
+{
+	std::vector< OctaveGradientCache > octaveGradients;
+	octaveGradients.reserve( octaves );
+	for( unsigned int tone = 0; tone < octaves; ++tone )
+	{
+		float frequency = 1.f / ( 1 << tone );
+		octaveGradients.push_back( OctaveGradientCache( startingBlockSize * frequency ) );
+	}
+
+	unsigned int index = 0;
+
+#if defined( NOISE_USE_SSE2 )
+	static const unsigned int LANES = 4;
+	for( ; index + LANES <= count; index += LANES )
+	{
+		__m128 x = _mm_loadu_ps( xs + index );
+		__m128 y = _mm_loadu_ps( ys + index );
+
+		__m128 total = _mm_setzero_ps();
+		float amplitude = 1.f;
+		for( unsigned int tone = 0; tone < octaves; ++tone )
+		{
+			total = _mm_add_ps( total, _mm_mul_ps( Generate2DNoise4( x, y, octaveGradients[ tone ] ), _mm_set1_ps( amplitude ) ) );
+			amplitude *= persistence;
+		}
+		_mm_storeu_ps( out_noise + index, total );
+	}
+#endif
+
+	for( ; index < count; ++index )
+	{
+		float total = 0.f;
+		float amplitude = 1.f;
+		for( unsigned int tone = 0; tone < octaves; ++tone )
+		{
+			OctaveGradientCache& octave = octaveGradients[ tone ];
+			float xWithRespectToGridSize = xs[ index ] * octave.GetInverseGridSize();
+			float yWithRespectToGridSize = ys[ index ] * octave.GetInverseGridSize();
+			int	  gridX = static_cast< int >( floor( xWithRespectToGridSize ) );
+			int   gridY = static_cast< int >( floor( yWithRespectToGridSize ) );
+
+			total += Blend2DCornerGradients( xWithRespectToGridSize - gridX, yWithRespectToGridSize - gridY, octave.GetCornerGradients( gridX, gridY ) ) * amplitude;
+
+			amplitude *= persistence;
+		}
+		out_noise[ index ] = total;
+	}
+}
+
+
+
+//-----------------------------------------------------------------------------------------------
+//Table driven noise
+//-----------------------------------------------------------------------------------------------
+static const unsigned int GRADIENT_TABLE_SIZE = 256;
+static const unsigned int GRADIENT_TABLE_MASK = GRADIENT_TABLE_SIZE - 1;
+static const unsigned int MAX_NOISE_DIMENSIONS = 4;
+static const unsigned int LATTICE_HASH_SEED = 0x9e3779b9u;
+static const unsigned int LATTICE_HASH_MULTIPLIERS[ MAX_NOISE_DIMENSIONS ] = { 0x8da6b343u, 0xd8163841u, 0xcb1ab31fu, 0x165667b1u };
+static const unsigned int LATTICE_HASH_MIXER = 0x2c1b3c6du;
+
+//-----------------------------------------------------------------------------------------------
+//Gradients are stored one component per array so the SIMD path can gather them directly.
+//Indexed as [ dimensions - 3 ][ component ][ hash ]; 2D noise keeps the original gradients above.
+struct NoiseGradientTables
+{
+	float components[ MAX_NOISE_DIMENSIONS - 2 ][ MAX_NOISE_DIMENSIONS ][ GRADIENT_TABLE_SIZE ];
+
+	NoiseGradientTables()
+	{
+		for( unsigned int index = 0; index < GRADIENT_TABLE_SIZE; ++index )
+		{
+			//Pseudo random directions from the seed noise, normalized
+			for( unsigned int dimensions = 3; dimensions <= MAX_NOISE_DIMENSIONS; ++dimensions )
+			{
+				float direction[ MAX_NOISE_DIMENSIONS ];
+				float squaredLength = 0.f;
+				for( unsigned int component = 0; component < dimensions; ++component )
+				{
+					direction[ component ] = static_cast< float >( GenerateNoiseFromSeeds( index, component + 17 * dimensions ) );
+					squaredLength += direction[ component ] * direction[ component ];
+				}
+
+				if( squaredLength < 0.0001f )
+				{
+					direction[ 0 ] = 1.f;
+					squaredLength = 1.f;
+					for( unsigned int component = 1; component < dimensions; ++component )
+						direction[ component ] = 0.f;
+				}
+
+				float inverseLength = 1.f / sqrt( squaredLength );
+				for( unsigned int component = 0; component < dimensions; ++component )
+					components[ dimensions - 3 ][ component ][ index ] = direction[ component ] * inverseLength;
+			}
+		}
+	}
+};
+static const NoiseGradientTables s_gradientTables;
+
+//-----------------------------------------------------------------------------------------------
+inline unsigned int FinalizeLatticeHash( unsigned int hash )
+{
+	hash ^= hash >> 15;
+	hash *= LATTICE_HASH_MIXER;
+	hash ^= hash >> 12;
+	return hash & GRADIENT_TABLE_MASK;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Noise at a position already scaled into lattice space.
+template< unsigned int DIMENSIONS >
+inline float GenerateLatticeNoise( const float* latticePosition )
+{
+	static const unsigned int NUMBER_OF_CORNERS = 1 << DIMENSIONS;
+	const float ( &gradients )[ MAX_NOISE_DIMENSIONS ][ GRADIENT_TABLE_SIZE ] = s_gradientTables.components[ DIMENSIONS - 3 ];
+
+	int   cell[ DIMENSIONS ];
+	float offsetInCell[ DIMENSIONS ];
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		float cellStart = floor( latticePosition[ dimension ] );
+		cell[ dimension ] = static_cast< int >( cellStart );
+		offsetInCell[ dimension ] = latticePosition[ dimension ] - cellStart;
+	}
+
+	//Bit d of the corner index means "+1 along dimension d"
+	float influences[ NUMBER_OF_CORNERS ];
+	for( unsigned int corner = 0; corner < NUMBER_OF_CORNERS; ++corner )
+	{
+		unsigned int hash = LATTICE_HASH_SEED;
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			hash ^= static_cast< unsigned int >( cell[ dimension ] + ( ( corner >> dimension ) & 1 ) ) * LATTICE_HASH_MULTIPLIERS[ dimension ];
+		hash = FinalizeLatticeHash( hash );
+
+		float influence = 0.f;
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			influence += gradients[ dimension ][ hash ] * ( offsetInCell[ dimension ] - ( ( corner >> dimension ) & 1 ) );
+		influences[ corner ] = influence;
+	}
+
+	//Collapse one dimension at a time; after each pass the next dimension is in bit 0
+	unsigned int remainingCorners = NUMBER_OF_CORNERS;
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		float weight = SmoothStep( offsetInCell[ dimension ] );
+		remainingCorners >>= 1;
+		for( unsigned int pair = 0; pair < remainingCorners; ++pair )
+			influences[ pair ] = influences[ 2 * pair ] + weight * ( influences[ 2 * pair + 1 ] - influences[ 2 * pair ] );
+	}
+	return influences[ 0 ];
+}
+
+//-----------------------------------------------------------------------------------------------
+template< unsigned int DIMENSIONS >
+inline float GenerateFractalLatticeNoise( const float* position, float startingBlockSize, float persistence, unsigned int octaves )
+{
+	float total = 0.f;
+	float amplitude = 1.f;
+	float inverseBlockSize = 1.f / startingBlockSize;
+	float latticePosition[ DIMENSIONS ];
+	for( unsigned int tone = 0; tone < octaves; ++tone )
+	{
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			latticePosition[ dimension ] = position[ dimension ] * inverseBlockSize;
+
+		total += GenerateLatticeNoise< DIMENSIONS >( latticePosition ) * amplitude;
+
+		amplitude *= persistence;
+		inverseBlockSize *= 2.f;
+	}
+	return total;
+}
+
+#if defined( __AVX2__ )
+//-----------------------------------------------------------------------------------------------
+inline __m256 SmoothStep8( __m256 value )
+{
+	//3t^2 - 2t^3 = t^2 * ( 3 - 2t )
+	__m256 valueSquared = _mm256_mul_ps( value, value );
+	return _mm256_mul_ps( valueSquared, _mm256_sub_ps( _mm256_set1_ps( 3.f ), _mm256_add_ps( value, value ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Eight lanes of GenerateLatticeNoise.
+template< unsigned int DIMENSIONS >
+inline __m256 GenerateLatticeNoise8( const __m256* latticePosition )
+{
+	static const unsigned int NUMBER_OF_CORNERS = 1 << DIMENSIONS;
+	const float ( &gradients )[ MAX_NOISE_DIMENSIONS ][ GRADIENT_TABLE_SIZE ] = s_gradientTables.components[ DIMENSIONS - 3 ];
+	const __m256 ONE = _mm256_set1_ps( 1.f );
+	const __m256i ONE_INTEGER = _mm256_set1_epi32( 1 );
+
+	__m256i cell[ DIMENSIONS ];
+	__m256  offsetInCell[ DIMENSIONS ];
+	__m256  offsetFromFarCorner[ DIMENSIONS ];
+	__m256i hashedCell[ DIMENSIONS ][ 2 ];
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		__m256 cellStart = _mm256_floor_ps( latticePosition[ dimension ] );
+		cell[ dimension ] = _mm256_cvttps_epi32( cellStart );
+		offsetInCell[ dimension ] = _mm256_sub_ps( latticePosition[ dimension ], cellStart );
+		offsetFromFarCorner[ dimension ] = _mm256_sub_ps( offsetInCell[ dimension ], ONE );
+
+		__m256i multiplier = _mm256_set1_epi32( static_cast< int >( LATTICE_HASH_MULTIPLIERS[ dimension ] ) );
+		hashedCell[ dimension ][ 0 ] = _mm256_mullo_epi32( cell[ dimension ], multiplier );
+		hashedCell[ dimension ][ 1 ] = _mm256_mullo_epi32( _mm256_add_epi32( cell[ dimension ], ONE_INTEGER ), multiplier );
+	}
+
+	__m256 influences[ NUMBER_OF_CORNERS ];
+	for( unsigned int corner = 0; corner < NUMBER_OF_CORNERS; ++corner )
+	{
+		__m256i hash = _mm256_set1_epi32( static_cast< int >( LATTICE_HASH_SEED ) );
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			hash = _mm256_xor_si256( hash, hashedCell[ dimension ][ ( corner >> dimension ) & 1 ] );
+
+		hash = _mm256_xor_si256( hash, _mm256_srli_epi32( hash, 15 ) );
+		hash = _mm256_mullo_epi32( hash, _mm256_set1_epi32( static_cast< int >( LATTICE_HASH_MIXER ) ) );
+		hash = _mm256_xor_si256( hash, _mm256_srli_epi32( hash, 12 ) );
+		hash = _mm256_and_si256( hash, _mm256_set1_epi32( GRADIENT_TABLE_MASK ) );
+
+		__m256 influence = _mm256_setzero_ps();
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+		{
+			__m256 gradientComponent = _mm256_i32gather_ps( gradients[ dimension ], hash, 4 );
+			__m256 offset = ( ( corner >> dimension ) & 1 ) ? offsetFromFarCorner[ dimension ] : offsetInCell[ dimension ];
+			influence = _mm256_add_ps( influence, _mm256_mul_ps( gradientComponent, offset ) );
+		}
+		influences[ corner ] = influence;
+	}
+
+	unsigned int remainingCorners = NUMBER_OF_CORNERS;
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		__m256 weight = SmoothStep8( offsetInCell[ dimension ] );
+		remainingCorners >>= 1;
+		for( unsigned int pair = 0; pair < remainingCorners; ++pair )
+		{
+			__m256 difference = _mm256_sub_ps( influences[ 2 * pair + 1 ], influences[ 2 * pair ] );
+			influences[ pair ] = _mm256_add_ps( influences[ 2 * pair ], _mm256_mul_ps( weight, difference ) );
+		}
+	}
+	return influences[ 0 ];
+}
+#endif
+
+#if defined( NOISE_USE_SSE2 )
+//-----------------------------------------------------------------------------------------------
+//32 bit multiply keeping the low half; SSE2 only has the 32x32->64 bit _mm_mul_epu32 for lanes 0 and 2.
+inline __m128i MultiplyLow4( __m128i a, __m128i b )
+{
+	__m128i evenProducts = _mm_mul_epu32( a, b );
+	__m128i oddProducts = _mm_mul_epu32( _mm_srli_si128( a, 4 ), _mm_srli_si128( b, 4 ) );
+	return _mm_unpacklo_epi32( _mm_shuffle_epi32( evenProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ), _mm_shuffle_epi32( oddProducts, _MM_SHUFFLE( 0, 0, 2, 0 ) ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Four lanes of GenerateLatticeNoise, with the same operation order so the results match it exactly.
+//SSE2 has no gather, so the gradient components are fetched one lane at a time.
+template< unsigned int DIMENSIONS >
+inline __m128 GenerateLatticeNoise4( const __m128* latticePosition )
+{
+	static const unsigned int NUMBER_OF_CORNERS = 1 << DIMENSIONS;
+	const float ( &gradients )[ MAX_NOISE_DIMENSIONS ][ GRADIENT_TABLE_SIZE ] = s_gradientTables.components[ DIMENSIONS - 3 ];
+	const __m128 ONE = _mm_set1_ps( 1.f );
+	const __m128i ONE_INTEGER = _mm_set1_epi32( 1 );
+
+	__m128  offsetInCell[ DIMENSIONS ];
+	__m128  offsetFromFarCorner[ DIMENSIONS ];
+	__m128i hashedCell[ DIMENSIONS ][ 2 ];
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		__m128i cell;
+		__m128 cellStart;
+		Floor4( latticePosition[ dimension ], cell, cellStart );
+		offsetInCell[ dimension ] = _mm_sub_ps( latticePosition[ dimension ], cellStart );
+		offsetFromFarCorner[ dimension ] = _mm_sub_ps( offsetInCell[ dimension ], ONE );
+
+		__m128i multiplier = _mm_set1_epi32( static_cast< int >( LATTICE_HASH_MULTIPLIERS[ dimension ] ) );
+		hashedCell[ dimension ][ 0 ] = MultiplyLow4( cell, multiplier );
+		hashedCell[ dimension ][ 1 ] = MultiplyLow4( _mm_add_epi32( cell, ONE_INTEGER ), multiplier );
+	}
+
+	__m128 influences[ NUMBER_OF_CORNERS ];
+	for( unsigned int corner = 0; corner < NUMBER_OF_CORNERS; ++corner )
+	{
+		__m128i hash = _mm_set1_epi32( static_cast< int >( LATTICE_HASH_SEED ) );
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			hash = _mm_xor_si128( hash, hashedCell[ dimension ][ ( corner >> dimension ) & 1 ] );
+
+		hash = _mm_xor_si128( hash, _mm_srli_epi32( hash, 15 ) );
+		hash = MultiplyLow4( hash, _mm_set1_epi32( static_cast< int >( LATTICE_HASH_MIXER ) ) );
+		hash = _mm_xor_si128( hash, _mm_srli_epi32( hash, 12 ) );
+		hash = _mm_and_si128( hash, _mm_set1_epi32( GRADIENT_TABLE_MASK ) );
+		int hashes[ 4 ];
+		_mm_storeu_si128( reinterpret_cast< __m128i* >( hashes ), hash );
+
+		__m128 influence = _mm_setzero_ps();
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+		{
+			const float* gradientComponents = gradients[ dimension ];
+			__m128 gradientComponent = _mm_setr_ps( gradientComponents[ hashes[ 0 ] ], gradientComponents[ hashes[ 1 ] ], gradientComponents[ hashes[ 2 ] ], gradientComponents[ hashes[ 3 ] ] );
+			__m128 offset = ( ( corner >> dimension ) & 1 ) ? offsetFromFarCorner[ dimension ] : offsetInCell[ dimension ];
+			influence = _mm_add_ps( influence, _mm_mul_ps( gradientComponent, offset ) );
+		}
+		influences[ corner ] = influence;
+	}
+
+	unsigned int remainingCorners = NUMBER_OF_CORNERS;
+	for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+	{
+		__m128 weight = SmoothStep4( offsetInCell[ dimension ] );
+		remainingCorners >>= 1;
+		for( unsigned int pair = 0; pair < remainingCorners; ++pair )
+		{
+			__m128 difference = _mm_sub_ps( influences[ 2 * pair + 1 ], influences[ 2 * pair ] );
+			influences[ pair ] = _mm_add_ps( influences[ 2 * pair ], _mm_mul_ps( weight, difference ) );
+		}
+	}
+	return influences[ 0 ];
+}
+#endif
+
+//-----------------------------------------------------------------------------------------------
+//Shared driver for the batch functions. coordinates[ d ] points at the d'th input stream.
+template< unsigned int DIMENSIONS >
+void GenerateFractalLatticeNoiseBatch( const float* const* coordinates, float* out_noise, unsigned int count,
+									   float startingBlockSize, float persistence, unsigned int octaves )
+{
+	unsigned int index = 0;
+
+#if defined( __AVX2__ )
+	static const unsigned int LANES = 8;
+	for( ; index + LANES <= count; index += LANES )
+	{
+		__m256 position[ DIMENSIONS ];
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			position[ dimension ] = _mm256_loadu_ps( coordinates[ dimension ] + index );
+
+		__m256 total = _mm256_setzero_ps();
+		float amplitude = 1.f;
+		float inverseBlockSize = 1.f / startingBlockSize;
+		__m256 latticePosition[ DIMENSIONS ];
+		for( unsigned int tone = 0; tone < octaves; ++tone )
+		{
+			__m256 scale = _mm256_set1_ps( inverseBlockSize );
+			for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+				latticePosition[ dimension ] = _mm256_mul_ps( position[ dimension ], scale );
+
+			__m256 octaveNoise = GenerateLatticeNoise8< DIMENSIONS >( latticePosition );
+			total = _mm256_add_ps( total, _mm256_mul_ps( octaveNoise, _mm256_set1_ps( amplitude ) ) );
+
+			amplitude *= persistence;
+			inverseBlockSize *= 2.f;
+		}
+		_mm256_storeu_ps( out_noise + index, total );
+	}
+#endif
+
+#if defined( NOISE_USE_SSE2 )
+	static const unsigned int SSE_LANES = 4;
+	for( ; index + SSE_LANES <= count; index += SSE_LANES )
+	{
+		__m128 position[ DIMENSIONS ];
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			position[ dimension ] = _mm_loadu_ps( coordinates[ dimension ] + index );
+
+		__m128 total = _mm_setzero_ps();
+		float amplitude = 1.f;
+		float inverseBlockSize = 1.f / startingBlockSize;
+		__m128 latticePosition[ DIMENSIONS ];
+		for( unsigned int tone = 0; tone < octaves; ++tone )
+		{
+			__m128 scale = _mm_set1_ps( inverseBlockSize );
+			for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+				latticePosition[ dimension ] = _mm_mul_ps( position[ dimension ], scale );
+
+			__m128 octaveNoise = GenerateLatticeNoise4< DIMENSIONS >( latticePosition );
+			total = _mm_add_ps( total, _mm_mul_ps( octaveNoise, _mm_set1_ps( amplitude ) ) );
+
+			amplitude *= persistence;
+			inverseBlockSize *= 2.f;
+		}
+		_mm_storeu_ps( out_noise + index, total );
+	}
+#endif
+
+	float position[ DIMENSIONS ];
+	for( ; index < count; ++index )
+	{
+		for( unsigned int dimension = 0; dimension < DIMENSIONS; ++dimension )
+			position[ dimension ] = coordinates[ dimension ][ index ];
+
+		out_noise[ index ] = GenerateFractalLatticeNoise< DIMENSIONS >( position, startingBlockSize, persistence, octaves );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void PerlinNoise3DBatch( const float* xs, const float* ys, const float* zs, float* out_noise, unsigned int count,
+						 float startingBlockSize, float persistence, unsigned int octaves )
+{
+	const float* coordinates[ 3 ] = { xs, ys, zs };
+	GenerateFractalLatticeNoiseBatch< 3 >( coordinates, out_noise, count, startingBlockSize, persistence, octaves );
+}
+
+//-----------------------------------------------------------------------------------------------
+void PerlinNoise4DBatch( const float* xs, const float* ys, const float* zs, const float* ws, float* out_noise, unsigned int count,
+						 float startingBlockSize, float persistence, unsigned int octaves )
+{
+	const float* coordinates[ 4 ] = { xs, ys, zs, ws };
+	GenerateFractalLatticeNoiseBatch< 4 >( coordinates, out_noise, count, startingBlockSize, persistence, octaves );
+}
+
+//-----------------------------------------------------------------------------------------------
+float PerlinNoise3D( float x, float y, float z, float startingBlockSize, float persistence, unsigned int octaves )
+{
+	float position[ 3 ] = { x, y, z };
+	return GenerateFractalLatticeNoise< 3 >( position, startingBlockSize, persistence, octaves );
+}
+
+//-----------------------------------------------------------------------------------------------
+float PerlinNoise4D( float x, float y, float z, float w, float startingBlockSize, float persistence, unsigned int octaves )
+{
+	float position[ 4 ] = { x, y, z, w };
+	return GenerateFractalLatticeNoise< 4 >( position, startingBlockSize, persistence, octaves );
+}
@@ -0,0 +1,267 @@
+#include <iomanip>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <sstream>
+#include "Profiler.hpp"
+#include "Time.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC std::atomic< bool > Profiler::s_isEnabled( true );
+
+//-----------------------------------------------------------------------------------------------
+struct ZoneRecord
+{
+	const char* name;
+	unsigned int depth;
+	long long startCounts;
+	long long endCounts;
+};
+
+//-----------------------------------------------------------------------------------------------
+//Records stay in the order their zones began, so the depths alone are enough to rebuild the tree.
+struct ThreadZoneBuffer
+{
+	unsigned int threadIndex;
+	bool threadHasExited;
+	std::vector< ZoneRecord > openRecords;
+	std::vector< unsigned int > openZoneStack;
+
+	std::mutex completedRecordsLock;
+	std::vector< ZoneRecord > completedRecords;
+
+	explicit ThreadZoneBuffer( unsigned int index )
+		: threadIndex( index )
+		, threadHasExited( false )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+typedef std::pair< unsigned int, std::string > ZoneKey;
+
+static std::mutex g_threadBufferRegistryLock;
+static std::vector< std::shared_ptr< ThreadZoneBuffer > > g_threadBuffers;
+static unsigned int g_nextThreadIndex = 0;
+static std::set< unsigned int > g_freeThreadIndices; //Left by exited threads, handed out lowest first
+
+static std::map< ZoneKey, Profiler::ZoneStatistics > g_zoneStatistics;
+static long long g_lastFrameEndCounts = 0;
+
+//-----------------------------------------------------------------------------------------------
+//Owned by the thread; flags its buffer for removal once the thread is gone and its records are collected.
+struct ThreadZoneBufferHandle
+{
+	std::shared_ptr< ThreadZoneBuffer > buffer;
+
+	~ThreadZoneBufferHandle()
+	{
+		if( buffer )
+		{
+			std::lock_guard< std::mutex > bufferLock( buffer->completedRecordsLock );
+			buffer->threadHasExited = true;
+		}
+	}
+};
+static thread_local ThreadZoneBufferHandle t_threadBuffer;
+
+//-----------------------------------------------------------------------------------------------
+//Reusing the indices of exited threads keeps short-lived workers (a std::async per wind slice) on
+//the same few rows of statistics, rather than adding a new set of rows for every thread ever made.
+static ThreadZoneBuffer& GetThreadZoneBuffer()
+{
+	if( !t_threadBuffer.buffer )
+	{
+		std::lock_guard< std::mutex > registryLock( g_threadBufferRegistryLock );
+		unsigned int threadIndex = g_nextThreadIndex;
+		if( g_freeThreadIndices.empty() )
+			++g_nextThreadIndex;
+		else
+		{
+			threadIndex = *g_freeThreadIndices.begin();
+			g_freeThreadIndices.erase( g_freeThreadIndices.begin() );
+		}
+		t_threadBuffer.buffer = std::make_shared< ThreadZoneBuffer >( threadIndex );
+		g_threadBuffers.push_back( t_threadBuffer.buffer );
+	}
+	return *t_threadBuffer.buffer;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::BeginZone( const char* zoneName )
+{
+	ThreadZoneBuffer& buffer = GetThreadZoneBuffer();
+
+	ZoneRecord record;
+	record.name = zoneName;
+	record.depth = buffer.openZoneStack.size();
+	record.endCounts = 0;
+
+	buffer.openZoneStack.push_back( buffer.openRecords.size() );
+	buffer.openRecords.push_back( record );
+	buffer.openRecords.back().startCounts = GetCurrentTimeCounts();
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::EndZone()
+{
+	long long endCounts = GetCurrentTimeCounts();
+	ThreadZoneBuffer& buffer = GetThreadZoneBuffer();
+	if( buffer.openZoneStack.empty() )
+		return;
+
+	buffer.openRecords[ buffer.openZoneStack.back() ].endCounts = endCounts;
+	buffer.openZoneStack.pop_back();
+
+	if( buffer.openZoneStack.empty() )
+	{
+		std::lock_guard< std::mutex > bufferLock( buffer.completedRecordsLock );
+		buffer.completedRecords.insert( buffer.completedRecords.end(), buffer.openRecords.begin(), buffer.openRecords.end() );
+		buffer.openRecords.clear();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::EndFrame()
+{
+	struct FrameZoneTotal
+	{
+		const char* name;
+		unsigned int depth;
+		unsigned int calls;
+		long long counts;
+	};
+
+	long long frameEndCounts = GetCurrentTimeCounts();
+	std::map< ZoneKey, FrameZoneTotal > frameTotals;
+
+	//The whole frame is its own zone, so everything else can be read against it
+	if( g_lastFrameEndCounts != 0 )
+	{
+		FrameZoneTotal frameTotal = { "Frame", 0, 1, frameEndCounts - g_lastFrameEndCounts };
+		frameTotals[ ZoneKey( 0, "Frame" ) ] = frameTotal;
+	}
+	g_lastFrameEndCounts = frameEndCounts;
+
+	std::vector< ZoneRecord > records;
+	std::vector< std::string > pathStack;
+	std::lock_guard< std::mutex > registryLock( g_threadBufferRegistryLock );
+	for( unsigned int bufferIndex = 0; bufferIndex < g_threadBuffers.size(); )
+	{
+		ThreadZoneBuffer& buffer = *g_threadBuffers[ bufferIndex ];
+		bool removeBuffer = false;
+		{
+			std::lock_guard< std::mutex > bufferLock( buffer.completedRecordsLock );
+			records.swap( buffer.completedRecords );
+			removeBuffer = buffer.threadHasExited;
+		}
+
+		pathStack.clear();
+		for( unsigned int i = 0; i < records.size(); ++i )
+		{
+			const ZoneRecord& record = records[ i ];
+			pathStack.resize( record.depth );
+			pathStack.push_back( ( record.depth == 0 ) ? std::string( record.name ) : pathStack.back() + "/" + record.name );
+
+			FrameZoneTotal& total = frameTotals[ ZoneKey( buffer.threadIndex, pathStack.back() ) ];
+			if( total.calls == 0 )
+			{
+				total.name = record.name;
+				total.depth = record.depth;
+				total.counts = 0;
+			}
+			++total.calls;
+			total.counts += record.endCounts - record.startCounts;
+		}
+		records.clear();
+
+		if( removeBuffer )
+		{
+			g_freeThreadIndices.insert( buffer.threadIndex );
+			g_threadBuffers.erase( g_threadBuffers.begin() + bufferIndex );
+		}
+		else
+			++bufferIndex;
+	}
+
+	double secondsPerCount = GetSecondsPerCount();
+	for( std::map< ZoneKey, ZoneStatistics >::iterator zone = g_zoneStatistics.begin(); zone != g_zoneStatistics.end(); ++zone )
+		zone->second.callsLastFrame = 0;
+
+	for( std::map< ZoneKey, FrameZoneTotal >::const_iterator frameZone = frameTotals.begin(); frameZone != frameTotals.end(); ++frameZone )
+	{
+		double seconds = frameZone->second.counts * secondsPerCount;
+
+		std::map< ZoneKey, ZoneStatistics >::iterator existingZone = g_zoneStatistics.find( frameZone->first );
+		if( existingZone == g_zoneStatistics.end() )
+		{
+			ZoneStatistics newZone;
+			newZone.path = frameZone->first.second;
+			newZone.name = frameZone->second.name;
+			newZone.threadIndex = frameZone->first.first;
+			newZone.depth = frameZone->second.depth;
+			newZone.framesRecorded = 0;
+			newZone.minimumSeconds = seconds;
+			newZone.maximumSeconds = seconds;
+			newZone.totalSeconds = 0.0;
+			existingZone = g_zoneStatistics.insert( std::make_pair( frameZone->first, newZone ) ).first;
+		}
+
+		ZoneStatistics& zone = existingZone->second;
+		++zone.framesRecorded;
+		zone.callsLastFrame = frameZone->second.calls;
+		zone.lastFrameSeconds = seconds;
+		zone.totalSeconds += seconds;
+		if( seconds < zone.minimumSeconds )
+			zone.minimumSeconds = seconds;
+		if( seconds > zone.maximumSeconds )
+			zone.maximumSeconds = seconds;
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::ResetStatistics()
+{
+	std::lock_guard< std::mutex > registryLock( g_threadBufferRegistryLock );
+	g_zoneStatistics.clear();
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::GetZoneStatistics( std::vector< ZoneStatistics >& out_statistics )
+{
+	std::lock_guard< std::mutex > registryLock( g_threadBufferRegistryLock );
+	out_statistics.clear();
+	for( std::map< ZoneKey, ZoneStatistics >::const_iterator zone = g_zoneStatistics.begin(); zone != g_zoneStatistics.end(); ++zone )
+		out_statistics.push_back( zone->second );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void Profiler::WriteReport( std::vector< std::string >& out_reportLines )
+{
+	static const double MILLISECONDS_PER_SECOND = 1000.0;
+
+	std::vector< ZoneStatistics > statistics;
+	GetZoneStatistics( statistics );
+
+	std::ostringstream header;
+	header << std::left << std::setw( 40 ) << "zone (thread)" << std::right << std::setw( 9 ) << "avg ms" 
+		   << std::setw( 9 ) << "min ms" << std::setw( 9 ) << "max ms" << std::setw( 7 ) << "calls";
+	out_reportLines.push_back( header.str() );
+
+	for( unsigned int i = 0; i < statistics.size(); ++i )
+	{
+		const ZoneStatistics& zone = statistics[ i ];
+
+		std::ostringstream indentedName;
+		indentedName << std::string( 2 * zone.depth, ' ' ) << zone.name << " (" << zone.threadIndex << ")";
+
+		std::ostringstream line;
+		line << std::fixed << std::setprecision( 3 );
+		line << std::left << std::setw( 40 ) << indentedName.str() << std::right 
+			 << std::setw( 9 ) << zone.GetAverageSeconds() * MILLISECONDS_PER_SECOND
+			 << std::setw( 9 ) << zone.minimumSeconds * MILLISECONDS_PER_SECOND
+			 << std::setw( 9 ) << zone.maximumSeconds * MILLISECONDS_PER_SECOND
+			 << std::setw( 7 ) << zone.callsLastFrame;
+		out_reportLines.push_back( line.str() );
+	}
+}
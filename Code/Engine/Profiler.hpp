@@ -0,0 +1,88 @@
+#ifndef INCLUDED_PROFILER_HPP
+#define INCLUDED_PROFILER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <atomic>
+#include <string>
+#include <vector>
+#include "EngineDefines.hpp"
+#include "TraceRecorder.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Times the enclosing scope under zoneName, which must be a string literal (only the pointer is kept).
+//Zones also go to the TraceRecorder while it is recording.
+#define PROFILE_ZONE_CONCATENATE_IMPLEMENTATION( a, b ) a##b
+#define PROFILE_ZONE_CONCATENATE( a, b ) PROFILE_ZONE_CONCATENATE_IMPLEMENTATION( a, b )
+#define PROFILE_ZONE( zoneName ) Profiler::ScopedZone PROFILE_ZONE_CONCATENATE( profileZone_, __LINE__ )( zoneName )
+
+//-----------------------------------------------------------------------------------------------
+//Scoped zone timing. Each thread records its zones into its own buffer and hands them over when its
+//outermost zone closes; EndFrame() collects every thread's zones into a tree per thread and keeps
+//min/avg/max of each zone's per-frame time. A thread's index is reused once it has exited, so
+//statistics are per live thread slot rather than per thread ever created.
+STATIC class Profiler
+{
+public:
+	//-----------------------------------------------------------------------------------------------
+	struct ZoneStatistics
+	{
+		std::string path; //Zone names from the thread's outermost zone down, separated by '/'
+		const char* name;
+		unsigned int threadIndex;
+		unsigned int depth;
+		unsigned int framesRecorded;
+		unsigned int callsLastFrame;
+		double lastFrameSeconds;
+		double minimumSeconds;
+		double maximumSeconds;
+		double totalSeconds;
+
+		double GetAverageSeconds() const { return ( framesRecorded == 0 ) ? 0.0 : totalSeconds / framesRecorded; }
+	};
+
+	//-----------------------------------------------------------------------------------------------
+	class ScopedZone
+	{
+	public:
+		explicit ScopedZone( const char* zoneName )
+			: m_zoneName( zoneName )
+			, m_isRecording( Profiler::IsEnabled() )
+			, m_isTracing( TraceRecorder::IsRecording() )
+		{
+			if( m_isRecording )
+				Profiler::BeginZone( zoneName );
+			if( m_isTracing )
+				TraceRecorder::RecordBegin( zoneName );
+		}
+
+		~ScopedZone()
+		{
+			if( m_isTracing )
+				TraceRecorder::RecordEnd( m_zoneName );
+			if( m_isRecording )
+				Profiler::EndZone();
+		}
+
+	private:
+		const char* m_zoneName;
+		bool m_isRecording;
+		bool m_isTracing;
+	};
+
+	static void BeginZone( const char* zoneName );
+	static void EndZone();
+	static void EndFrame();
+
+	static bool IsEnabled() { return s_isEnabled.load( std::memory_order_relaxed ); }
+	static void SetEnabled( bool isEnabled ) { s_isEnabled.store( isEnabled, std::memory_order_relaxed ); }
+
+	static void ResetStatistics();
+	static void GetZoneStatistics( std::vector< ZoneStatistics >& out_statistics );
+	static void WriteReport( std::vector< std::string >& out_reportLines );
+
+private:
+	static std::atomic< bool > s_isEnabled;
+};
+
+#endif //INCLUDED_PROFILER_HPP
@@ -1,3 +1,5 @@
+#include "../../Game/EngineSettings.hpp"
+#ifdef AUDIO_USE_FMOD
 #include "FMODMixer.hpp"
 
 //-----------------------------------------------------------------------------------------------
@@ -99,3 +101,5 @@ Mixer::Sound* FMODMixer::GetOrLoadSound( const std::string& fileLocation )
 
 	return soundIterator->second;
 }
+
+#endif //AUDIO_USE_FMOD
@@ -1,6 +1,8 @@
 #include "Mixer.hpp"
-#include "FMODMixer.hpp"
 #include "../../Game/EngineSettings.hpp"
+#ifdef AUDIO_USE_FMOD
+	#include "FMODMixer.hpp"
+#endif
 
 STATIC Mixer* Mixer::s_audioMixer = nullptr;
 STATIC std::map< std::string, Mixer::Sound* > Mixer::s_soundRegistry;
@@ -0,0 +1,156 @@
+#ifndef INCLUDED_STRING_ID_HPP
+#define INCLUDED_STRING_ID_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <string>
+#include <type_traits>
+#include <cstring>
+#include <vector>
+
+//-----------------------------------------------------------------------------------------------
+//A 32-bit FNV-1a hash of a name. Compare these instead of strings anywhere a name is looked up
+//more than once; the string only needs hashing when it is first seen.
+typedef unsigned int StringID;
+
+static const StringID FNV_OFFSET_BASIS = 2166136261u;
+static const StringID FNV_PRIME = 16777619u;
+
+//-----------------------------------------------------------------------------------------------
+constexpr StringID HashStringAtCompileTime( const char* string, StringID hash = FNV_OFFSET_BASIS )
+{
+	return ( *string == '\0' ) ? hash : HashStringAtCompileTime( string + 1, ( hash ^ static_cast< unsigned char >( *string ) ) * FNV_PRIME );
+}
+
+//Forces the hash of a string literal to be computed by the compiler, even in a debug build.
+#define STRING_ID( stringLiteral ) ( std::integral_constant< StringID, HashStringAtCompileTime( stringLiteral ) >::value )
+
+//-----------------------------------------------------------------------------------------------
+inline StringID HashString( const char* string, size_t length )
+{
+	StringID hash = FNV_OFFSET_BASIS;
+	for( size_t i = 0; i < length; ++i )
+		hash = ( hash ^ static_cast< unsigned char >( string[ i ] ) ) * FNV_PRIME;
+	return hash;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline StringID HashString( const char* string )
+{
+	return HashString( string, strlen( string ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline StringID HashString( const std::string& string )
+{
+	return HashString( string.data(), string.length() );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline StringID CombineStringIDs( StringID first, StringID second )
+{
+	return ( first ^ ( second + 0x9e3779b9u + ( first << 6 ) + ( first >> 2 ) ) );
+}
+
+
+
+//-----------------------------------------------------------------------------------------------
+//A small open-addressing table from StringIDs to ints, for per-object name lookups (shader
+//uniforms, attributes) that happen every frame. Lookups never allocate or touch a string.
+//-----------------------------------------------------------------------------------------------
+class StringIDTable
+{
+	static const unsigned int MINIMUM_CAPACITY = 16;
+
+	struct Slot
+	{
+		StringID id;
+		int value;
+		bool isOccupied;
+
+		Slot() : id( 0 ), value( 0 ), isOccupied( false ) { }
+	};
+
+	std::vector< Slot > m_slots;
+	unsigned int m_numberOfEntries;
+
+	void Grow();
+
+public:
+	StringIDTable()
+		: m_numberOfEntries( 0 )
+	{ }
+
+	void Clear() { m_slots.clear(); m_numberOfEntries = 0; }
+	bool Contains( StringID id ) const;
+	int Find( StringID id, int valueIfMissing ) const;
+	unsigned int GetNumberOfEntries() const { return m_numberOfEntries; }
+	void Insert( StringID id, int value );
+};
+
+//-----------------------------------------------------------------------------------------------
+inline void StringIDTable::Grow()
+{
+	std::vector< Slot > oldSlots;
+	oldSlots.swap( m_slots );
+	m_slots.resize( oldSlots.empty() ? MINIMUM_CAPACITY : oldSlots.size() * 2 );
+	m_numberOfEntries = 0;
+
+	for( unsigned int i = 0; i < oldSlots.size(); ++i )
+	{
+		if( oldSlots[ i ].isOccupied )
+			Insert( oldSlots[ i ].id, oldSlots[ i ].value );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+inline bool StringIDTable::Contains( StringID id ) const
+{
+	if( m_slots.empty() )
+		return false;
+
+	unsigned int mask = m_slots.size() - 1;
+	for( unsigned int slotIndex = id & mask; m_slots[ slotIndex ].isOccupied; slotIndex = ( slotIndex + 1 ) & mask )
+	{
+		if( m_slots[ slotIndex ].id == id )
+			return true;
+	}
+	return false;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline int StringIDTable::Find( StringID id, int valueIfMissing ) const
+{
+	if( m_slots.empty() )
+		return valueIfMissing;
+
+	//The table is never more than half full, so this always reaches an empty slot
+	unsigned int mask = m_slots.size() - 1;
+	for( unsigned int slotIndex = id & mask; m_slots[ slotIndex ].isOccupied; slotIndex = ( slotIndex + 1 ) & mask )
+	{
+		if( m_slots[ slotIndex ].id == id )
+			return m_slots[ slotIndex ].value;
+	}
+	return valueIfMissing;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void StringIDTable::Insert( StringID id, int value )
+{
+	if( ( m_numberOfEntries + 1 ) * 2 > m_slots.size() )
+		Grow();
+
+	unsigned int mask = m_slots.size() - 1;
+	unsigned int slotIndex = id & mask;
+	while( m_slots[ slotIndex ].isOccupied && m_slots[ slotIndex ].id != id )
+		slotIndex = ( slotIndex + 1 ) & mask;
+
+	Slot& slot = m_slots[ slotIndex ];
+	if( !slot.isOccupied )
+		++m_numberOfEntries;
+	slot.id = id;
+	slot.value = value;
+	slot.isOccupied = true;
+}
+
+#endif //INCLUDED_STRING_ID_HPP
@@ -1,8 +1,10 @@
-#define WIN32_LEAN_AND_MEAN
-#include <windows.h>
 #include <assert.h>
 #include "Time.hpp"
 
+#if defined( _WIN32 )
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+
 //----------------------------------------------------------------------------------------------------
 static double g_secondsPerCount = 0.0;
 
@@ -18,6 +20,21 @@ double GetCurrentTimeSeconds()
 	return timeSeconds;
 }
 
+//----------------------------------------------------------------------------------------------------
+long long GetCurrentTimeCounts()
+{
+	LARGE_INTEGER performanceCount;
+	QueryPerformanceCounter( &performanceCount );
+	return performanceCount.QuadPart;
+}
+
+//----------------------------------------------------------------------------------------------------
+double GetSecondsPerCount()
+{
+	assert( g_secondsPerCount != 0.0 );
+	return g_secondsPerCount;
+}
+
 //----------------------------------------------------------------------------------------------------
 void InitializeTimer()
 {
@@ -25,3 +42,35 @@ void InitializeTimer()
 	QueryPerformanceFrequency( &countsPerSecond );
 	g_secondsPerCount = 1.0 / static_cast< double>( countsPerSecond.QuadPart );
 }
+
+#else
+#include <chrono>
+
+//----------------------------------------------------------------------------------------------------
+typedef std::chrono::steady_clock TimerClock;
+static const double SECONDS_PER_CLOCK_COUNT = static_cast< double >( TimerClock::period::num ) / TimerClock::period::den;
+
+//----------------------------------------------------------------------------------------------------
+double GetCurrentTimeSeconds()
+{
+	return static_cast< double >( GetCurrentTimeCounts() ) * SECONDS_PER_CLOCK_COUNT;
+}
+
+//----------------------------------------------------------------------------------------------------
+long long GetCurrentTimeCounts()
+{
+	return static_cast< long long >( TimerClock::now().time_since_epoch().count() );
+}
+
+//----------------------------------------------------------------------------------------------------
+double GetSecondsPerCount()
+{
+	return SECONDS_PER_CLOCK_COUNT;
+}
+
+//----------------------------------------------------------------------------------------------------
+void InitializeTimer()
+{
+	//steady_clock needs no setup
+}
+#endif
@@ -6,4 +6,9 @@
 double GetCurrentTimeSeconds();
 void InitializeTimer();
 
+//----------------------------------------------------------------------------------------------------
+//Raw counter access for code that takes lots of timestamps and converts them later (profiling).
+long long GetCurrentTimeCounts();
+double GetSecondsPerCount();
+
 #endif //INCLUDED_TIME_HPP
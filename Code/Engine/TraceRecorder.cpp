@@ -0,0 +1,303 @@
+#include <algorithm>
+#include <cstdio>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "Time.hpp"
+#include "TraceRecorder.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC std::atomic< bool > TraceRecorder::s_isRecording( false );
+
+//-----------------------------------------------------------------------------------------------
+struct TraceEvent
+{
+	const char* name;
+	long long timestampCounts;
+	unsigned int threadIndex;
+	char phase;
+
+	bool operator<( const TraceEvent& other ) const { return timestampCounts < other.timestampCounts; }
+};
+
+//-----------------------------------------------------------------------------------------------
+//Only ever written by its own thread, and only read by Stop once isWriting is down.
+struct ThreadTraceBuffer
+{
+	std::atomic< bool > threadHasExited;
+	std::atomic< bool > isWriting;
+	unsigned int threadIndex;
+	std::vector< TraceEvent > events; //Grows to the capacity, then wraps
+	unsigned long long numberOfEventsRecorded;
+
+	explicit ThreadTraceBuffer( unsigned int traceThreadIndex )
+		: threadHasExited( false )
+		, isWriting( false )
+		, threadIndex( traceThreadIndex )
+		, numberOfEventsRecorded( 0 )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+//Owned by the thread; flags its buffer for removal at the next Start once the thread is gone.
+struct ThreadTraceBufferHandle
+{
+	std::shared_ptr< ThreadTraceBuffer > buffer;
+
+	~ThreadTraceBufferHandle()
+	{
+		if( buffer )
+			buffer->threadHasExited = true;
+	}
+};
+
+//-----------------------------------------------------------------------------------------------
+static std::mutex g_traceBufferRegistryLock;
+static std::vector< std::shared_ptr< ThreadTraceBuffer > > g_threadTraceBuffers;
+static unsigned int g_traceCapacityPerThread = 0; //Guarded by g_traceBufferRegistryLock
+static long long g_traceStartCounts = 0;
+static bool g_hasStarted = false;
+static std::vector< TraceEvent > g_mergedTraceEvents;
+static std::vector< const char* > g_openZoneNames; //Only used while merging, but kept so merging doesn't allocate
+
+static std::atomic< unsigned int > g_nextTraceThreadIndex( 0 );
+static thread_local unsigned int t_traceThreadIndex = ~0u;
+static thread_local ThreadTraceBufferHandle t_threadTraceBuffer;
+
+static std::mutex g_threadNamesLock;
+static std::map< unsigned int, std::string > g_threadNames;
+
+//-----------------------------------------------------------------------------------------------
+static unsigned int GetTraceThreadIndex()
+{
+	if( t_traceThreadIndex == ~0u )
+		t_traceThreadIndex = g_nextTraceThreadIndex.fetch_add( 1, std::memory_order_relaxed );
+	return t_traceThreadIndex;
+}
+
+//-----------------------------------------------------------------------------------------------
+static ThreadTraceBuffer& GetThreadTraceBuffer()
+{
+	if( !t_threadTraceBuffer.buffer )
+	{
+		std::lock_guard< std::mutex > registryLock( g_traceBufferRegistryLock );
+		t_threadTraceBuffer.buffer = std::make_shared< ThreadTraceBuffer >( GetTraceThreadIndex() );
+		t_threadTraceBuffer.buffer->events.reserve( std::min( g_traceCapacityPerThread, 1024u ) );
+		g_threadTraceBuffers.push_back( t_threadTraceBuffer.buffer );
+	}
+	return *t_threadTraceBuffer.buffer;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Capacity is rounded up to a power of two so slots can be found with a mask. Stop has waited out
+//every writer by the time the buffers are cleared, so none can be left writing into them.
+STATIC void TraceRecorder::Start( unsigned int capacityEvents )
+{
+	Stop();
+
+	unsigned int roundedCapacity = 1;
+	while( roundedCapacity < capacityEvents )
+		roundedCapacity <<= 1;
+
+	{
+		std::lock_guard< std::mutex > registryLock( g_traceBufferRegistryLock );
+		g_traceCapacityPerThread = roundedCapacity;
+		for( unsigned int i = 0; i < g_threadTraceBuffers.size(); )
+		{
+			if( g_threadTraceBuffers[ i ]->threadHasExited )
+			{
+				g_threadTraceBuffers.erase( g_threadTraceBuffers.begin() + i );
+				continue;
+			}
+
+			ThreadTraceBuffer& buffer = *g_threadTraceBuffers[ i ];
+			buffer.events.clear();
+			buffer.numberOfEventsRecorded = 0;
+			++i;
+		}
+	}
+
+	g_mergedTraceEvents.clear();
+	g_hasStarted = true;
+	g_traceStartCounts = GetCurrentTimeCounts();
+	s_isRecording.store( true );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Adds one thread's surviving events to out_events, oldest first, dropping ends whose begins were
+//overwritten and closing zones still open at endCounts.
+static void AppendMatchedThreadEvents( const ThreadTraceBuffer& buffer, unsigned int capacity, long long endCounts, std::vector< TraceEvent >& out_events )
+{
+	g_openZoneNames.clear();
+
+	unsigned long long endIndex = buffer.numberOfEventsRecorded;
+	unsigned long long startIndex = ( endIndex > capacity ) ? endIndex - capacity : 0;
+	for( unsigned long long eventIndex = startIndex; eventIndex < endIndex; ++eventIndex )
+	{
+		const TraceEvent& traceEvent = buffer.events[ eventIndex & ( capacity - 1 ) ];
+		if( traceEvent.phase == 'B' )
+		{
+			g_openZoneNames.push_back( traceEvent.name );
+		}
+		else if( traceEvent.phase == 'E' )
+		{
+			if( g_openZoneNames.empty() )
+				continue;
+			g_openZoneNames.pop_back();
+		}
+		out_events.push_back( traceEvent );
+	}
+
+	while( !g_openZoneNames.empty() )
+	{
+		TraceEvent closingEvent;
+		closingEvent.name = g_openZoneNames.back();
+		closingEvent.timestampCounts = endCounts;
+		closingEvent.threadIndex = buffer.threadIndex;
+		closingEvent.phase = 'E';
+		out_events.push_back( closingEvent );
+		g_openZoneNames.pop_back();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void TraceRecorder::Stop()
+{
+	if( !IsRecording() )
+		return;
+
+	s_isRecording.store( false );
+	long long stopCounts = GetCurrentTimeCounts();
+
+	std::lock_guard< std::mutex > registryLock( g_traceBufferRegistryLock );
+	g_mergedTraceEvents.clear();
+	for( unsigned int i = 0; i < g_threadTraceBuffers.size(); ++i )
+	{
+		ThreadTraceBuffer& buffer = *g_threadTraceBuffers[ i ];
+		while( buffer.isWriting.load() )
+			std::this_thread::yield();
+
+		AppendMatchedThreadEvents( buffer, g_traceCapacityPerThread, stopCounts, g_mergedTraceEvents );
+	}
+
+	//Each thread's events are already in order, so a stable sort keeps a thread's ties in order too
+	std::stable_sort( g_mergedTraceEvents.begin(), g_mergedTraceEvents.end() );
+}
+
+//-----------------------------------------------------------------------------------------------
+//A writer raises its flag before looking at the recording flag again, so once Stop has cleared the
+//recording flag and seen a thread's flag down, that thread either finished or touched nothing.
+STATIC void TraceRecorder::RecordEvent( const char* eventName, char phase )
+{
+	ThreadTraceBuffer& buffer = GetThreadTraceBuffer();
+	buffer.isWriting.store( true );
+	if( !s_isRecording.load() )
+	{
+		buffer.isWriting.store( false, std::memory_order_release );
+		return;
+	}
+
+	TraceEvent traceEvent;
+	traceEvent.name = eventName;
+	traceEvent.timestampCounts = GetCurrentTimeCounts();
+	traceEvent.threadIndex = buffer.threadIndex;
+	traceEvent.phase = phase;
+
+	if( buffer.events.size() < g_traceCapacityPerThread )
+		buffer.events.push_back( traceEvent );
+	else
+		buffer.events[ buffer.numberOfEventsRecorded & ( g_traceCapacityPerThread - 1 ) ] = traceEvent;
+	++buffer.numberOfEventsRecorded;
+
+	buffer.isWriting.store( false, std::memory_order_release );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC void TraceRecorder::SetCurrentThreadName( const std::string& threadName )
+{
+	std::lock_guard< std::mutex > namesLock( g_threadNamesLock );
+	g_threadNames[ GetTraceThreadIndex() ] = threadName;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC unsigned int TraceRecorder::GetNumberOfRecordedEvents()
+{
+	return g_mergedTraceEvents.size();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Escapes the characters JSON requires; zone names are plain identifiers, so this is rarely used.
+static void WriteJSONString( FILE* file, const char* text )
+{
+	fputc( '"', file );
+	for( const char* character = text; *character != '\0'; ++character )
+	{
+		if( *character == '"' || *character == '\\' )
+			fputc( '\\', file );
+		if( static_cast< unsigned char >( *character ) >= 0x20 )
+			fputc( *character, file );
+	}
+	fputc( '"', file );
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool TraceRecorder::WriteChromeTraceFile( const std::string& filePath )
+{
+	if( !g_hasStarted )
+		return false;
+
+	bool wasRecording = IsRecording();
+	Stop();
+	bool wasWritten = WriteStoppedTraceFile( filePath );
+	if( wasRecording )
+		s_isRecording.store( true );
+	return wasWritten;
+}
+
+//-----------------------------------------------------------------------------------------------
+STATIC bool TraceRecorder::WriteStoppedTraceFile( const std::string& filePath )
+{
+	FILE* traceFile = nullptr;
+#if defined( _WIN32 )
+	if( fopen_s( &traceFile, filePath.c_str(), "w" ) != 0 )
+		traceFile = nullptr;
+#else
+	traceFile = fopen( filePath.c_str(), "w" );
+#endif
+	if( traceFile == nullptr )
+		return false;
+
+	static const double MICROSECONDS_PER_SECOND = 1000000.0;
+	double microsecondsPerCount = GetSecondsPerCount() * MICROSECONDS_PER_SECOND;
+
+	fprintf( traceFile, "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[\n" );
+	bool isFirstEvent = true;
+
+	{
+		std::lock_guard< std::mutex > namesLock( g_threadNamesLock );
+		for( std::map< unsigned int, std::string >::const_iterator threadName = g_threadNames.begin(); threadName != g_threadNames.end(); ++threadName )
+		{
+			fprintf( traceFile, "%s{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":%u,\"args\":{\"name\":", isFirstEvent ? "" : ",\n", threadName->first );
+			WriteJSONString( traceFile, threadName->second.c_str() );
+			fprintf( traceFile, "}}" );
+			isFirstEvent = false;
+		}
+	}
+
+	for( unsigned int eventIndex = 0; eventIndex < g_mergedTraceEvents.size(); ++eventIndex )
+	{
+		const TraceEvent& traceEvent = g_mergedTraceEvents[ eventIndex ];
+		double timestampMicroseconds = ( traceEvent.timestampCounts - g_traceStartCounts ) * microsecondsPerCount;
+		fprintf( traceFile, "%s{\"name\":", isFirstEvent ? "" : ",\n" );
+		WriteJSONString( traceFile, traceEvent.name );
+		fprintf( traceFile, ",\"ph\":\"%c\",\"ts\":%.3f,\"pid\":1,\"tid\":%u%s}", traceEvent.phase, timestampMicroseconds, traceEvent.threadIndex,
+				 ( traceEvent.phase == 'i' ) ? ",\"s\":\"t\"" : "" );
+		isFirstEvent = false;
+	}
+
+	fprintf( traceFile, "\n]}\n" );
+	fclose( traceFile );
+	return true;
+}
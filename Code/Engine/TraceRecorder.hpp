@@ -0,0 +1,46 @@
+#ifndef INCLUDED_TRACE_RECORDER_HPP
+#define INCLUDED_TRACE_RECORDER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <atomic>
+#include <string>
+#include "EngineDefines.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Records begin/end events from any thread and writes them out as Chrome Trace Event JSON, for
+//chrome://tracing or ui.perfetto.dev. Each thread records into its own ring buffer (its oldest
+//events are overwritten) and flags itself while writing, so recording touches no shared cache
+//lines; Stop waits out those flags and merges the threads' events in time order. While stopped,
+//each call is one relaxed load. Start, Stop and WriteChromeTraceFile are meant to be called from
+//one thread.
+STATIC class TraceRecorder
+{
+public:
+	static const unsigned int DEFAULT_CAPACITY_EVENTS = 1 << 18;
+
+	//The capacity is for each thread, and only the events actually recorded take memory.
+	static void Start( unsigned int capacityEvents = DEFAULT_CAPACITY_EVENTS );
+	static void Stop();
+	static bool IsRecording() { return s_isRecording.load( std::memory_order_relaxed ); }
+
+	//Names must be string literals or otherwise outlive the recording; only the pointer is stored.
+	static void RecordBegin( const char* eventName ) { if( IsRecording() ) RecordEvent( eventName, 'B' ); }
+	static void RecordEnd( const char* eventName )	 { if( IsRecording() ) RecordEvent( eventName, 'E' ); }
+	static void RecordInstant( const char* eventName ) { if( IsRecording() ) RecordEvent( eventName, 'i' ); }
+	static void SetCurrentThreadName( const std::string& threadName );
+
+	//Counts the events merged by the last Stop.
+	static unsigned int GetNumberOfRecordedEvents();
+	//A recording in progress is paused while the file is written and then carries on; events
+	//from other threads during the write are dropped.
+	static bool WriteChromeTraceFile( const std::string& filePath );
+
+private:
+	static std::atomic< bool > s_isRecording;
+
+	static void RecordEvent( const char* eventName, char phase );
+	static bool WriteStoppedTraceFile( const std::string& filePath );
+};
+
+#endif //INCLUDED_TRACE_RECORDER_HPP
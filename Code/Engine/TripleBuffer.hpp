@@ -0,0 +1,71 @@
+#ifndef INCLUDED_TRIPLE_BUFFER_HPP
+#define INCLUDED_TRIPLE_BUFFER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <atomic>
+
+//-----------------------------------------------------------------------------------------------
+//Hands whole values from one producer thread to one consumer thread without either ever waiting.
+//The producer fills its slot and publishes it; the consumer takes the most recently published slot
+//and may read it for as long as it likes. The third slot sits between them, so publishing never
+//touches what the consumer holds. Values the consumer never took are simply overwritten.
+//
+//Slots are reused rather than reset, so a T holding vectors keeps its capacity between publishes.
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+class TripleBuffer
+{
+	static const unsigned int SLOT_INDEX_MASK = 0x3;
+	static const unsigned int HAS_NEW_VALUE_BIT = 0x4;
+
+	T m_slots[ 3 ];
+	std::atomic< unsigned int > m_sharedSlotState; //The middle slot's index, plus HAS_NEW_VALUE_BIT once published
+	unsigned int m_writeSlotIndex; //Producer only
+	unsigned int m_readSlotIndex; //Consumer only
+
+	//We have no need of a pithy assignment or copy operator!
+	TripleBuffer( const TripleBuffer& );
+	void operator=( const TripleBuffer& );
+
+public:
+	TripleBuffer()
+		: m_sharedSlotState( 1 )
+		, m_writeSlotIndex( 0 )
+		, m_readSlotIndex( 2 )
+	{ }
+
+	//Producer side
+	T& GetWriteSlot() { return m_slots[ m_writeSlotIndex ]; }
+	void Publish();
+
+	//Consumer side. Returns false, leaving the current read slot in place, if nothing new was published.
+	//Once HasNewValue is true it stays true until AcquireLatest, so the read slot can be copied first.
+	bool HasNewValue() const { return ( m_sharedSlotState.load( std::memory_order_relaxed ) & HAS_NEW_VALUE_BIT ) != 0; }
+	bool AcquireLatest();
+	const T& GetReadSlot() const { return m_slots[ m_readSlotIndex ]; }
+};
+
+
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline void TripleBuffer< T >::Publish()
+{
+	unsigned int previousState = m_sharedSlotState.exchange( m_writeSlotIndex | HAS_NEW_VALUE_BIT, std::memory_order_acq_rel );
+	m_writeSlotIndex = previousState & SLOT_INDEX_MASK;
+}
+
+//-----------------------------------------------------------------------------------------------
+template< typename T >
+inline bool TripleBuffer< T >::AcquireLatest()
+{
+	if( !HasNewValue() )
+		return false;
+
+	unsigned int previousState = m_sharedSlotState.exchange( m_readSlotIndex, std::memory_order_acq_rel );
+	m_readSlotIndex = previousState & SLOT_INDEX_MASK;
+	return true;
+}
+
+#endif //INCLUDED_TRIPLE_BUFFER_HPP
@@ -0,0 +1,176 @@
+//-----------------------------------------------------------------------------------------------
+//Entry point for platforms without Win32: runs the game with no window, input or audio against the
+//recording renderer, so a scripted run can profile Game::Render on a machine with no graphics card.
+//Build every .cpp under Engine and Game, plus the C stb_image.c, with GRAPHICS_USE_RECORDING defined,
+//e.g. from the Code directory:
+//	gcc -O2 -c Engine/Graphics/stb_image.c -o stb_image.o
+//	g++ -std=c++11 -O2 -DGRAPHICS_USE_RECORDING -I. $(find Engine Game -name "*.cpp") stb_image.o -lpthread -o Sandbox
+//and run it from the Code directory so Data/ resolves:
+//	./Sandbox -exec Data/Scripts/ClothThreadScaling.txt -trace trace.json
+#if !defined( _WIN32 )
+
+#include <string>
+#include "../Game/EngineSettings.hpp"
+#include "../Engine/Console/CommandConsole.hpp"
+#include "../Engine/Graphics/Renderer.hpp"
+#include "../Engine/Graphics/RenderCommandBuffer.hpp"
+#include "../Engine/Graphics/TextBatch.hpp"
+#include "../Engine/Graphics/Texture.hpp"
+#include "../Engine/Input/Keyboard.hpp"
+#include "../Engine/Input/Mouse.hpp"
+#include "../Engine/Input/Xbox.hpp"
+#include "../Engine/FramePacer.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Profiler.hpp"
+#include "../Engine/TraceRecorder.hpp"
+#include "../Engine/Time.hpp"
+#include "../Game/Sandbox.hpp"
+
+#ifndef GRAPHICS_USE_RECORDING
+	#error The headless entry point has no window to draw to; build it with GRAPHICS_USE_RECORDING.
+#endif
+
+//-----------------------------------------------------------------------------------------------
+bool g_isQuitting = false;
+
+//Game
+Game*			 g_gameInstance;
+
+//Graphics
+const int		 SCREEN_WIDTH = 1600;
+const int		 SCREEN_HEIGHT = 900;
+
+//Input (never fed, so the game sees no keys, buttons or mouse movement)
+Keyboard		 g_keyboard;
+Mouse			 g_mouse;
+Xbox::Controller g_controller;
+
+static const double LOCKED_FRAME_RATE_SECONDS = 1.0 / 60.0;
+
+void SetRendererSettings( Renderer* renderer )
+{
+	renderer->EnableFeature( Renderer::COLOR_BLENDING );
+	renderer->SetAlphaBlendingFunction( Renderer::SOURCE_ALPHA, Renderer::ONE_MINUS_SOURCE_ALPHA );
+	renderer->EnableFeature( Renderer::DEPTH_TESTING );
+	renderer->EnableFeature( Renderer::FACE_CULLING );
+
+	renderer->SetColorBufferClearValue( 0.f, 0.f, 0.f, 1.f );
+	renderer->SetDepthBufferClearValue( 1.f );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Update( double timeSpentLastFrameSeconds )
+{
+	float deltaSeconds = static_cast< float >( timeSpentLastFrameSeconds );
+
+	g_gameInstance->Update( deltaSeconds, g_keyboard, g_mouse, g_controller );
+	g_keyboard.Update();
+	g_mouse.Update();
+	g_controller.Update( deltaSeconds );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Render()
+{
+	Renderer* renderer = Renderer::GetRenderer();
+
+	renderer->ClearColorBuffer();
+	renderer->ClearDepthBuffer();
+
+	g_gameInstance->Render();
+}
+
+//-----------------------------------------------------------------------------------------------
+double WaitUntilNextFrameThenGiveFrameTime()
+{
+	FramePacer::WaitForNextFrame();
+
+	if( FramePacer::IsCapped() )
+		return FramePacer::GetTargetFrameSeconds();
+	return LOCKED_FRAME_RATE_SECONDS;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RunFrame()
+{
+	static double timeSpentLastFrameSeconds = LOCKED_FRAME_RATE_SECONDS;
+	Update( timeSpentLastFrameSeconds );
+	Render();
+	Renderer::GetRenderer()->EndFrame();
+	Profiler::EndFrame();
+	RenderCommandBuffer::EndFrame();
+	TextBatch::EndFrame();
+	TraceRecorder::RecordInstant( "Frame" );
+	timeSpentLastFrameSeconds = WaitUntilNextFrameThenGiveFrameTime();
+}
+
+void QuitGame( const CommandConsole::CommandArguments& )
+{
+	g_gameInstance->Quit();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Returns the value following the given flag on the command line, or an empty string if it's absent.
+std::string FindCommandLineValue( int argumentCount, char** arguments, const std::string& flag )
+{
+	for( int i = 1; i + 1 < argumentCount; ++i )
+	{
+		if( flag == arguments[ i ] )
+			return arguments[ i + 1 ];
+	}
+	return std::string();
+}
+
+//-----------------------------------------------------------------------------------------------
+int main( int argumentCount, char** arguments )
+{
+	InitializeTimer();
+	FramePacer::Initialize( LOCKED_FRAME_RATE_SECONDS );
+
+	//-trace <file> records the whole run and writes it out as a Chrome trace on exit
+	std::string traceFilePath = FindCommandLineValue( argumentCount, arguments, "-trace" );
+	TraceRecorder::SetCurrentThreadName( "Main" );
+	if( !traceFilePath.empty() )
+		TraceRecorder::Start();
+
+	g_gameInstance = new Sandbox( g_isQuitting, SCREEN_WIDTH, SCREEN_HEIGHT, 70.f );
+
+	Renderer::CreateRenderer();
+	SetRendererSettings( Renderer::GetRenderer() );
+
+	g_gameInstance->Initialize();
+	CommandConsole::RegisterConsoleCommand( "quit", QuitGame );
+
+	JobSystem::SetNumberOfThreads( JobSystem::GetNumberOfHardwareThreads() );
+
+	//-exec <script> replays a console script from the first frame; with nobody at the keyboard it
+	//should end in "quit", or the run goes on until it's killed
+	std::string scriptFilePath = FindCommandLineValue( argumentCount, arguments, "-exec" );
+	if( !scriptFilePath.empty() )
+		CommandConsole::GetConsole()->ExecuteScript( scriptFilePath );
+
+	while( !g_isQuitting )
+	{
+		RunFrame();
+	}
+	g_gameInstance->Shutdown();
+	JobSystem::Shutdown();
+	FramePacer::Shutdown();
+
+	if( !traceFilePath.empty() )
+	{
+		TraceRecorder::Stop();
+		TraceRecorder::WriteChromeTraceFile( traceFilePath );
+	}
+
+	//The console outlives the game, so its log file would otherwise never be flushed or closed
+	CommandConsole::GetConsole()->StopLogFile();
+
+	Texture::CleanUpTextureRepository();
+	int exitCode = g_gameInstance->GetExitCode();
+	delete g_gameInstance;
+
+	return exitCode;
+}
+
+#endif //!defined( _WIN32 )
@@ -1,3 +1,4 @@
+#if defined( _WIN32 )
 #define WIN32_LEAN_AND_MEAN
 #define UNICODE 0
 #include <windows.h>
@@ -5,13 +6,20 @@
 #include <cassert>
 #include <crtdbg.h>
 #include <map>
+#include <sstream>
 #include "../Engine/Console/CommandConsole.hpp"
 #include "../Engine/Graphics/Renderer.hpp"
+#include "../Engine/Graphics/RenderCommandBuffer.hpp"
+#include "../Engine/Graphics/TextBatch.hpp"
 #include "../Engine/Graphics/Texture.hpp"
 #include "../Engine/Input/Keyboard.hpp"
 #include "../Engine/Input/Mouse.hpp"
 #include "../Engine/Input/Xbox.hpp"
 #include "../Engine/Sound/Mixer.hpp"
+#include "../Engine/FramePacer.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Profiler.hpp"
+#include "../Engine/TraceRecorder.hpp"
 #include "../Engine/Time.hpp"
 #include "../Game/Sandbox.hpp"
 
@@ -270,31 +278,34 @@ void Render()
 
 	g_gameInstance->Render();
 
+	PROFILE_ZONE( "SwapBuffers" );
 	SwapBuffers( g_displayDeviceContext );
 }
 
 //-----------------------------------------------------------------------------------------------
+//Capped, the game steps by the pacer's target so game time keeps up with wall time at any rate.
+//Uncapped it keeps the fixed step, so a scripted run replays the same frames, only faster.
 double WaitUntilNextFrameThenGiveFrameTime()
 {
-	static double targetTime = 0.0;
-	double timeNow = GetCurrentTimeSeconds();
-
-	while( timeNow < targetTime )
-	{
-		timeNow = GetCurrentTimeSeconds();
-	}
-	targetTime = timeNow + LOCKED_FRAME_RATE_SECONDS;
+	FramePacer::WaitForNextFrame();
 
+	if( FramePacer::IsCapped() )
+		return FramePacer::GetTargetFrameSeconds();
 	return LOCKED_FRAME_RATE_SECONDS;
 }
 
 //-----------------------------------------------------------------------------------------------
 void RunFrame()
 {
-	static double timeSpentLastFrameSeconds = 0.0;
+	static double timeSpentLastFrameSeconds = LOCKED_FRAME_RATE_SECONDS;
 	RunMessagePump();
-	Update( LOCKED_FRAME_RATE_SECONDS );
+	Update( timeSpentLastFrameSeconds );
 	Render();
+	Renderer::GetRenderer()->EndFrame();
+	Profiler::EndFrame();
+	RenderCommandBuffer::EndFrame();
+	TextBatch::EndFrame();
+	TraceRecorder::RecordInstant( "Frame" );
 	timeSpentLastFrameSeconds = WaitUntilNextFrameThenGiveFrameTime();
 }
 
@@ -303,11 +314,31 @@ void QuitGame( const CommandConsole::CommandArguments& )
 	g_gameInstance->Quit();
 }
 
+//-----------------------------------------------------------------------------------------------
+//Returns the value following the given flag on the command line, or an empty string if it's absent.
+std::string FindCommandLineValue( const char* commandLineString, const std::string& flag )
+{
+	std::istringstream commandLineStream( commandLineString );
+	std::string token;
+	while( commandLineStream >> token )
+	{
+		if( token == flag && commandLineStream >> token )
+			return token;
+	}
+	return std::string();
+}
+
 //-----------------------------------------------------------------------------------------------
 int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR commandLineString, int )
 {
-	UNUSED( commandLineString );
 	InitializeTimer();
+	FramePacer::Initialize( LOCKED_FRAME_RATE_SECONDS );
+
+	//-trace <file> records the whole run and writes it out as a Chrome trace on exit
+	std::string traceFilePath = FindCommandLineValue( commandLineString, "-trace" );
+	TraceRecorder::SetCurrentThreadName( "Main" );
+	if( !traceFilePath.empty() )
+		TraceRecorder::Start();
 
 	g_gameInstance = new Sandbox( g_isQuitting, SCREEN_WIDTH, SCREEN_HEIGHT, 70.f );
 
@@ -321,18 +352,43 @@ int WINAPI WinMain( HINSTANCE applicationInstanceHandle, HINSTANCE, LPSTR comman
 	g_gameInstance->Initialize();
 	CommandConsole::RegisterConsoleCommand( "quit", QuitGame );
 
+	//The main thread sleeps out the end of each frame now rather than spinning, so every hardware
+	//thread can take a share of the parallel work
+	JobSystem::SetNumberOfThreads( JobSystem::GetNumberOfHardwareThreads() );
+
+	//-exec <script> replays a console script from the first frame, e.g. a perf scenario ending in "quit"
+	std::string scriptFilePath = FindCommandLineValue( commandLineString, "-exec" );
+	if( !scriptFilePath.empty() )
+		CommandConsole::GetConsole()->ExecuteScript( scriptFilePath );
+
 	while( !g_isQuitting )	
 	{
 		RunFrame();
 	}
+	g_gameInstance->Shutdown();
+	JobSystem::Shutdown();
+	FramePacer::Shutdown();
+
+	if( !traceFilePath.empty() )
+	{
+		TraceRecorder::Stop();
+		TraceRecorder::WriteChromeTraceFile( traceFilePath );
+	}
+
+	//The console outlives the game, so its log file would otherwise never be flushed or closed
+	CommandConsole::GetConsole()->StopLogFile();
+
 	Texture::CleanUpTextureRepository();
+	int exitCode = g_gameInstance->GetExitCode();
 	delete g_gameInstance;
 	
 
-#if defined( _WIN32 ) && defined( _DEBUG )
+#if defined( _DEBUG )
 	assert( _CrtCheckMemory() );
 	_CrtDumpMemoryLeaks();
 #endif
 
-	return 0;
+	return exitCode;
 }
+
+#endif //defined( _WIN32 )
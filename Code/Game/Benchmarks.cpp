@@ -0,0 +1,410 @@
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <iomanip>
+#include <map>
+#include <sstream>
+#include "../Engine/DebugDrawing.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Math/Float4x4Matrix.hpp"
+#include "../Engine/PerlinNoise.hpp"
+#include "../Engine/Time.hpp"
+#include "Benchmarks.hpp"
+#include "Cloth.hpp"
+
+//-----------------------------------------------------------------------------------------------
+typedef void ( *BenchmarkFunction )( const std::vector< std::string >& parameters );
+static std::map< std::string, BenchmarkFunction > s_benchmarkRegistry;
+
+static const Color BENCHMARK_TEXT_COLOR = Color( 0.6f, 1.f, 0.6f, 1.f );
+static const Color BENCHMARK_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+
+//-----------------------------------------------------------------------------------------------
+static unsigned int GetUnsignedParameter( const std::vector< std::string >& parameters, unsigned int index, unsigned int defaultValue )
+{
+	if( index >= parameters.size() )
+		return defaultValue;
+
+	int value = atoi( parameters[ index ].c_str() );
+	if( value <= 0 )
+		return defaultValue;
+	return static_cast< unsigned int >( value );
+}
+
+//-----------------------------------------------------------------------------------------------
+static void WriteBenchmarkTiming( const std::string& label, double seconds, unsigned int numberOfSamples, double baselineSeconds = 0.0 )
+{
+	std::ostringstream line;
+	line << std::fixed << std::setprecision( 2 );
+	line << label << ": " << ( seconds * 1000.0 ) << " ms, " << ( seconds * 1.0e9 / numberOfSamples ) << " ns/sample";
+	if( baselineSeconds > 0.0 && seconds > 0.0 )
+		line << " (" << ( baselineSeconds / seconds ) << "x)";
+
+	CommandConsole::GetConsole()->WriteTextToLog( line.str(), BENCHMARK_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//bench noise [numberOfSamples]
+void BenchmarkNoise( const std::vector< std::string >& parameters )
+{
+	static const float BLOCK_SIZE = 16.f;
+	static const float PERSISTENCE = 0.25f; //keeps the scalar version inside its asserted range
+	static const unsigned int OCTAVES = 4;
+	static const unsigned int SAMPLES_PER_ROW = 1024;
+
+	unsigned int numberOfSamples = GetUnsignedParameter( parameters, 0, 1 << 18 );
+
+	std::vector< float > xs( numberOfSamples ), ys( numberOfSamples ), zs( numberOfSamples ), ws( numberOfSamples );
+	std::vector< float > originalResults( numberOfSamples ), results( numberOfSamples );
+	for( unsigned int i = 0; i < numberOfSamples; ++i )
+	{
+		xs[ i ] = ( i % SAMPLES_PER_ROW ) * 0.37f - 100.f;
+		ys[ i ] = ( i / SAMPLES_PER_ROW ) * 0.53f - 50.f;
+		zs[ i ] = i * 0.001f;
+		ws[ i ] = 1.5f;
+	}
+
+	//The 3D and 4D batches only take their AVX2 path in builds with /arch:AVX2
+#if defined( __AVX2__ )
+	CommandConsole::GetConsole()->WriteTextToLog( "Noise benchmark (2D SSE2, 3D/4D AVX2 batch paths):", BENCHMARK_TEXT_COLOR );
+#else
+	CommandConsole::GetConsole()->WriteTextToLog( "Noise benchmark (SSE2 batch paths):", BENCHMARK_TEXT_COLOR );
+#endif
+
+	double startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfSamples; ++i )
+		originalResults[ i ] = PerlinNoise2D( xs[ i ], ys[ i ], BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	double scalarSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  PerlinNoise2D loop", scalarSeconds, numberOfSamples );
+
+	//The 2D batch computes the same noise, so its speedup is against the original implementation
+	startTimeSeconds = GetCurrentTimeSeconds();
+	PerlinNoise2DBatch( &xs[ 0 ], &ys[ 0 ], &results[ 0 ], numberOfSamples, BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	WriteBenchmarkTiming( "  PerlinNoise2DBatch", GetCurrentTimeSeconds() - startTimeSeconds, numberOfSamples, scalarSeconds );
+
+	float largestDifference = 0.f;
+	for( unsigned int i = 0; i < numberOfSamples; ++i )
+		largestDifference = std::max( largestDifference, std::abs( results[ i ] - originalResults[ i ] ) );
+	std::ostringstream differenceLine;
+	differenceLine << "  largest difference from PerlinNoise2D: " << largestDifference;
+	CommandConsole::GetConsole()->WriteTextToLog( differenceLine.str(), BENCHMARK_TEXT_COLOR );
+
+	//3D and 4D batches against their own single point versions
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfSamples; ++i )
+		originalResults[ i ] = PerlinNoise3D( xs[ i ], ys[ i ], zs[ i ], BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	scalarSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  PerlinNoise3D loop", scalarSeconds, numberOfSamples );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	PerlinNoise3DBatch( &xs[ 0 ], &ys[ 0 ], &zs[ 0 ], &results[ 0 ], numberOfSamples, BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	WriteBenchmarkTiming( "  PerlinNoise3DBatch", GetCurrentTimeSeconds() - startTimeSeconds, numberOfSamples, scalarSeconds );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfSamples; ++i )
+		originalResults[ i ] = PerlinNoise4D( xs[ i ], ys[ i ], zs[ i ], ws[ i ], BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	scalarSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  PerlinNoise4D loop", scalarSeconds, numberOfSamples );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	PerlinNoise4DBatch( &xs[ 0 ], &ys[ 0 ], &zs[ 0 ], &ws[ 0 ], &results[ 0 ], numberOfSamples, BLOCK_SIZE, PERSISTENCE, OCTAVES );
+	WriteBenchmarkTiming( "  PerlinNoise4DBatch", GetCurrentTimeSeconds() - startTimeSeconds, numberOfSamples, scalarSeconds );
+}
+
+//-----------------------------------------------------------------------------------------------
+//bench debugdraw [particlesPerSide] [numberOfFrames]
+//Times emitting a cloth's debug wireframe one shape at a time versus through the bulk list calls.
+//Shapes already drawn are set aside while it runs and come back afterwards.
+void BenchmarkDebugDrawing( const std::vector< std::string >& parameters )
+{
+	static const Color WHITE = Color( 1.f, 1.f, 1.f, 1.f );
+	static const Color GREEN = Color( 0.f, 1.f, 0.f, 1.f );
+	static const Color YELLOW = Color( 1.f, 1.f, 0.f, 1.f );
+	static const Color BLUE = Color( 0.f, 0.f, 1.f, 1.f );
+
+	unsigned int particlesPerSide = GetUnsignedParameter( parameters, 0, 256 );
+	unsigned int numberOfFrames = GetUnsignedParameter( parameters, 1, 10 );
+	if( particlesPerSide < 3 )
+		particlesPerSide = 3;
+
+	Cloth cloth( particlesPerSide, particlesPerSide, 0.f );
+	const std::vector< unsigned int >* constraintIndexPairs[ 3 ] = { &cloth.GetStructuralConstraintIndexPairs(), &cloth.GetShearConstraintIndexPairs(), &cloth.GetBendingConstraintIndexPairs() };
+	const Color* constraintColors[ 3 ] = { &GREEN, &YELLOW, &BLUE };
+
+	unsigned int numberOfLines = 0;
+	for( unsigned int i = 0; i < 3; ++i )
+		numberOfLines += constraintIndexPairs[ i ]->size() / 2;
+	unsigned int shapesPerFrame = cloth.GetNumberOfParticles() + numberOfLines;
+
+	std::ostringstream header;
+	header << "Debug drawing benchmark (" << particlesPerSide << "x" << particlesPerSide << " cloth, " << shapesPerFrame << " shapes/frame):";
+	CommandConsole::GetConsole()->WriteTextToLog( header.str(), BENCHMARK_TEXT_COLOR );
+	Debug::ScopedShapeStash userShapes;
+
+	double perShapeSeconds = 0.0;
+	unsigned int perShapeBytes = 0;
+	for( unsigned int frame = 0; frame < numberOfFrames; ++frame )
+	{
+		double startTimeSeconds = GetCurrentTimeSeconds();
+		for( unsigned int i = 0; i < cloth.GetNumberOfParticles(); ++i )
+			Debug::DrawPoint( cloth.GetParticlePosition( i ), 0.5f, WHITE, Debug::DRAW_ALWAYS );
+
+		for( unsigned int type = 0; type < 3; ++type )
+		{
+			const std::vector< unsigned int >& indexPairs = *constraintIndexPairs[ type ];
+			for( unsigned int i = 0; i < indexPairs.size(); i += 2 )
+				Debug::DrawLine( cloth.GetParticlePosition( indexPairs[ i ] ), *constraintColors[ type ], cloth.GetParticlePosition( indexPairs[ i + 1 ] ), *constraintColors[ type ], Debug::DRAW_ALWAYS );
+		}
+		perShapeSeconds += GetCurrentTimeSeconds() - startTimeSeconds;
+
+		perShapeBytes = Debug::GetNumberOfBytesInDrawings();
+		Debug::ClearDrawings();
+	}
+	WriteBenchmarkTiming( "  DrawPoint/DrawLine per shape", perShapeSeconds / numberOfFrames, shapesPerFrame );
+
+	//The bulk path draws from a positions array, as rendering from a simulation snapshot does
+	std::vector< FloatVector3 > particlePositions( cloth.GetNumberOfParticles() );
+	double bulkSeconds = 0.0;
+	unsigned int bulkBytes = 0;
+	for( unsigned int frame = 0; frame < numberOfFrames; ++frame )
+	{
+		double startTimeSeconds = GetCurrentTimeSeconds();
+		for( unsigned int i = 0; i < cloth.GetNumberOfParticles(); ++i )
+			particlePositions[ i ] = cloth.GetParticlePosition( i );
+		cloth.Render( particlePositions, true );
+		bulkSeconds += GetCurrentTimeSeconds() - startTimeSeconds;
+
+		bulkBytes = Debug::GetNumberOfBytesInDrawings();
+		Debug::ClearDrawings();
+	}
+	WriteBenchmarkTiming( "  DrawPointList/DrawLineList", bulkSeconds / numberOfFrames, shapesPerFrame, perShapeSeconds / numberOfFrames );
+
+	//Before shapes had records, every point was 6 and every line 2 stored vertices of 32 bytes each
+	static const unsigned int BYTES_PER_STORED_VERTEX = 32;
+	double perVertexBytes = static_cast< double >( BYTES_PER_STORED_VERTEX ) * ( 6.0 * cloth.GetNumberOfParticles() + 2.0 * numberOfLines );
+
+	std::ostringstream memoryLine;
+	memoryLine << std::fixed << std::setprecision( 2 );
+	memoryLine << "  stored per frame: " << ( perVertexBytes / 1048576.0 ) << " MB as vertices, "
+		<< ( perShapeBytes / 1048576.0 ) << " MB as shape records (" << ( perVertexBytes / perShapeBytes ) << "x), "
+		<< ( bulkBytes / 1048576.0 ) << " MB as lists (" << ( perVertexBytes / bulkBytes ) << "x)";
+	CommandConsole::GetConsole()->WriteTextToLog( memoryLine.str(), BENCHMARK_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//bench matrix [numberOfMatrices]
+//Times the Float4x4Matrix specializations against the generic loops they replace.
+void BenchmarkMatrices( const std::vector< std::string >& parameters )
+{
+	unsigned int numberOfMatrices = GetUnsignedParameter( parameters, 0, 1 << 16 );
+
+	std::vector< Float4x4Matrix > matrices( numberOfMatrices, F4X4_IDENTITY_MATRIX );
+	std::vector< Float4x4Matrix > results( numberOfMatrices );
+	std::vector< FloatVector3 > points( numberOfMatrices );
+	std::vector< FloatVector3 > transformedPoints( numberOfMatrices );
+	for( unsigned int i = 0; i < numberOfMatrices; ++i )
+	{
+		Float4x4Matrix& matrix = matrices[ i ];
+		matrix[ 0 ] = 1.f + i * 0.001f;
+		matrix[ 1 ] = 0.25f;
+		matrix[ 4 ] = -0.25f;
+		matrix[ 5 ] = 1.f + ( i % 7 ) * 0.1f;
+		matrix[ 10 ] = 2.f;
+		matrix[ 12 ] = static_cast< float >( i % 100 );
+		matrix[ 13 ] = -3.f;
+		matrix[ 14 ] = 0.5f;
+		points[ i ] = FloatVector3( i * 0.01f, 1.f, -2.f );
+	}
+
+#ifdef FLOAT_4X4_MATRIX_USE_SSE
+	CommandConsole::GetConsole()->WriteTextToLog( "Matrix benchmark (SSE specializations):", BENCHMARK_TEXT_COLOR );
+#else
+	CommandConsole::GetConsole()->WriteTextToLog( "Matrix benchmark (no SIMD; both paths are loops):", BENCHMARK_TEXT_COLOR );
+#endif
+
+	double startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 1; i < numberOfMatrices; ++i )
+		results[ i ] = MultiplyMatricesWithLoops( matrices[ i ], matrices[ i - 1 ] );
+	double loopSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  Multiply loops", loopSeconds, numberOfMatrices );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 1; i < numberOfMatrices; ++i )
+		results[ i ] = matrices[ i ] * matrices[ i - 1 ];
+	WriteBenchmarkTiming( "  Multiply", GetCurrentTimeSeconds() - startTimeSeconds, numberOfMatrices, loopSeconds );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfMatrices; ++i )
+		results[ i ] = TransposeWithLoops( matrices[ i ] );
+	loopSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  Transpose loops", loopSeconds, numberOfMatrices );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfMatrices; ++i )
+		results[ i ] = Transpose( matrices[ i ] );
+	WriteBenchmarkTiming( "  Transpose", GetCurrentTimeSeconds() - startTimeSeconds, numberOfMatrices, loopSeconds );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfMatrices; ++i )
+		results[ i ] = CalculateAffineInverseWithLoops( matrices[ i ] );
+	loopSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  Affine inverse loops", loopSeconds, numberOfMatrices );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	for( unsigned int i = 0; i < numberOfMatrices; ++i )
+		results[ i ] = CalculateAffineInverse( matrices[ i ] );
+	WriteBenchmarkTiming( "  Affine inverse", GetCurrentTimeSeconds() - startTimeSeconds, numberOfMatrices, loopSeconds );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	TransformPointsWithLoops( matrices[ 1 ], &points[ 0 ], &transformedPoints[ 0 ], numberOfMatrices );
+	loopSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+	WriteBenchmarkTiming( "  Transform points loops", loopSeconds, numberOfMatrices );
+
+	startTimeSeconds = GetCurrentTimeSeconds();
+	TransformPoints( matrices[ 1 ], &points[ 0 ], &transformedPoints[ 0 ], numberOfMatrices );
+	WriteBenchmarkTiming( "  Transform points", GetCurrentTimeSeconds() - startTimeSeconds, numberOfMatrices, loopSeconds );
+}
+
+//-----------------------------------------------------------------------------------------------
+//A cloth benchmark in progress. Steps run in slices of at most CLOTH_BENCHMARK_SLICE_SECONDS per frame,
+//and a step that doesn't fit carries on from its next constraint pass in the following frame.
+struct ClothBenchmarkRun
+{
+	Cloth* cloth;
+	unsigned int particlesPerX;
+	unsigned int particlesPerY;
+	unsigned int numberOfSteps;
+	unsigned int stepsCompleted;
+	bool isStepInProgress;
+	bool useConstraintSatisfaction;
+	double simulatedSeconds; //Time spent inside Cloth::Update only, not the frames in between
+};
+static ClothBenchmarkRun* s_runningClothBenchmark = nullptr;
+
+static const double CLOTH_BENCHMARK_SLICE_SECONDS = 0.004;
+static const float CLOTH_BENCHMARK_STEP_SECONDS = 1.f / 60.f;
+
+//-----------------------------------------------------------------------------------------------
+//bench cloth [particlesPerX] [particlesPerY] [numberOfSteps] [constraints|springs]
+void BenchmarkCloth( const std::vector< std::string >& parameters )
+{
+	CommandConsole* console = CommandConsole::GetConsole();
+	if( s_runningClothBenchmark != nullptr )
+	{
+		console->WriteTextToLog( "ERROR: A cloth benchmark is already running.", BENCHMARK_ERROR_COLOR );
+		return;
+	}
+
+	bool useConstraintSatisfaction = true;
+	if( parameters.size() > 3 )
+	{
+		if( parameters[ 3 ] == "springs" )
+			useConstraintSatisfaction = false;
+		else if( parameters[ 3 ] != "constraints" )
+		{
+			console->WriteTextToLog( "Usage: bench cloth [particlesPerX] [particlesPerY] [numberOfSteps] [constraints|springs]", BENCHMARK_ERROR_COLOR );
+			return;
+		}
+	}
+
+	ClothBenchmarkRun* run = new ClothBenchmarkRun;
+	run->particlesPerX = std::max( GetUnsignedParameter( parameters, 0, 64 ), 3u );
+	run->particlesPerY = std::max( GetUnsignedParameter( parameters, 1, 64 ), 3u );
+	run->numberOfSteps = GetUnsignedParameter( parameters, 2, 300 );
+	run->stepsCompleted = 0;
+	run->isStepInProgress = false;
+	run->useConstraintSatisfaction = useConstraintSatisfaction;
+	run->simulatedSeconds = 0.0;
+	run->cloth = new Cloth( run->particlesPerX, run->particlesPerY, 0.5f );
+	s_runningClothBenchmark = run;
+
+	std::ostringstream header;
+	header << "Cloth benchmark (" << run->particlesPerX << "x" << run->particlesPerY << ", " << run->numberOfSteps << " steps, " 
+		   << ( useConstraintSatisfaction ? "constraints" : "springs" ) << ", " << JobSystem::GetNumberOfThreads() << " thread(s)) running...";
+	console->WriteTextToLog( header.str(), BENCHMARK_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//Runs steps until the slice is used up, checking between constraint passes, so a frame only goes over
+//by the pass and the end of the step in flight when the budget runs out.
+void UpdateRunningBenchmarks()
+{
+	ClothBenchmarkRun* run = s_runningClothBenchmark;
+	if( run == nullptr )
+		return;
+
+	double sliceStartSeconds = GetCurrentTimeSeconds();
+	double sliceEndSeconds = sliceStartSeconds + CLOTH_BENCHMARK_SLICE_SECONDS;
+	double currentTimeSeconds = sliceStartSeconds;
+	while( run->stepsCompleted < run->numberOfSteps && currentTimeSeconds < sliceEndSeconds )
+	{
+		double stepStartSeconds = currentTimeSeconds;
+		if( !run->isStepInProgress )
+		{
+			run->cloth->BeginUpdate();
+			run->isStepInProgress = true;
+		}
+		bool stepFinished = run->cloth->ContinueUpdate( CLOTH_BENCHMARK_STEP_SECONDS, run->useConstraintSatisfaction, sliceEndSeconds );
+		currentTimeSeconds = GetCurrentTimeSeconds();
+
+		run->simulatedSeconds += currentTimeSeconds - stepStartSeconds;
+		if( !stepFinished )
+			return;
+
+		run->isStepInProgress = false;
+		++run->stepsCompleted;
+	}
+
+	if( run->stepsCompleted < run->numberOfSteps )
+		return;
+
+	double particleSteps = static_cast< double >( run->cloth->GetNumberOfParticles() ) * run->numberOfSteps;
+	std::ostringstream result;
+	result << std::fixed << std::setprecision( 2 );
+	result << "  Cloth::Update: " << ( run->simulatedSeconds * 1000.0 ) << " ms, " 
+		   << ( run->simulatedSeconds * 1000.0 / run->numberOfSteps ) << " ms/step, " 
+		   << ( run->simulatedSeconds * 1.0e9 / particleSteps ) << " ns/particle per step";
+	CommandConsole::GetConsole()->WriteTextToLog( result.str(), BENCHMARK_TEXT_COLOR );
+
+	delete run->cloth;
+	delete run;
+	s_runningClothBenchmark = nullptr;
+}
+
+//-----------------------------------------------------------------------------------------------
+void RunBenchmark( const CommandConsole::CommandArguments& arguments )
+{
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( arguments.argumentsAsStringArray.empty() )
+	{
+		std::string availableBenchmarks = "Usage: bench <name> [parameters]. Available:";
+		for( std::map< std::string, BenchmarkFunction >::const_iterator benchmark = s_benchmarkRegistry.begin(); 
+				benchmark != s_benchmarkRegistry.end(); ++benchmark )
+			availableBenchmarks += " " + benchmark->first;
+		console->WriteTextToLog( availableBenchmarks, BENCHMARK_TEXT_COLOR );
+		return;
+	}
+
+	const std::string& benchmarkName = arguments.argumentsAsStringArray[ 0 ];
+	std::map< std::string, BenchmarkFunction >::const_iterator benchmark = s_benchmarkRegistry.find( benchmarkName );
+	if( benchmark == s_benchmarkRegistry.end() )
+	{
+		console->WriteTextToLog( "ERROR: Benchmark " + benchmarkName + " not found.", BENCHMARK_ERROR_COLOR );
+		return;
+	}
+
+	std::vector< std::string > parameters( arguments.argumentsAsStringArray.begin() + 1, arguments.argumentsAsStringArray.end() );
+	benchmark->second( parameters );
+}
+
+//-----------------------------------------------------------------------------------------------
+void RegisterBenchmarkCommands()
+{
+	s_benchmarkRegistry[ "noise" ] = BenchmarkNoise;
+	s_benchmarkRegistry[ "debugdraw" ] = BenchmarkDebugDrawing;
+	s_benchmarkRegistry[ "matrix" ] = BenchmarkMatrices;
+	s_benchmarkRegistry[ "cloth" ] = BenchmarkCloth;
+
+	CommandConsole::RegisterConsoleCommand( "bench", RunBenchmark );
+}
@@ -0,0 +1,16 @@
+#ifndef INCLUDED_BENCHMARKS_HPP
+#define INCLUDED_BENCHMARKS_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include "../Engine/Console/CommandConsole.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Microbenchmarks run from the console as "bench <name> [parameters]". Results go to the log.
+//Long benchmarks are started by the command and advanced a slice at a time by UpdateRunningBenchmarks,
+//which the game calls once per frame, so the console keeps responding while they run.
+void RegisterBenchmarkCommands();
+void RunBenchmark( const CommandConsole::CommandArguments& arguments );
+void UpdateRunningBenchmarks();
+
+#endif //INCLUDED_BENCHMARKS_HPP
@@ -1,12 +1,27 @@
+#include <limits>
 #include "../Engine/DebugDrawing.hpp"
 #include "../Engine/Graphics/Renderer.hpp"
 #include "../Engine/Graphics/VertexDataContainers.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Profiler.hpp"
+#include "../Engine/Time.hpp"
 #include "Cloth.hpp"
 #include "IntegrationMethods.hpp"
 
 static const float STRUCTURAL_STIFFNESS_COEFFICIENT = 8.f;
 static const float SHEAR_STIFFNESS_COEFFICIENT = 6.f;
 static const float BENDING_STIFFNESS_COEFFICIENT = 7.f;
+static const unsigned int MINIMUM_PARTICLES_PER_INTEGRATION_CHUNK = 256;
+
+STATIC const float Cloth::DEFAULT_PARTICLE_SPACING = 2.f;
+STATIC const float Cloth::DEFAULT_PARTICLE_MASS = 0.2f;
+
+//-----------------------------------------------------------------------------------------------
+Cloth::~Cloth()
+{
+	for( unsigned int i = 0; i < m_particles.size(); ++i )
+		delete m_particles[ i ];
+}
 
 //-----------------------------------------------------------------------------------------------
 void Cloth::ClearParticleAccelerations()
@@ -41,6 +56,14 @@ void Cloth::GenerateClothNormals()
 	}
 }
 
+//-----------------------------------------------------------------------------------------------
+void Cloth::AddConstraint( std::vector< Constraint >& constraints, std::vector< unsigned int >& indexPairs, unsigned int particleIndex1, unsigned int particleIndex2 )
+{
+	constraints.push_back( Constraint( *m_particles[ particleIndex1 ], *m_particles[ particleIndex2 ] ) );
+	indexPairs.push_back( particleIndex1 );
+	indexPairs.push_back( particleIndex2 );
+}
+
 //-----------------------------------------------------------------------------------------------
 void Cloth::GenerateParticleGrid( unsigned int particlesPerX, unsigned int particlesPerY )
 {
@@ -49,55 +72,40 @@ void Cloth::GenerateParticleGrid( unsigned int particlesPerX, unsigned int parti
 	{
 		for( unsigned int j = 0; j < particlesPerY; ++j )
 		{
-			m_particles.push_back( new Particle( FloatVector3( TOP_LEFT_CORNER.x + static_cast< float >( 2 * i ), TOP_LEFT_CORNER.y + static_cast< float >( 2 * j ), 0.f ), false, 0.2f ) );
+			m_particles.push_back( new Particle( FloatVector3( TOP_LEFT_CORNER.x + m_particleSpacingX * i, TOP_LEFT_CORNER.y + m_particleSpacingY * j, 0.f ), false, m_particleMass ) );
 		}
 	}
 
-	m_particles[ 0 ]->positionIsLocked = true;
-	m_particles[ particlesPerX - 1 ]->positionIsLocked = true;
-	m_particles[ m_particles.size() - particlesPerX ]->positionIsLocked = true;
-	m_particles[ m_particles.size() - 1 ]->positionIsLocked = true;
-
-	for( unsigned int i = 0; i < m_particles.size(); ++i )
-	{
-		Particle& thisParticle = *m_particles[ i ];
-
-		if( indexIsNotOnRightEdge( i ) )
-		{
-			Particle& particleOneEastOfThis = *m_particles[ i + 1 ];
-			m_structuralConstraints.push_back( Constraint( thisParticle, particleOneEastOfThis ) );
-		}
-
-		if( indexIsNotOnBottomEdge( i ) )
-		{
-			Particle& particleOneSouthOfThis = *m_particles[ i + particlesPerX ];
-			m_structuralConstraints.push_back( Constraint( thisParticle, particleOneSouthOfThis ) );
-		}
-
-		if( indexIsNotOnRightEdge( i ) && indexIsNotOnBottomEdge( i ) )
-		{
-			Particle& particleOneEastOfThis = *m_particles[ i + 1 ];
-			Particle& particleOneSouthOfThis = *m_particles[ i + particlesPerX ];
-			Particle& particleSouthEastOfThis = *m_particles[ i + particlesPerX + 1 ];
-			
-			m_shearConstraints.push_back( Constraint( thisParticle, particleSouthEastOfThis ) );
+	GetParticleAt( 0, 0 ).positionIsLocked = true;
+	GetParticleAt( 0, particlesPerY - 1 ).positionIsLocked = true;
+	GetParticleAt( particlesPerX - 1, 0 ).positionIsLocked = true;
+	GetParticleAt( particlesPerX - 1, particlesPerY - 1 ).positionIsLocked = true;
 
-			m_shearConstraints.push_back( Constraint( particleOneEastOfThis, particleOneSouthOfThis ) );
-		}
+	m_boundsMinimum = GetParticleAt( 0, 0 ).currentPosition;
+	m_boundsMaximum = GetParticleAt( particlesPerX - 1, particlesPerY - 1 ).currentPosition;
 
- 		if( i % particlesPerX < particlesPerX - 2 )
+	for( unsigned int x = 0; x < particlesPerX; ++x )
+	{
+		for( unsigned int y = 0; y < particlesPerY; ++y )
 		{
-			Particle& particleTwoEastOfThis = *m_particles[ i + 2 ];
+			unsigned int i = GetParticleIndex( x, y );
+			if( y + 1 < particlesPerY )
+				AddConstraint( m_structuralConstraints, m_structuralConstraintIndexPairs, i, GetParticleIndex( x, y + 1 ) );
 
-			m_bendingConstraints.push_back( Constraint( thisParticle, particleTwoEastOfThis ) );
-		}
+			if( x + 1 < particlesPerX )
+				AddConstraint( m_structuralConstraints, m_structuralConstraintIndexPairs, i, GetParticleIndex( x + 1, y ) );
 
+			if( x + 1 < particlesPerX && y + 1 < particlesPerY )
+			{
+				AddConstraint( m_shearConstraints, m_shearConstraintIndexPairs, i, GetParticleIndex( x + 1, y + 1 ) );
+				AddConstraint( m_shearConstraints, m_shearConstraintIndexPairs, GetParticleIndex( x, y + 1 ), GetParticleIndex( x + 1, y ) );
+			}
 
-		if( i < m_particles.size() - 2 * particlesPerX )
-		{
-			Particle& particleTwoSouthOfThis = *m_particles[ i + 2 * particlesPerX ];
+			if( y + 2 < particlesPerY )
+				AddConstraint( m_bendingConstraints, m_bendingConstraintIndexPairs, i, GetParticleIndex( x, y + 2 ) );
 
-			m_bendingConstraints.push_back( Constraint( thisParticle, particleTwoSouthOfThis ) );
+			if( x + 2 < particlesPerX )
+				AddConstraint( m_bendingConstraints, m_bendingConstraintIndexPairs, i, GetParticleIndex( x + 2, y ) );
 		}
 	}
 }
@@ -117,7 +125,7 @@ void Cloth::GenerateVertexAndIndexArray( VertexColorNormalTextureData* out_nullV
 	//Bind every particle except the last line
 	for( unsigned int i = 0; i < 10 * VERTICES_PER_CLOTH_SQUARE; ++i )
 	{
-		if( i % m_particlesPerX < m_particlesPerX - 1 )
+		if( indexIsNotOnRightEdge( i ) && indexIsNotOnBottomEdge( i ) )
 		{
 			Particle& thisParticle = *m_particles[ i ];
 			Particle& particleOneEastOfThis = *m_particles[ GetIndexOfParticleEastOf( i ) ];
@@ -138,24 +146,150 @@ void Cloth::GenerateVertexAndIndexArray( VertexColorNormalTextureData* out_nullV
 }
 
 //-----------------------------------------------------------------------------------------------
-void Cloth::Render( bool drawInDebug ) const
+//gridU runs along the outer (x) index of the grid and gridV along the inner (y) index, both 0 to 1.
+void Cloth::SampleParticleStateAt( float gridU, float gridV, FloatVector3& out_position, FloatVector3& out_previousPosition, 
+								   FloatVector3& out_velocity ) const
+{
+	float gridX = gridU * ( m_particlesPerX - 1 );
+	float gridY = gridV * ( m_particlesPerY - 1 );
+	unsigned int cellX = std::min( static_cast< unsigned int >( gridX ), m_particlesPerX - 2 );
+	unsigned int cellY = std::min( static_cast< unsigned int >( gridY ), m_particlesPerY - 2 );
+	float weightX = gridX - cellX;
+	float weightY = gridY - cellY;
+
+	const Particle& particle00 = *m_particles[ GetParticleIndex( cellX, cellY ) ];
+	const Particle& particle01 = *m_particles[ GetParticleIndex( cellX, cellY + 1 ) ];
+	const Particle& particle10 = *m_particles[ GetParticleIndex( cellX + 1, cellY ) ];
+	const Particle& particle11 = *m_particles[ GetParticleIndex( cellX + 1, cellY + 1 ) ];
+
+	float weight00 = ( 1.f - weightX ) * ( 1.f - weightY );
+	float weight01 = ( 1.f - weightX ) * weightY;
+	float weight10 = weightX * ( 1.f - weightY );
+	float weight11 = weightX * weightY;
+
+	out_position = weight00 * particle00.currentPosition + weight01 * particle01.currentPosition 
+				 + weight10 * particle10.currentPosition + weight11 * particle11.currentPosition;
+	out_previousPosition = weight00 * particle00.previousPosition + weight01 * particle01.previousPosition 
+						 + weight10 * particle10.previousPosition + weight11 * particle11.previousPosition;
+	out_velocity = weight00 * particle00.currentVelocity + weight01 * particle01.currentVelocity 
+				 + weight10 * particle10.currentVelocity + weight11 * particle11.currentVelocity;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Cloth::CopyStateFrom( const Cloth& source )
+{
+	float inverseLastX = 1.f / ( m_particlesPerX - 1 );
+	float inverseLastY = 1.f / ( m_particlesPerY - 1 );
+	for( unsigned int i = 0; i < m_particlesPerX; ++i )
+	{
+		for( unsigned int j = 0; j < m_particlesPerY; ++j )
+		{
+			Particle& particle = GetParticleAt( i, j );
+			source.SampleParticleStateAt( i * inverseLastX, j * inverseLastY, particle.currentPosition, particle.previousPosition, particle.currentVelocity );
+		}
+	}
+
+	m_boundsMinimum = source.m_boundsMinimum;
+	m_boundsMaximum = source.m_boundsMaximum;
+	m_windField->SetBaseForce( source.m_windField->GetBaseForce() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Cloth::ProlongPositionsFrom( const Cloth& source )
 {
+	FloatVector3 unusedPreviousPosition, unusedVelocity;
+	float inverseLastX = 1.f / ( m_particlesPerX - 1 );
+	float inverseLastY = 1.f / ( m_particlesPerY - 1 );
+	for( unsigned int i = 0; i < m_particlesPerX; ++i )
+	{
+		for( unsigned int j = 0; j < m_particlesPerY; ++j )
+		{
+			Particle& particle = GetParticleAt( i, j );
+			source.SampleParticleStateAt( i * inverseLastX, j * inverseLastY, particle.currentPosition, unusedPreviousPosition, unusedVelocity );
+		}
+	}
+
+	m_boundsMinimum = source.m_boundsMinimum;
+	m_boundsMaximum = source.m_boundsMaximum;
+}
+
+//-----------------------------------------------------------------------------------------------
+void Cloth::CopyPositionsAndNormalsInto( std::vector< FloatVector3 >& out_positions, std::vector< FloatVector3 >& out_normals ) const
+{
+	PROFILE_ZONE( "Cloth::CopyPositionsAndNormals" );
+
+	out_positions.resize( m_particles.size() );
+	out_normals.resize( m_particles.size() );
+	for( unsigned int i = 0; i < m_particles.size(); ++i )
+		out_positions[ i ] = m_particles[ i ]->currentPosition;
+
+	for( unsigned int i = 0; i < m_particlesPerX; ++i )
+	{
+		unsigned int previousI = ( i > 0 ) ? i - 1 : i;
+		unsigned int nextI = ( i < m_particlesPerX - 1 ) ? i + 1 : i;
+		for( unsigned int j = 0; j < m_particlesPerY; ++j )
+		{
+			unsigned int previousJ = ( j > 0 ) ? j - 1 : j;
+			unsigned int nextJ = ( j < m_particlesPerY - 1 ) ? j + 1 : j;
+
+			FloatVector3 alongX = out_positions[ GetParticleIndex( nextI, j ) ] - out_positions[ GetParticleIndex( previousI, j ) ];
+			FloatVector3 alongY = out_positions[ GetParticleIndex( i, nextJ ) ] - out_positions[ GetParticleIndex( i, previousJ ) ];
+			FloatVector3 normal = CrossProduct( alongX, alongY );
+			if( normal.CalculateNorm() > 0.f )
+				normal.Normalize();
+			out_normals[ GetParticleIndex( i, j ) ] = normal;
+		}
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void Cloth::Render( const std::vector< FloatVector3 >& particlePositions, bool drawInDebug ) const
+{
+	PROFILE_ZONE( "Cloth::Render" );
+
+	if( particlePositions.size() != m_particles.size() )
+		return;
+
 	if( drawInDebug )
-		RenderDebugParticlesAndConstraints();
+		RenderDebugParticlesAndConstraints( particlePositions );
 }
 
 //-----------------------------------------------------------------------------------------------
 void Cloth::Update( float deltaSeconds, bool useConstraintSatisfaction )
+{
+	PROFILE_ZONE( "Cloth::Update" );
+
+	BeginUpdate();
+	ContinueUpdate( deltaSeconds, useConstraintSatisfaction, std::numeric_limits< double >::infinity() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Cloth::BeginUpdate()
 {
 	ClearParticleAccelerations();
 
 	GenerateClothNormals();
 
+	m_constraintPassesCompleted = 0;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Every call runs at least one constraint pass, so a step always moves on however small the budget.
+bool Cloth::ContinueUpdate( float deltaSeconds, bool useConstraintSatisfaction, double stopAtTimeSeconds )
+{
 	if( useConstraintSatisfaction )
 	{
+		PROFILE_ZONE( "Cloth::SatisfyConstraints" );
+
 		// PR: Added loop to control how many times we want to satisfy the constraints
-		for ( unsigned int i = 0; i < m_numberOfConstraintSatisfactionLoops; ++i )
+		size_t firstPassThisCall = m_constraintPassesCompleted;
+		for ( ; m_constraintPassesCompleted < m_numberOfConstraintSatisfactionLoops; ++m_constraintPassesCompleted )
 		{
+			if( m_constraintPassesCompleted > firstPassThisCall && GetCurrentTimeSeconds() >= stopAtTimeSeconds )
+				return false;
+
+			PROFILE_ZONE( "Cloth::ConstraintPass" );
+
 			for( unsigned int j = 0; j < m_structuralConstraints.size(); ++j )
 			{
 				SatisfyConstraint( m_structuralConstraints[ j ] );
@@ -174,6 +308,7 @@ void Cloth::Update( float deltaSeconds, bool useConstraintSatisfaction )
 	}
 	else
 	{
+		PROFILE_ZONE( "Cloth::ApplySpringForces" );
 		for( unsigned int j = 0; j < m_structuralConstraints.size(); ++j )
 		{
 			ApplyForceToParticlesFromConstraint( m_structuralConstraints[ j ], STRUCTURAL_STIFFNESS_COEFFICIENT );
@@ -191,12 +326,56 @@ void Cloth::Update( float deltaSeconds, bool useConstraintSatisfaction )
 	}
 	
 
-	AddWindForce( m_windForce );
+	AddWindForce( deltaSeconds );
 
-	for( unsigned int i = 0; i < m_particles.size(); ++i )
+	PROFILE_ZONE( "Cloth::Integrate" );
+
+	//Particles integrate independently, unlike the Gauss-Seidel constraint passes above, so this is
+	//the part of the step that can be spread across the job system's threads.
+	unsigned int numberOfParticles = m_particles.size();
+	unsigned int numberOfChunks = JobSystem::CalculateNumberOfChunks( numberOfParticles, MINIMUM_PARTICLES_PER_INTEGRATION_CHUNK );
+	m_chunkBoundsMinimums.resize( numberOfChunks );
+	m_chunkBoundsMaximums.resize( numberOfChunks );
+	JobSystem::ParallelFor( numberOfParticles, numberOfChunks,
+		[ & ]( unsigned int chunkIndex, unsigned int firstParticle, unsigned int endParticle )
+		{
+			IntegrateParticles( firstParticle, endParticle, deltaSeconds, useConstraintSatisfaction, 
+								m_chunkBoundsMinimums[ chunkIndex ], m_chunkBoundsMaximums[ chunkIndex ] );
+		} );
+
+	FloatVector3 boundsMinimum = m_chunkBoundsMinimums[ 0 ];
+	FloatVector3 boundsMaximum = m_chunkBoundsMaximums[ 0 ];
+	for( unsigned int i = 1; i < numberOfChunks; ++i )
+	{
+		for( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			boundsMinimum[ axis ] = std::min( boundsMinimum[ axis ], m_chunkBoundsMinimums[ i ][ axis ] );
+			boundsMaximum[ axis ] = std::max( boundsMaximum[ axis ], m_chunkBoundsMaximums[ i ][ axis ] );
+		}
+	}
+
+	m_boundsMinimum = boundsMinimum;
+	m_boundsMaximum = boundsMaximum;
+	return true;
+}
+
+//-----------------------------------------------------------------------------------------------
+//Bounds are taken from the positions before integration, matching what the wind field saw this step.
+void Cloth::IntegrateParticles( unsigned int firstParticle, unsigned int endParticle, float deltaSeconds, bool useConstraintSatisfaction, 
+								FloatVector3& out_boundsMinimum, FloatVector3& out_boundsMaximum )
+{
+	FloatVector3 boundsMinimum = m_particles[ firstParticle ]->currentPosition;
+	FloatVector3 boundsMaximum = boundsMinimum;
+	for( unsigned int i = firstParticle; i < endParticle; ++i )
 	{
 		Particle& particle = *m_particles[ i ];
 
+		for( unsigned int axis = 0; axis < 3; ++axis )
+		{
+			boundsMinimum[ axis ] = std::min( boundsMinimum[ axis ], particle.currentPosition[ axis ] );
+			boundsMaximum[ axis ] = std::max( boundsMaximum[ axis ], particle.currentPosition[ axis ] );
+		}
+
 		if( particle.positionIsLocked )
 			continue;
 
@@ -217,27 +396,41 @@ void Cloth::Update( float deltaSeconds, bool useConstraintSatisfaction )
 
 	}
 
+	out_boundsMinimum = boundsMinimum;
+	out_boundsMaximum = boundsMaximum;
 }
 
 
-void Cloth::AddWindForce( const FloatVector3& directionOfWindForce ) {
+void Cloth::AddWindForce( float deltaSeconds ) {
+	PROFILE_ZONE( "Cloth::AddWindForce" );
+
+	m_windField->Update( deltaSeconds, m_boundsMinimum, m_boundsMaximum );
+
+	const FloatVector3& baseWindForce = m_windField->GetBaseForce();
+	if( baseWindForce.x == 0.f && baseWindForce.y == 0.f && baseWindForce.z == 0.f )
+		return;
+
 	// PR :: Ensure we don't overstep with (-1)
-	for ( size_t x = 0; x < ( m_particlesPerX - 1 ); ++x ) {
-		for ( size_t y = 0; y < ( m_particlesPerY - 1 ); ++y ) {
-			Particle & p1 = GetParticleAtPosition( x+1, y );
-			Particle & p2 = GetParticleAtPosition( x, y );
-			Particle & p3 = GetParticleAtPosition( x, y+1 );
-			AddWindForcesForTriangle( p1, p2, p3, directionOfWindForce );
-			Particle & pOne = GetParticleAtPosition( x+1, y+1 );
-			Particle & pTwo = GetParticleAtPosition( x+1, y );
-			Particle & pThree = GetParticleAtPosition( x, y+1 );
-			AddWindForcesForTriangle( p1, p2, p3, directionOfWindForce );
+	for ( unsigned int x = 0; x < ( m_particlesPerX - 1 ); ++x ) {
+		for ( unsigned int y = 0; y < ( m_particlesPerY - 1 ); ++y ) {
+			Particle & p1 = GetParticleAt( x, y+1 );
+			Particle & p2 = GetParticleAt( x, y );
+			Particle & p3 = GetParticleAt( x+1, y );
+			AddWindForcesForTriangle( p1, p2, p3 );
+			Particle & pOne = GetParticleAt( x+1, y+1 );
+			Particle & pTwo = GetParticleAt( x, y+1 );
+			Particle & pThree = GetParticleAt( x+1, y );
+			AddWindForcesForTriangle( pOne, pTwo, pThree );
 		} // end inner for
 	} // end outer for
 }
 
 
-void Cloth::AddWindForcesForTriangle( Particle& p1, Particle& p2, Particle& p3, const FloatVector3& direction ) {
+void Cloth::AddWindForcesForTriangle( Particle& p1, Particle& p2, Particle& p3 ) {
+
+	static const float ONE_THIRD = 1.f / 3.f;
+	FloatVector3 centroid = ( p1.currentPosition + p2.currentPosition + p3.currentPosition ) * ONE_THIRD;
+	FloatVector3 direction = m_windField->SampleForceAt( centroid );
 
 	FloatVector3 normalOfTriangle = calculateTriangleNormal( p1, p2, p3 );
 	FloatVector3 d = normalOfTriangle;
@@ -250,39 +443,18 @@ void Cloth::AddWindForcesForTriangle( Particle& p1, Particle& p2, Particle& p3,
 }
 
 
-void Cloth::RenderDebugParticlesAndConstraints() const
+void Cloth::RenderDebugParticlesAndConstraints( const std::vector< FloatVector3 >& particlePositions ) const
 {
 	static const Color YELLOW = Color( 1.f, 1.f, 0.f, 1.f );
 	static const Color BLUE = Color( 0.f, 0.f, 1.f, 1.f );
 	static const Color GREEN = Color( 0.f, 1.f, 0.f, 1.f );
 	static const Color WHITE = Color( 1.f, 1.f, 1.f, 1.f );
 
-	for( unsigned int i = 0; i < m_particles.size(); ++i )
-	{
-		const Particle& particle = *m_particles[ i ];
+	const FloatVector3* positions = particlePositions.data();
 
-		Debug::DrawPoint( particle.currentPosition, 0.5f, WHITE, Debug::DRAW_ALWAYS );
-	}
-
-	for( unsigned int i = 0; i < m_structuralConstraints.size(); ++i )
-	{
-		const Constraint& constraint = m_structuralConstraints[ i ];
-
-		Debug::DrawLine( constraint.particle1->currentPosition, GREEN, constraint.particle2->currentPosition, GREEN, Debug::DRAW_ALWAYS );
-	}
-
-	for( unsigned int i = 0; i < m_shearConstraints.size(); ++i )
-	{
-		const Constraint& constraint = m_shearConstraints[ i ];
-
-		Debug::DrawLine( constraint.particle1->currentPosition, YELLOW, constraint.particle2->currentPosition, YELLOW, Debug::DRAW_ALWAYS );
-	}
-
-	for( unsigned int i = 0; i < m_bendingConstraints.size(); ++i )
-	{
-		const Constraint& constraint = m_bendingConstraints[ i ];
-
-		Debug::DrawLine( constraint.particle1->currentPosition, BLUE, constraint.particle2->currentPosition, BLUE, Debug::DRAW_ALWAYS );
-	}
+	Debug::DrawPointList( positions, particlePositions.size(), 0.5f, WHITE, Debug::DRAW_ALWAYS );
+	Debug::DrawLineList( positions, m_structuralConstraintIndexPairs.data(), m_structuralConstraints.size(), GREEN, Debug::DRAW_ALWAYS );
+	Debug::DrawLineList( positions, m_shearConstraintIndexPairs.data(), m_shearConstraints.size(), YELLOW, Debug::DRAW_ALWAYS );
+	Debug::DrawLineList( positions, m_bendingConstraintIndexPairs.data(), m_bendingConstraints.size(), BLUE, Debug::DRAW_ALWAYS );
 }
 
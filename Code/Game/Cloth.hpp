@@ -5,12 +5,17 @@
 //-----------------------------------------------------------------------------------------------
 #include <cassert>
 #include <vector>
+#include "../Engine/Graphics/VertexDataContainers.hpp"
 #include "../Engine/Math/FloatVector3.hpp"
+#include "../Engine/Math/FloatVector3A.hpp"
+#include "WindField.hpp"
 
 //-----------------------------------------------------------------------------------------------
 class Cloth
 {
 	static const size_t DEFAULT_NUMBER_OF_CONSTRAINT_SATISFACTION_LOOPS = 8;
+	static const float DEFAULT_PARTICLE_SPACING;
+	static const float DEFAULT_PARTICLE_MASS;
 
 public:
 	#pragma region Composed Class Definitions 
@@ -63,22 +68,70 @@ public:
 	#pragma endregion
 
 public:
-	Cloth( unsigned int particlesPerX, unsigned int particlesPerY, float dragCoefficient )
+	//Resampling between grids needs at least one cell in each direction
+	static const unsigned int MINIMUM_PARTICLES_PER_SIDE = 2;
+
+	Cloth( unsigned int particlesPerX, unsigned int particlesPerY, float dragCoefficient, 
+		   float particleSpacingX = DEFAULT_PARTICLE_SPACING, float particleSpacingY = DEFAULT_PARTICLE_SPACING, float particleMass = DEFAULT_PARTICLE_MASS )
 		: m_dragCoefficient( dragCoefficient )
 		, m_particlesPerX( particlesPerX )
 		, m_particlesPerY( particlesPerY )
+		, m_particleSpacingX( particleSpacingX )
+		, m_particleSpacingY( particleSpacingY )
+		, m_particleMass( particleMass )
+		, m_windField( &m_ownWindField )
 		, m_numberOfConstraintSatisfactionLoops( DEFAULT_NUMBER_OF_CONSTRAINT_SATISFACTION_LOOPS )
+		, m_constraintPassesCompleted( 0 )
 	{
+		assert( particlesPerX >= MINIMUM_PARTICLES_PER_SIDE && particlesPerY >= MINIMUM_PARTICLES_PER_SIDE );
 		GenerateParticleGrid( particlesPerX, particlesPerY );
 	}
 
-	void Render( bool drawInDebug ) const;
+	~Cloth();
+
+	//Draws the given positions (one per particle, such as a snapshot taken by CopyPositionsAndNormalsInto)
+	//with this cloth's constraints. Only the constraint topology is read from the cloth, and that never
+	//changes after construction, so this is safe while another thread runs Update.
+	void Render( const std::vector< FloatVector3 >& particlePositions, bool drawInDebug ) const;
 	void Update( float deltaSeconds, bool useConstraintSatisfaction );
 
+	//Update in pieces, for callers on a time budget: after BeginUpdate, each ContinueUpdate runs
+	//constraint passes until stopAtTimeSeconds (as GetCurrentTimeSeconds) and returns true once the
+	//step has finished. The cloth is mid-step in between, so it shouldn't be read or copied then.
+	void BeginUpdate();
+	bool ContinueUpdate( float deltaSeconds, bool useConstraintSatisfaction, double stopAtTimeSeconds );
+
+	//Normals come from the neighboring particles' positions, one-sided along the edges.
+	void CopyPositionsAndNormalsInto( std::vector< FloatVector3 >& out_positions, std::vector< FloatVector3 >& out_normals ) const;
+
+	//Moves this cloth onto the surface of another cloth of any resolution by bilinear resampling.
+	//CopyStateFrom carries velocity over; ProlongPositionsFrom only moves particles, for display.
+	void CopyStateFrom( const Cloth& source );
+	void ProlongPositionsFrom( const Cloth& source );
+
+	unsigned int GetNumberOfParticles() const { return m_particles.size(); }
+	unsigned int GetParticlesPerX() const { return m_particlesPerX; }
+	unsigned int GetParticlesPerY() const { return m_particlesPerY; }
+	float GetParticleSpacingX() const { return m_particleSpacingX; }
+	float GetParticleSpacingY() const { return m_particleSpacingY; }
+	float GetParticleMass() const { return m_particleMass; }
+	const FloatVector3& GetParticlePosition( unsigned int particleIndex ) const { return m_particles[ particleIndex ]->currentPosition; }
+	void SetParticlePosition( unsigned int particleIndex, const FloatVector3& position ) { m_particles[ particleIndex ]->currentPosition = position; }
+	const FloatVector3& GetBoundsMinimum() const { return m_boundsMinimum; }
+	const FloatVector3& GetBoundsMaximum() const { return m_boundsMaximum; }
+	const std::vector< unsigned int >& GetStructuralConstraintIndexPairs() const { return m_structuralConstraintIndexPairs; }
+	const std::vector< unsigned int >& GetShearConstraintIndexPairs() const { return m_shearConstraintIndexPairs; }
+	const std::vector< unsigned int >& GetBendingConstraintIndexPairs() const { return m_bendingConstraintIndexPairs; }
+
 	// Inline Mutators
 	void setDragCoefficient( float dragCoefficient ); 
 	float getDragCoefficient() const;
-	void SetWindForce( const FloatVector3& windForce ) { m_windForce = windForce; }
+	void SetWindForce( const FloatVector3& windForce ) { m_windField->SetBaseForce( windForce ); }
+	//For cloths that take turns simulating the same surface, so the wind carries on across a switch.
+	//The other cloth must outlive this one's updates.
+	void ShareWindFieldOf( Cloth& other ) { m_windField = other.m_windField; }
+	size_t GetNumberOfConstraintSatisfactionLoops() const { return m_numberOfConstraintSatisfactionLoops; }
+	void SetNumberOfConstraintSatisfactionLoops( size_t numberOfLoops ) { m_numberOfConstraintSatisfactionLoops = numberOfLoops; }
 
 private:
 
@@ -86,23 +139,46 @@ private:
 	std::vector< Constraint > m_bendingConstraints;
 	std::vector< Constraint > m_shearConstraints;
 	std::vector< Constraint > m_structuralConstraints;
+	std::vector< unsigned int > m_bendingConstraintIndexPairs; //Particle indices of each constraint, for bulk debug drawing
+	std::vector< unsigned int > m_shearConstraintIndexPairs;
+	std::vector< unsigned int > m_structuralConstraintIndexPairs;
+	std::vector< FloatVector3 > m_chunkBoundsMinimums; //One per integration chunk, merged once the chunks finish
+	std::vector< FloatVector3 > m_chunkBoundsMaximums;
 	float m_dragCoefficient;
 	unsigned int m_particlesPerX, m_particlesPerY;
-	FloatVector3 m_windForce;
+	float		 m_particleSpacingX, m_particleSpacingY;
+	float		 m_particleMass;
+	WindField	 m_ownWindField;
+	WindField*	 m_windField; //m_ownWindField unless shared from another cloth
+	FloatVector3 m_boundsMinimum, m_boundsMaximum;
 	// PR: Added this to dictate how many times we for loop
 	size_t		 m_numberOfConstraintSatisfactionLoops;
-
-	Particle &   GetParticleAtPosition( size_t rowNum, size_t colNum );
-	unsigned int GetIndexOfParticleEastOf( unsigned int particleIndex ) { return particleIndex + 1; }
-	unsigned int GetIndexOfParticleSouthOf( unsigned int particleIndex ) { return particleIndex + m_particlesPerX; }
-	unsigned int GetIndexOfParticleSoutheastOf( unsigned int particleIndex ) { return particleIndex + m_particlesPerX + 1; }
-
-	bool indexIsNotOnRightEdge( unsigned int particleIndex ) { return particleIndex % m_particlesPerX < m_particlesPerX - 1; }
-	bool indexIsNotOnBottomEdge( unsigned int particleIndex ) { return particleIndex < m_particles.size() - m_particlesPerX; }
+	size_t		 m_constraintPassesCompleted; //Of the step in progress
+
+	//We have no need of a pithy assignment or copy operator!
+	Cloth( const Cloth& other );
+	Cloth& operator=( const Cloth& other );
+
+	//Particles are stored row-major, one row per x holding m_particlesPerY particles, and every
+	//(x, y) lookup goes through here so non-square grids index the same way everywhere.
+	unsigned int GetParticleIndex( unsigned int x, unsigned int y ) const { return x * m_particlesPerY + y; }
+	Particle &   GetParticleAt( unsigned int x, unsigned int y ) { return *m_particles[ GetParticleIndex( x, y ) ]; }
+	void		 IntegrateParticles( unsigned int firstParticle, unsigned int endParticle, float deltaSeconds, bool useConstraintSatisfaction, 
+									 FloatVector3& out_boundsMinimum, FloatVector3& out_boundsMaximum );
+	void		 SampleParticleStateAt( float gridU, float gridV, FloatVector3& out_position, FloatVector3& out_previousPosition, 
+										FloatVector3& out_velocity ) const;
+	//East is +x and south is +y on the grid
+	unsigned int GetIndexOfParticleEastOf( unsigned int particleIndex ) { return particleIndex + GetParticleIndex( 1, 0 ); }
+	unsigned int GetIndexOfParticleSouthOf( unsigned int particleIndex ) { return particleIndex + GetParticleIndex( 0, 1 ); }
+	unsigned int GetIndexOfParticleSoutheastOf( unsigned int particleIndex ) { return particleIndex + GetParticleIndex( 1, 1 ); }
+
+	bool indexIsNotOnRightEdge( unsigned int particleIndex ) { return particleIndex < GetParticleIndex( m_particlesPerX - 1, 0 ); }
+	bool indexIsNotOnBottomEdge( unsigned int particleIndex ) { return particleIndex % m_particlesPerY < m_particlesPerY - 1; }
 
 	void ClearParticleAccelerations();
 	void ClearParticleNormals();
 
+	void AddConstraint( std::vector< Constraint >& constraints, std::vector< unsigned int >& indexPairs, unsigned int particleIndex1, unsigned int particleIndex2 );
 	void ApplyForceToParticlesFromConstraint( Constraint& constraint, float stiffnessCoefficient );
 	void CalculateAndAddNormalsToParticles( Particle* particle1, Particle* particle2, Particle* particle3 );
 	void GenerateClothNormals();
@@ -111,10 +187,10 @@ private:
 									  unsigned short* out_nullIndexArray, unsigned int& out_numberOfIndices );
 	void SatisfyConstraint( Constraint& constraint );
 
-	void AddWindForce( const FloatVector3& directionOfWindForce );
-	void AddWindForcesForTriangle( Particle& p1, Particle& p2, Particle& p3, const FloatVector3& direction );
+	void AddWindForce( float deltaSeconds );
+	void AddWindForcesForTriangle( Particle& p1, Particle& p2, Particle& p3 );
 
-	void RenderDebugParticlesAndConstraints() const;
+	void RenderDebugParticlesAndConstraints( const std::vector< FloatVector3 >& particlePositions ) const;
 };
 
 //-----------------------------------------------------------------------------------------------
@@ -165,31 +241,26 @@ inline void Cloth::SatisfyConstraint( Constraint& constraint )
 	Particle* particle1 = constraint.particle1;
 	Particle* particle2 = constraint.particle2;
 
-	FloatVector3 vectorFromParticle1To2 = particle2->currentPosition - particle1->currentPosition;
+	//This runs for every constraint on every pass, so the math stays in SSE registers
+	FloatVector3A particle1Position( particle1->currentPosition );
+	FloatVector3A particle2Position( particle2->currentPosition );
+
+	FloatVector3A vectorFromParticle1To2 = particle2Position - particle1Position;
 	// PR: CalculateNorm is Length of vector?
 	float currentDistanceBetweenParticles = vectorFromParticle1To2.CalculateNorm();
 
-	FloatVector3 correctionVector = vectorFromParticle1To2 * ( 1.f - constraint.relaxedLength / currentDistanceBetweenParticles );
-	FloatVector3 correctionVectorHalf = 0.5f * correctionVector;
+	FloatVector3A correctionVectorHalf = vectorFromParticle1To2 * ( 0.5f * ( 1.f - constraint.relaxedLength / currentDistanceBetweenParticles ) );
 	
 	if ( !particle1->positionIsLocked ) {
-		particle1->currentPosition += correctionVectorHalf;
+		particle1Position += correctionVectorHalf;
+		particle1Position.StoreTo( particle1->currentPosition );
 	}
 
 	if ( !particle2->positionIsLocked ) {
-		FloatVector3 negatedHalfCorrectionVector = correctionVectorHalf * -1.0f;
-		particle2->currentPosition += negatedHalfCorrectionVector;
+		particle2Position -= correctionVectorHalf;
+		particle2Position.StoreTo( particle2->currentPosition );
 	}
 }
 
 
-// PR : For Row major convenience
-inline Cloth::Particle& Cloth::GetParticleAtPosition( size_t colNum, size_t rowNum ) 
-{
-	size_t offset = ( rowNum * m_particlesPerX ) + colNum; 
-	Particle & particle = *(m_particles[offset]);
-	return particle;
-}
-
-
 #endif //INCLUDED_CLOTH_HPP
@@ -0,0 +1,129 @@
+#include <algorithm>
+#include <cfloat>
+#include "../Engine/Time.hpp"
+#include "ClothQualityScheduler.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC const float ClothQualityScheduler::DEFAULT_FRAME_BUDGET_SECONDS = 0.004f;
+STATIC const float ClothQualityScheduler::MAXIMUM_STEP_SECONDS = 1.f / 15.f;
+STATIC const float ClothQualityScheduler::COST_SMOOTHING_WEIGHT = 0.2f;
+STATIC const float ClothQualityScheduler::OFF_SCREEN_PRIORITY_PENALTY = 100000.f;
+
+STATIC const ClothQualityScheduler::QualityLevel ClothQualityScheduler::VISIBLE_QUALITY_LEVELS[] =
+{
+	//maximum distance, constraint iterations, update every N frames
+	{ 30.f,		8, 1 },
+	{ 80.f,		4, 1 },
+	{ 200.f,	2, 2 },
+	{ FLT_MAX,	1, 4 }
+};
+STATIC const unsigned int ClothQualityScheduler::NUMBER_OF_VISIBLE_QUALITY_LEVELS = sizeof( VISIBLE_QUALITY_LEVELS ) / sizeof( QualityLevel );
+STATIC const ClothQualityScheduler::QualityLevel ClothQualityScheduler::OFF_SCREEN_QUALITY_LEVEL = { FLT_MAX, 1, 8 };
+
+//-----------------------------------------------------------------------------------------------
+void ClothQualityScheduler::AssignQualityFromView( ScheduledCloth& scheduledCloth, const Camera& camera ) const
+{
+	FloatVector3 center;
+	float radius;
+	scheduledCloth.cloth->CalculateBoundingSphere( center, radius );
+
+	float distance = std::max( ( center - camera.GetPosition() ).CalculateNorm() - radius, 0.f );
+	scheduledCloth.isVisible = camera.CanSeeObject( center, radius );
+
+	const QualityLevel* quality = &OFF_SCREEN_QUALITY_LEVEL;
+	if( scheduledCloth.isVisible )
+	{
+		quality = &VISIBLE_QUALITY_LEVELS[ NUMBER_OF_VISIBLE_QUALITY_LEVELS - 1 ];
+		for( unsigned int i = 0; i < NUMBER_OF_VISIBLE_QUALITY_LEVELS; ++i )
+		{
+			if( distance <= VISIBLE_QUALITY_LEVELS[ i ].maximumDistance )
+			{
+				quality = &VISIBLE_QUALITY_LEVELS[ i ];
+				break;
+			}
+		}
+	}
+
+	scheduledCloth.desiredIterations = quality->constraintIterations;
+	scheduledCloth.updateIntervalFrames = quality->updateIntervalFrames;
+	scheduledCloth.priority = scheduledCloth.isVisible ? distance : distance + OFF_SCREEN_PRIORITY_PENALTY;
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothQualityScheduler::RunClothUpdate( ScheduledCloth& scheduledCloth, unsigned int iterations, bool useConstraintSatisfaction, 
+											const Camera& camera, float pixelsPerWorldUnitAtUnitDistance )
+{
+	//A cloth that has been waiting catches up, but never in a step long enough to blow up the integration;
+	//whatever is over the cap carries over to its next update
+	float stepSeconds = std::min( scheduledCloth.secondsSinceLastUpdate, MAXIMUM_STEP_SECONDS );
+
+	double startTimeSeconds = GetCurrentTimeSeconds();
+	scheduledCloth.cloth->SetNumberOfConstraintSatisfactionLoops( iterations );
+	scheduledCloth.cloth->Update( stepSeconds, m_numberOfSubsteps, useConstraintSatisfaction, camera, pixelsPerWorldUnitAtUnitDistance );
+	double elapsedSeconds = GetCurrentTimeSeconds() - startTimeSeconds;
+
+	double secondsPerWorkUnit = elapsedSeconds / ( ( iterations + 1 ) * m_numberOfSubsteps );
+	if( scheduledCloth.averageSecondsPerWorkUnit == 0.0 )
+		scheduledCloth.averageSecondsPerWorkUnit = secondsPerWorkUnit;
+	else
+		scheduledCloth.averageSecondsPerWorkUnit += COST_SMOOTHING_WEIGHT * ( secondsPerWorkUnit - scheduledCloth.averageSecondsPerWorkUnit );
+
+	//A backlog of more than one further step only builds up after a hitch, and is dropped rather than replayed
+	scheduledCloth.framesSinceLastUpdate = 0;
+	scheduledCloth.secondsSinceLastUpdate = std::min( scheduledCloth.secondsSinceLastUpdate - stepSeconds, MAXIMUM_STEP_SECONDS );
+	m_lastFrameCostSeconds += elapsedSeconds;
+	++m_numberOfClothsUpdatedLastFrame;
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothQualityScheduler::UpdateCloths( float deltaSeconds, bool useConstraintSatisfaction, const Camera& camera, float pixelsPerWorldUnitAtUnitDistance )
+{
+	m_lastFrameCostSeconds = 0.0;
+	m_numberOfClothsUpdatedLastFrame = 0;
+	m_numberOfClothsDeferredLastFrame = 0;
+
+	//No update interval may span more than the longest step, or each update would leave time behind
+	unsigned int maximumIntervalFrames = 1;
+	if( deltaSeconds > 0.f )
+		maximumIntervalFrames = std::max( 1u, static_cast< unsigned int >( MAXIMUM_STEP_SECONDS / deltaSeconds + 0.001f ) );
+
+	//Gather the cloths whose update interval has come up, most important first
+	std::vector< std::pair< float, unsigned int > > dueCloths;
+	for( unsigned int i = 0; i < m_cloths.size(); ++i )
+	{
+		ScheduledCloth& scheduledCloth = m_cloths[ i ];
+		AssignQualityFromView( scheduledCloth, camera );
+
+		++scheduledCloth.framesSinceLastUpdate;
+		scheduledCloth.secondsSinceLastUpdate += deltaSeconds;
+		if( scheduledCloth.framesSinceLastUpdate >= std::min( scheduledCloth.updateIntervalFrames, maximumIntervalFrames ) )
+			dueCloths.push_back( std::make_pair( scheduledCloth.priority, i ) );
+	}
+	std::sort( dueCloths.begin(), dueCloths.end() );
+
+	for( unsigned int i = 0; i < dueCloths.size(); ++i )
+	{
+		ScheduledCloth& scheduledCloth = m_cloths[ dueCloths[ i ].second ];
+		double remainingBudgetSeconds = m_frameBudgetSeconds - m_lastFrameCostSeconds;
+
+		if( m_iterationOverride != 0 )
+		{
+			RunClothUpdate( scheduledCloth, m_iterationOverride, useConstraintSatisfaction, camera, pixelsPerWorldUnitAtUnitDistance );
+			continue;
+		}
+
+		//Over budget: first give up constraint passes, then push the step to a later frame
+		unsigned int iterations = scheduledCloth.desiredIterations;
+		while( iterations > 1 && scheduledCloth.EstimateCostSeconds( iterations, m_numberOfSubsteps ) > remainingBudgetSeconds )
+			iterations /= 2;
+
+		bool mustUpdateNow = scheduledCloth.secondsSinceLastUpdate >= MAXIMUM_STEP_SECONDS;
+		if( scheduledCloth.EstimateCostSeconds( iterations, m_numberOfSubsteps ) > remainingBudgetSeconds && !mustUpdateNow )
+		{
+			++m_numberOfClothsDeferredLastFrame;
+			continue;
+		}
+
+		RunClothUpdate( scheduledCloth, iterations, useConstraintSatisfaction, camera, pixelsPerWorldUnitAtUnitDistance );
+	}
+}
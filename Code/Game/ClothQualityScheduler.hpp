@@ -0,0 +1,95 @@
+#ifndef INCLUDED_CLOTH_QUALITY_SCHEDULER_HPP
+#define INCLUDED_CLOTH_QUALITY_SCHEDULER_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <vector>
+#include "../Engine/Camera.hpp"
+#include "MultiResolutionCloth.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Decides how many constraint passes each cloth gets and how often it steps, from its distance to
+//the camera and whether it's inside the camera's clipping planes. Cloths due this frame are run
+//nearest first; once the frame's physics budget is spent, the rest lose iterations or wait.
+class ClothQualityScheduler
+{
+	static const float DEFAULT_FRAME_BUDGET_SECONDS;
+	static const float MAXIMUM_STEP_SECONDS;
+	static const float COST_SMOOTHING_WEIGHT;
+	static const float OFF_SCREEN_PRIORITY_PENALTY;
+
+	struct QualityLevel
+	{
+		float maximumDistance;
+		unsigned int constraintIterations;
+		unsigned int updateIntervalFrames;
+	};
+	static const QualityLevel VISIBLE_QUALITY_LEVELS[];
+	static const unsigned int NUMBER_OF_VISIBLE_QUALITY_LEVELS;
+	static const QualityLevel OFF_SCREEN_QUALITY_LEVEL;
+
+	struct ScheduledCloth
+	{
+		MultiResolutionCloth* cloth;
+		bool isVisible;
+		float priority;
+		unsigned int desiredIterations;
+		unsigned int updateIntervalFrames;
+		unsigned int framesSinceLastUpdate;
+		float secondsSinceLastUpdate;
+		double averageSecondsPerWorkUnit; //One work unit is a constraint pass; integration counts as one more
+
+		ScheduledCloth( MultiResolutionCloth* scheduledCloth )
+			: cloth( scheduledCloth )
+			, isVisible( true )
+			, priority( 0.f )
+			, desiredIterations( 1 )
+			, updateIntervalFrames( 1 )
+			, framesSinceLastUpdate( 0 )
+			, secondsSinceLastUpdate( 0.f )
+			, averageSecondsPerWorkUnit( 0.0 )
+		{ }
+
+		double EstimateCostSeconds( unsigned int iterations, unsigned int numberOfSubsteps ) const { return averageSecondsPerWorkUnit * ( iterations + 1 ) * numberOfSubsteps; }
+	};
+
+	std::vector< ScheduledCloth > m_cloths;
+	float m_frameBudgetSeconds;
+	double m_lastFrameCostSeconds;
+	unsigned int m_numberOfClothsUpdatedLastFrame;
+	unsigned int m_numberOfClothsDeferredLastFrame;
+	unsigned int m_iterationOverride; //0 leaves iterations to the quality levels and the budget
+	unsigned int m_numberOfSubsteps;
+
+	void AssignQualityFromView( ScheduledCloth& scheduledCloth, const Camera& camera ) const;
+	void RunClothUpdate( ScheduledCloth& scheduledCloth, unsigned int iterations, bool useConstraintSatisfaction, 
+						 const Camera& camera, float pixelsPerWorldUnitAtUnitDistance );
+
+public:
+	explicit ClothQualityScheduler( float frameBudgetSeconds = DEFAULT_FRAME_BUDGET_SECONDS )
+		: m_frameBudgetSeconds( frameBudgetSeconds )
+		, m_lastFrameCostSeconds( 0.0 )
+		, m_numberOfClothsUpdatedLastFrame( 0 )
+		, m_numberOfClothsDeferredLastFrame( 0 )
+		, m_iterationOverride( 0 )
+		, m_numberOfSubsteps( 1 )
+	{ }
+
+	void AddCloth( MultiResolutionCloth* cloth ) { m_cloths.push_back( ScheduledCloth( cloth ) ); }
+	float GetFrameBudgetSeconds() const { return m_frameBudgetSeconds; }
+	void SetFrameBudgetSeconds( float frameBudgetSeconds ) { m_frameBudgetSeconds = frameBudgetSeconds; }
+
+	//A fixed iteration count is run as asked, ignoring distance and budget, so its cost can be measured.
+	unsigned int GetIterationOverride() const { return m_iterationOverride; }
+	void SetIterationOverride( unsigned int iterations ) { m_iterationOverride = iterations; }
+	unsigned int GetNumberOfSubsteps() const { return m_numberOfSubsteps; }
+	void SetNumberOfSubsteps( unsigned int numberOfSubsteps ) { m_numberOfSubsteps = ( numberOfSubsteps == 0 ) ? 1 : numberOfSubsteps; }
+
+	double GetLastFrameCostSeconds() const { return m_lastFrameCostSeconds; }
+	unsigned int GetNumberOfClothsUpdatedLastFrame() const { return m_numberOfClothsUpdatedLastFrame; }
+	unsigned int GetNumberOfClothsDeferredLastFrame() const { return m_numberOfClothsDeferredLastFrame; }
+
+	void UpdateCloths( float deltaSeconds, bool useConstraintSatisfaction, const Camera& camera, float pixelsPerWorldUnitAtUnitDistance );
+};
+
+#endif //INCLUDED_CLOTH_QUALITY_SCHEDULER_HPP
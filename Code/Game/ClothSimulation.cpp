@@ -0,0 +1,151 @@
+#include <algorithm>
+#include <chrono>
+#include "../Engine/Math/Interpolation.hpp"
+#include "../Engine/Profiler.hpp"
+#include "../Engine/Time.hpp"
+#include "../Engine/TraceRecorder.hpp"
+#include "ClothSimulation.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC const float ClothSimulation::DEFAULT_STEP_SECONDS = 1.f / 60.f;
+STATIC const double ClothSimulation::MAXIMUM_SECONDS_BEHIND = 0.25;
+STATIC const float ClothSimulation::MAXIMUM_EXTRAPOLATION_FRACTION = 0.5f;
+
+//-----------------------------------------------------------------------------------------------
+void ClothSimulation::Start( float stepSeconds, const ClothSimulationInputs& initialInputs )
+{
+	if( IsRunning() )
+		return;
+
+	m_stepSeconds = stepSeconds;
+	m_pendingInputs = initialInputs;
+	m_isStopping.store( false );
+	m_simulationThread = std::thread( &ClothSimulation::RunSimulationThread, this );
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothSimulation::Stop()
+{
+	if( !IsRunning() )
+		return;
+
+	m_isStopping.store( true );
+	m_simulationThread.join();
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothSimulation::SetStepSeconds( float stepSeconds )
+{
+	if( !IsRunning() )
+	{
+		m_stepSeconds = stepSeconds;
+		return;
+	}
+
+	//Stopped, the thread no longer touches the pending inputs
+	Stop();
+	Start( stepSeconds, m_pendingInputs );
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothSimulation::SetInputs( const ClothSimulationInputs& inputs )
+{
+	std::lock_guard< std::mutex > inputGuard( m_inputLock );
+	m_pendingInputs = inputs;
+}
+
+//-----------------------------------------------------------------------------------------------
+void ClothSimulation::StepAndPublish( const ClothSimulationInputs& inputs, unsigned int stepNumber, double clockOriginSeconds )
+{
+	PROFILE_ZONE( "ClothSimulation::Step" );
+
+	double stepStartSeconds = GetCurrentTimeSeconds();
+	m_cloth.SetWindForce( inputs.windForce );
+	m_scheduler.SetIterationOverride( inputs.iterationOverride );
+	m_scheduler.SetNumberOfSubsteps( inputs.numberOfSubsteps );
+	m_scheduler.UpdateCloths( m_stepSeconds, inputs.useConstraintSatisfaction, inputs.camera, inputs.pixelsPerWorldUnitAtUnitDistance );
+
+	ClothSnapshot& snapshot = m_snapshots.GetWriteSlot();
+	m_cloth.CopyRenderedPositionsAndNormalsInto( snapshot.particlePositions, snapshot.particleNormals );
+	m_cloth.CalculateBoundingSphere( snapshot.boundingSphereCenter, snapshot.boundingSphereRadius );
+	snapshot.stepNumber = stepNumber;
+	snapshot.simulationTimeSeconds = static_cast< double >( m_stepSeconds ) * stepNumber;
+	snapshot.clockOriginSeconds = clockOriginSeconds;
+	snapshot.activeLevel = m_cloth.GetActiveLevel();
+	snapshot.stepCostSeconds = GetCurrentTimeSeconds() - stepStartSeconds;
+	++m_totalNumberOfSteps;
+	m_totalStepCostSeconds += snapshot.stepCostSeconds;
+	snapshot.totalNumberOfSteps = m_totalNumberOfSteps;
+	snapshot.totalStepCostSeconds = m_totalStepCostSeconds;
+	m_snapshots.Publish();
+}
+
+//-----------------------------------------------------------------------------------------------
+//Each step starts once the sim clock reaches the simulated time its predecessor ended at, so steps
+//fall on whole multiples of the step time like the frame pacer's targets. If the thread falls far
+//behind (a breakpoint, a hitch) the clock is moved up rather than racing to catch up.
+void ClothSimulation::RunSimulationThread()
+{
+	TraceRecorder::SetCurrentThreadName( "Cloth Simulation" );
+
+	unsigned int stepNumber = 0;
+	double clockOriginSeconds = GetCurrentTimeSeconds();
+	while( !m_isStopping.load() )
+	{
+		ClothSimulationInputs inputs;
+		{
+			std::lock_guard< std::mutex > inputGuard( m_inputLock );
+			inputs = m_pendingInputs;
+		}
+
+		++stepNumber;
+		StepAndPublish( inputs, stepNumber, clockOriginSeconds );
+
+		double nextStepSeconds = clockOriginSeconds + static_cast< double >( m_stepSeconds ) * stepNumber;
+		double timeNow = GetCurrentTimeSeconds();
+		if( timeNow - nextStepSeconds > MAXIMUM_SECONDS_BEHIND )
+		{
+			clockOriginSeconds += timeNow - nextStepSeconds;
+			nextStepSeconds = timeNow;
+		}
+
+		if( timeNow < nextStepSeconds )
+			std::this_thread::sleep_for( std::chrono::duration< double >( nextStepSeconds - timeNow ) );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+//The previous snapshot's positions are copied out before the newer one is taken, since its slot
+//goes back to the simulation as soon as it's swapped. A snapshot older than the one before it means
+//the simulation was restarted, so there's nothing to blend from until the next.
+void ClothSimulation::UpdateRenderedPositions()
+{
+	PROFILE_ZONE( "ClothSimulation::UpdateRenderedPositions" );
+
+	if( m_snapshots.HasNewValue() )
+	{
+		const ClothSnapshot& previousSnapshot = m_snapshots.GetReadSlot();
+		m_previousSnapshotPositions = previousSnapshot.particlePositions;
+		m_previousSnapshotTimeSeconds = previousSnapshot.simulationTimeSeconds;
+		m_snapshots.AcquireLatest();
+	}
+
+	const ClothSnapshot& latestSnapshot = m_snapshots.GetReadSlot();
+	const std::vector< FloatVector3 >& latestPositions = latestSnapshot.particlePositions;
+	double snapshotIntervalSeconds = latestSnapshot.simulationTimeSeconds - m_previousSnapshotTimeSeconds;
+	if( !m_isSmoothingEnabled || snapshotIntervalSeconds <= 0.0 || m_previousSnapshotPositions.size() != latestPositions.size() )
+	{
+		m_renderedPositions = latestPositions;
+		m_renderedFraction = 1.f;
+		return;
+	}
+
+	double simulationClockSeconds = GetCurrentTimeSeconds() - latestSnapshot.clockOriginSeconds;
+	float fraction = static_cast< float >( ( simulationClockSeconds - m_previousSnapshotTimeSeconds ) / snapshotIntervalSeconds );
+	fraction = std::max( 0.f, std::min( fraction, 1.f + MAXIMUM_EXTRAPOLATION_FRACTION ) );
+
+	m_renderedPositions.resize( latestPositions.size() );
+	for( unsigned int i = 0; i < latestPositions.size(); ++i )
+		m_renderedPositions[ i ] = LinearInterpolate( m_previousSnapshotPositions[ i ], latestPositions[ i ], fraction );
+	m_renderedFraction = fraction;
+}
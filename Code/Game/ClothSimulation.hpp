@@ -0,0 +1,144 @@
+#ifndef INCLUDED_CLOTH_SIMULATION_HPP
+#define INCLUDED_CLOTH_SIMULATION_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include "../Engine/Camera.hpp"
+#include "../Engine/TripleBuffer.hpp"
+#include "ClothQualityScheduler.hpp"
+#include "MultiResolutionCloth.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//Everything the renderer needs from one finished simulation step.
+struct ClothSnapshot
+{
+	std::vector< FloatVector3 > particlePositions; //Full resolution cloth, one per particle
+	std::vector< FloatVector3 > particleNormals;
+	FloatVector3 boundingSphereCenter;
+	float boundingSphereRadius;
+	unsigned int stepNumber; //0 until the first step is published
+	double simulationTimeSeconds; //Simulated time at the end of the step
+	double clockOriginSeconds; //Wall time at which simulated time was zero, so the sim clock is now minus this
+	double stepCostSeconds;
+	unsigned int totalNumberOfSteps; //Since the simulation was created, across restarts
+	double totalStepCostSeconds;
+	unsigned int activeLevel;
+
+	ClothSnapshot()
+		: boundingSphereRadius( 0.f )
+		, stepNumber( 0 )
+		, simulationTimeSeconds( 0.0 )
+		, clockOriginSeconds( 0.0 )
+		, stepCostSeconds( 0.0 )
+		, totalNumberOfSteps( 0 )
+		, totalStepCostSeconds( 0.0 )
+		, activeLevel( 0 )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+//What the game thread hands the simulation; the latest set is picked up at the start of each step.
+struct ClothSimulationInputs
+{
+	Camera camera;
+	float pixelsPerWorldUnitAtUnitDistance;
+	bool useConstraintSatisfaction;
+	FloatVector3 windForce;
+	unsigned int iterationOverride; //0 leaves iterations to the scheduler
+	unsigned int numberOfSubsteps;
+
+	ClothSimulationInputs()
+		: pixelsPerWorldUnitAtUnitDistance( 1.f )
+		, useConstraintSatisfaction( true )
+		, windForce( 0.f, 0.f, 0.f )
+		, iterationOverride( 0 )
+		, numberOfSubsteps( 1 )
+	{ }
+};
+
+//-----------------------------------------------------------------------------------------------
+//Steps a cloth at a fixed rate on its own thread, so simulation overlaps rendering instead of
+//adding to the frame. Each step ends by publishing a snapshot into a triple buffer; the game
+//thread takes the newest one once a frame and renders from it without taking any lock. Only the
+//inputs cross the other way, under a lock held just long enough to copy them.
+//
+//So the cloth moves smoothly when the simulation steps slower than frames are drawn, the rendered
+//positions are blended between the two newest snapshots at the current sim clock time. While the
+//next step is still running that runs a little past the newest snapshot, which is allowed up to
+//MAXIMUM_EXTRAPOLATION_FRACTION of a step before the cloth holds still.
+//-----------------------------------------------------------------------------------------------
+class ClothSimulation
+{
+	static const double MAXIMUM_SECONDS_BEHIND;
+	static const float MAXIMUM_EXTRAPOLATION_FRACTION;
+
+	MultiResolutionCloth m_cloth;
+	ClothQualityScheduler m_scheduler;
+	float m_stepSeconds;
+	unsigned int m_totalNumberOfSteps; //Simulation thread only
+	double m_totalStepCostSeconds;
+
+	std::thread m_simulationThread;
+	std::atomic< bool > m_isStopping;
+
+	std::mutex m_inputLock;
+	ClothSimulationInputs m_pendingInputs;
+
+	TripleBuffer< ClothSnapshot > m_snapshots;
+
+	//Game thread only
+	bool m_isSmoothingEnabled;
+	std::vector< FloatVector3 > m_previousSnapshotPositions;
+	double m_previousSnapshotTimeSeconds;
+	std::vector< FloatVector3 > m_renderedPositions;
+	float m_renderedFraction; //0 at the previous snapshot, 1 at the newest, more when extrapolating
+
+	//We have no need of a pithy assignment or copy operator!
+	ClothSimulation( const ClothSimulation& other );
+	ClothSimulation& operator=( const ClothSimulation& other );
+
+	void RunSimulationThread();
+	void StepAndPublish( const ClothSimulationInputs& inputs, unsigned int stepNumber, double clockOriginSeconds );
+
+public:
+	static const float DEFAULT_STEP_SECONDS;
+
+	ClothSimulation( unsigned int particlesPerX, unsigned int particlesPerY, float dragCoefficient )
+		: m_cloth( particlesPerX, particlesPerY, dragCoefficient )
+		, m_stepSeconds( DEFAULT_STEP_SECONDS )
+		, m_totalNumberOfSteps( 0 )
+		, m_totalStepCostSeconds( 0.0 )
+		, m_isStopping( false )
+		, m_isSmoothingEnabled( true )
+		, m_previousSnapshotTimeSeconds( 0.0 )
+		, m_renderedFraction( 1.f )
+	{
+		m_scheduler.AddCloth( &m_cloth );
+	}
+	~ClothSimulation() { Stop(); }
+
+	void Start( float stepSeconds, const ClothSimulationInputs& initialInputs );
+	void Stop();
+	bool IsRunning() const { return m_simulationThread.joinable(); }
+	float GetStepSeconds() const { return m_stepSeconds; }
+	//Restarts a running simulation at the new rate; the cloth carries on from where it was.
+	void SetStepSeconds( float stepSeconds );
+
+	void SetInputs( const ClothSimulationInputs& inputs );
+
+	//The rest is game thread only. Call once a frame, before rendering, to take the newest snapshot
+	//and work out the positions to draw.
+	void UpdateRenderedPositions();
+	const ClothSnapshot& GetLatestSnapshot() const { return m_snapshots.GetReadSlot(); }
+	float GetRenderedFraction() const { return m_renderedFraction; }
+	bool IsSmoothingEnabled() const { return m_isSmoothingEnabled; }
+	void SetSmoothingEnabled( bool isSmoothingEnabled ) { m_isSmoothingEnabled = isSmoothingEnabled; }
+
+	void Render( bool drawInDebug ) const { m_cloth.Render( m_renderedPositions, drawInDebug ); }
+};
+
+#endif //INCLUDED_CLOTH_SIMULATION_HPP
@@ -1,6 +1,13 @@
 //ENGINE SETTING: set the audio renderer that we will use.
-#define AUDIO_USE_FMOD
+//The FMOD library we link is the Win32 build, so other platforms run without audio.
+#if defined( _WIN32 )
+	#define AUDIO_USE_FMOD
+#endif
 
 //ENGINE SETTING: set the graphics renderer that we will use.
-#define GRAPHICS_USE_OPENGL
+//Define GRAPHICS_USE_RECORDING in the build instead to run without a graphics card, recording
+//every renderer call so render paths can be profiled headlessly.
+#ifndef GRAPHICS_USE_RECORDING
+	#define GRAPHICS_USE_OPENGL
+#endif
 
@@ -6,6 +6,7 @@
 
 #include "Cloth.hpp"
 #include "../Engine/Math/FloatVector3.hpp"
+#include "../Engine/Math/FloatVector3A.hpp"
 
 // Inline Integrator Function Dec
 void verletLeapFrogIntegrationMassSpringDamper( const Cloth & cloth, Cloth::Particle & particleToIntegrate, float deltaSeconds );
@@ -36,9 +37,13 @@ inline FloatVector3 calculateTriangleNormal( const Cloth::Particle& p1, const Cl
 
 inline void verletIntegration( Cloth::Particle& p1, float deltaSeconds ) {
 
-	FloatVector3 tempPos = p1.currentPosition;
-	p1.currentPosition = p1.currentPosition + ( p1.currentPosition - p1.previousPosition ) + ( p1.acceleration * deltaSeconds );
-	p1.previousPosition = tempPos;
+	FloatVector3A currentPosition( p1.currentPosition );
+	FloatVector3A previousPosition( p1.previousPosition );
+	FloatVector3A acceleration( p1.acceleration );
+
+	FloatVector3A nextPosition = currentPosition + ( currentPosition - previousPosition ) + ( acceleration * deltaSeconds );
+	nextPosition.StoreTo( p1.currentPosition );
+	currentPosition.StoreTo( p1.previousPosition );
 
 }
 
@@ -0,0 +1,131 @@
+#include "../Engine/Profiler.hpp"
+#include "MultiResolutionCloth.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC const float MultiResolutionCloth::TARGET_PIXELS_PER_PARTICLE_SPACING = 24.f;
+STATIC const float MultiResolutionCloth::LEVEL_SWITCH_HYSTERESIS = 0.25f;
+STATIC const float MultiResolutionCloth::TRANSITION_SECONDS = 0.4f;
+
+//-----------------------------------------------------------------------------------------------
+MultiResolutionCloth::MultiResolutionCloth( unsigned int particlesPerX, unsigned int particlesPerY, float dragCoefficient )
+	: m_activeLevel( 0 )
+	, m_transitionWeight( 0.f )
+{
+	if( particlesPerX < Cloth::MINIMUM_PARTICLES_PER_SIDE )
+		particlesPerX = Cloth::MINIMUM_PARTICLES_PER_SIDE;
+	if( particlesPerY < Cloth::MINIMUM_PARTICLES_PER_SIDE )
+		particlesPerY = Cloth::MINIMUM_PARTICLES_PER_SIDE;
+	Cloth* finestLevel = new Cloth( particlesPerX, particlesPerY, dragCoefficient );
+	m_levels.push_back( finestLevel );
+
+	//Each level roughly halves the particles per side while covering the same area with the same total mass
+	float totalMass = finestLevel->GetParticleMass() * finestLevel->GetNumberOfParticles();
+	float clothWidth  = finestLevel->GetParticleSpacingX() * ( particlesPerX - 1 );
+	float clothHeight = finestLevel->GetParticleSpacingY() * ( particlesPerY - 1 );
+	unsigned int levelParticlesPerX = ( particlesPerX - 1 ) / 2 + 1;
+	unsigned int levelParticlesPerY = ( particlesPerY - 1 ) / 2 + 1;
+	while( levelParticlesPerX >= MINIMUM_PARTICLES_PER_SIDE && levelParticlesPerY >= MINIMUM_PARTICLES_PER_SIDE )
+	{
+		float particleMass = totalMass / ( levelParticlesPerX * levelParticlesPerY );
+		m_levels.push_back( new Cloth( levelParticlesPerX, levelParticlesPerY, dragCoefficient,
+									   clothWidth / ( levelParticlesPerX - 1 ), clothHeight / ( levelParticlesPerY - 1 ), particleMass ) );
+		m_levels.back()->ShareWindFieldOf( *finestLevel );
+
+		levelParticlesPerX = ( levelParticlesPerX - 1 ) / 2 + 1;
+		levelParticlesPerY = ( levelParticlesPerY - 1 ) / 2 + 1;
+	}
+
+	m_transitionOffsets.resize( finestLevel->GetNumberOfParticles() );
+}
+
+//-----------------------------------------------------------------------------------------------
+unsigned int MultiResolutionCloth::ChooseLevelForView( const Camera& camera, float pixelsPerWorldUnitAtUnitDistance ) const
+{
+	unsigned int coarsestLevel = m_levels.size() - 1;
+
+	FloatVector3 center;
+	float radius;
+	CalculateBoundingSphere( center, radius );
+
+	if( !camera.CanSeeObject( center, radius ) )
+		return coarsestLevel;
+
+	//Use the nearest point of the bounding sphere so large cloths stay detailed when we're close to an edge
+	float distance = std::max( ( center - camera.GetPosition() ).CalculateNorm() - radius, 1.f );
+	float pixelsPerWorldUnit = pixelsPerWorldUnitAtUnitDistance / distance;
+
+	unsigned int desiredLevel = 0;
+	while( desiredLevel < coarsestLevel && 
+		   CalculateOnScreenSpacingPixels( desiredLevel + 1, pixelsPerWorldUnit ) <= TARGET_PIXELS_PER_PARTICLE_SPACING )
+		++desiredLevel;
+
+	//Only switch once we're clearly past the threshold, so we don't flicker between levels
+	if( desiredLevel > m_activeLevel && 
+		CalculateOnScreenSpacingPixels( desiredLevel, pixelsPerWorldUnit ) > TARGET_PIXELS_PER_PARTICLE_SPACING * ( 1.f - LEVEL_SWITCH_HYSTERESIS ) )
+		return m_activeLevel;
+	if( desiredLevel < m_activeLevel && 
+		CalculateOnScreenSpacingPixels( m_activeLevel, pixelsPerWorldUnit ) < TARGET_PIXELS_PER_PARTICLE_SPACING * ( 1.f + LEVEL_SWITCH_HYSTERESIS ) )
+		return m_activeLevel;
+	return desiredLevel;
+}
+
+//-----------------------------------------------------------------------------------------------
+void MultiResolutionCloth::SwitchToLevel( unsigned int newLevel )
+{
+	Cloth& renderedCloth = *m_levels[ 0 ];
+	Cloth& newCloth = *m_levels[ newLevel ];
+	newCloth.CopyStateFrom( *m_levels[ m_activeLevel ] );
+	m_activeLevel = newLevel;
+
+	//Moving to level 0 waits for any fade to finish (see Update), so it starts from exactly what
+	//was being drawn and needs no offsets of its own.
+	if( m_activeLevel == 0 )
+		return;
+
+	//Remember where we were drawing, then fade from there to the new level's shape
+	for( unsigned int i = 0; i < m_transitionOffsets.size(); ++i )
+		m_transitionOffsets[ i ] = renderedCloth.GetParticlePosition( i );
+
+	renderedCloth.ProlongPositionsFrom( newCloth );
+
+	for( unsigned int i = 0; i < m_transitionOffsets.size(); ++i )
+		m_transitionOffsets[ i ] -= renderedCloth.GetParticlePosition( i );
+	m_transitionWeight = 1.f;
+}
+
+//-----------------------------------------------------------------------------------------------
+void MultiResolutionCloth::UpdateRenderedCloth( float deltaSeconds )
+{
+	if( m_activeLevel == 0 )
+		return;
+
+	Cloth& renderedCloth = *m_levels[ 0 ];
+	renderedCloth.ProlongPositionsFrom( *m_levels[ m_activeLevel ] );
+
+	if( m_transitionWeight <= 0.f )
+		return;
+
+	m_transitionWeight = std::max( m_transitionWeight - deltaSeconds / TRANSITION_SECONDS, 0.f );
+	for( unsigned int i = 0; i < m_transitionOffsets.size(); ++i )
+		renderedCloth.SetParticlePosition( i, renderedCloth.GetParticlePosition( i ) + m_transitionWeight * m_transitionOffsets[ i ] );
+}
+
+//-----------------------------------------------------------------------------------------------
+void MultiResolutionCloth::Update( float deltaSeconds, unsigned int numberOfSubsteps, bool useConstraintSatisfaction, const Camera& camera, float pixelsPerWorldUnitAtUnitDistance )
+{
+	PROFILE_ZONE( "MultiResolutionCloth::Update" );
+
+	//Level 0 simulates directly, so it can't carry display offsets; switching back to it mid-fade
+	//would snap away what's left of the offsets, so hold the current level until the fade is done
+	unsigned int desiredLevel = ChooseLevelForView( camera, pixelsPerWorldUnitAtUnitDistance );
+	if( desiredLevel != m_activeLevel && !( desiredLevel == 0 && m_transitionWeight > 0.f ) )
+		SwitchToLevel( desiredLevel );
+
+	if( numberOfSubsteps == 0 )
+		numberOfSubsteps = 1;
+	float substepSeconds = deltaSeconds / numberOfSubsteps;
+	for( unsigned int i = 0; i < numberOfSubsteps; ++i )
+		m_levels[ m_activeLevel ]->Update( substepSeconds, useConstraintSatisfaction );
+
+	UpdateRenderedCloth( deltaSeconds );
+}
@@ -0,0 +1,99 @@
+#ifndef INCLUDED_MULTI_RESOLUTION_CLOTH_HPP
+#define INCLUDED_MULTI_RESOLUTION_CLOTH_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <vector>
+#include "../Engine/Camera.hpp"
+#include "Cloth.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A cloth simulated at one of several grid resolutions, chosen by how large its particle spacing
+//appears on screen. Level 0 is the full resolution cloth and is always the one rendered; when a
+//coarser level is simulating, its positions are interpolated onto level 0 each update. All levels
+//share level 0's wind field, so the wind doesn't jump when the active level changes.
+class MultiResolutionCloth
+{
+	static const unsigned int MINIMUM_PARTICLES_PER_SIDE = 3;
+	static const float TARGET_PIXELS_PER_PARTICLE_SPACING;
+	static const float LEVEL_SWITCH_HYSTERESIS;
+	static const float TRANSITION_SECONDS;
+
+	std::vector< Cloth* > m_levels;
+	unsigned int m_activeLevel;
+
+	//Offsets added to the rendered positions after a switch, faded out over TRANSITION_SECONDS
+	std::vector< FloatVector3 > m_transitionOffsets;
+	float m_transitionWeight;
+
+	//We have no need of a pithy assignment or copy operator!
+	MultiResolutionCloth( const MultiResolutionCloth& other );
+	MultiResolutionCloth& operator=( const MultiResolutionCloth& other );
+
+	float CalculateOnScreenSpacingPixels( unsigned int level, float pixelsPerWorldUnit ) const;
+	unsigned int ChooseLevelForView( const Camera& camera, float pixelsPerWorldUnitAtUnitDistance ) const;
+	void SwitchToLevel( unsigned int newLevel );
+	void UpdateRenderedCloth( float deltaSeconds );
+
+public:
+	MultiResolutionCloth( unsigned int particlesPerX, unsigned int particlesPerY, float dragCoefficient );
+	~MultiResolutionCloth();
+
+	unsigned int GetActiveLevel() const { return m_activeLevel; }
+	unsigned int GetNumberOfLevels() const { return m_levels.size(); }
+	const Cloth& GetLevel( unsigned int level ) const { return *m_levels[ level ]; }
+	void SetWindForce( const FloatVector3& windForce );
+	void SetNumberOfConstraintSatisfactionLoops( size_t numberOfLoops );
+
+	void CalculateBoundingSphere( FloatVector3& out_center, float& out_radius ) const;
+
+	//Positions are level 0's, as copied out by CopyRenderedPositionsAndNormalsInto.
+	void Render( const std::vector< FloatVector3 >& particlePositions, bool drawInDebug ) const { m_levels[ 0 ]->Render( particlePositions, drawInDebug ); }
+	void CopyRenderedPositionsAndNormalsInto( std::vector< FloatVector3 >& out_positions, std::vector< FloatVector3 >& out_normals ) const
+	{
+		m_levels[ 0 ]->CopyPositionsAndNormalsInto( out_positions, out_normals );
+	}
+
+	//pixelsPerWorldUnitAtUnitDistance is the projection scale: half the screen width over tan( half FOV ).
+	//The step is split into numberOfSubsteps equal steps of the active level, for stiffer, steadier cloth.
+	void Update( float deltaSeconds, unsigned int numberOfSubsteps, bool useConstraintSatisfaction, const Camera& camera, float pixelsPerWorldUnitAtUnitDistance );
+};
+
+
+
+//-----------------------------------------------------------------------------------------------
+inline MultiResolutionCloth::~MultiResolutionCloth()
+{
+	for( unsigned int i = 0; i < m_levels.size(); ++i )
+		delete m_levels[ i ];
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void MultiResolutionCloth::SetWindForce( const FloatVector3& windForce )
+{
+	m_levels[ 0 ]->SetWindForce( windForce );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void MultiResolutionCloth::SetNumberOfConstraintSatisfactionLoops( size_t numberOfLoops )
+{
+	for( unsigned int i = 0; i < m_levels.size(); ++i )
+		m_levels[ i ]->SetNumberOfConstraintSatisfactionLoops( numberOfLoops );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void MultiResolutionCloth::CalculateBoundingSphere( FloatVector3& out_center, float& out_radius ) const
+{
+	const Cloth& activeCloth = *m_levels[ m_activeLevel ];
+	out_center = 0.5f * ( activeCloth.GetBoundsMinimum() + activeCloth.GetBoundsMaximum() );
+	out_radius = 0.5f * ( activeCloth.GetBoundsMaximum() - activeCloth.GetBoundsMinimum() ).CalculateNorm();
+}
+
+//-----------------------------------------------------------------------------------------------
+inline float MultiResolutionCloth::CalculateOnScreenSpacingPixels( unsigned int level, float pixelsPerWorldUnit ) const
+{
+	const Cloth& cloth = *m_levels[ level ];
+	return std::max( cloth.GetParticleSpacingX(), cloth.GetParticleSpacingY() ) * pixelsPerWorldUnit;
+}
+
+#endif //INCLUDED_MULTI_RESOLUTION_CLOTH_HPP
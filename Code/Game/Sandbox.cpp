@@ -1,5 +1,8 @@
+#include <cstdlib>
+#include <functional>
 #include "../Engine/DebugDrawing.hpp"
 #include "../Engine/Font/BitmapFont.hpp"
+#include "Benchmarks.hpp"
 #include "Sandbox.hpp"
 
 //-----------------------------------------------------------------------------------------------
@@ -101,10 +104,155 @@ void Sandbox::UpdatePlayerFromInput( float deltaSeconds, Keyboard& keyboard, con
 		m_drawOrigin = !m_drawOrigin;
 }
 
+//-----------------------------------------------------------------------------------------------
+//iterations [n|auto]: constraint passes per step for every cloth; auto hands them back to the scheduler
+void Sandbox::SetClothIterations( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color CLOTH_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color CLOTH_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		const std::string& option = arguments.argumentsAsStringArray[ 0 ];
+		int iterations = atoi( option.c_str() );
+		if( option == "auto" )
+			m_clothIterationOverride = 0;
+		else if( iterations > 0 )
+			m_clothIterationOverride = static_cast< unsigned int >( iterations );
+		else
+		{
+			console->WriteTextToLog( "Usage: iterations [numberOfIterations|auto]", CLOTH_ERROR_COLOR );
+			return;
+		}
+	}
+
+	std::ostringstream message;
+	message << "Constraint iterations: ";
+	if( m_clothIterationOverride == 0 )
+		message << "auto (chosen by distance and budget)";
+	else
+		message << m_clothIterationOverride;
+	console->WriteTextToLog( message.str(), CLOTH_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//substeps [n]: how many steps each cloth update is split into
+void Sandbox::SetClothSubsteps( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color CLOTH_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color CLOTH_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		int numberOfSubsteps = atoi( arguments.argumentsAsStringArray[ 0 ].c_str() );
+		if( numberOfSubsteps <= 0 )
+		{
+			console->WriteTextToLog( "Usage: substeps [numberOfSubsteps]", CLOTH_ERROR_COLOR );
+			return;
+		}
+		m_clothSubsteps = static_cast< unsigned int >( numberOfSubsteps );
+	}
+
+	std::ostringstream message;
+	message << "Cloth substeps: " << m_clothSubsteps;
+	console->WriteTextToLog( message.str(), CLOTH_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//clothrate [stepsPerSecond]: how often the cloth simulation thread steps, independent of the frame rate
+void Sandbox::SetClothStepRate( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color CLOTH_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color CLOTH_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		float stepsPerSecond = static_cast< float >( atof( arguments.argumentsAsStringArray[ 0 ].c_str() ) );
+		if( stepsPerSecond <= 0.f )
+		{
+			console->WriteTextToLog( "Usage: clothrate [stepsPerSecond]", CLOTH_ERROR_COLOR );
+			return;
+		}
+		m_clothSimulation.SetStepSeconds( 1.f / stepsPerSecond );
+	}
+
+	const ClothSnapshot& latestSnapshot = m_clothSimulation.GetLatestSnapshot();
+	std::ostringstream message;
+	message << "Cloth steps per second: " << 1.f / m_clothSimulation.GetStepSeconds() 
+			<< " (last step " << latestSnapshot.stepCostSeconds * 1000.0 << " ms)";
+	console->WriteTextToLog( message.str(), CLOTH_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+//clothsmoothing [on|off]: draw the cloth blended between simulation steps, or as of the latest step
+void Sandbox::SetClothSmoothing( const CommandConsole::CommandArguments& arguments )
+{
+	static const Color CLOTH_TEXT_COLOR = Color( 0.6f, 0.8f, 1.f, 1.f );
+	static const Color CLOTH_ERROR_COLOR = Color( 1.f, 0.f, 0.f, 1.f );
+	CommandConsole* console = CommandConsole::GetConsole();
+
+	if( !arguments.argumentsAsStringArray.empty() )
+	{
+		const std::string& option = arguments.argumentsAsStringArray[ 0 ];
+		if( option == "on" )
+			m_clothSimulation.SetSmoothingEnabled( true );
+		else if( option == "off" )
+			m_clothSimulation.SetSmoothingEnabled( false );
+		else
+		{
+			console->WriteTextToLog( "Usage: clothsmoothing [on|off]", CLOTH_ERROR_COLOR );
+			return;
+		}
+	}
+
+	std::ostringstream message;
+	message << "Cloth smoothing between steps: " << ( m_clothSimulation.IsSmoothingEnabled() ? "on" : "off" );
+	console->WriteTextToLog( message.str(), CLOTH_TEXT_COLOR );
+}
+
+//-----------------------------------------------------------------------------------------------
+ClothSimulationInputs Sandbox::GatherClothSimulationInputs() const
+{
+	ClothSimulationInputs inputs;
+	inputs.camera = m_camera;
+	inputs.pixelsPerWorldUnitAtUnitDistance = 0.5f * m_screenWidth / static_cast< float >( tan( ConvertDegreesToRadians( 0.5f * static_cast< float >( m_horizontalFOVDegrees ) ) ) );
+	inputs.useConstraintSatisfaction = m_useConstraintSatisfaction;
+	inputs.windForce = m_windForce;
+	inputs.iterationOverride = m_clothIterationOverride;
+	inputs.numberOfSubsteps = m_clothSubsteps;
+	return inputs;
+}
+
+//-----------------------------------------------------------------------------------------------
+//As of the newest snapshot the game thread has taken, which is at most a frame behind
+void Sandbox::GetSimulationThreadTotals( unsigned int& out_numberOfSteps, double& out_stepSeconds ) const
+{
+	const ClothSnapshot& latestSnapshot = m_clothSimulation.GetLatestSnapshot();
+	out_numberOfSteps = latestSnapshot.totalNumberOfSteps;
+	out_stepSeconds = latestSnapshot.totalStepCostSeconds;
+}
+
 //-----------------------------------------------------------------------------------------------
 void Sandbox::Initialize()
 {
 	Game::Initialize();
+
+	RegisterBenchmarkCommands();
+	CommandConsole::RegisterConsoleCommand( "iterations", std::bind( &Sandbox::SetClothIterations, this, std::placeholders::_1 ) );
+	CommandConsole::RegisterConsoleCommand( "substeps", std::bind( &Sandbox::SetClothSubsteps, this, std::placeholders::_1 ) );
+	CommandConsole::RegisterConsoleCommand( "clothrate", std::bind( &Sandbox::SetClothStepRate, this, std::placeholders::_1 ) );
+	CommandConsole::RegisterConsoleCommand( "clothsmoothing", std::bind( &Sandbox::SetClothSmoothing, this, std::placeholders::_1 ) );
+
+	m_clothSimulation.Start( ClothSimulation::DEFAULT_STEP_SECONDS, GatherClothSimulationInputs() );
+}
+
+//-----------------------------------------------------------------------------------------------
+void Sandbox::Shutdown()
+{
+	m_clothSimulation.Stop();
 }
 
 //-----------------------------------------------------------------------------------------------
@@ -112,7 +260,7 @@ void Sandbox::RenderGame() const
 {
 	m_camera.ViewWorldThrough();
 
-	m_cloth.Render( m_drawDebugCloth );
+	m_clothSimulation.Render( m_drawDebugCloth );
 
 	Debug::DrawPoint( m_lightPosition, 1.f, Color( 1.f, 1.f, 1.f, 1.f ), Debug::DRAW_ONLY_IF_VISIBLE );
 }
@@ -133,7 +281,11 @@ void Sandbox::GameUpdate( float deltaSeconds )
 		Debug::DrawAABB( FloatVector3( 0.f, 0.f, 0.f ), FloatVector3( 5.f, 5.f, 5.f ), Color( 1.f, 1.f, 0.f, 1.f ), Color( 0.f, 1.f, 0.f, 1.f ), Debug::DRAW_ONLY_IF_VISIBLE );
 	}
 
-	m_cloth.Update( deltaSeconds, m_useConstraintSatisfaction );
+	//The simulation steps on its own thread; this frame just hands it fresh inputs and takes its newest result
+	m_clothSimulation.SetInputs( GatherClothSimulationInputs() );
+	m_clothSimulation.UpdateRenderedPositions();
+
+	UpdateRunningBenchmarks();
 
 	m_totalRunTimeSeconds += deltaSeconds;
 }
@@ -151,11 +303,11 @@ void Sandbox::InputUpdate( float deltaSeconds, Keyboard& keyboard, const Mouse&
 		m_useConstraintSatisfaction = !m_useConstraintSatisfaction;
 
 	if( keyboard.KeyIsPressed( Keyboard::NUMBER_1 ) )
-		m_cloth.SetWindForce( FloatVector3( 0.f, 0.f, 0.f ) );
+		m_windForce = FloatVector3( 0.f, 0.f, 0.f );
 	if( keyboard.KeyIsPressed( Keyboard::NUMBER_2 ) )
-		m_cloth.SetWindForce( FloatVector3( 0.2f, 0.1f, 0.1f ) );
+		m_windForce = FloatVector3( 0.2f, 0.1f, 0.1f );
 	if( keyboard.KeyIsPressed( Keyboard::NUMBER_3 ) )
-		m_cloth.SetWindForce( FloatVector3( 0.f, 0.f, 0.1f ) );
+		m_windForce = FloatVector3( 0.f, 0.f, 0.1f );
 
 	UpdatePlayerFromInput( deltaSeconds, keyboard, mouse );
 }
@@ -8,14 +8,17 @@
 #include "../Engine/Input/Xbox.hpp"
 #include "../Engine/Camera.hpp"
 #include "../Engine/Game.hpp"
-#include "Cloth.hpp"
+#include "ClothSimulation.hpp"
 
 //-----------------------------------------------------------------------------------------------
 class Sandbox: public Game
 {
 	Camera m_camera;
-	Cloth m_cloth;
+	ClothSimulation m_clothSimulation;
 	FloatVector3 m_lightPosition;
+	FloatVector3 m_windForce;
+	unsigned int m_clothIterationOverride; //0 leaves iterations to the scheduler
+	unsigned int m_clothSubsteps;
 
 	bool m_drawOrigin;
 	bool m_drawDebugCloth;
@@ -27,11 +30,19 @@ class Sandbox: public Game
 	float TransformKeyInputIntoAngleDegrees( bool upKeyIsPressed, bool rightKeyIsPressed, bool downKeyIsPressed, bool leftKeyIsPressed );
 
 	void UpdatePlayerFromInput( float deltaSeconds, Keyboard& keyboard, const Mouse& mouse );
+	ClothSimulationInputs GatherClothSimulationInputs() const;
+	void GetSimulationThreadTotals( unsigned int& out_numberOfSteps, double& out_stepSeconds ) const;
+
+	void SetClothIterations( const CommandConsole::CommandArguments& arguments );
+	void SetClothSubsteps( const CommandConsole::CommandArguments& arguments );
+	void SetClothStepRate( const CommandConsole::CommandArguments& arguments );
+	void SetClothSmoothing( const CommandConsole::CommandArguments& arguments );
 
 public:
 	Sandbox( bool& quitVariable, unsigned int width, unsigned int height, float horizontalFOVDegrees );
 
 	void Initialize();
+	void Shutdown();
 
 	void RenderGame() const;
 	void RenderUI() const;
@@ -46,8 +57,11 @@ public:
 inline Sandbox::Sandbox( bool& quitVariable, unsigned int width, unsigned int height, float horizontalFOVDegrees )
 	: Game( quitVariable, width, height, horizontalFOVDegrees )
 	, m_camera( -2.f, 0.f, 0.f )
-	, m_cloth( 12, 12, 0.5f )
+	, m_clothSimulation( 12, 12, 0.5f )
 	, m_lightPosition( 1.f, 1.f, 1.f )
+	, m_windForce( 0.f, 0.f, 0.f )
+	, m_clothIterationOverride( 0 )
+	, m_clothSubsteps( 1 )
 	, m_drawOrigin( false )
 	, m_totalRunTimeSeconds( 0.f )
 	, m_drawDebugCloth( true )
@@ -0,0 +1,125 @@
+#include "../Engine/PerlinNoise.hpp"
+#include "../Engine/Profiler.hpp"
+#include "WindField.hpp"
+
+//-----------------------------------------------------------------------------------------------
+STATIC const float WindField::SLICE_INTERVAL_SECONDS = 0.25f;
+
+static const float REGION_PADDING = 1.f;
+static const float MINIMUM_REGION_EXTENT = 2.f;
+static const float NOISE_BLOCK_SIZE = 8.f;
+static const float NOISE_PERSISTENCE = 0.5f;
+static const unsigned int NOISE_OCTAVES = 2;
+static const float NOISE_TIME_SCALE = 0.5f;
+static const float GUST_STRENGTH = 0.6f;
+static const float TURBULENCE_STRENGTH = 0.4f;
+
+//-----------------------------------------------------------------------------------------------
+//Runs as a background job. Only touches m_slices[ sliceIndex ], which nothing samples until the
+//main thread has seen the build finish and rotated it in.
+void WindField::BuildSlice( unsigned int sliceIndex, unsigned int sliceNumber, const FloatVector3& regionMinimum, const FloatVector3& regionMaximum,
+							const FloatVector3& baseForce )
+{
+	PROFILE_ZONE( "WindField::BuildSlice" );
+
+	Slice& slice = m_slices[ sliceIndex ];
+	slice.sliceNumber = sliceNumber;
+	slice.timeSeconds = static_cast< double >( sliceNumber ) * SLICE_INTERVAL_SECONDS;
+
+	FloatVector3 paddedMinimum = regionMinimum - FloatVector3( REGION_PADDING, REGION_PADDING, REGION_PADDING );
+	FloatVector3 paddedMaximum = regionMaximum + FloatVector3( REGION_PADDING, REGION_PADDING, REGION_PADDING );
+	FloatVector3 cellSize;
+	for( unsigned int axis = 0; axis < 3; ++axis )
+	{
+		float extent = paddedMaximum[ axis ] - paddedMinimum[ axis ];
+		if( extent < MINIMUM_REGION_EXTENT )
+		{
+			paddedMinimum[ axis ] -= 0.5f * ( MINIMUM_REGION_EXTENT - extent );
+			extent = MINIMUM_REGION_EXTENT;
+		}
+		cellSize[ axis ] = extent / ( SAMPLES_PER_AXIS - 1 );
+		slice.inverseCellSize[ axis ] = 1.f / cellSize[ axis ];
+	}
+	slice.origin = paddedMinimum;
+
+	float baseStrength = baseForce.CalculateNorm();
+	if( baseStrength == 0.f )
+	{
+		for( unsigned int i = 0; i < SAMPLES_PER_SLICE; ++i )
+			slice.forces[ i ] = FloatVector3( 0.f, 0.f, 0.f );
+		return;
+	}
+
+	//One noise channel scales the base wind (gusts), three more add turbulence around it
+	static const unsigned int NUMBER_OF_CHANNELS = 4;
+	static const float CHANNEL_OFFSET = 97.f;
+	std::vector< float > xs( SAMPLES_PER_SLICE * NUMBER_OF_CHANNELS ), ys( xs.size() ), zs( xs.size() ), ws( xs.size() ), noise( xs.size() );
+	float noiseTime = static_cast< float >( slice.timeSeconds * NOISE_TIME_SCALE );
+	for( unsigned int channel = 0; channel < NUMBER_OF_CHANNELS; ++channel )
+	{
+		for( unsigned int i = 0; i < SAMPLES_PER_SLICE; ++i )
+		{
+			unsigned int sample = channel * SAMPLES_PER_SLICE + i;
+			xs[ sample ] = paddedMinimum.x + cellSize.x * ( i % SAMPLES_PER_AXIS );
+			ys[ sample ] = paddedMinimum.y + cellSize.y * ( ( i / SAMPLES_PER_AXIS ) % SAMPLES_PER_AXIS );
+			zs[ sample ] = paddedMinimum.z + cellSize.z * ( i / ( SAMPLES_PER_AXIS * SAMPLES_PER_AXIS ) );
+			ws[ sample ] = noiseTime + CHANNEL_OFFSET * channel;
+		}
+	}
+	PerlinNoise4DBatch( &xs[ 0 ], &ys[ 0 ], &zs[ 0 ], &ws[ 0 ], &noise[ 0 ], xs.size(), NOISE_BLOCK_SIZE, NOISE_PERSISTENCE, NOISE_OCTAVES );
+
+	const float* gust = &noise[ 0 ];
+	const float* turbulenceX = &noise[ SAMPLES_PER_SLICE ];
+	const float* turbulenceY = &noise[ 2 * SAMPLES_PER_SLICE ];
+	const float* turbulenceZ = &noise[ 3 * SAMPLES_PER_SLICE ];
+	float turbulenceScale = TURBULENCE_STRENGTH * baseStrength;
+	for( unsigned int i = 0; i < SAMPLES_PER_SLICE; ++i )
+	{
+		slice.forces[ i ] = baseForce * ( 1.f + GUST_STRENGTH * gust[ i ] )
+						  + turbulenceScale * FloatVector3( turbulenceX[ i ], turbulenceY[ i ], turbulenceZ[ i ] );
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+void WindField::StartBuildingNextSlice()
+{
+	unsigned int nextSliceNumber = m_slices[ m_newerSliceIndex ].sliceNumber + 1;
+	m_pendingBuild = JobSystem::RunInBackground( std::bind( &WindField::BuildSlice, this, m_buildingSliceIndex, nextSliceNumber,
+															m_regionMinimum, m_regionMaximum, m_baseForce ) );
+}
+
+//-----------------------------------------------------------------------------------------------
+void WindField::Update( float deltaSeconds, const FloatVector3& regionMinimum, const FloatVector3& regionMaximum )
+{
+	m_regionMinimum = regionMinimum;
+	m_regionMaximum = regionMaximum;
+
+	if( !m_isInitialized )
+	{
+		//A rebuild can't start while a job is still writing its slice
+		WaitForPendingBuild();
+
+		//Rebuild the slices either side of now, where they already were on the timeline
+		unsigned int currentSliceNumber = static_cast< unsigned int >( m_timeSeconds / SLICE_INTERVAL_SECONDS );
+		BuildSlice( m_olderSliceIndex, currentSliceNumber, m_regionMinimum, m_regionMaximum, m_baseForce );
+		BuildSlice( m_newerSliceIndex, currentSliceNumber + 1, m_regionMinimum, m_regionMaximum, m_baseForce );
+		StartBuildingNextSlice();
+		m_isInitialized = true;
+	}
+
+	m_timeSeconds += deltaSeconds;
+
+	//Rotate in the pending slice once we've moved past the newer one, if its job has finished
+	if( m_timeSeconds >= m_slices[ m_newerSliceIndex ].timeSeconds && JobSystem::IsFinished( m_pendingBuild ) )
+	{
+		unsigned int retiredSliceIndex = m_olderSliceIndex;
+		m_olderSliceIndex = m_newerSliceIndex;
+		m_newerSliceIndex = m_buildingSliceIndex;
+		m_buildingSliceIndex = retiredSliceIndex;
+
+		StartBuildingNextSlice();
+	}
+
+	const Slice& olderSlice = m_slices[ m_olderSliceIndex ];
+	m_sliceBlendWeight = ClampNumberToWithin( static_cast< float >( ( m_timeSeconds - olderSlice.timeSeconds ) / SLICE_INTERVAL_SECONDS ), 0.f, 1.f );
+}
@@ -0,0 +1,146 @@
+#ifndef INCLUDED_WIND_FIELD_HPP
+#define INCLUDED_WIND_FIELD_HPP
+#pragma once
+
+//-----------------------------------------------------------------------------------------------
+#include <vector>
+#include "../Engine/Math/EngineMath.hpp"
+#include "../Engine/JobSystem.hpp"
+#include "../Engine/Math/FloatVector3.hpp"
+
+//-----------------------------------------------------------------------------------------------
+//A coarse grid of wind forces around a region, rebuilt from 4D noise as a background job every
+//SLICE_INTERVAL_SECONDS. Samples blend trilinearly inside the two most recent time slices and
+//linearly between them, so a lookup is a few loads instead of a noise evaluation. Slice n always
+//stands for n * SLICE_INTERVAL_SECONDS after the field started, so late builds and rebuilds never
+//shift the timeline the noise is sampled on.
+class WindField
+{
+	static const unsigned int SAMPLES_PER_AXIS = 8;
+	static const unsigned int SAMPLES_PER_SLICE = SAMPLES_PER_AXIS * SAMPLES_PER_AXIS * SAMPLES_PER_AXIS;
+	static const unsigned int NUMBER_OF_SLICES = 3;
+	static const float SLICE_INTERVAL_SECONDS;
+
+	struct Slice
+	{
+		FloatVector3 origin;
+		FloatVector3 inverseCellSize;
+		unsigned int sliceNumber;
+		double timeSeconds;
+		std::vector< FloatVector3 > forces;
+
+		Slice()
+			: sliceNumber( 0 )
+			, timeSeconds( 0.0 )
+			, forces( SAMPLES_PER_SLICE )
+		{ }
+	};
+
+public:
+	WindField();
+	~WindField();
+
+	//Slices bake in the force they were built with, so any change rebuilds them on the next Update
+	//instead of waiting for the new force to work its way through the queued slices.
+	void SetBaseForce( const FloatVector3& baseForce );
+	const FloatVector3& GetBaseForce() const { return m_baseForce; }
+
+	FloatVector3 SampleForceAt( const FloatVector3& position ) const;
+	void Update( float deltaSeconds, const FloatVector3& regionMinimum, const FloatVector3& regionMaximum );
+
+private:
+	WindField( const WindField& );
+	WindField& operator=( const WindField& );
+
+	void BuildSlice( unsigned int sliceIndex, unsigned int sliceNumber, const FloatVector3& regionMinimum, const FloatVector3& regionMaximum,
+					 const FloatVector3& baseForce );
+	void StartBuildingNextSlice();
+	void WaitForPendingBuild();
+	FloatVector3 SampleSlice( const Slice& slice, const FloatVector3& position ) const;
+
+	Slice m_slices[ NUMBER_OF_SLICES ];
+	unsigned int m_olderSliceIndex, m_newerSliceIndex, m_buildingSliceIndex;
+	JobSystem::BackgroundJobHandle m_pendingBuild;
+
+	FloatVector3 m_baseForce;
+	FloatVector3 m_regionMinimum, m_regionMaximum;
+	double m_timeSeconds;
+	float m_sliceBlendWeight;
+	bool m_isInitialized;
+};
+
+
+
+//-----------------------------------------------------------------------------------------------
+inline WindField::WindField()
+	: m_olderSliceIndex( 0 )
+	, m_newerSliceIndex( 1 )
+	, m_buildingSliceIndex( 2 )
+	, m_timeSeconds( 0.0 )
+	, m_sliceBlendWeight( 0.f )
+	, m_isInitialized( false )
+{ }
+
+//-----------------------------------------------------------------------------------------------
+inline WindField::~WindField()
+{
+	WaitForPendingBuild();
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void WindField::SetBaseForce( const FloatVector3& baseForce )
+{
+	if( baseForce != m_baseForce )
+		m_isInitialized = false;
+	m_baseForce = baseForce;
+}
+
+//-----------------------------------------------------------------------------------------------
+inline void WindField::WaitForPendingBuild()
+{
+	if( m_pendingBuild )
+	{
+		JobSystem::WaitFor( m_pendingBuild );
+		m_pendingBuild.reset();
+	}
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3 WindField::SampleForceAt( const FloatVector3& position ) const
+{
+	FloatVector3 olderForce = SampleSlice( m_slices[ m_olderSliceIndex ], position );
+	FloatVector3 newerForce = SampleSlice( m_slices[ m_newerSliceIndex ], position );
+	return olderForce + m_sliceBlendWeight * ( newerForce - olderForce );
+}
+
+//-----------------------------------------------------------------------------------------------
+inline FloatVector3 WindField::SampleSlice( const Slice& slice, const FloatVector3& position ) const
+{
+	static const float LAST_CELL_START = static_cast< float >( SAMPLES_PER_AXIS - 1 ) - 0.0001f;
+
+	//Find the sample position in grid space, holding the border values outside the region
+	float gridX = ClampNumberToWithin( ( position.x - slice.origin.x ) * slice.inverseCellSize.x, 0.f, LAST_CELL_START );
+	float gridY = ClampNumberToWithin( ( position.y - slice.origin.y ) * slice.inverseCellSize.y, 0.f, LAST_CELL_START );
+	float gridZ = ClampNumberToWithin( ( position.z - slice.origin.z ) * slice.inverseCellSize.z, 0.f, LAST_CELL_START );
+	unsigned int cellX = static_cast< unsigned int >( gridX );
+	unsigned int cellY = static_cast< unsigned int >( gridY );
+	unsigned int cellZ = static_cast< unsigned int >( gridZ );
+	float weightX = gridX - cellX;
+	float weightY = gridY - cellY;
+	float weightZ = gridZ - cellZ;
+
+	static const unsigned int STRIDE_Y = SAMPLES_PER_AXIS;
+	static const unsigned int STRIDE_Z = SAMPLES_PER_AXIS * SAMPLES_PER_AXIS;
+	const FloatVector3* corner = &slice.forces[ cellX + cellY * STRIDE_Y + cellZ * STRIDE_Z ];
+
+	FloatVector3 lowerNear = corner[ 0 ]					+ weightX * ( corner[ 1 ]						- corner[ 0 ] );
+	FloatVector3 lowerFar  = corner[ STRIDE_Y ]				+ weightX * ( corner[ STRIDE_Y + 1 ]			- corner[ STRIDE_Y ] );
+	FloatVector3 upperNear = corner[ STRIDE_Z ]				+ weightX * ( corner[ STRIDE_Z + 1 ]			- corner[ STRIDE_Z ] );
+	FloatVector3 upperFar  = corner[ STRIDE_Z + STRIDE_Y ]	+ weightX * ( corner[ STRIDE_Z + STRIDE_Y + 1 ] - corner[ STRIDE_Z + STRIDE_Y ] );
+
+	FloatVector3 lower = lowerNear + weightY * ( lowerFar - lowerNear );
+	FloatVector3 upper = upperNear + weightY * ( upperFar - upperNear );
+	return lower + weightZ * ( upper - lower );
+}
+
+#endif //INCLUDED_WIND_FIELD_HPP